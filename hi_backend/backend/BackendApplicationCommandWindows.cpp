@@ -809,9 +809,22 @@ public:
 		}
 	}
 
+	struct Reporter : public SampleMapToWavetableConverter::ProgressReporter
+	{
+		Reporter(WavetableConverterDialog& parent_) : parent(parent_) {};
+
+		void stageChanged(const String& stageName) override { parent.showStatusMessage(stageName); }
+		void progressChanged(double progress) override { parent.setProgress(progress); }
+		bool shouldCancel() override { return parent.threadShouldExit(); }
+
+		WavetableConverterDialog& parent;
+	};
+
 	void run() override
 	{
-		converter->renderAllWavetablesFromHarmonicMaps(getProgressCounter());
+		Reporter reporter(*this);
+
+		r = converter->convertAllMaps(reporter);
 
 		if (threadShouldExit())
 			return;
@@ -631,7 +631,7 @@ public:
 
 		table.setMultipleSelectionEnabled(false);
 
-		table.getHeader().addColumn("CC #", CCNumber, 40, 40, 40);
+		table.getHeader().addColumn("CC #", CCNumber, 70, 70, 70);
 		table.getHeader().addColumn("Parameter", ParameterName, 70);
 		table.getHeader().addColumn("Inverted", Inverted, 50, 50, 50);
 		table.getHeader().addColumn("Min", Minimum, 70, 70, 70);
@@ -836,7 +836,7 @@ public:
 		if (columnId == ColumnId::ParameterName)
 			text = ProcessorHelpers::getPrettyNameForAutomatedParameter(data.processor, data.attribute);
 		else if (columnId == ColumnId::CCNumber)
-			text = String(data.ccNumber);
+			text = data.getControllerName();
 		
 		g.drawText(text, 2, 0, width - 4, height, Justification::centredLeft, true);
 
@@ -30,7 +30,10 @@
 *
 * - Real-complex FFT and complex-real inverse FFT for power-of-2-sized real data.
 *
-* - Uniform interface to different FFT implementations (currently Ooura, FFTW3 and Apple Accelerate).
+* - Uniform interface to different FFT implementations (currently Ooura, FFTW3, Apple Accelerate, IPP
+*   and a SIMD implementation).
+*
+* - BestAvailable measures the available implementations once per FFT size and picks the fastest one.
 *
 * - Complex data is handled in "split-complex" format, i.e. there are separate
 *   arrays for the real and imaginary parts which can be useful for SIMD optimizations
@@ -100,6 +103,7 @@ namespace audiofft
 		AppleAccelerate,
 		Ooura,
 		FFTW3,
+		SIMD,
 		numImplementationTypes
 	};
 
@@ -136,9 +140,17 @@ namespace audiofft
     /**
      * @brief Initializes the FFT object
      * @param size Size of the real input (must be power 2)
+     *
+     * If the object was created with BestAvailable, this picks the fastest implementation
+     * for the given size (see getFastestImplementation()), so don't call it on the audio thread.
      */
     void init(size_t size);
 
+    /**
+     * @brief Returns the implementation that is currently used
+     */
+    ImplementationType getImplementationType() const;
+
     /**
      * @brief Performs the forward FFT
      * @param data The real input data (has to be of the length as specified in init())
@@ -162,7 +174,34 @@ namespace audiofft
      */
     static size_t ComplexSize(size_t size);
 
+    /**
+     * @brief Checks whether the implementation can be used on this platform / build
+     */
+    static bool isAvailable(ImplementationType type);
+
+    /**
+     * @brief Returns the fastest available implementation for the given size
+     *
+     * The first call for each size runs a short benchmark of all available implementations.
+     * The result is cached, so subsequent calls (and all other FFT objects with this size) are cheap.
+     */
+    static ImplementationType getFastestImplementation(size_t size);
+
+    /**
+     * @brief Returns the preferred available implementation without measuring anything
+     *
+     * This is Apple Accelerate or IPP if available, otherwise Ooura. FFTW3 and SIMD are
+     * never picked here. Use this instead of BestAvailable if the result must not depend
+     * on a benchmark (the implementations differ in their rounding errors).
+     */
+    static ImplementationType getDefaultImplementation();
+
   private:
+
+    void createImplementation(ImplementationType type);
+
+    ImplementationType _requestedType;
+    ImplementationType _currentType;
     std::unique_ptr<detail::AudioFFTImpl> _impl;
   };
 
@@ -0,0 +1,158 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+namespace hise {
+using namespace juce;
+
+FFTService::Plan::Plan(int size_, audiofft::ImplementationType type) :
+	size(size_),
+	numBins((int)audiofft::AudioFFT::ComplexSize((size_t)size_)),
+	requestedType(type),
+	fft(type)
+{
+	jassert(isPowerOfTwo(size));
+
+	fft.init((size_t)size);
+
+	// 4 spectrums for the complex FFT and one signal buffer for the inverse
+	scratch.calloc(4 * numBins + size);
+}
+
+void FFTService::Plan::forward(const float* input, float* re, float* im) noexcept
+{
+	fft.fft(input, re, im);
+}
+
+void FFTService::Plan::inverse(float* output, const float* re, const float* im) noexcept
+{
+	fft.ifft(output, re, im);
+}
+
+void FFTService::Plan::forwardBatch(const float* const* inputs, float* const* re, float* const* im, int numTransforms) noexcept
+{
+	// The tables of the plan stay in the cache for all transforms
+	for (int i = 0; i < numTransforms; i++)
+		fft.fft(inputs[i], re[i], im[i]);
+}
+
+void FFTService::Plan::inverseBatch(float* const* outputs, const float* const* re, const float* const* im, int numTransforms) noexcept
+{
+	for (int i = 0; i < numTransforms; i++)
+		fft.ifft(outputs[i], re[i], im[i]);
+}
+
+void FFTService::Plan::forwardMagnitudes(const float* input, float* magnitudes) noexcept
+{
+	auto re = scratch.get();
+	auto im = re + numBins;
+
+	fft.fft(input, re, im);
+	calculateMagnitudes(re, im, magnitudes, numBins);
+}
+
+void FFTService::Plan::complexForward(const float* inputRe, const float* inputIm, float* outputRe, float* outputIm) noexcept
+{
+	auto xRe = scratch.get();
+	auto xIm = xRe + numBins;
+	auto yRe = xIm + numBins;
+	auto yIm = yRe + numBins;
+
+	// FFT(x + iy) = X + iY, where X and Y are the (hermitian) spectrums of the real and the imaginary part
+	fft.fft(inputRe, xRe, xIm);
+	fft.fft(inputIm, yRe, yIm);
+
+	for (int k = 0; k < numBins; k++)
+	{
+		outputRe[k] = xRe[k] - yIm[k];
+		outputIm[k] = xIm[k] + yRe[k];
+	}
+
+	// The upper half uses the conjugated bins of the lower half
+	for (int k = numBins; k < size; k++)
+	{
+		const int m = size - k;
+
+		outputRe[k] = xRe[m] + yIm[m];
+		outputIm[k] = yRe[m] - xIm[m];
+	}
+}
+
+void FFTService::Plan::complexInverse(const float* inputRe, const float* inputIm, float* outputRe, float* outputIm) noexcept
+{
+	auto conjugated = scratch.get() + 4 * numBins;
+
+	// IFFT(z) = conj(FFT(conj(z))) / N
+	FloatVectorOperations::multiply(conjugated, inputIm, -1.0f, size);
+
+	complexForward(inputRe, conjugated, outputRe, outputIm);
+
+	const float scale = 1.0f / (float)size;
+
+	FloatVectorOperations::multiply(outputRe, scale, size);
+	FloatVectorOperations::multiply(outputIm, -scale, size);
+}
+
+FFTService::Plan::Ptr FFTService::getPlan(int size, audiofft::ImplementationType type)
+{
+	ScopedLock sl(planLock);
+
+	for (auto p : plans)
+	{
+		// The reference in the pool is the only one, so nobody else is using this plan
+		if (p->getSize() == size && p->getRequestedType() == type && p->getReferenceCount() == 1)
+			return p;
+	}
+
+	Plan::Ptr newPlan = new Plan(size, type);
+	plans.add(newPlan);
+
+	return newPlan;
+}
+
+void FFTService::clearUnusedPlans()
+{
+	ScopedLock sl(planLock);
+
+	for (int i = plans.size() - 1; i >= 0; i--)
+	{
+		if (plans.getUnchecked(i)->getReferenceCount() == 1)
+			plans.remove(i);
+	}
+}
+
+void FFTService::calculateMagnitudes(const float* re, const float* im, float* magnitudes, int numBins) noexcept
+{
+	for (int i = 0; i < numBins; i++)
+		magnitudes[i] = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+}
+
+} // namespace hise
@@ -0,0 +1,137 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef FFTSERVICE_H_INCLUDED
+#define FFTSERVICE_H_INCLUDED
+
+namespace hise {
+using namespace juce;
+
+/** A pool of FFT plans that can be shared between all FFT users.
+*	@ingroup core
+*
+*	Use a SharedResourcePointer<FFTService> to access the global instance and call getPlan() to obtain a plan
+*	for a given size. Creating a plan allocates the FFT tables and scratch buffers, so it must not be done on
+*	the audio thread, but the execution of a plan doesn't allocate anything and is realtime safe.
+*
+*	A plan must only be used by one thread at the same time. The service hands out plans that are not referenced
+*	elsewhere, so if you need multiple FFTs of the same size in parallel, just ask for multiple plans.
+*
+*	If the implementation type is audiofft::ImplementationType::BestAvailable, the fastest implementation for the
+*	size is chosen by a short benchmark that runs the first time a size is requested (see 
+*	audiofft::AudioFFT::getFastestImplementation()).
+*/
+class FFTService
+{
+public:
+
+	/** A preallocated FFT of a fixed size. */
+	class Plan : public ReferenceCountedObject
+	{
+	public:
+
+		using Ptr = ReferenceCountedObjectPtr<Plan>;
+
+		Plan(int size, audiofft::ImplementationType type);
+
+		/** The size of the real signal. */
+		int getSize() const noexcept { return size; }
+
+		/** The number of bins of the real spectrum (size / 2 + 1). */
+		int getNumBins() const noexcept { return numBins; }
+
+		/** Returns the implementation that was picked for this plan. */
+		audiofft::ImplementationType getImplementationType() const noexcept { return fft.getImplementationType(); }
+
+		/** Returns the implementation type that was passed into getPlan(). */
+		audiofft::ImplementationType getRequestedType() const noexcept { return requestedType; }
+
+		/** Calculates the spectrum of the real signal (with 'size' samples). re and im must have getNumBins() elements. */
+		void forward(const float* input, float* re, float* im) noexcept;
+
+		/** Calculates the real signal from the spectrum. The result is scaled so that inverse(forward(x)) == x. */
+		void inverse(float* output, const float* re, const float* im) noexcept;
+
+		/** Calculates the spectrum of multiple signals (eg. all channels or voices) with the same plan. */
+		void forwardBatch(const float* const* inputs, float* const* re, float* const* im, int numTransforms) noexcept;
+
+		/** Calculates multiple real signals from their spectrum. */
+		void inverseBatch(float* const* outputs, const float* const* re, const float* const* im, int numTransforms) noexcept;
+
+		/** Calculates the magnitudes of the spectrum of the real signal. magnitudes must have getNumBins() elements. */
+		void forwardMagnitudes(const float* input, float* magnitudes) noexcept;
+
+		/** Calculates the complex FFT of the split complex signal. All buffers must have getSize() elements.
+		*
+		*	It uses two real FFTs and the symmetry of their spectrum, so it works with all implementations.
+		*	The input and output buffers may be the same.
+		*/
+		void complexForward(const float* inputRe, const float* inputIm, float* outputRe, float* outputIm) noexcept;
+
+		/** Calculates the inverse complex FFT (scaled by 1 / size). */
+		void complexInverse(const float* inputRe, const float* inputIm, float* outputRe, float* outputIm) noexcept;
+
+	private:
+
+		const int size;
+		const int numBins;
+		const audiofft::ImplementationType requestedType;
+
+		audiofft::AudioFFT fft;
+
+		HeapBlock<float> scratch;
+
+		JUCE_DECLARE_NON_COPYABLE(Plan);
+	};
+
+	FFTService() {};
+
+	/** Returns a plan for the given size that isn't used anywhere else. This might allocate, so don't call it on the audio thread. */
+	Plan::Ptr getPlan(int size, audiofft::ImplementationType type = audiofft::ImplementationType::BestAvailable);
+
+	/** Removes all plans that are not used anymore. */
+	void clearUnusedPlans();
+
+	/** Calculates the magnitudes of the split complex spectrum. */
+	static void calculateMagnitudes(const float* re, const float* im, float* magnitudes, int numBins) noexcept;
+
+private:
+
+	CriticalSection planLock;
+	ReferenceCountedArray<Plan> plans;
+
+	JUCE_DECLARE_NON_COPYABLE(FFTService);
+};
+
+} // namespace hise
+
+#endif  // FFTSERVICE_H_INCLUDED
@@ -67,6 +67,9 @@ public:
 		testAlignment<16>(128);
 		testAlignment<1>(128);
 		testAlignment<32>(32);
+		testEventScheduler(128, 64);
+		testEventScheduler(37, 5000);
+		testEventScheduler(1000, 300000);
 	}
 
 private:
@@ -793,7 +796,98 @@ private:
 
 	}
 
+	void testEventScheduler(int blockSize, int maxDelay)
+	{
+		beginTest("Testing HiseEventScheduler with block size " + String(blockSize) + " and delays up to " + String(maxDelay));
+
+		HiseEventScheduler scheduler(512);
+		HiseEventBuffer b;
+		Random r;
+
+		struct Expected
+		{
+			int64 position;
+			int index;
+		};
+
+		Array<Expected> expected;
+		Array<Expected> received;
+
+		int index = 0;
+
+		const int numBlocks = (maxDelay * 2) / blockSize + 8;
+
+		for (int block = 0; block < numBlocks; block++)
+		{
+			const int64 blockStart = scheduler.getCurrentPosition();
+
+			expectEquals<int64>(blockStart, (int64)block * (int64)blockSize, "Position advances with the block");
+
+			// Add a few events in the first half, including some with equal timestamps
+			if (block < numBlocks / 2)
+			{
+				const int numToAdd = r.nextInt(4);
+				const int sharedDelay = r.nextInt(maxDelay);
+
+				for (int i = 0; i < numToAdd; i++)
+				{
+					const int delay = (i % 2 == 0) ? sharedDelay : r.nextInt(maxDelay);
+
+					HiseEvent e(HiseEvent::Type::Controller, (uint8)(index % 128), (uint8)(index / 128 % 128), 1);
+					e.setTimeStamp(delay);
+
+					scheduler.addEvent(e);
+					expected.add({ blockStart + delay, index++ });
+				}
+			}
+
+			b.clear();
+			scheduler.moveDueEvents(b, blockSize);
+
+			HiseEventBuffer::Iterator it(b);
 
+			while (auto e = it.getNextConstEventPointer())
+			{
+				expect(e->getTimeStamp() < blockSize, "Timestamp inside block");
+				received.add({ blockStart + e->getTimeStamp(), e->getControllerNumber() + e->getControllerValue() * 128 });
+			}
+		}
+
+		expect(scheduler.isEmpty(), "All events were delivered");
+
+		struct Sorter
+		{
+			static int compareElements(const Expected& a, const Expected& b)
+			{
+				if (a.position < b.position) return -1;
+				if (a.position > b.position) return 1;
+				return 0;
+			}
+		};
+
+		Sorter s;
+		expected.sort(s, true);
+
+		expectEquals(received.size(), expected.size(), "Number of events");
+
+		int numErrors = 0;
+
+		for (int i = 0; i < jmin(received.size(), expected.size()); i++)
+		{
+			if (received[i].position != expected[i].position || received[i].index != expected[i].index)
+				numErrors++;
+		}
+
+		expectEquals<int>(numErrors, 0, "Events are delivered in order at the right position");
+
+		HiseEvent late(HiseEvent::Type::NoteOn, 64, 127, 1);
+		scheduler.addEventAtPosition(late, scheduler.getCurrentPosition() - 1000);
+
+		b.clear();
+		scheduler.moveDueEvents(b, blockSize);
+		expectEquals<int>(b.getNumUsed(), 1, "Events in the past are due in the next block");
+		expectEquals<int>(b.getEvent(0).getTimeStamp(), 0, "Events in the past are moved to the block start");
+	}
 };
 
 static HiseEventUnitTest eventBufferTestInstance;
@@ -33,15 +33,79 @@
 namespace hise { using namespace juce;
 
 MacroControlBroadcaster::MacroControlBroadcaster(ModulatorSynthChain *chain):
-	thisAsSynth(chain)
+	thisAsSynth(chain),
+	notificationTimer(*this)
 {
-	for(int i = 0; i < 8; i++)
+	for(int i = 0; i < NumDefaultMacros; i++)
 	{
 		macroControls.add(new MacroControlData(i));
 		
 	}
 }
 
+void MacroControlBroadcaster::MacroMapping::compile(const NormalisableRange<double>& range, bool inverted)
+{
+	for (int i = 0; i <= TableSize; i++)
+	{
+		const double normalisedValue = (double)i / (double)TableSize;
+
+		table[i] = (float)range.convertFrom0to1(inverted ? (1.0 - normalisedValue) : normalisedValue);
+	}
+
+	// Force the next advance() to report the value with the new mapping
+	initialised = false;
+}
+
+float MacroControlBroadcaster::MacroMapping::getValue(float macroValue) const noexcept
+{
+	const float index = jlimit(0.0f, (float)TableSize, macroValue * ((float)TableSize / 127.0f));
+
+	const int i0 = jmin<int>((int)index, TableSize - 1);
+	const float alpha = index - (float)i0;
+
+	return table[i0] + alpha * (table[i0 + 1] - table[i0]);
+}
+
+void MacroControlBroadcaster::MacroMapping::setMacroValue(float macroValue, int numSmoothingSamples) noexcept
+{
+	targetValue = getValue(macroValue);
+
+	if (numSmoothingSamples <= 0 || !initialised)
+	{
+		currentValue = targetValue;
+		numRampSamples = 0;
+	}
+	else
+	{
+		delta = (targetValue - currentValue) / (float)numSmoothingSamples;
+		numRampSamples = numSmoothingSamples;
+	}
+}
+
+bool MacroControlBroadcaster::MacroMapping::advance(int numSamples) noexcept
+{
+	if (numRampSamples > 0 && numSamples > 0)
+	{
+		if (numSamples >= numRampSamples)
+		{
+			currentValue = targetValue;
+			numRampSamples = 0;
+		}
+		else
+		{
+			currentValue += delta * (float)numSamples;
+			numRampSamples -= numSamples;
+		}
+	}
+
+	if (initialised && currentValue == lastValue)
+		return false;
+
+	lastValue = currentValue;
+	initialised = true;
+	return true;
+}
+
 
 /** Creates a new Parameter data object. */
 MacroControlBroadcaster::MacroControlledParameterData::MacroControlledParameterData(Processor *p, int  parameter_, const String &parameterName_, NormalisableRange<double> range_, bool readOnly):
@@ -53,7 +117,9 @@ MacroControlBroadcaster::MacroControlledParameterData::MacroControlledParameterD
 	parameterRange(range_),
 	inverted(false),
 	readOnly(readOnly)
-{};
+{
+	mapping.compile(parameterRange, inverted);
+};
 
 /** Restores a Parameter object from an exported XML document. 
 *
@@ -69,7 +135,10 @@ MacroControlBroadcaster::MacroControlledParameterData::MacroControlledParameterD
 {
 	parameterRange = NormalisableRange<double>(xml.getDoubleAttribute("low", 0.0), xml.getDoubleAttribute("high", 1.0));
 	inverted = xml.getBoolAttribute("inverted", false);
+	smoothingTimeMs = xml.getDoubleAttribute("smoothing", 0.0);
 	controlledProcessor = findProcessor(chain, id);
+
+	mapping.compile(parameterRange, inverted);
 }
 
 /** Allows comparison. This only compares the Processor and the parameter (not the range). */
@@ -78,6 +147,24 @@ bool MacroControlBroadcaster::MacroControlledParameterData::operator== (const Ma
 	return other.id == id && other.parameter == parameter;
 }
 
+void MacroControlBroadcaster::MacroControlledParameterData::setInverted(bool shouldBeInverted)
+{
+	inverted = shouldBeInverted;
+	mapping.compile(parameterRange, inverted);
+}
+
+void MacroControlBroadcaster::MacroControlledParameterData::setRangeStart(double min)
+{
+	parameterRange.start = min;
+	mapping.compile(parameterRange, inverted);
+}
+
+void MacroControlBroadcaster::MacroControlledParameterData::setRangeEnd(double max)
+{
+	parameterRange.end = max;
+	mapping.compile(parameterRange, inverted);
+}
+
 void MacroControlBroadcaster::MacroControlledParameterData::setAttribute(double normalizedInputValue)
 {
 	
@@ -124,6 +211,9 @@ XmlElement *MacroControlBroadcaster::MacroControlledParameterData::exportAsXml()
 	entry->setAttribute("inverted", inverted);
 	entry->setAttribute("readonly", readOnly);
 
+	if (smoothingTimeMs > 0.0)
+		entry->setAttribute("smoothing", smoothingTimeMs);
+
 	return entry;
 }
 
@@ -189,13 +279,14 @@ void MacroControlBroadcaster::loadMacrosFromValueTree(const ValueTree &v)
 
 	ScopedPointer<XmlElement> data = macroData.createXml();
 
-	if(data != nullptr && data->getNumChildElements() == 8)
+	if(data != nullptr && data->getNumChildElements() >= NumDefaultMacros)
 	{
 		macroControls.clear();
 
 		for(int i = 0; i < data->getNumChildElements(); i++)
 		{
 			macroControls.add(new MacroControlData(thisAsSynth, data->getChildElement(i)));
+			macroControls.getLast()->setSampleRate(macroSampleRate);
 
 			thisAsSynth->getMainController()->getMacroManager().setMidiControllerForMacro(i, macroControls.getLast()->getMidiController());
 		}
@@ -240,6 +331,7 @@ void MacroControlBroadcaster::replaceMacroControlData(int index, MacroControlDat
 		ScopedPointer<XmlElement> xml = newData->exportAsXml();
 
 		MacroControlData *copy = new MacroControlData(parentChain, xml);
+		copy->setSampleRate(macroSampleRate);
 
 		macroControls.set(index, copy);
 	}
@@ -295,16 +387,75 @@ void MacroControlBroadcaster::clearData(int macroIndex)
 
 void MacroControlBroadcaster::MacroControlData::setValue(float newValue)
 {
-	currentValue = newValue;
+	currentValue.store(newValue);
+	valueChangePending.store(true);
+};
 
-	for(int i = 0; i < controlledParameters.size(); i++)
+void MacroControlBroadcaster::MacroControlData::processPendingChanges(int numSamples)
+{
+	if (valueChangePending.exchange(false))
 	{
-		MacroControlledParameterData *pData = controlledParameters[i];
-			
-		pData->setAttribute(newValue / 127.0f);
+		const float newValue = currentValue.load();
+
+		for (auto pData : controlledParameters)
+		{
+			const int numSmoothingSamples = sampleRate > 0.0 ? roundToInt(pData->getSmoothingTime() * 0.001 * sampleRate) : 0;
+
+			pData->getMapping().setMacroValue(newValue, numSmoothingSamples);
+		}
+
+		// Apply all values (the parameters might have been changed by something else)
+		applyMappings(0, true);
 	}
+	else if (numSmoothingParameters > 0)
+	{
+		applyMappings(numSamples, false);
+	}
+}
 
-};
+void MacroControlBroadcaster::MacroControlData::applyMappings(int numSamples, bool forceUpdate)
+{
+	int numSmoothing = 0;
+	bool anyChanged = false;
+
+	for (auto pData : controlledParameters)
+	{
+		auto& m = pData->getMapping();
+
+		const bool changed = m.advance(numSamples);
+
+		if (changed || forceUpdate)
+		{
+			if (auto p = pData->getProcessor())
+			{
+				p->setAttribute(pData->getParameter(), m.getCurrentValue(), dontSendNotification);
+				anyChanged |= pData->isReadOnly();
+			}
+		}
+
+		numSmoothing += m.isSmoothing() ? 1 : 0;
+	}
+
+	numSmoothingParameters = numSmoothing;
+
+	if (anyChanged)
+		parametersChanged.store(true);
+}
+
+void MacroControlBroadcaster::MacroControlData::sendPendingParameterNotifications()
+{
+	if (!parametersChanged.exchange(false))
+		return;
+
+	for (auto pData : controlledParameters)
+	{
+		if (!pData->isReadOnly())
+			continue;
+
+		if (auto p = pData->getProcessor())
+			p->sendChangeMessage();
+	}
+}
 
 bool MacroControlBroadcaster::MacroControlData::isDanglingProcessor(int parameterIndex)
 {
@@ -338,7 +489,7 @@ XmlElement *MacroControlBroadcaster::MacroControlData::exportAsXml()
 
 	macro->setAttribute("name", macroName);
 
-	macro->setAttribute("value", currentValue);
+	macro->setAttribute("value", currentValue.load());
 	
 	macro->setAttribute("midi_cc", midiController);
 
@@ -393,9 +544,94 @@ void MacroControlBroadcaster::setMacroControl(int macroIndex, float newValue, No
 {
 	MacroControlData *data = getMacroControlData(macroIndex);
 
+	if (data == nullptr)
+	{
+		jassertfalse;
+		return;
+	}
+
 	data->setValue(newValue);
 
-	
+	auto& ksh = thisAsSynth->getMainController()->getKillStateHandler();
+
+	// Without a running audio callback nobody would pick up the value, so apply it here
+	if (!ksh.isAudioRunning() && ksh.getCurrentThread() != MainController::KillStateHandler::AudioThread)
+	{
+		LockHelpers::SafeLock sl(thisAsSynth->getMainController(), LockHelpers::AudioLock);
+		data->processPendingChanges(0);
+	}
+
+	if (notifyEditor == sendNotification)
+		data->pendingHostUpdate.store(true);
+
+	if (notifyEditor == sendNotification || notifyEditor == sendNotificationAsync)
+		data->pendingEditorUpdate.store(true);
+}
+
+void MacroControlBroadcaster::setNumMacroControls(int numMacroControls)
+{
+	numMacroControls = jlimit<int>(NumDefaultMacros, MainController::MacroManager::MaxNumMacros, numMacroControls);
+
+	if (numMacroControls == macroControls.size())
+		return;
+
+	{
+		LockHelpers::SafeLock sl(thisAsSynth->getMainController(), LockHelpers::AudioLock);
+
+		while (macroControls.size() > numMacroControls)
+		{
+			clearData(macroControls.size() - 1);
+			macroControls.removeLast();
+		}
+
+		while (macroControls.size() < numMacroControls)
+		{
+			auto newData = new MacroControlData(macroControls.size());
+			newData->setSampleRate(macroSampleRate);
+			macroControls.add(newData);
+		}
+	}
+
+	thisAsSynth->sendChangeMessage();
+}
+
+void MacroControlBroadcaster::prepareMacroControls(double sampleRate)
+{
+	macroSampleRate = sampleRate;
+
+	for (auto data : macroControls)
+		data->setSampleRate(sampleRate);
+}
+
+void MacroControlBroadcaster::processMacroSmoothing(int numSamples)
+{
+	for (auto data : macroControls)
+	{
+		if (data->needsProcessing())
+			data->processPendingChanges(numSamples);
+	}
+}
+
+void MacroControlBroadcaster::NotificationTimer::timerCallback()
+{
+	for (int i = 0; i < parent.macroControls.size(); i++)
+	{
+		auto data = parent.macroControls[i];
+
+		data->sendPendingParameterNotifications();
+
+		const bool hostUpdate = data->pendingHostUpdate.exchange(false);
+		const bool editorUpdate = data->pendingEditorUpdate.exchange(false);
+
+		if (hostUpdate)
+			parent.sendMacroControlChangeMessage(i, data->getCurrentValue(), sendNotification);
+		else if (editorUpdate)
+			parent.sendMacroControlChangeMessage(i, data->getCurrentValue(), sendNotificationAsync);
+	}
+}
+
+void MacroControlBroadcaster::sendMacroControlChangeMessage(int macroIndex, float newValue, NotificationType notifyEditor)
+{
 	if(notifyEditor == sendNotificationAsync)
 	{
 		thisAsSynth->sendChangeMessage();
@@ -45,9 +45,56 @@ class MacroControlBroadcaster
 {
 public:
 
+	/** The number of macro slots that are always available. You can add more with setNumMacroControls(). */
+	static constexpr int NumDefaultMacros = 8;
+
 	/** Creates a new MacroControlBroadcaster with eight Macro slots. */
 	MacroControlBroadcaster(ModulatorSynthChain *chain);
 
+	/** A mapping curve of a macro controlled parameter that is compiled into a lookup table.
+	*	@ingroup macroControl
+	*
+	*	Setting a macro value only interpolates between two table values instead of converting every
+	*	target through its NormalisableRange. It also holds the smoothing state of the target, so that
+	*	the values can be ramped at block rate.
+	*/
+	struct MacroMapping
+	{
+		/** The number of table segments for the macro range 0 - 127. */
+		static constexpr int TableSize = 256;
+
+		MacroMapping() { compile(NormalisableRange<double>(), false); }
+
+		/** Fills the lookup table with the values of the range. */
+		void compile(const NormalisableRange<double>& range, bool inverted);
+
+		/** Returns the target value for the macro value (0 - 127). */
+		float getValue(float macroValue) const noexcept;
+
+		/** Sets the new target value. If numSmoothingSamples is zero, the value is applied with the next call to advance(). */
+		void setMacroValue(float macroValue, int numSmoothingSamples) noexcept;
+
+		/** Advances the smoothing and returns true if the value has changed since the last call. */
+		bool advance(int numSamples) noexcept;
+
+		/** Returns true if the value is ramping to a new target. */
+		bool isSmoothing() const noexcept { return numRampSamples > 0; }
+
+		float getCurrentValue() const noexcept { return currentValue; }
+
+	private:
+
+		float table[TableSize + 1];
+
+		float currentValue = 0.0f;
+		float targetValue = 0.0f;
+		float delta = 0.0f;
+		int numRampSamples = 0;
+
+		float lastValue = 0.0f;
+		bool initialised = false;
+	};
+
 	/** A simple POD object to store information about a macro controlled parameter. 
 	*	@ingroup macroControl
 	*
@@ -71,7 +118,7 @@ public:
 		void setAttribute(double normalizedInputValue);
 
 		/** Inverts the range of the parameter. */
-		void setInverted(bool shouldBeInverted) { inverted = shouldBeInverted; };
+		void setInverted(bool shouldBeInverted);
 
 		/** Sets the parameter to be read only. 
 		*
@@ -105,10 +152,18 @@ public:
 		float getNormalizedValue(double normalizedSliderInput);
 
 		/** set the range start that is used by the macro control. */
-		void setRangeStart(double min) {parameterRange.start = min; };
+		void setRangeStart(double min);
 
 		/** set the range end that is used by the macro control. */
-		void setRangeEnd(double max) {	parameterRange.end = max; };
+		void setRangeEnd(double max);
+
+		/** Sets the time in milliseconds that the parameter needs to follow a macro change. */
+		void setSmoothingTime(double newSmoothingTimeMs) { smoothingTimeMs = jmax<double>(0.0, newSmoothingTimeMs); }
+
+		double getSmoothingTime() const noexcept { return smoothingTimeMs; }
+
+		/** Returns the compiled mapping curve. */
+		MacroMapping& getMapping() noexcept { return mapping; }
 
 		/** returns the processor that the parameter is connected to. This may be nullptr, if the Processor was deleted. */
 		Processor *getProcessor() {return controlledProcessor.get(); };
@@ -158,6 +213,10 @@ public:
 
 		bool readOnly;
 
+		double smoothingTimeMs = 0.0;
+
+		MacroMapping mapping;
+
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MacroControlledParameterData)
 	};
 
@@ -197,11 +256,28 @@ public:
 		*
 		*	@param newValue the value from 0 to 127 (the knob range).
 		*
-		*	This iterates all parameters that this controller is connected to and sets the attribute.
-		*	It also saves the parameter so that other objects have access to the current value (useful if using scripting)
+		*	This only publishes the new value and can be called from any thread. The audio thread picks it
+		*	up in processPendingChanges(), updates the compiled mappings and sets the attributes that have
+		*	changed. The notifications for the parameters are sent later from the message thread.
 		*/
 		void setValue(float newValue);
 
+		/** Sets the sample rate that is used to calculate the smoothing times. */
+		void setSampleRate(double newSampleRate) noexcept { sampleRate = newSampleRate; }
+
+		/** Applies the last value that was passed into setValue() and advances the smoothing of the parameters.
+		*
+		*	This owns the ramp state of the mappings, so it must only be called from the audio thread (or with
+		*	the audio lock held if the audio isn't running).
+		*/
+		void processPendingChanges(int numSamples);
+
+		/** Returns true if a new value is pending or any parameter is ramping to a new value. */
+		bool needsProcessing() const noexcept { return valueChangePending.load() || numSmoothingParameters > 0; }
+
+		/** Sends the change messages for the parameters that were changed since the last call. */
+		void sendPendingParameterNotifications();
+
 		/** Checks if the processor of the parameter still exists. */
 		bool isDanglingProcessor(int parameterIndex);
 
@@ -287,14 +363,29 @@ public:
 
 		int getMidiController() const noexcept { return midiController; };
 
+		/** The notifications that were requested by setMacroControl() and are sent from the message thread. */
+		std::atomic<bool> pendingEditorUpdate { false };
+		std::atomic<bool> pendingHostUpdate { false };
+
 	private:
 
+		/** Sets the attributes of all parameters whose mapped value has changed. */
+		void applyMappings(int numSamples, bool forceUpdate);
+
 		String macroName;
 
-		float currentValue;
+		std::atomic<float> currentValue;
+
+		std::atomic<bool> valueChangePending { false };
 
 		int midiController;
 
+		double sampleRate = 0.0;
+
+		int numSmoothingParameters = 0;
+
+		std::atomic<bool> parametersChanged { false };
+
 		OwnedArray<MacroControlledParameterData> controlledParameters;
 
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MacroControlData)
@@ -303,9 +394,33 @@ public:
 	/** Small helper function that iterates all child processors and returns the matching Processor with the given ID. */
 	static Processor *findProcessor(Processor *p, const String &idToSearch);
 
-	/** sets the macro control to the supplied value and sends a notification message if desired. */
+	/** sets the macro control to the supplied value and sends a notification message if desired. 
+	*
+	*	The value is applied immediately, but the notifications are sent asynchronously from the message thread,
+	*	so you can call this from the audio thread.
+	*/
 	void setMacroControl(int macroIndex, float newValue, NotificationType notifyEditor=dontSendNotification);
 
+	/** Returns the number of macro controls. */
+	int getNumMacroControls() const noexcept { return macroControls.size(); }
+
+	/** Changes the number of macro controls. There are at least NumDefaultMacros and at most MacroManager::MaxNumMacros slots.
+	*
+	*	Call this from the message thread. Removing macros clears their parameters.
+	*/
+	void setNumMacroControls(int numMacroControls);
+
+	/** Sets the sample rate for the smoothing of the macro controlled parameters. */
+	void prepareMacroControls(double sampleRate);
+
+	/** Applies the pending macro values and advances the smoothing. Call this once per block before the rendering. */
+	void processMacroSmoothing(int numSamples);
+
+	/** Sends the notification for a macro control value without changing it. 
+	*
+	*	Use this on the message thread if the value was set on the audio thread with dontSendNotification. */
+	void sendMacroControlChangeMessage(int macroIndex, float newValue, NotificationType notifyEditor);
+
 	/** searches all macroControls and returns the index of the control if the supplied parameter is mapped or -1 if it is not mapped. */
 	int getMacroControlIndexForProcessorParameter(const Processor *p, int parameter) const
 	{
@@ -387,10 +502,28 @@ public:
 
 private:
 
+	/** Sends the notifications that were deferred by setMacroControl(). */
+	struct NotificationTimer : private Timer
+	{
+		NotificationTimer(MacroControlBroadcaster& parent_) : parent(parent_) { startTimer(30); }
+
+		~NotificationTimer() { stopTimer(); }
+
+	private:
+
+		void timerCallback() override;
+
+		MacroControlBroadcaster& parent;
+	};
+
 	OwnedArray<MacroControlData> macroControls;
 	
 	ModulatorSynthChain *thisAsSynth;
 
+	double macroSampleRate = 0.0;
+
+	NotificationTimer notificationTimer;
+
 };
 
 } // namespace hise
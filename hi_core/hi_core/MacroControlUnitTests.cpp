@@ -0,0 +1,180 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "AppConfig.h"
+
+#if HI_RUN_UNIT_TESTS
+
+#include  "JuceHeader.h"
+
+using namespace hise;
+
+class MacroControlUnitTest : public UnitTest
+{
+public:
+
+	MacroControlUnitTest() :
+		UnitTest("Testing macro controls")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testMacroMapping(500);
+		testPendingValue();
+	}
+
+private:
+
+	void testMacroMapping(int numTargets)
+	{
+		beginTest("Testing macro mapping tables with " + String(numTargets) + " targets");
+
+		using Mapping = MacroControlBroadcaster::MacroMapping;
+
+		Random r(0x1234);
+
+		Array<NormalisableRange<double>> ranges;
+		Array<bool> invertedStates;
+		std::vector<Mapping> mappings((size_t)numTargets);
+
+		for (int i = 0; i < numTargets; i++)
+		{
+			const double start = r.nextDouble() * 1000.0 - 500.0;
+			const double end = start + 1.0 + r.nextDouble() * 2000.0;
+
+			NormalisableRange<double> range(start, end);
+			
+			if (i % 3 == 0)
+				range.skew = 0.3 + r.nextDouble();
+
+			ranges.add(range);
+			invertedStates.add(i % 5 == 0);
+			mappings[i].compile(range, invertedStates[i]);
+		}
+
+		double maxError = 0.0;
+
+		for (int i = 0; i < numTargets; i++)
+		{
+			for (int v = 0; v <= 127; v++)
+			{
+				const double normalised = (double)v / 127.0;
+				const double expected = ranges[i].convertFrom0to1(invertedStates[i] ? 1.0 - normalised : normalised);
+				const double error = std::abs(expected - (double)mappings[i].getValue((float)v)) / ranges[i].getRange().getLength();
+
+				maxError = jmax<double>(maxError, error);
+			}
+		}
+
+		expect(maxError < 0.002, "The table is close to the range conversion: " + String(maxError));
+
+		expectEquals<float>(mappings[5].getValue(0.0f), (float)ranges[5].end, "Inverted start");
+		expectEquals<float>(mappings[1].getValue(127.0f), (float)ranges[1].end, "End is exact");
+
+		// Smoothing: the value ramps linearly and reports a change only while it moves
+		Mapping& m = mappings[1];
+		
+		m.setMacroValue(0.0f, 0);
+		m.advance(0);
+		m.setMacroValue(127.0f, 256);
+
+		expect(m.isSmoothing());
+		expect(m.advance(128));
+		expectWithinAbsoluteError<float>(m.getCurrentValue(), (float)ranges[1].convertFrom0to1(0.5), (float)ranges[1].getRange().getLength() * 0.001f, "Half way");
+		expect(m.advance(128));
+		expect(!m.isSmoothing());
+		expectEquals<float>(m.getCurrentValue(), (float)ranges[1].end);
+		expect(!m.advance(128), "No change after the ramp");
+
+		// Sweep the macro through the whole range and compare with the range conversion
+		const int numSweeps = 50;
+		double sum = 0.0;
+
+		auto start = Time::getHighResolutionTicks();
+
+		for (int s = 0; s < numSweeps; s++)
+		{
+			for (int v = 0; v <= 127; v++)
+			{
+				const double normalised = (double)v / 127.0;
+
+				for (int i = 0; i < numTargets; i++)
+					sum += ranges[i].convertFrom0to1(invertedStates[i] ? 1.0 - normalised : normalised);
+			}
+		}
+
+		const double rangeSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+
+		start = Time::getHighResolutionTicks();
+
+		for (int s = 0; s < numSweeps; s++)
+		{
+			for (int v = 0; v <= 127; v++)
+			{
+				for (int i = 0; i < numTargets; i++)
+					sum += mappings[i].getValue((float)v);
+			}
+		}
+
+		const double tableSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+
+		logMessage("Macro sweep with " + String(numTargets) + " targets: range conversion " + String(rangeSeconds * 1000.0, 2) + 
+				   "ms, compiled table " + String(tableSeconds * 1000.0, 2) + "ms (" + String(sum, 0) + ")");
+	}
+
+	void testPendingValue()
+	{
+		beginTest("Testing pending macro values");
+
+		MacroControlBroadcaster::MacroControlData data(0);
+
+		expect(!data.needsProcessing(), "Nothing to do");
+
+		data.setValue(12.0f);
+		data.setValue(64.0f);
+
+		expect(data.needsProcessing(), "The value is pending");
+		expectEquals<float>(data.getCurrentValue(), 64.0f, "The last value is reported");
+
+		data.processPendingChanges(512);
+
+		expect(!data.needsProcessing(), "The value was applied");
+		expectEquals<float>(data.getCurrentValue(), 64.0f, "The value is kept");
+	}
+};
+
+static MacroControlUnitTest macroControlTestInstance;
+
+#endif
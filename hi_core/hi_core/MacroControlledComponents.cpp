@@ -132,7 +132,7 @@ void MacroControlledObject::enableMidiLearnWithPopup()
 
 	if (midiController != -1)
 	{
-		m.addItem(Remove, "Remove CC " + String(midiController));
+		m.addItem(Remove, "Remove " + handler->getMidiControllerName(processor, parameter));
 	}
 	
 #if 0
@@ -585,14 +585,19 @@ void MainController::processBlockCommon(AudioSampleBuffer &buffer, MidiBuffer &m
 
 	jassert(maxBufferSize.get() >= numSamplesThisBlock);
 
+	// Makes the signals of the last block readable before any module is processed
+	sidechainBus.advance();
+
 #if !FRONTEND_IS_PLUGIN
     
 	keyboardState.processNextMidiBuffer(midiMessages, 0, numSamplesThisBlock, true);
 
-	getMacroManager().getMidiControlAutomationHandler()->handleParameterData(midiMessages); // TODO_BUFFER: Move this after the next line...
+	getMacroManager().getMidiControlAutomationHandler()->handleParameterData(midiMessages, numSamplesThisBlock); // TODO_BUFFER: Move this after the next line...
 
 	masterEventBuffer.addEvents(midiMessages);
 
+	eventInbox.processBlock(masterEventBuffer, numSamplesThisBlock);
+
 	handleSuspendedNoteOffs();
 
     if (!masterEventBuffer.isEmpty()) setMidiInputFlag();
@@ -613,6 +618,16 @@ void MainController::processBlockCommon(AudioSampleBuffer &buffer, MidiBuffer &m
 	if ( thisAsProcessor->getPlayHead() != nullptr && thisAsProcessor->getPlayHead()->getCurrentPosition(newTime))
 	{
 		lastPosInfo = newTime;
+
+		// The host buffer was split, so move the position to the start of this sub block
+		if (hostBlockOffset != 0 && sampleRate > 0.0)
+		{
+			const double offsetSeconds = (double)hostBlockOffset / sampleRate;
+
+			lastPosInfo.timeInSamples += hostBlockOffset;
+			lastPosInfo.timeInSeconds += offsetSeconds;
+			lastPosInfo.ppqPosition += offsetSeconds * lastPosInfo.bpm / 60.0;
+		}
 	}
 	else lastPosInfo.resetToDefault();
 
@@ -902,6 +917,8 @@ void MainController::prepareToPlay(double sampleRate_, int samplesPerBlock)
     
 #endif
 
+	sidechainBus.prepare(sampleRate, maxBufferSize.get());
+
 	getMainSynthChain()->prepareToPlay(sampleRate, maxBufferSize.get());
 
 	AudioThreadGuard guard(&getKillStateHandler());
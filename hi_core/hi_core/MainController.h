@@ -337,6 +337,9 @@ public:
 	{
 	public:
 
+		/** The maximum number of macro controls. The MIDI learn table is preallocated with this size. */
+		static constexpr int MaxNumMacros = 128;
+
 		MacroManager(MainController *mc_);
 		~MacroManager() {};
 
@@ -374,7 +377,7 @@ public:
 
 		MainController *mc;
 
-		int macroControllerNumbers[8];
+		int macroControllerNumbers[MaxNumMacros];
 
 		ModulatorSynthChain *macroChain;
 		int macroIndexForCurrentLearnMode;
@@ -1022,6 +1025,10 @@ public:
 	AutoSaver &getAutoSaver() noexcept { return autoSaver; }
 	const AutoSaver &getAutoSaver() const noexcept { return autoSaver; }
 
+	/** Returns the service that creates the (reproducible) random number generators of the project. */
+	RandomNumberService& getRandomNumberService() noexcept { return randomNumberService; }
+	const RandomNumberService& getRandomNumberService() const noexcept { return randomNumberService; }
+
 	DelayedRenderer& getDelayedRenderer() noexcept { return delayedRenderer; };
 	const DelayedRenderer& getDelayedRenderer() const noexcept { return delayedRenderer; };
 
@@ -1152,6 +1159,9 @@ public:
 		return bpm.load() > 0.0 ? bpm.load() : 120.0;
     };
 
+	/** Returns the position of the host transport at the start of the current block. */
+	const AudioPlayHead::CurrentPositionInfo& getHostPosition() const noexcept { return lastPosInfo; }
+
 	void setHostBpm(double newTempo);
 
 	/** skins the given component (applies the global look and feel to it). */
@@ -1321,6 +1331,12 @@ public:
 
 	EventIdHandler& getEventHandler() { return eventIdHandler; }
 
+	/** Returns the inbox that can be used to schedule events from any thread. */
+	EventInbox& getEventInbox() { return eventInbox; }
+
+	/** Returns the bus that modules can use to share audio and envelope signals. */
+	SidechainBus& getSidechainBus() { return sidechainBus; }
+
 	void setSkipCompileAtPresetLoad(bool shouldSkip)
 	{
 		skipCompilingAtPresetLoad = shouldSkip;
@@ -1448,10 +1464,15 @@ private:
 
 	bool replaceBufferContent = true;
 
+	/** The position of the current sub block in the host buffer (set by the DelayedRenderer). */
+	int hostBlockOffset = 0;
+
 	UnorderedStack<HiseEvent> suspendedNoteOns;
 
 	HiseEventBuffer masterEventBuffer;
 	EventIdHandler eventIdHandler;
+	EventInbox eventInbox;
+	SidechainBus sidechainBus;
 	LockFreeDispatcher lockfreeDispatcher;
 	UserPresetHandler userPresetHandler;
 	ProcessorChangeHandler processorChangeHandler;
@@ -1492,6 +1513,8 @@ private:
 
 	MacroManager macroManager;
 
+	RandomNumberService randomNumberService;
+
 	KillStateHandler killStateHandler;
 
 	Component::SafePointer<Plotter> plotter;
@@ -37,17 +37,23 @@ namespace hise { using namespace juce;
 MidiControllerAutomationHandler::MidiControllerAutomationHandler(MainController *mc_) :
 anyUsed(false),
 mpeData(mc_),
-mc(mc_)
+mc(mc_),
+pendingNotifications(*this)
 {
 	tempBuffer.ensureSize(2048);
 
 	clear();
 }
 
+MidiControllerAutomationHandler::~MidiControllerAutomationHandler()
+{
+}
+
 void MidiControllerAutomationHandler::addMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex, NormalisableRange<double> parameterRange, int macroIndex)
 {
 	ScopedLock sl(mc->getLock());
 
+	unlearnedData.mc = mc;
 	unlearnedData.processor = interfaceProcessor;
 	unlearnedData.attribute = attributeIndex;
 	unlearnedData.parameterRange = parameterRange;
@@ -75,17 +81,39 @@ void MidiControllerAutomationHandler::deactivateMidiLearning()
 }
 
 void MidiControllerAutomationHandler::setUnlearndedMidiControlNumber(int ccNumber, NotificationType notifyListeners)
+{
+	setUnlearnedController(ControllerType::CC, ccNumber, notifyListeners);
+}
+
+struct AutomationDataSorter
+{
+	static int compareElements(const MidiControllerAutomationHandler::AutomationData& first, const MidiControllerAutomationHandler::AutomationData& second)
+	{
+		if (first.getControllerKey() < second.getControllerKey())
+			return -1;
+
+		return first.getControllerKey() > second.getControllerKey() ? 1 : 0;
+	}
+};
+
+void MidiControllerAutomationHandler::setUnlearnedController(ControllerType type, int number, NotificationType notifyListeners)
 {
 	jassert(isLearningActive());
 
 	ScopedLock sl(mc->getLock());
 
-	unlearnedData.ccNumber = ccNumber;
+	unlearnedData.ccNumber = number;
+	unlearnedData.controllerType = type;
+
+	if (!automationData.contains(unlearnedData))
+	{
+		AutomationDataSorter sorter;
+		automationData.addSorted(sorter, unlearnedData);
+	}
 
-	automationData[ccNumber].addIfNotAlreadyThere(unlearnedData);
 	unlearnedData = AutomationData();
 
-	anyUsed = true;
+	rebuildDispatchTable();
 
 	if (notifyListeners)
 		sendChangeMessage();
@@ -93,20 +121,39 @@ void MidiControllerAutomationHandler::setUnlearndedMidiControlNumber(int ccNumbe
 
 int MidiControllerAutomationHandler::getMidiControllerNumber(Processor *interfaceProcessor, int attributeIndex) const
 {
-	for (int i = 0; i < 128; i++)
+	for (const auto& a : automationData)
 	{
-		for (auto& a : automationData[i])
-		{
-			if (a.processor == interfaceProcessor && a.attribute == attributeIndex)
-			{
-				return i;
-			}
-		}
+		if (a.processor == interfaceProcessor && a.attribute == attributeIndex)
+			return a.ccNumber;
 	}
 
 	return -1;
 }
 
+String MidiControllerAutomationHandler::getMidiControllerName(Processor *interfaceProcessor, int attributeIndex) const
+{
+	for (const auto& a : automationData)
+	{
+		if (a.processor == interfaceProcessor && a.attribute == attributeIndex)
+			return a.getControllerName();
+	}
+
+	return {};
+}
+
+String MidiControllerAutomationHandler::getControllerName(ControllerType type, int number)
+{
+	switch (type)
+	{
+	case ControllerType::CC:	return "CC " + String(number);
+	case ControllerType::CC14:	return "CC " + String(number) + "/" + String(number + 32);
+	case ControllerType::NRPN:	return "NRPN " + String(number);
+	case ControllerType::RPN:	return "RPN " + String(number);
+	case ControllerType::numControllerTypes:
+	default:					return {};
+	}
+}
+
 void MidiControllerAutomationHandler::refreshAnyUsedState()
 {
 	AudioThreadGuard::Suspender suspender;
@@ -114,31 +161,83 @@ void MidiControllerAutomationHandler::refreshAnyUsedState()
 
 	ignoreUnused(suspender);
 
+	rebuildDispatchTable();
+}
+
+void MidiControllerAutomationHandler::clear()
+{
+	automationData.clearQuick();
+
+	unlearnedData = AutomationData();
+
+	rebuildDispatchTable();
+}
+
+void MidiControllerAutomationHandler::rebuildDispatchTable()
+{
+	dispatchTable.clear();
+
 	anyUsed = false;
+	numActiveRamps = 0;
 
-	for (int i = 0; i < 128; i++)
+	for (int i = 0; i < automationData.size(); i++)
 	{
-		for (auto& a : automationData[i])
+		auto& a = automationData.getReference(i);
+
+		// The ramps start again at the next controller value
+		a.numRampSamples = 0;
+
+		if (!a.used)
+			continue;
+
+		anyUsed = true;
+
+		Range<int>* r = nullptr;
+		Range<int> parameterRange;
+
+		switch (a.controllerType)
 		{
-			if (a.used)
-			{
-				anyUsed = true;
-				return;
-			}
+		case ControllerType::CC:	r = isPositiveAndBelow(a.ccNumber, 128) ? dispatchTable.cc + a.ccNumber : nullptr; break;
+		case ControllerType::CC14:	r = isPositiveAndBelow(a.ccNumber, 32) ? dispatchTable.cc14 + a.ccNumber : nullptr; break;
+		case ControllerType::NRPN:
+		case ControllerType::RPN:	parameterRange = dispatchTable.parameterNumbers[a.getControllerKey()];
+									r = &parameterRange; break;
+		case ControllerType::numControllerTypes: break;
 		}
+
+		if (r == nullptr)
+			continue;
+
+		// The list is sorted, so the assignments of a controller are next to each other
+		*r = r->isEmpty() ? Range<int>(i, i + 1) : r->withEnd(i + 1);
+
+		if (r == &parameterRange)
+			dispatchTable.parameterNumbers.set(a.getControllerKey(), parameterRange);
 	}
 }
 
-void MidiControllerAutomationHandler::clear()
+void MidiControllerAutomationHandler::DispatchTable::clear()
 {
-	for (int i = 0; i < 128; i++)
-	{
-		automationData[i].clearQuick();
-	};
+	for (auto& r : cc)
+		r = {};
 
-	unlearnedData = AutomationData();
+	for (auto& r : cc14)
+		r = {};
 
-	anyUsed = false;
+	parameterNumbers.clear();
+}
+
+juce::Range<int> MidiControllerAutomationHandler::DispatchTable::getAssignments(const ControllerValue& v) const
+{
+	switch (v.type)
+	{
+	case ControllerType::CC:	return isPositiveAndBelow(v.number, 128) ? cc[v.number] : Range<int>();
+	case ControllerType::CC14:	return isPositiveAndBelow(v.number, 32) ? cc14[v.number] : Range<int>();
+	case ControllerType::NRPN:
+	case ControllerType::RPN:	return parameterNumbers[((int)v.type << 14) | v.number];
+	case ControllerType::numControllerTypes:
+	default:					return {};
+	}
 }
 
 void MidiControllerAutomationHandler::removeMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex, NotificationType notifyListeners)
@@ -147,17 +246,18 @@ void MidiControllerAutomationHandler::removeMidiControlledParameter(Processor *i
 		AudioThreadGuard audioGuard(&(mc->getKillStateHandler()));
 		LockHelpers::SafeLock sl(mc, LockHelpers::AudioLock);
 
-		for (int i = 0; i < 128; i++)
+		for (int i = 0; i < automationData.size(); i++)
 		{
-			for (auto& a : automationData[i])
+			const auto& a = automationData.getReference(i);
+
+			if (a.processor == interfaceProcessor && a.attribute == attributeIndex)
 			{
-				if (a.processor == interfaceProcessor && a.attribute == attributeIndex)
-				{
-					automationData[i].removeAllInstancesOf(a);
-					break;
-				}
+				automationData.remove(i);
+				break;
 			}
 		}
+
+		rebuildDispatchTable();
 	}
 
 	refreshAnyUsedState();
@@ -188,8 +288,58 @@ void MidiControllerAutomationHandler::AutomationData::clear()
 	fullRange = NormalisableRange<double>();
 	macroIndex = -1;
 	ccNumber = -1;
+	controllerType = ControllerType::CC;
+	smoothingTime = 0.0;
 	inverted = false;
 	used = false;
+	currentValue = -1.0;
+	numRampSamples = 0;
+}
+
+void MidiControllerAutomationHandler::AutomationData::setTargetValue(double normalisedValue, int samplePosition)
+{
+	advance(samplePosition);
+
+	const double sampleRate = mc != nullptr ? mc->getMainSynthChain()->getSampleRate() : 0.0;
+	const int numSamples = sampleRate > 0.0 ? roundToInt(smoothingTime * 0.001 * sampleRate) : 0;
+
+	targetValue = normalisedValue;
+	dirty = true;
+
+	// The first value after loading is applied without smoothing
+	if (numSamples <= 0 || currentValue < 0.0)
+	{
+		currentValue = targetValue;
+		numRampSamples = 0;
+	}
+	else
+	{
+		delta = (targetValue - currentValue) / (double)numSamples;
+		numRampSamples = numSamples;
+	}
+}
+
+bool MidiControllerAutomationHandler::AutomationData::advance(int samplePosition)
+{
+	const int numToAdvance = jmax<int>(0, samplePosition - blockPosition);
+
+	blockPosition = jmax<int>(blockPosition, samplePosition);
+
+	if (numRampSamples == 0 || numToAdvance == 0)
+		return false;
+
+	if (numToAdvance >= numRampSamples)
+	{
+		currentValue = targetValue;
+		numRampSamples = 0;
+	}
+	else
+	{
+		currentValue += delta * (double)numToAdvance;
+		numRampSamples -= numToAdvance;
+	}
+
+	return true;
 }
 
 
@@ -199,9 +349,22 @@ bool MidiControllerAutomationHandler::AutomationData::operator==(const Automatio
 	return other.processor == processor && other.attribute == attribute;
 }
 
+static const char* controllerTypeIds[] = { "CC", "CC14", "NRPN", "RPN" };
+
 void MidiControllerAutomationHandler::AutomationData::restoreFromValueTree(const ValueTree &v)
 {
 	ccNumber = v.getProperty("Controller", 1);;
+	controllerType = ControllerType::CC;
+	smoothingTime = v.getProperty("SmoothingTime", 0.0);
+
+	const auto typeName = v.getProperty("ControllerType", "CC").toString();
+
+	for (int i = 0; i < (int)ControllerType::numControllerTypes; i++)
+	{
+		if (typeName == controllerTypeIds[i])
+			controllerType = (ControllerType)i;
+	}
+
 	processor = ProcessorHelpers::getFirstProcessorWithName(mc->getMainSynthChain(), v.getProperty("Processor"));
 	macroIndex = v.getProperty("MacroIndex");
 
@@ -278,6 +441,12 @@ juce::ValueTree MidiControllerAutomationHandler::AutomationData::exportAsValueTr
 	cc.setProperty("Attribute", processor->getIdentifierForParameterIndex(attribute).toString(), nullptr);
 	cc.setProperty("Inverted", inverted, nullptr);
 
+	if (controllerType != ControllerType::CC)
+		cc.setProperty("ControllerType", controllerTypeIds[(int)controllerType], nullptr);
+
+	if (smoothingTime > 0.0)
+		cc.setProperty("SmoothingTime", smoothingTime, nullptr);
+
 	return cc;
 }
 
@@ -622,15 +791,12 @@ ValueTree MidiControllerAutomationHandler::exportAsValueTree() const
 {
 	ValueTree v("MidiAutomation");
 
-	for (int i = 0; i < 128; i++)
+	for (const auto& a : automationData)
 	{
-		for (auto& a : automationData[i])
+		if (a.used && a.processor != nullptr)
 		{
-			if (a.used && a.processor != nullptr)
-			{
-				auto cc = a.exportAsValueTree();
-				v.addChild(cc, -1, nullptr);
-			}
+			auto cc = a.exportAsValueTree();
+			v.addChild(cc, -1, nullptr);
 		}
 	}
 
@@ -643,20 +809,19 @@ void MidiControllerAutomationHandler::restoreFromValueTree(const ValueTree &v)
 
 	clear();
 
+	AutomationDataSorter sorter;
+
 	for (int i = 0; i < v.getNumChildren(); i++)
 	{
 		ValueTree cc = v.getChild(i);
 
-		int controller = cc.getProperty("Controller", 1);
-
-		auto& aArray = automationData[controller];
-
 		AutomationData a;
 		a.mc = mc;
 
 		a.restoreFromValueTree(cc);
 
-		aArray.addIfNotAlreadyThere(a);
+		if (!automationData.contains(a))
+			automationData.addSorted(sorter, a);
 	}
 
 	sendChangeMessage();
@@ -664,19 +829,23 @@ void MidiControllerAutomationHandler::restoreFromValueTree(const ValueTree &v)
 	refreshAnyUsedState();
 }
 
-void MidiControllerAutomationHandler::handleParameterData(MidiBuffer &b)
+void MidiControllerAutomationHandler::handleParameterData(MidiBuffer &b, int numSamples)
 {
-	const bool bufferEmpty = b.isEmpty();
 	const bool noCCsUsed = !anyUsed && !unlearnedData.used;
 
-	if (bufferEmpty || noCCsUsed) return;
+	if (noCCsUsed || (b.isEmpty() && numActiveRamps == 0)) return;
 
-	tempBuffer.clear();
+	for (auto& a : automationData)
+		a.blockPosition = 0;
 
 	MidiBuffer::Iterator mb(b);
 	MidiMessage m;
 
-	int samplePos;
+	int samplePos = 0;
+	int eventIndex = 0;
+	bool anyConsumed = false;
+
+	ControllerValue values[ControllerDecoder::MaxNumValues];
 
 	while (mb.getNextEvent(m, samplePos))
 	{
@@ -684,99 +853,323 @@ void MidiControllerAutomationHandler::handleParameterData(MidiBuffer &b)
 
 		if (m.isController())
 		{
-			const int number = m.getControllerNumber();
+			const int numValues = decoder.decode(m, values);
 
-			if (isLearningActive())
-			{
-				setUnlearndedMidiControlNumber(number, sendNotification);
-			}
+			if (unlearnedData.used)
+				learnController(values, numValues);
 
-			for (auto& a : automationData[number])
+			for (int i = 0; i < numValues; i++)
 			{
-				if (a.used && a.processor.get() != nullptr)
-				{
-					jassert(a.processor.get() != nullptr);
+				const auto r = dispatchTable.getAssignments(values[i]);
 
-					auto normalizedValue = (double)m.getControllerValue() / 127.0;
+				for (int j = r.getStart(); j < r.getEnd(); j++)
+				{
+					auto& a = automationData.getReference(j);
 
-					if (a.inverted) normalizedValue = 1.0 - normalizedValue;
+					if (!a.used || a.processor.get() == nullptr)
+						continue;
 
-					const double value = a.parameterRange.convertFrom0to1(normalizedValue);
+					if (a.numRampSamples > 0)
+						numActiveRamps--;
 
-					const float snappedValue = (float)a.parameterRange.snapToLegalValue(value);
+					a.setTargetValue(values[i].normalisedValue, samplePos);
 
-					if (a.macroIndex != -1)
-					{
-						a.processor->getMainController()->getMacroManager().getMacroChain()->setMacroControl(a.macroIndex, (float)m.getControllerValue(), sendNotification);
-					}
-					else
-					{
-						if (a.lastValue != snappedValue)
-						{
-							a.processor->setAttribute(a.attribute, snappedValue, sendNotification);
-							a.lastValue = snappedValue;
-						}
-					}
+					if (a.numRampSamples > 0)
+						numActiveRamps++;
 
 					consumed = true;
 				}
 			}
 		}
 
-		if (!consumed) tempBuffer.addEvent(m, samplePos);
+		if (consumed && !anyConsumed)
+		{
+			// Only copy the events if we need to remove one
+			tempBuffer.clear();
+
+			MidiBuffer::Iterator previous(b);
+			MidiMessage pm;
+			int pos;
+
+			for (int i = 0; i < eventIndex && previous.getNextEvent(pm, pos); i++)
+				tempBuffer.addEvent(pm, pos);
+
+			anyConsumed = true;
+		}
+		else if (!consumed && anyConsumed)
+		{
+			tempBuffer.addEvent(m, samplePos);
+		}
+
+		eventIndex++;
 	}
 
-	b.clear();
-	b.addEvents(tempBuffer, 0, -1, 0);
-}
+	// Apply the value at the end of the block
+	const int endPosition = jmax<int>(numSamples, samplePos);
+
+	for (auto& a : automationData)
+	{
+		const bool wasRamping = a.numRampSamples > 0;
 
+		if (!wasRamping && !a.dirty)
+			continue;
 
-hise::MidiControllerAutomationHandler::AutomationData MidiControllerAutomationHandler::getDataFromIndex(int index) const
+		a.advance(endPosition);
+		a.dirty = false;
+
+		if (wasRamping && a.numRampSamples == 0)
+			numActiveRamps--;
+
+		if (a.used && a.processor.get() != nullptr)
+			applyValue(a);
+	}
+
+	if (anyConsumed)
+		b.swapWith(tempBuffer);
+}
+
+void MidiControllerAutomationHandler::applyValue(AutomationData& a)
 {
-	int currentIndex = 0;
+	auto normalizedValue = jlimit(0.0, 1.0, a.currentValue);
 
-	for (int i = 0; i < 128; i++)
+	if (a.macroIndex != -1)
 	{
-		for (const auto& a: automationData[i])
+		const float macroValue = (float)normalizedValue * 127.0f;
+
+		if (a.lastValue != macroValue)
 		{
-			if (index == currentIndex)
-				return AutomationData(a);
+			mc->getMacroManager().getMacroChain()->setMacroControl(a.macroIndex, macroValue, dontSendNotification);
+			a.lastValue = macroValue;
 
-			currentIndex++;
+			Notification n;
+			n.macroIndex = a.macroIndex;
+			n.value = macroValue;
+			pendingNotifications.queue.push(std::move(n));
 		}
+
+		return;
 	}
 
-	return AutomationData();
+	if (a.inverted) normalizedValue = 1.0 - normalizedValue;
+
+	const double value = a.parameterRange.convertFrom0to1(normalizedValue);
+
+	const float snappedValue = (float)a.parameterRange.snapToLegalValue(value);
+
+	if (a.lastValue != snappedValue)
+	{
+		a.processor->setAttribute(a.attribute, snappedValue, dontSendNotification);
+		a.lastValue = snappedValue;
+
+		Notification n;
+		n.processor = a.processor;
+		n.attribute = a.attribute;
+		n.value = snappedValue;
+
+		// If the queue is full, the UI will pick up the next change
+		pendingNotifications.queue.push(std::move(n));
+	}
 }
 
-int MidiControllerAutomationHandler::getNumActiveConnections() const
+void MidiControllerAutomationHandler::learnController(const ControllerValue* values, int numValues)
 {
-	int numActive = 0;
+	if (numValues == 0)
+		return;
+
+	// The first value is always the 7-bit controller.
+	auto best = values[0];
+	const ControllerValue* lsbPair = nullptr;
 
-	for (int i = 0; i < 128; i++)
+	for (int i = 1; i < numValues; i++)
 	{
-		numActive += automationData[i].size();
+		if (values[i].type == ControllerType::NRPN || values[i].type == ControllerType::RPN)
+			best = values[i];
+		else if (values[i].type == ControllerType::CC14 && values[0].number >= 32)
+			lsbPair = values + i;
 	}
 
-	return numActive;
+	int currentKey = pendingNotifications.learnedControllerKey.load();
+
+	if (currentKey != -1)
+	{
+		// The MSB of a 14-bit pair or the parameter selection of a NRPN arrives before the actual value
+		if ((ControllerType)(currentKey >> 14) != ControllerType::CC)
+			return;
+
+		// A 14-bit pair is only learned if the LSB follows its MSB, otherwise a 7-bit controller
+		// between 32 and 63 would be learned as LSB of a pair whose MSB is never sent.
+		if (lsbPair != nullptr && (currentKey & 0x3FFF) == lsbPair->number)
+			best = *lsbPair;
+		else if (best.type != ControllerType::NRPN && best.type != ControllerType::RPN)
+			return;
+	}
+
+	const int newKey = ((int)best.type << 14) | best.number;
+	pendingNotifications.learnedControllerKey.compare_exchange_strong(currentKey, newKey);
 }
 
-bool MidiControllerAutomationHandler::setNewRangeForParameter(int index, NormalisableRange<double> range)
+MidiControllerAutomationHandler::PendingNotifications::PendingNotifications(MidiControllerAutomationHandler& parent_) :
+	queue(1024),
+	learnedControllerKey(-1),
+	parent(parent_)
+{
+	startTimer(30);
+}
+
+void MidiControllerAutomationHandler::commitLearnedController(NotificationType notifyListeners)
+{
+	const int key = pendingNotifications.learnedControllerKey.exchange(-1);
+
+	if (key != -1 && isLearningActive())
+		setUnlearnedController((ControllerType)(key >> 14), key & 0x3FFF, notifyListeners);
+}
+
+void MidiControllerAutomationHandler::PendingNotifications::timerCallback()
+{
+	parent.commitLearnedController(sendNotification);
+
+	if (queue.isEmpty())
+		return;
+
+	auto f = [this](Notification& n)
+	{
+		if (n.macroIndex != -1)
+			parent.mc->getMacroManager().getMacroChain()->sendMacroControlChangeMessage(n.macroIndex, n.value, sendNotification);
+		else if (n.processor.get() != nullptr)
+			n.processor->sendChangeMessage();
+
+		return MultithreadedQueueHelpers::OK;
+	};
+
+	queue.clear(f);
+}
+
+void MidiControllerAutomationHandler::ControllerDecoder::reset()
+{
+	for (auto& c : channels)
+	{
+		memset(c.msbValues, 0, sizeof(c.msbValues));
+		c.dataMsb = 0;
+		c.parameterMsb = 127;
+		c.parameterLsb = 127;
+		c.parameterType = ControllerType::CC;
+	}
+}
+
+int MidiControllerAutomationHandler::ControllerDecoder::decode(const MidiMessage& m, ControllerValue* values)
 {
-	int currentIndex = 0;
+	if (!m.isController())
+		return 0;
+
+	auto& c = channels[jlimit(1, 16, m.getChannel()) - 1];
+
+	const int number = m.getControllerNumber();
+	const int value = m.getControllerValue();
+
+	int numValues = 0;
+
+	values[numValues++] = { ControllerType::CC, number, (double)value / 127.0 };
+
+	auto add14BitValue = [&](ControllerType type, int valueNumber, int msb, int lsb)
+	{
+		values[numValues++] = { type, valueNumber, (double)((msb << 7) | lsb) / 16383.0 };
+	};
 
-	for (int i = 0; i < 128; i++)
+	const bool parameterSelected = c.parameterType != ControllerType::CC;
+	const int parameterNumber = (c.parameterMsb << 7) | c.parameterLsb;
+
+	switch (number)
+	{
+	case 99: // NRPN MSB
+	case 98: // NRPN LSB
+	case 101: // RPN MSB
+	case 100: // RPN LSB
 	{
-		for (auto& a : automationData[i])
+		const auto type = number >= 100 ? ControllerType::RPN : ControllerType::NRPN;
+
+		// A new parameter type resets the other half of the number
+		if (c.parameterType != type)
 		{
-			if (index == currentIndex)
-			{
-				a.parameterRange = range;
-				return true;
-			}
-			
-			currentIndex++;
+			c.parameterMsb = 127;
+			c.parameterLsb = 127;
+		}
+
+		if (number == 99 || number == 101)
+			c.parameterMsb = (uint8)value;
+		else
+			c.parameterLsb = (uint8)value;
+
+		c.parameterType = type;
+		c.dataMsb = 0;
+
+		// 127/127 is the RPN null function that deselects the parameter
+		if (type == ControllerType::RPN && c.parameterMsb == 127 && c.parameterLsb == 127)
+			c.parameterType = ControllerType::CC;
+
+		break;
+	}
+	case 6: // Data entry MSB
+	{
+		c.dataMsb = (uint8)value;
+		c.msbValues[number] = (uint8)value;
+
+		if (parameterSelected)
+			add14BitValue(c.parameterType, parameterNumber, value, 0);
+		else
+			add14BitValue(ControllerType::CC14, number, value, 0);
+
+		break;
+	}
+	case 38: // Data entry LSB
+	{
+		if (parameterSelected)
+			add14BitValue(c.parameterType, parameterNumber, c.dataMsb, value);
+		else
+			add14BitValue(ControllerType::CC14, number - 32, c.msbValues[number - 32], value);
+
+		break;
+	}
+	default:
+	{
+		// The MSB resets the LSB, so the value is sent with the MSB and updated when the LSB arrives
+		if (number < 32)
+		{
+			c.msbValues[number] = (uint8)value;
+			add14BitValue(ControllerType::CC14, number, value, 0);
+		}
+		else if (number < 64)
+		{
+			add14BitValue(ControllerType::CC14, number - 32, c.msbValues[number - 32], value);
 		}
+
+		break;
+	}
+	}
+
+	jassert(numValues <= MaxNumValues);
+
+	return numValues;
+}
+
+hise::MidiControllerAutomationHandler::AutomationData MidiControllerAutomationHandler::getDataFromIndex(int index) const
+{
+	if (isPositiveAndBelow(index, automationData.size()))
+		return AutomationData(automationData.getReference(index));
+
+	return AutomationData();
+}
+
+int MidiControllerAutomationHandler::getNumActiveConnections() const
+{
+	return automationData.size();
+}
+
+bool MidiControllerAutomationHandler::setNewRangeForParameter(int index, NormalisableRange<double> range)
+{
+	if (isPositiveAndBelow(index, automationData.size()))
+	{
+		automationData.getReference(index).parameterRange = range;
+		return true;
 	}
 
 	return false;
@@ -784,20 +1177,21 @@ bool MidiControllerAutomationHandler::setNewRangeForParameter(int index, Normali
 
 bool MidiControllerAutomationHandler::setParameterInverted(int index, bool value)
 {
-	int currentIndex = 0;
-
-	for (int i = 0; i < 128; i++)
+	if (isPositiveAndBelow(index, automationData.size()))
 	{
-		for (auto& a : automationData[i])
-		{
-			if (index == currentIndex)
-			{
-				a.inverted = value;
-				return true;
-			}
+		automationData.getReference(index).inverted = value;
+		return true;
+	}
 
-			currentIndex++;
-		}
+	return false;
+}
+
+bool MidiControllerAutomationHandler::setSmoothingTime(int index, double smoothingTimeMs)
+{
+	if (isPositiveAndBelow(index, automationData.size()))
+	{
+		automationData.getReference(index).smoothingTime = jmax<double>(0.0, smoothingTimeMs);
+		return true;
 	}
 
 	return false;
@@ -877,6 +1271,11 @@ bool DelayedRenderer::shouldDelayRendering() const
 	return pimpl->shouldDelayRendering();
 }
 
+int DelayedRenderer::getLatency() const
+{
+	return splitter.getLatency();
+}
+
 CircularAudioSampleBuffer::CircularAudioSampleBuffer(int numChannels_, int numSamples) :
 	internalBuffer(numChannels_, numSamples),
 	numChannels(numChannels_),
@@ -1088,176 +1487,280 @@ bool CircularAudioSampleBuffer::readMidiEvents(MidiBuffer& destination, int offs
 	return ok;
 }
 
-void DelayedRenderer::processWrapped(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+void RasterBlockSplitter::prepare(Mode newMode, int numChannels_, int maxHostBlockSize, int maxRenderBlockSize)
 {
-	if (shouldDelayRendering())
-	{
-	
-		const bool ok = circularInputBuffer.writeSamples(buffer, 0, buffer.getNumSamples());
+	mode = newMode;
+	numChannels = jmax<int>(1, numChannels_);
+	maxHostSize = jmax<int>(HISE_EVENT_RASTER, maxHostBlockSize);
 
-		jassert(ok);
+	// The sub blocks must start at the raster, so the render size must be aligned too
+	maxRenderSize = jmax<int>(HISE_EVENT_RASTER, (maxRenderBlockSize / HISE_EVENT_RASTER) * HISE_EVENT_RASTER);
 
-		INSTRUMENT_ONLY(circularInputBuffer.writeMidiEvents(midiMessages, 0, buffer.getNumSamples()));
-		INSTRUMENT_ONLY(buffer.clear());
+	pendingBuffer.setSize(numChannels, HISE_EVENT_RASTER);
+	pendingBuffer.clear();
+	pendingOffset = 0;
+	numPending = 0;
 
-		while (circularInputBuffer.getNumAvailableSamples() >= fullBlockSize)
-		{
-			delayedMidiBuffer.clear();
+	if (mode == Mode::DelayedInput)
+	{
+		inputFifo = CircularAudioSampleBuffer(numChannels, maxHostSize + HISE_EVENT_RASTER);
+		outputFifo = CircularAudioSampleBuffer(numChannels, maxHostSize + 2 * HISE_EVENT_RASTER);
+		outputFifo.setReadDelta(HISE_EVENT_RASTER);
 
-			circularInputBuffer.readSamples(processBuffer, 0, fullBlockSize);
+		renderBuffer.setSize(numChannels, maxRenderSize);
+		renderBuffer.clear();
+	}
+	else
+	{
+		inputFifo = CircularAudioSampleBuffer();
+		outputFifo = CircularAudioSampleBuffer();
+		renderBuffer.setSize(1, 0);
+	}
 
-			INSTRUMENT_ONLY(circularInputBuffer.readMidiEvents(delayedMidiBuffer, 0, fullBlockSize));
-			
-			mc->processBlockCommon(processBuffer, delayedMidiBuffer);
+	subBlockMidi.clear();
+	heldMidi.clear();
+	lateMidi.clear();
+	swapMidi.clear();
 
-			circularOutputBuffer.writeSamples(processBuffer, 0, fullBlockSize);
-		}
+	subBlockMidi.ensureSize(2048);
+	heldMidi.ensureSize(2048);
+	lateMidi.ensureSize(1024);
+	swapMidi.ensureSize(2048);
+}
 
-		circularOutputBuffer.readSamples(buffer, 0, buffer.getNumSamples());
+void RasterBlockSplitter::process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, Renderer& r)
+{
+	const int numSamples = buffer.getNumSamples();
 
-#if 0
-		const int thisNumSamples = buffer.getNumSamples();
-		const int blockSize = writeBuffer->getNumSamples();
-		
-		//String s;
-		//s << "thisNumSamples: " << thisNumSamples << ", sampleIndex: " << sampleIndex;
-		//DBG(s);
+	if (numSamples == 0)
+		return;
 
+	const bool isAligned = mode == Mode::Passthrough || numSamples % HISE_EVENT_RASTER == 0;
+	const bool hasState = numPending != 0 || !lateMidi.isEmpty() || mode == Mode::DelayedInput;
 
-		int numSamplesTodo = thisNumSamples;
+	// This is the common case, so we don't touch anything
+	if (isAligned && !hasState && numSamples <= maxRenderSize)
+	{
+		r.renderBlock(buffer, midiMessages, 0);
+		return;
+	}
 
-		while (numSamplesTodo > 0)
-		{
-			jassert(sampleIndexInternal < blockSize);
-			jassert(sampleIndexInternal >= 0);
-			jassert(sampleIndexExternal < thisNumSamples);
-			jassert(sampleIndexExternal >= 0);
+	const bool channelMismatch = mode == Mode::DelayedInput ? buffer.getNumChannels() != numChannels :
+															  buffer.getNumChannels() > numChannels;
 
-			const bool wrapInternalBuffer = (sampleIndexInternal + numSamplesTodo) >= blockSize;
+	if (channelMismatch || maxRenderSize == 0)
+	{
+		// You need to call prepare() with the channel amount of the host buffer
+		jassertfalse;
+		r.renderBlock(buffer, midiMessages, 0);
+		return;
+	}
 
-			if (wrapInternalBuffer)
-			{
-				
+	// The host shouldn't exceed the block size from prepareToPlay, but we don't rely on it
+	for (int offset = 0; offset < numSamples; offset += maxHostSize)
+		processSlice(buffer, midiMessages, offset, jmin<int>(maxHostSize, numSamples - offset), r);
 
-				const int numSamplesToCopyBeforeProcessing = jmin<int>(thisNumSamples - sampleIndexExternal, numSamplesTodo - sampleIndexInternal, blockSize - sampleIndexInternal);
+	midiMessages.clear();
+}
 
-				if (numSamplesToCopyBeforeProcessing > 0)
-				{
+void RasterBlockSplitter::processSlice(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offset, int numSamples, Renderer& r)
+{
+	switch (mode)
+	{
+	case Mode::RenderAhead:	 renderAhead(buffer, midiMessages, offset, numSamples, r); break;
+	case Mode::DelayedInput: renderDelayed(buffer, midiMessages, offset, numSamples, r); break;
+	case Mode::Passthrough:
+	case Mode::numModes:
+	{
+		for (int pos = 0; pos < numSamples; pos += maxRenderSize)
+		{
+			const int start = offset + pos;
+			const int numToRender = jmin<int>(maxRenderSize, numSamples - pos);
 
-#if FRONTEND_IS_PLUGIN
-					FloatVectorOperations::copy(writeBuffer->getWritePointer(0, sampleIndexInternal), buffer.getReadPointer(0, sampleIndexExternal), numSamplesToCopyBeforeProcessing);
-					FloatVectorOperations::copy(writeBuffer->getWritePointer(1, sampleIndexInternal), buffer.getReadPointer(1, sampleIndexExternal), numSamplesToCopyBeforeProcessing);
-#else
-					delayedMidiBuffer.addEvents(midiMessages, 0, numSamplesToCopyBeforeProcessing, sampleIndexInternal);
-#endif
+			AudioSampleBuffer subBlock(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numToRender);
 
-					FloatVectorOperations::copy(buffer.getWritePointer(0, sampleIndexExternal), readBuffer->getReadPointer(0, sampleIndexInternal), numSamplesToCopyBeforeProcessing);
-					FloatVectorOperations::copy(buffer.getWritePointer(1, sampleIndexExternal), readBuffer->getReadPointer(1, sampleIndexInternal), numSamplesToCopyBeforeProcessing);
-					
-				}
+			subBlockMidi.clear();
+			subBlockMidi.addEvents(midiMessages, start, numToRender, -start);
+
+			r.renderBlock(subBlock, subBlockMidi, start);
+		}
+
+		break;
+	}
+	}
+}
 
-				sampleIndexExternal += numSamplesToCopyBeforeProcessing;
+void RasterBlockSplitter::renderAhead(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offset, int numSamples, Renderer& r)
+{
+	const int numChannelsThisTime = buffer.getNumChannels();
+	const bool addToInput = r.addsToInput();
+
+	int pos = 0;
 
-				
+	if (numPending > 0)
+	{
+		pos = jmin<int>(numPending, numSamples);
 
-				jassert(sampleIndexExternal + numSamplesToCopyBeforeProcessing == thisNumSamples);
+		for (int i = 0; i < numChannelsThisTime; i++)
+		{
+			auto src = pendingBuffer.getReadPointer(i, pendingOffset);
+			auto dst = buffer.getWritePointer(i, offset);
 
-				mc->processBlockCommon(*writeBuffer, delayedMidiBuffer);
+			// The pending samples were rendered with a silent input
+			if (addToInput)
+				FloatVectorOperations::add(dst, src, pos);
+			else
+				FloatVectorOperations::copy(dst, src, pos);
+		}
 
-				AudioSampleBuffer* temp = readBuffer;
-				readBuffer = writeBuffer;
-				writeBuffer = temp;
-				delayedMidiBuffer.clear();
-				sampleIndexInternal = 0;
+		pendingOffset += pos;
+		numPending -= pos;
 
-				const int numSamplesToCopyAfterProcessing = jmin<int>(blockSize- indexInOutputBuffer, numSamplesTodo- indexInOutputBuffer);
+		// These events belong to a block that was already rendered
+		deferEvents(midiMessages, offset, pos);
+	}
 
-				numSamplesTodo -= remainingSamples;
+	while (numSamples - pos >= HISE_EVENT_RASTER)
+	{
+		const int start = offset + pos;
+		const int numToRender = jmin<int>(maxRenderSize, ((numSamples - pos) / HISE_EVENT_RASTER) * HISE_EVENT_RASTER);
 
-				if (numSamplesToCopyAfterProcessing > 0)
-				{
-					FloatVectorOperations::copy(buffer.getWritePointer(0, indexInOutputBuffer), readBuffer->getReadPointer(0, 0), numSamplesToCopyAfterProcessing);
-					FloatVectorOperations::copy(buffer.getWritePointer(1, indexInOutputBuffer), readBuffer->getReadPointer(1, 0), numSamplesToCopyAfterProcessing);
-					numSamplesTodo -= numSamplesToCopyAfterProcessing;
-				}
+		AudioSampleBuffer subBlock(buffer.getArrayOfWritePointers(), numChannelsThisTime, start, numToRender);
 
-				
+		subBlockMidi.clear();
+		addLateEvents(subBlockMidi);
+		subBlockMidi.addEvents(midiMessages, start, numToRender, -start);
 
-				sampleIndexInternal = (sampleIndexInternal + numSamplesToCopyAfterProcessing) % blockSize;
+		r.renderBlock(subBlock, subBlockMidi, start);
 
-				
-			}
-			else
-			{
+		pos += numToRender;
+	}
 
-				int numToCopy = jmin<int>(blockSize - sampleIndexInternal, numSamplesTodo);
+	if (pos < numSamples)
+	{
+		const int start = offset + pos;
+		const int numRemaining = numSamples - pos;
 
-				jassert(numToCopy > 0);
+		pendingBuffer.clear();
 
-#if FRONTEND_IS_PLUGIN
-				FloatVectorOperations::copy(writeBuffer->getWritePointer(0, sampleIndexInternal), buffer.getReadPointer(0, 0), numToCopy);
-				FloatVectorOperations::copy(writeBuffer->getWritePointer(1, sampleIndexInternal), buffer.getReadPointer(1, 0), numToCopy);
-#else
-				delayedMidiBuffer.addEvents(midiMessages, 0, numToCopy, sampleIndexInternal);
-#endif
+		for (int i = 0; i < numChannelsThisTime; i++)
+			FloatVectorOperations::copy(pendingBuffer.getWritePointer(i, 0), buffer.getReadPointer(i, start), numRemaining);
 
-				FloatVectorOperations::copy(buffer.getWritePointer(0, 0), readBuffer->getReadPointer(0, sampleIndexInternal), numToCopy);
-				FloatVectorOperations::copy(buffer.getWritePointer(1, 0), readBuffer->getReadPointer(1, sampleIndexInternal), numToCopy);
-				numSamplesTodo -= numToCopy;
+		AudioSampleBuffer subBlock(pendingBuffer.getArrayOfWritePointers(), numChannelsThisTime, HISE_EVENT_RASTER);
 
-				sampleIndexInternal = (sampleIndexInternal + numToCopy) % blockSize;
-			}
+		subBlockMidi.clear();
+		addLateEvents(subBlockMidi);
+		subBlockMidi.addEvents(midiMessages, start, numRemaining, -start);
 
-			
+		r.renderBlock(subBlock, subBlockMidi, start);
 
-			}
-#endif
+		for (int i = 0; i < numChannelsThisTime; i++)
+			FloatVectorOperations::copy(buffer.getWritePointer(i, start), pendingBuffer.getReadPointer(i, 0), numRemaining);
 
-	}
-	else
-	{
-		mc->processBlockCommon(buffer, midiMessages);
+		pendingOffset = numRemaining;
+		numPending = HISE_EVENT_RASTER - numRemaining;
 	}
 }
 
-void DelayedRenderer::prepareToPlayWrapped(double sampleRate, int samplesPerBlock)
+void RasterBlockSplitter::renderDelayed(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offset, int numSamples, Renderer& r)
 {
-	if (shouldDelayRendering())
-	{
-		if (samplesPerBlock > lastBlockSize)
-		{
-			lastBlockSize = samplesPerBlock;
+	AudioSampleBuffer slice(buffer.getArrayOfWritePointers(), numChannels, offset, numSamples);
 
-#if FRONTEND_IS_PLUGIN
-			fullBlockSize = samplesPerBlock;
-#else
-			fullBlockSize = jmin<int>(256, samplesPerBlock);
-#endif
+	const int numHeldBefore = inputFifo.getNumAvailableSamples();
 
-			circularInputBuffer = CircularAudioSampleBuffer(2, 3 * samplesPerBlock);
+	inputFifo.writeSamples(slice, 0, numSamples);
 
+	// The timestamps of the held events are relative to the first held sample
+	heldMidi.addEvents(midiMessages, offset, numSamples, numHeldBefore - offset);
 
+	while (inputFifo.getNumAvailableSamples() >= HISE_EVENT_RASTER)
+	{
+		const int numHeld = inputFifo.getNumAvailableSamples();
+		const int numToRender = jmin<int>(maxRenderSize, (numHeld / HISE_EVENT_RASTER) * HISE_EVENT_RASTER);
 
-			circularOutputBuffer = CircularAudioSampleBuffer(2, 3 * samplesPerBlock);
+		// The position of the rendered input in the host buffer (it might start in the last buffer)
+		const int hostOffset = offset + numSamples - numHeld;
 
-			circularOutputBuffer.setReadDelta(fullBlockSize);
+		AudioSampleBuffer subBlock(renderBuffer.getArrayOfWritePointers(), numChannels, numToRender);
 
-			processBuffer.setSize(2, fullBlockSize);
+		inputFifo.readSamples(subBlock, 0, numToRender);
 
-			delayedMidiBuffer.ensureSize(1024);
+		subBlockMidi.clear();
+		subBlockMidi.addEvents(heldMidi, 0, numToRender, 0);
 
-			dynamic_cast<AudioProcessor*>(mc)->setLatencySamples(fullBlockSize);
+		swapMidi.clear();
+		swapMidi.addEvents(heldMidi, numToRender, -1, -numToRender);
+		heldMidi.swapWith(swapMidi);
 
-			mc->prepareToPlay(sampleRate, fullBlockSize);
-		}
+		r.renderBlock(subBlock, subBlockMidi, hostOffset);
 
+		outputFifo.writeSamples(subBlock, 0, numToRender);
 	}
-	else
+
+	outputFifo.readSamples(slice, 0, numSamples);
+}
+
+void RasterBlockSplitter::addLateEvents(MidiBuffer& destination)
+{
+	if (!lateMidi.isEmpty())
 	{
-		mc->prepareToPlay(sampleRate, samplesPerBlock);
+		destination.addEvents(lateMidi, 0, -1, 0);
+		lateMidi.clear();
 	}
 }
 
+void RasterBlockSplitter::deferEvents(const MidiBuffer& source, int startSample, int numSamples)
+{
+	MidiBuffer::Iterator it(source);
+	it.setNextSamplePosition(startSample);
+
+	const uint8* data;
+	int numBytes;
+	int samplePos;
+
+	while (it.getNextEvent(data, numBytes, samplePos) && samplePos < startSample + numSamples)
+		lateMidi.addEvent(data, numBytes, 0);
+}
+
+void DelayedRenderer::processWrapped(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+	splitter.process(buffer, midiMessages, *this);
+}
+
+void DelayedRenderer::renderBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offsetInHostBuffer)
+{
+	mc->hostBlockOffset = offsetInHostBuffer;
+	mc->processBlockCommon(buffer, midiMessages);
+	mc->hostBlockOffset = 0;
+}
+
+bool DelayedRenderer::addsToInput() const
+{
+	return !mc->replaceBufferContent;
+}
+
+void DelayedRenderer::prepareToPlayWrapped(double sampleRate, int samplesPerBlock)
+{
+	auto mode = RasterBlockSplitter::Mode::RenderAhead;
+
+#if FRONTEND_IS_PLUGIN
+	// Rendering ahead would need the input of the next buffer, so effects only delay the input
+	// if the host is known to send irregular buffer sizes.
+	mode = shouldDelayRendering() ? RasterBlockSplitter::Mode::DelayedInput : RasterBlockSplitter::Mode::Passthrough;
+#endif
+
+	mc->prepareToPlay(sampleRate, RasterBlockSplitter::getRasterAlignedBlockSize(samplesPerBlock));
+
+	int numChannels = 2;
+
+	if (auto ap = dynamic_cast<AudioProcessor*>(mc))
+		numChannels = jmax<int>(numChannels, ap->getTotalNumInputChannels(), ap->getTotalNumOutputChannels());
+
+	splitter.prepare(mode, numChannels, samplesPerBlock, mc->maxBufferSize.get());
+
+	mc->getMainSynthChain()->triggerLatencyUpdate();
+}
+
 
 void OverlayMessageBroadcaster::sendOverlayMessage(int newState, const String& newCustomMessage/*=String()*/)
 {
@@ -1279,4 +1782,636 @@ void OverlayMessageBroadcaster::sendOverlayMessage(int newState, const String& n
 #endif
 }
 
+EventInbox::EventInbox() :
+	pendingEvents(HISE_EVENT_INBOX_SIZE),
+	currentSamplePosition(0)
+{
+	scheduledEvents.calloc(HISE_EVENT_INBOX_SIZE);
+}
+
+bool EventInbox::push(const HiseEvent& e, int64 samplePosition)
+{
+	ScheduledEvent se;
+	se.e = e;
+	se.samplePosition = samplePosition;
+
+	return pendingEvents.push(std::move(se));
+}
+
+void EventInbox::processBlock(HiseEventBuffer& buffer, int numSamples)
+{
+	const int64 blockStart = currentSamplePosition.load();
+	const int64 blockEnd = blockStart + numSamples;
+
+	ScheduledEvent se;
+
+	while (numScheduledEvents < HISE_EVENT_INBOX_SIZE && pendingEvents.pop(se))
+		scheduledEvents[numScheduledEvents++] = se;
+
+	int numRemaining = 0;
+
+	// Keep the remaining events in their order so that events with the same position are inserted in the order they were pushed.
+	for (int i = 0; i < numScheduledEvents; i++)
+	{
+		const auto& thisEvent = scheduledEvents[i];
+
+		if (thisEvent.samplePosition < blockEnd && buffer.getNumUsed() < HISE_EVENT_BUFFER_SIZE)
+		{
+			HiseEvent copy(thisEvent.e);
+			copy.setTimeStamp((int)jmax<int64>(0, thisEvent.samplePosition - blockStart));
+			buffer.addEvent(copy);
+		}
+		else
+		{
+			scheduledEvents[numRemaining++] = thisEvent;
+		}
+	}
+
+	numScheduledEvents = numRemaining;
+
+	currentSamplePosition.store(blockEnd);
+}
+
+SidechainBus::EnvelopeDetector::EnvelopeDetector()
+{
+	updateCoefficients();
+}
+
+void SidechainBus::EnvelopeDetector::prepare(double newSampleRate)
+{
+	sampleRate = newSampleRate;
+	updateCoefficients();
+	reset();
+}
+
+void SidechainBus::EnvelopeDetector::reset()
+{
+	state = 0.0;
+
+	for (int i = 0; i < NumAudioChannels; i++)
+	{
+		shelfFilters[i].z1 = shelfFilters[i].z2 = 0.0;
+		highpassFilters[i].z1 = highpassFilters[i].z2 = 0.0;
+	}
+}
+
+void SidechainBus::EnvelopeDetector::setMode(Mode newMode)
+{
+	if (mode != newMode)
+	{
+		mode = newMode;
+		reset();
+	}
+}
+
+void SidechainBus::EnvelopeDetector::setAttack(double attackMs)
+{
+	attack = jmax(0.01, attackMs);
+	updateCoefficients();
+}
+
+void SidechainBus::EnvelopeDetector::setRelease(double releaseMs)
+{
+	release = jmax(0.01, releaseMs);
+	updateCoefficients();
+}
+
+void SidechainBus::EnvelopeDetector::updateCoefficients()
+{
+	attackCoef = exp(-1000.0 / (attack * sampleRate));
+	releaseCoef = exp(-1000.0 / (release * sampleRate));
+
+	// The K-weighting filter of ITU-R BS.1770 (calculated for the current samplerate)
+	{
+		const double f0 = 1681.974450955533;
+		const double G = 3.999843853973347;
+		const double Q = 0.7071752369554196;
+
+		const double K = tan(double_Pi * f0 / sampleRate);
+		const double Vh = pow(10.0, G / 20.0);
+		const double Vb = pow(Vh, 0.4996667741545416);
+		const double a0 = 1.0 + K / Q + K * K;
+
+		for (auto& f : shelfFilters)
+		{
+			f.b0 = (Vh + Vb * K / Q + K * K) / a0;
+			f.b1 = 2.0 * (K * K - Vh) / a0;
+			f.b2 = (Vh - Vb * K / Q + K * K) / a0;
+			f.a1 = 2.0 * (K * K - 1.0) / a0;
+			f.a2 = (1.0 - K / Q + K * K) / a0;
+		}
+	}
+
+	{
+		const double f0 = 38.13547087602444;
+		const double Q = 0.5003270373238773;
+
+		const double K = tan(double_Pi * f0 / sampleRate);
+		const double a0 = 1.0 + K / Q + K * K;
+
+		for (auto& f : highpassFilters)
+		{
+			f.b0 = 1.0;
+			f.b1 = -2.0;
+			f.b2 = 1.0;
+			f.a1 = 2.0 * (K * K - 1.0) / a0;
+			f.a2 = (1.0 - K / Q + K * K) / a0;
+		}
+	}
+}
+
+void SidechainBus::EnvelopeDetector::process(const float* const* channels, int numChannels, float* destination, int numSamples)
+{
+	numChannels = jmin(numChannels, (int)NumAudioChannels);
+
+	if (numChannels <= 0)
+	{
+		FloatVectorOperations::clear(destination, numSamples);
+		return;
+	}
+
+	int offset = 0;
+
+	while (offset < numSamples)
+	{
+		const int numThisTime = jmin(numSamples - offset, (int)BlockSize);
+
+		const float* chunk[NumAudioChannels];
+
+		for (int c = 0; c < numChannels; c++)
+			chunk[c] = channels[c] + offset;
+
+		processChunk(chunk, numChannels, destination + offset, numThisTime);
+
+		offset += numThisTime;
+	}
+}
+
+void SidechainBus::EnvelopeDetector::processChunk(const float* const* channels, int numChannels, float* destination, int numSamples)
+{
+	float temp[BlockSize];
+
+	// Calculate the key signal of all channels
+	switch (mode)
+	{
+	case Mode::Peak:
+	{
+		FloatVectorOperations::abs(destination, channels[0], numSamples);
+
+		for (int c = 1; c < numChannels; c++)
+		{
+			FloatVectorOperations::abs(temp, channels[c], numSamples);
+			FloatVectorOperations::max(destination, destination, temp, numSamples);
+		}
+
+		break;
+	}
+	case Mode::RMS:
+	{
+		FloatVectorOperations::multiply(destination, channels[0], channels[0], numSamples);
+
+		for (int c = 1; c < numChannels; c++)
+		{
+			FloatVectorOperations::multiply(temp, channels[c], channels[c], numSamples);
+			FloatVectorOperations::add(destination, temp, numSamples);
+		}
+
+		if (numChannels > 1)
+			FloatVectorOperations::multiply(destination, 1.0f / (float)numChannels, numSamples);
+
+		break;
+	}
+	case Mode::LUFS:
+	{
+		// The power of the K-weighted channels is summed (not averaged)
+		for (int c = 0; c < numChannels; c++)
+		{
+			FloatVectorOperations::copy(temp, channels[c], numSamples);
+
+			shelfFilters[c].process(temp, numSamples);
+			highpassFilters[c].process(temp, numSamples);
+
+			if (c == 0)
+				FloatVectorOperations::multiply(destination, temp, temp, numSamples);
+			else
+			{
+				FloatVectorOperations::multiply(temp, temp, temp, numSamples);
+				FloatVectorOperations::add(destination, temp, numSamples);
+			}
+		}
+
+		break;
+	}
+	case Mode::numModes:
+	default:
+		jassertfalse;
+		break;
+	}
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		const double k = (double)destination[i];
+
+		state = k + (k > state ? attackCoef : releaseCoef) * (state - k);
+		destination[i] = (float)state;
+	}
+
+	if (mode == Mode::RMS)
+	{
+		for (int i = 0; i < numSamples; i++)
+			destination[i] = std::sqrt(destination[i]);
+	}
+	else if (mode == Mode::LUFS)
+	{
+		// The loudness definition of BS.1770 has an offset of -0.691dB
+		const float loudnessOffset = 0.852904f;
+
+		for (int i = 0; i < numSamples; i++)
+			destination[i] = std::sqrt(destination[i] * loudnessOffset);
+	}
+}
+
+void SidechainBus::EnvelopeDetector::Biquad::process(float* data, int numSamples) noexcept
+{
+	for (int i = 0; i < numSamples; i++)
+	{
+		const double x = (double)data[i];
+		const double y = b0 * x + z1;
+
+		z1 = b1 * x - a1 * y + z2;
+		z2 = b2 * x - a2 * y;
+
+		data[i] = (float)y;
+	}
+}
+
+SidechainBus::Channel::Channel(const String& name_) :
+	name(name_),
+	pendingMode((int)EnvelopeDetector::Mode::Peak),
+	pendingAttack(10.0),
+	pendingRelease(100.0),
+	detectorChanged(false),
+	currentValue(0.0f)
+{
+
+}
+
+void SidechainBus::Channel::setDetector(EnvelopeDetector::Mode newMode, double attackMs, double releaseMs)
+{
+	pendingMode.store((int)newMode);
+	pendingAttack.store(attackMs);
+	pendingRelease.store(releaseMs);
+	detectorChanged.store(true);
+}
+
+void SidechainBus::Channel::applyPendingDetector()
+{
+	if (detectorChanged.exchange(false))
+	{
+		detector.setMode((EnvelopeDetector::Mode)pendingMode.load());
+		detector.setAttack(pendingAttack.load());
+		detector.setRelease(pendingRelease.load());
+	}
+}
+
+void SidechainBus::Channel::prepare(double sampleRate, int maxBlockSize)
+{
+	maxSize = maxBlockSize;
+
+	for (int i = 0; i < 2; i++)
+	{
+		audio[i].setSize(NumAudioChannels, jmax(1, maxSize));
+		envelope[i].setSize(1, jmax(1, maxSize));
+
+		audio[i].clear();
+		envelope[i].clear();
+	}
+
+	applyPendingDetector();
+	detector.prepare(sampleRate);
+
+	numWritten = 0;
+	numReadable = 0;
+	lastValue = 0.0f;
+	currentValue.store(0.0f);
+}
+
+void SidechainBus::Channel::write(const AudioSampleBuffer& buffer, int startSample, int numSamples)
+{
+	numSamples = jmin(numSamples, maxSize - startSample);
+
+	if (numSamples <= 0 || buffer.getNumChannels() == 0)
+		return;
+
+	applyPendingDetector();
+
+	auto& a = audio[writeIndex];
+	const int numChannelsToWrite = jmin(buffer.getNumChannels(), (int)NumAudioChannels);
+
+	const float* signal[NumAudioChannels];
+
+	for (int c = 0; c < NumAudioChannels; c++)
+	{
+		// A mono signal is written into both channels
+		a.copyFrom(c, startSample, buffer, jmin(c, numChannelsToWrite - 1), startSample, numSamples);
+		signal[c] = a.getReadPointer(c, startSample);
+	}
+
+	detector.process(signal, numChannelsToWrite, envelope[writeIndex].getWritePointer(0, startSample), numSamples);
+
+	numWritten = jmax(numWritten, startSample + numSamples);
+}
+
+float SidechainBus::Channel::getEnvelopeValue(int samplePosition) const noexcept
+{
+	if (isPositiveAndBelow(samplePosition, numReadable))
+		return envelope[1 - writeIndex].getSample(0, samplePosition);
+
+	return lastValue;
+}
+
+void SidechainBus::Channel::readEnvelope(float* destination, int startSample, int numSamples) const noexcept
+{
+	const int numAvailable = jlimit(0, numSamples, numReadable - startSample);
+
+	if (numAvailable > 0)
+		FloatVectorOperations::copy(destination, envelope[1 - writeIndex].getReadPointer(0, startSample), numAvailable);
+
+	// The last block was shorter (or the publisher didn't write anything), so the last value is held
+	if (numAvailable < numSamples)
+		FloatVectorOperations::fill(destination + numAvailable, lastValue, numSamples - numAvailable);
+}
+
+void SidechainBus::Channel::readAudio(int channelIndex, float* destination, int startSample, int numSamples) const noexcept
+{
+	const int numAvailable = jlimit(0, numSamples, numReadable - startSample);
+
+	if (numAvailable > 0)
+	{
+		const int c = jlimit(0, NumAudioChannels - 1, channelIndex);
+		FloatVectorOperations::copy(destination, audio[1 - writeIndex].getReadPointer(c, startSample), numAvailable);
+	}
+
+	if (numAvailable < numSamples)
+		FloatVectorOperations::clear(destination + numAvailable, numSamples - numAvailable);
+}
+
+void SidechainBus::Channel::advance()
+{
+	const int readIndex = writeIndex;
+
+	numReadable = numWritten;
+	numWritten = 0;
+	writeIndex = 1 - writeIndex;
+
+	lastValue = numReadable > 0 ? envelope[readIndex].getSample(0, numReadable - 1) : 0.0f;
+	currentValue.store(lastValue);
+}
+
+SidechainBus::SidechainBus() :
+	numChannels(0)
+{
+	for (int i = 0; i < HISE_NUM_SIDECHAIN_CHANNELS; i++)
+		channels[i] = nullptr;
+}
+
+SidechainBus::Channel* SidechainBus::getChannel(const String& name)
+{
+	ScopedLock sl(createLock);
+
+	const int n = numChannels.load();
+
+	for (int i = 0; i < n; i++)
+	{
+		if (channels[i]->getName() == name)
+			return channels[i];
+	}
+
+	if (n >= HISE_NUM_SIDECHAIN_CHANNELS)
+	{
+		// Increase HISE_NUM_SIDECHAIN_CHANNELS
+		jassertfalse;
+		return nullptr;
+	}
+
+	auto c = ownedChannels.add(new Channel(name));
+	c->prepare(sampleRate, maxBlockSize);
+
+	// The channel is prepared before the audio thread can see it
+	channels[n] = c;
+	numChannels.store(n + 1);
+
+	return c;
+}
+
+StringArray SidechainBus::getChannelNames() const
+{
+	ScopedLock sl(createLock);
+
+	StringArray names;
+
+	for (int i = 0; i < numChannels.load(); i++)
+		names.add(channels[i]->getName());
+
+	return names;
+}
+
+void SidechainBus::prepare(double newSampleRate, int newMaxBlockSize)
+{
+	ScopedLock sl(createLock);
+
+	sampleRate = newSampleRate;
+	maxBlockSize = newMaxBlockSize;
+
+	for (int i = 0; i < numChannels.load(); i++)
+		channels[i]->prepare(sampleRate, maxBlockSize);
+}
+
+void SidechainBus::advance()
+{
+	const int n = numChannels.load();
+
+	for (int i = 0; i < n; i++)
+		channels[i]->advance();
+}
+
+ControllerStateBuffer::ControllerStateBuffer()
+{
+	for (int i = 0; i < NumControllers; i++)
+	{
+		firstIndexes[i] = -1;
+		lastIndexes[i] = -1;
+		lastValues[i] = -1.0f;
+		blockStartValues[i] = -1.0f;
+		lastChangeBlocks[i] = 0;
+		previousChangeBlocks[i] = 0;
+	}
+
+	FloatVectorOperations::fill(polyAftertouchValues, -1.0f, 128);
+}
+
+void ControllerStateBuffer::processEvents(const HiseEventBuffer& events, int numSamples)
+{
+	for (int i = 0; i < numChangedControllers; i++)
+	{
+		firstIndexes[changedControllers[i]] = -1;
+		lastIndexes[changedControllers[i]] = -1;
+	}
+
+	numChangedControllers = 0;
+	numBreakpoints = 0;
+	++blockIndex;
+
+	const int lastTimestamp = jmax<int>(0, numSamples - 1);
+
+	HiseEventBuffer::Iterator iter(events);
+
+	while (auto e = iter.getNextConstEventPointer(true, false))
+	{
+		const int timestamp = jlimit<int>(0, lastTimestamp, (int)e->getTimeStamp());
+		const int channel = e->getChannel();
+
+		if (e->isController())
+		{
+			const int number = e->getControllerNumber();
+
+			if (isPositiveAndBelow(number, 128))
+				addBreakpoint(number, timestamp, (float)e->getControllerValue() / 127.0f, channel);
+		}
+		else if (e->isPitchWheel())
+		{
+			addBreakpoint(PitchWheelNumber, timestamp, (float)e->getPitchWheelValue() / 16383.0f, channel);
+		}
+		else if (e->isAftertouch())
+		{
+			// HiseEvents use the same type for channel pressure and polyphonic aftertouch, so treat every 
+			// message as pressure of its note and use the maximum of all held notes
+			polyAftertouchValues[e->getNoteNumber() & 127] = (float)e->getAfterTouchValue() / 127.0f;
+
+			const float maxPressure = FloatVectorOperations::findMaximum(polyAftertouchValues, 128);
+
+			addBreakpoint(AftertouchNumber, timestamp, jmax<float>(0.0f, maxPressure), channel);
+		}
+		else if (e->isNoteOff())
+		{
+			polyAftertouchValues[e->getNoteNumber() & 127] = -1.0f;
+		}
+	}
+}
+
+void ControllerStateBuffer::addBreakpoint(int controllerNumber, int timestamp, float value, int channel)
+{
+	// The size is the same as the event buffer, so this can't happen...
+	jassert(numBreakpoints < HISE_EVENT_BUFFER_SIZE);
+
+	const int index = numBreakpoints++;
+
+	auto& b = breakpoints[index];
+	b.timestamp = timestamp;
+	b.value = jlimit<float>(0.0f, 1.0f, value);
+	b.channel = channel;
+	b.next = -1;
+
+	if (lastIndexes[controllerNumber] == -1)
+	{
+		firstIndexes[controllerNumber] = index;
+		changedControllers[numChangedControllers++] = controllerNumber;
+
+		blockStartValues[controllerNumber] = lastValues[controllerNumber];
+		previousChangeBlocks[controllerNumber] = lastChangeBlocks[controllerNumber];
+		lastChangeBlocks[controllerNumber] = blockIndex;
+	}
+	else
+		breakpoints[lastIndexes[controllerNumber]].next = index;
+
+	lastIndexes[controllerNumber] = index;
+	lastValues[controllerNumber] = b.value;
+}
+
+void ControllerStateBuffer::ExponentialRamp::prepare(double newSampleRate)
+{
+	sampleRate = newSampleRate;
+	updateCoefficient();
+}
+
+void ControllerStateBuffer::ExponentialRamp::setSmoothingTime(float newSmoothingTime)
+{
+	smoothingTime = newSmoothingTime;
+	updateCoefficient();
+}
+
+void ControllerStateBuffer::ExponentialRamp::updateCoefficient()
+{
+	if (sampleRate > 0.0 && smoothingTime > 0.0f)
+	{
+		// Same coefficient as the Smoother
+		const float freq = 1000.0f / smoothingTime;
+		coefficient = expf(-2.0f * float_Pi * freq / (float)sampleRate);
+		logCoefficient = logf(coefficient);
+	}
+	else
+	{
+		coefficient = 0.0f;
+		logCoefficient = 0.0f;
+	}
+}
+
+void ControllerStateBuffer::ExponentialRamp::render(float* data, int numSamples) noexcept
+{
+	if (numSamples <= 0)
+		return;
+
+	const float delta = currentValue - targetValue;
+
+	if (std::abs(delta) <= Threshold || coefficient <= 0.0f || logCoefficient >= 0.0f)
+	{
+		currentValue = targetValue;
+		FloatVectorOperations::fill(data, targetValue, numSamples);
+		return;
+	}
+
+	// The number of samples until the value is within the threshold
+	const float numUntilThreshold = std::ceil(std::log(Threshold / std::abs(delta)) / logCoefficient);
+	const int numToSmooth = (int)jlimit<float>(1.0f, (float)numSamples, numUntilThreshold);
+
+	const float a = coefficient;
+	int i = 0;
+
+#if JUCE_INTEL
+	float powers[4] = { a, a * a, a * a * a, a * a * a * a };
+
+	auto d = _mm_mul_ps(_mm_set1_ps(delta), _mm_loadu_ps(powers));
+	const auto step = _mm_set1_ps(powers[3]);
+	const auto t = _mm_set1_ps(targetValue);
+
+	for (; i + 4 <= numToSmooth; i += 4)
+	{
+		_mm_storeu_ps(data + i, _mm_add_ps(t, d));
+		d = _mm_mul_ps(d, step);
+	}
+
+	// The lanes contain the next deltas, so the remaining samples can use them directly
+	_mm_storeu_ps(powers, d);
+
+	for (int j = 0; i < numToSmooth; i++, j++)
+		data[i] = targetValue + powers[j];
+#else
+	float d = delta;
+
+	for (; i < numToSmooth; i++)
+	{
+		d *= a;
+		data[i] = targetValue + d;
+	}
+#endif
+
+	if (numToSmooth < numSamples)
+	{
+		currentValue = targetValue;
+		FloatVectorOperations::fill(data + numToSmooth, targetValue, numSamples - numToSmooth);
+	}
+	else
+		currentValue = data[numToSmooth - 1];
+}
+
 } // namespace hise
@@ -64,16 +64,78 @@ class MPEModulator;
 
 /** This handles the MIDI automation for the frontend plugin.
 *
-*	For faster performance, one CC value can only control one parameter.
+*	Parameters can be assigned to 7-bit controllers, 14-bit controller pairs and NRPN / RPN messages. The
+*	assignments are stored in a list that is sorted by controller and a dispatch table points to the
+*	range of assignments for each controller, so incoming messages are dispatched without searching.
 *
+*	The values are applied on the audio thread and the notifications for the UI and the host are sent
+*	from the message thread, so dense controller streams don't cause any broadcasting on the audio thread.
 */
 class MidiControllerAutomationHandler : public RestorableObject,
 										public SafeChangeBroadcaster
 {
 public:
 
+	/** The type of the MIDI message that controls a parameter. */
+	enum class ControllerType
+	{
+		CC = 0, ///< a 7-bit controller (0 - 127)
+		CC14,	///< a 14-bit controller pair (the MSB controller 0 - 31 and the LSB at the number + 32)
+		NRPN,	///< a non registered parameter number (0 - 16383)
+		RPN,	///< a registered parameter number (0 - 16383)
+		numControllerTypes
+	};
+
+	/** A controller value that was decoded from a MIDI message. */
+	struct ControllerValue
+	{
+		ControllerType type = ControllerType::CC;
+		int number = -1;
+		double normalisedValue = 0.0;
+	};
+
+	/** Decodes 14-bit controller pairs and NRPN / RPN data entries from a stream of controller messages.
+	*
+	*	It stores the last MSB values and the selected parameter number for each MIDI channel, so the
+	*	messages must be passed in the order they arrive.
+	*/
+	class ControllerDecoder
+	{
+	public:
+
+		/** The maximum amount of values a single message can produce. */
+		static constexpr int MaxNumValues = 2;
+
+		ControllerDecoder() { reset(); }
+
+		/** Clears the MSB values and the selected parameter numbers. */
+		void reset();
+
+		/** Decodes the controller message and returns the number of values that were written into the array.
+		*
+		*	Every controller message creates a 7-bit value. The MSB and LSB of the controllers 0 - 31 also create
+		*	a 14-bit value and the data entry controllers create a NRPN / RPN value if a parameter is selected.
+		*/
+		int decode(const MidiMessage& m, ControllerValue* values);
+
+	private:
+
+		struct ChannelState
+		{
+			uint8 msbValues[32];
+			uint8 dataMsb = 0;
+			uint8 parameterMsb = 127;
+			uint8 parameterLsb = 127;
+			ControllerType parameterType = ControllerType::CC;
+		};
+
+		ChannelState channels[16];
+	};
+
 	MidiControllerAutomationHandler(MainController *mc_);
 
+	~MidiControllerAutomationHandler();
+
 	void addMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex, NormalisableRange<double> parameterRange, int macroIndex);
 	void removeMidiControlledParameter(Processor *interfaceProcessor, int attributeIndex, NotificationType notifyListeners);
 
@@ -86,13 +148,30 @@ public:
 	void deactivateMidiLearning();
 
 	void setUnlearndedMidiControlNumber(int ccNumber, NotificationType notifyListeners);
+
+	/** Assigns the parameter that is currently learning to the given controller. */
+	void setUnlearnedController(ControllerType type, int number, NotificationType notifyListeners);
+
+	/** Assigns the controller that was learned on the audio thread. A timer calls this periodically. */
+	void commitLearnedController(NotificationType notifyListeners);
+
 	int getMidiControllerNumber(Processor *interfaceProcessor, int attributeIndex) const;
 
+	/** Returns a description of the controller that is assigned to the parameter (eg. "NRPN 1025") or an empty string. */
+	String getMidiControllerName(Processor *interfaceProcessor, int attributeIndex) const;
+
 	void refreshAnyUsedState();
 	void clear();
 
-	/** The main routine. Call this for every MidiBuffer you want to process and it handles both setting parameters as well as MIDI learning. */
-	void handleParameterData(MidiBuffer &b);
+	/** The main routine. Call this for every MidiBuffer you want to process and it handles both setting parameters as well as MIDI learning. 
+	*
+	*	The parameters are set once per block with the value at the end of the block, but the smoothing of each
+	*	assignment starts at the position of the controller message.
+	*/
+	void handleParameterData(MidiBuffer &b, int numSamples);
+
+	/** Returns a name for the controller type and number that can be displayed to the user. */
+	static String getControllerName(ControllerType type, int number);
 
 		
 	class MPEData : public ControlledObject,
@@ -246,6 +325,18 @@ public:
 
 		ValueTree exportAsValueTree() const override;
 
+		/** Returns a number that sorts the assignments by controller type and number. */
+		int getControllerKey() const noexcept { return ((int)controllerType << 14) | ccNumber; }
+
+		/** Returns the name of the assigned controller. */
+		String getControllerName() const { return MidiControllerAutomationHandler::getControllerName(controllerType, ccNumber); }
+
+		/** Sets the new target value. The ramp starts at the given position within the current block. */
+		void setTargetValue(double normalisedValue, int samplePosition);
+
+		/** Advances the smoothing to the given position and returns true if the value has changed. */
+		bool advance(int samplePosition);
+
 		MainController* mc = nullptr;
 		WeakReference<Processor> processor;
 		int attribute;
@@ -254,8 +345,18 @@ public:
 		float lastValue = -1.0f;
 		int macroIndex;
 		int ccNumber = -1;
+		ControllerType controllerType = ControllerType::CC;
+		double smoothingTime = 0.0;
 		bool inverted = false;
 		bool used;
+
+		// The smoothing state (only used on the audio thread)
+		double currentValue = -1.0;
+		double targetValue = 0.0;
+		double delta = 0.0;
+		int numRampSamples = 0;
+		int blockPosition = 0;
+		bool dirty = false;
 	};
 
 	/** Returns a copy of the automation data for the given index. */
@@ -268,10 +369,61 @@ public:
 	int getNumActiveConnections() const;
 	bool setNewRangeForParameter(int index, NormalisableRange<double> range);
 	bool setParameterInverted(int index, bool value);
+
+	/** Sets the time in milliseconds that the parameter needs to reach a new controller value. */
+	bool setSmoothingTime(int index, double smoothingTimeMs);
+
 private:
 
 	// ========================================================================================================
 
+	/** A change that was applied on the audio thread and needs to be sent to the UI and the host. */
+	struct Notification
+	{
+		WeakReference<Processor> processor;
+		int attribute = -1;
+		int macroIndex = -1;
+		float value = 0.0f;
+	};
+
+	/** Sends the notifications and commits the controller that was learned on the audio thread. */
+	struct PendingNotifications : private Timer
+	{
+		PendingNotifications(MidiControllerAutomationHandler& parent_);
+
+		~PendingNotifications() { stopTimer(); }
+
+		MultithreadedLockfreeQueue<Notification, MultithreadedQueueHelpers::Configuration::NoAllocationsTokenlessUsageAllowed> queue;
+
+		/** The controller that was learned on the audio thread (-1 if nothing was learned yet). */
+		std::atomic<int> learnedControllerKey;
+
+	private:
+
+		void timerCallback() override;
+
+		MidiControllerAutomationHandler& parent;
+	};
+
+	/** Points to the range of assignments in the sorted list for each controller. */
+	struct DispatchTable
+	{
+		void clear();
+
+		Range<int> getAssignments(const ControllerValue& v) const;
+
+		Range<int> cc[128];
+		Range<int> cc14[32];
+		HashMap<int, Range<int>> parameterNumbers;
+	};
+
+	/** Call this whenever the list of assignments changed (with the audio lock held). */
+	void rebuildDispatchTable();
+
+	void applyValue(AutomationData& a);
+
+	void learnController(const ControllerValue* values, int numValues);
+
 	MainController *mc;
 	
 
@@ -284,7 +436,15 @@ private:
 	bool anyUsed;
 	MidiBuffer tempBuffer;
 
-	Array<AutomationData> automationData[128];
+	ControllerDecoder decoder;
+	DispatchTable dispatchTable;
+	PendingNotifications pendingNotifications;
+
+	/** The number of assignments that are currently smoothing. */
+	int numActiveRamps = 0;
+
+	/** All assignments sorted by their controller key. */
+	Array<AutomationData> automationData;
 	AutomationData unlearnedData;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiControllerAutomationHandler)
@@ -436,11 +596,120 @@ private:
 
 
 
-/** This introduces an artificial delay of max 256 samples and calls the internal processing loop with a fixed number of samples.
+/** Splits the buffers of the host into blocks that the engine can process.
 *
-*	This is supposed to offer a rather ugly fallback solution for hosts who change their processing size constantly (eg. FL Studio).
+*	The engine needs blocks with a length that is a multiple of HISE_EVENT_RASTER and that are not longer than
+*	the block size it was prepared with. Some hosts (eg. FL Studio) send buffers with arbitrary lengths, so this
+*	class cuts them into raster aligned sub blocks and shifts the MIDI events accordingly.
+*
+*	How the remainder that doesn't fill a whole raster is handled depends on the mode:
+*
+*	- RenderAhead renders a complete raster block and keeps the samples that haven't been requested yet for the next
+*	  buffer. This adds no latency, but the input of the pre-rendered samples is silent and MIDI events that fall into
+*	  this range are delayed to the next sub block (so they are off by less than one raster).
+*	- DelayedInput delays the input by one raster and only renders complete raster blocks. Use this if the input signal
+*	  is processed (eg. in an effect plugin).
+*	- Passthrough doesn't care about the raster and only splits buffers that are longer than the maximum block size.
+*
+*	All buffers are preallocated in prepare(), so process() can be called from the audio thread.
 */
-class DelayedRenderer
+class RasterBlockSplitter
+{
+public:
+
+	enum class Mode
+	{
+		Passthrough = 0,
+		RenderAhead,
+		DelayedInput,
+		numModes
+	};
+
+	/** The interface for the actual rendering callback. */
+	class Renderer
+	{
+	public:
+
+		virtual ~Renderer() {};
+
+		/** Renders the given block.
+		*
+		*	The length of the buffer is a multiple of HISE_EVENT_RASTER (unless the mode is Passthrough) and never
+		*	exceeds the maximum render block size. The offset is the position of the block's first sample relative to
+		*	the start of the host buffer (it can be negative for delayed input).
+		*/
+		virtual void renderBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offsetInHostBuffer) = 0;
+
+		/** Return true if the rendered signal is added to the input instead of replacing it. */
+		virtual bool addsToInput() const { return false; }
+	};
+
+	RasterBlockSplitter() {};
+
+	/** Returns the smallest raster aligned block size that can hold the given number of samples. */
+	static int getRasterAlignedBlockSize(int numSamples)
+	{
+		return ((numSamples + HISE_EVENT_RASTER - 1) / HISE_EVENT_RASTER) * HISE_EVENT_RASTER;
+	}
+
+	/** Allocates the internal buffers and resets the state. Don't call this while process() is running. */
+	void prepare(Mode newMode, int numChannels, int maxHostBlockSize, int maxRenderBlockSize);
+
+	/** Processes the host buffer with arbitrary length and calls the renderer with raster aligned blocks. */
+	void process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, Renderer& r);
+
+	/** Returns the latency that is introduced by the current mode. */
+	int getLatency() const { return mode == Mode::DelayedInput ? HISE_EVENT_RASTER : 0; }
+
+	Mode getMode() const { return mode; }
+
+	/** Returns the number of samples that were rendered but not yet sent to the host. */
+	int getNumPendingSamples() const { return numPending; }
+
+private:
+
+	void processSlice(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offset, int numSamples, Renderer& r);
+
+	void renderAhead(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offset, int numSamples, Renderer& r);
+	void renderDelayed(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offset, int numSamples, Renderer& r);
+
+	/** Adds the events that arrived too late for their block to the MIDI buffer of the next sub block. */
+	void addLateEvents(MidiBuffer& destination);
+
+	/** Adds the events of the given range with a timestamp of zero, so they are delivered with the next sub block. */
+	void deferEvents(const MidiBuffer& source, int startSample, int numSamples);
+
+	Mode mode = Mode::Passthrough;
+
+	int numChannels = 0;
+	int maxHostSize = 0;
+	int maxRenderSize = 0;
+
+	// RenderAhead: the rest of the last raster block
+	AudioSampleBuffer pendingBuffer;
+	int pendingOffset = 0;
+	int numPending = 0;
+
+	// DelayedInput: the input that doesn't fill a raster block yet and the rendered output
+	CircularAudioSampleBuffer inputFifo;
+	CircularAudioSampleBuffer outputFifo;
+	AudioSampleBuffer renderBuffer;
+
+	MidiBuffer subBlockMidi;
+	MidiBuffer heldMidi;
+	MidiBuffer lateMidi;
+	MidiBuffer swapMidi;
+
+	JUCE_DECLARE_NON_COPYABLE(RasterBlockSplitter);
+};
+
+
+/** Wraps the processing of the MainController so that the host can use arbitrary block sizes.
+*
+*	Instruments render the remainder of a buffer ahead and don't add any latency. Effect plugins delay the input by
+*	one raster block if the host is known to send irregular buffer sizes (eg. FL Studio).
+*/
+class DelayedRenderer: private RasterBlockSplitter::Renderer
 {
 public:
 
@@ -448,43 +717,507 @@ public:
 
 	~DelayedRenderer();
 
-	/** Checks whether this should be used. It currently is only activated on FL Studio. */
+	/** Checks whether the host is known to send irregular buffer sizes. It currently is only activated on FL Studio. */
 	bool shouldDelayRendering() const;
 
-	/** Wraps the processing and delays the processing if necessary. */
-	void processWrapped(AudioSampleBuffer& inputBuffer, MidiBuffer& midiBuffer);
+	/** Splits the host buffer into raster aligned blocks and calls the processing loop of the MainController. */
+	void processWrapped(AudioSampleBuffer& inputBuffer, MidiBuffer& midiMessages);
 
-	/** Calls prepareToPlay with either 256 samples or a smaller buffer size (if the block size is smaller). It correctly reports the latency to the host. */
+	/** Prepares the MainController with the raster aligned block size and reports the latency to the host. */
 	void prepareToPlayWrapped(double sampleRate, int samplesPerBlock);
 
+	/** Returns the latency that is caused by the block splitting (or zero if it doesn't add latency). */
+	int getLatency() const;
+
 private:
 
+	void renderBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int offsetInHostBuffer) override;
+
+	bool addsToInput() const override;
+
 	class Pimpl;
 
 	ScopedPointer<Pimpl> pimpl;
 
 	MainController* mc;
 
-	AudioSampleBuffer b1;
-	AudioSampleBuffer b2;
+	RasterBlockSplitter splitter;
+};
 
-	AudioSampleBuffer* readBuffer = nullptr;
-	AudioSampleBuffer* writeBuffer = nullptr;
+#ifndef HISE_EVENT_INBOX_SIZE
+#define HISE_EVENT_INBOX_SIZE 512
+#endif
 
-	CircularAudioSampleBuffer circularInputBuffer;
-	CircularAudioSampleBuffer circularOutputBuffer;
-	
-	int lastBlockSize = 0;
+/** A lock free queue that allows any thread to schedule events for the audio thread.
+*
+*	The events are stamped with an absolute sample position (use getCurrentSamplePosition() as reference)
+*	and will be inserted into the master event buffer at the beginning of the block that contains this position.
+*	This means they are treated like incoming MIDI messages and get their event IDs assigned by the EventIdHandler.
+*
+*	Pushing is lock free and doesn't allocate (it returns false if the inbox is full), so you can call it from
+*	the message thread, a background thread or the audio thread itself.
+*/
+class EventInbox
+{
+public:
 
-	AudioSampleBuffer processBuffer;
-	MidiBuffer delayedMidiBuffer;
+	EventInbox();
 
-	int fullBlockSize;
+	/** Schedules the event at the given absolute sample position.
+	*
+	*	If the position is already in the past, the event will be inserted at the start of the next block.
+	*/
+	bool push(const HiseEvent& e, int64 samplePosition);
 
-	int sampleIndexInternal = 0;
-	int sampleIndexExternal = 0;
+	/** Schedules the event at the start of the next block. */
+	bool push(const HiseEvent& e) { return push(e, 0); }
 
-	
+	/** Returns the sample position of the start of the next block. */
+	int64 getCurrentSamplePosition() const noexcept { return currentSamplePosition.load(); }
+
+	/** Inserts all events that are due in this block into the buffer and advances the sample position.
+	*
+	*	Call this from the audio thread at the start of each block.
+	*/
+	void processBlock(HiseEventBuffer& buffer, int numSamples);
+
+private:
+
+	struct ScheduledEvent
+	{
+		HiseEvent e;
+		int64 samplePosition = 0;
+	};
+
+	MultithreadedLockfreeQueue<ScheduledEvent, MultithreadedQueueHelpers::Configuration::NoAllocationsTokenlessUsageAllowed> pendingEvents;
+
+	/** The events that have been popped from the queue, but are scheduled for a later block. */
+	HeapBlock<ScheduledEvent> scheduledEvents;
+	int numScheduledEvents = 0;
+
+	std::atomic<int64> currentSamplePosition;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventInbox);
+};
+
+#ifndef HISE_NUM_SIDECHAIN_CHANNELS
+#define HISE_NUM_SIDECHAIN_CHANNELS 64
+#endif
+
+/** A bus that allows modules to publish a named signal that other modules can read at audio rate.
+*
+*	A publisher (eg. the GainCollector) writes its audio signal into a channel of the bus, which also calculates
+*	the envelope of the signal with the selected detector. Subscribers resolve the channel once by its name on the
+*	message thread and keep the pointer, so there is no lookup during the audio rendering.
+*
+*	The channels are double buffered: the signal that was written in one block can be read in the next block.
+*	This adds one block of latency, but the result doesn't depend on the processing order of the modules, so a
+*	subscriber can be processed before or after its publisher (or even in another synth).
+*
+*	Channels are never deleted (they stay alive as long as the MainController), so a subscriber can keep the
+*	pointer even if the publisher is removed (it will just read silence).
+*/
+class SidechainBus
+{
+public:
+
+	/** The maximum amount of audio channels that a publisher can write into the bus. */
+	static constexpr int NumAudioChannels = 2;
+
+	/** Calculates the envelope of a signal in blocks.
+	*
+	*	The key signal (the peak of all channels, the mean square or the K-weighted mean square) is calculated with
+	*	vector operations, then a single loop applies the attack / release smoothing.
+	*/
+	class EnvelopeDetector
+	{
+	public:
+
+		enum class Mode
+		{
+			Peak = 0,
+			RMS,
+			LUFS,
+			numModes
+		};
+
+		/** The maximum number of samples that are processed in one chunk. */
+		static constexpr int BlockSize = 256;
+
+		EnvelopeDetector();
+
+		void prepare(double newSampleRate);
+
+		/** Resets the envelope and the state of the K-weighting filter. */
+		void reset();
+
+		void setMode(Mode newMode);
+		void setAttack(double attackMs);
+		void setRelease(double releaseMs);
+
+		Mode getMode() const noexcept { return mode; }
+
+		/** Calculates the envelope of the given channels and writes it as gain factor into the destination. */
+		void process(const float* const* channels, int numChannels, float* destination, int numSamples);
+
+	private:
+
+		struct Biquad
+		{
+			void process(float* data, int numSamples) noexcept;
+
+			double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+			double z1 = 0.0, z2 = 0.0;
+		};
+
+		void processChunk(const float* const* channels, int numChannels, float* destination, int numSamples);
+		void updateCoefficients();
+
+		Mode mode = Mode::Peak;
+
+		double sampleRate = 44100.0;
+		double attack = 10.0;
+		double release = 100.0;
+		double attackCoef = 0.0;
+		double releaseCoef = 0.0;
+		double state = 0.0;
+
+		Biquad shelfFilters[NumAudioChannels];
+		Biquad highpassFilters[NumAudioChannels];
+	};
+
+	/** A named signal on the bus. */
+	class Channel
+	{
+	public:
+
+		Channel(const String& name_);
+
+		const String& getName() const noexcept { return name; }
+
+		/** Sets the detector that is used to calculate the envelope. Call this from the publisher.
+		*
+		*	This can be called from any thread: the settings are applied before the next block is written.
+		*/
+		void setDetector(EnvelopeDetector::Mode newMode, double attackMs, double releaseMs);
+
+		/** Writes the audio signal of the publisher and calculates its envelope.
+		*
+		*	Call this from the audio thread. The start sample is the position relative to the current block.
+		*/
+		void write(const AudioSampleBuffer& buffer, int startSample, int numSamples);
+
+		/** Returns the envelope of the last block at the given position. */
+		float getEnvelopeValue(int samplePosition) const noexcept;
+
+		/** Copies the envelope of the last block into the destination. */
+		void readEnvelope(float* destination, int startSample, int numSamples) const noexcept;
+
+		/** Copies the audio signal of the last block into the destination. */
+		void readAudio(int channelIndex, float* destination, int startSample, int numSamples) const noexcept;
+
+		/** Returns the last envelope value of the previous block. This can be called from any thread. */
+		float getCurrentValue() const noexcept { return currentValue.load(); }
+
+	private:
+
+		friend class SidechainBus;
+
+		void prepare(double sampleRate, int maxBlockSize);
+		void advance();
+
+		/** Applies the settings of the last setDetector() call. Only call this from the thread that writes the channel. */
+		void applyPendingDetector();
+
+		const String name;
+
+		EnvelopeDetector detector;
+
+		std::atomic<int> pendingMode;
+		std::atomic<double> pendingAttack;
+		std::atomic<double> pendingRelease;
+		std::atomic<bool> detectorChanged;
+
+		AudioSampleBuffer audio[2];
+		AudioSampleBuffer envelope[2];
+
+		int writeIndex = 0;
+		int numWritten = 0;
+		int numReadable = 0;
+		int maxSize = 0;
+
+		float lastValue = 0.0f;
+		std::atomic<float> currentValue;
+
+		JUCE_DECLARE_NON_COPYABLE(Channel);
+	};
+
+	SidechainBus();
+
+	/** Returns the channel with the given name and creates it if it doesn't exist yet.
+	*
+	*	Call this from the message or loading thread (never from the audio thread). Publishers and subscribers
+	*	both use this method, so it doesn't matter which one is created first.
+	*/
+	Channel* getChannel(const String& name);
+
+	/** Returns a list of the names of all channels. */
+	StringArray getChannelNames() const;
+
+	/** Resizes the buffers of all channels. Call this when the audio rendering is suspended. */
+	void prepare(double newSampleRate, int newMaxBlockSize);
+
+	/** Swaps the buffers of all channels, so the signal of the last block becomes readable.
+	*
+	*	Call this from the audio thread at the start of each block.
+	*/
+	void advance();
+
+private:
+
+	CriticalSection createLock;
+
+	OwnedArray<Channel> ownedChannels;
+
+	Channel* channels[HISE_NUM_SIDECHAIN_CHANNELS];
+	std::atomic<int> numChannels;
+
+	double sampleRate = 44100.0;
+	int maxBlockSize = 0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SidechainBus);
+};
+
+/** Decodes the controller messages of an event buffer into sample accurate breakpoint lists.
+*
+*	Every sound generator decodes its event buffer once per block (after the MIDI processors), so the modulators
+*	that react on MIDI controllers don't have to track the controller values themselves. A modulator reads the
+*	breakpoints of its controller that fall into the range it is rendering and calculates the smoothed signal between
+*	the breakpoints with an ExponentialRamp. This way the messages are also applied at the correct position if the
+*	modulator is rendered after all events of the block were processed (eg. in an effect).
+*
+*	Aftertouch and pitch wheel messages use the controller numbers 128 and 129 (like the ControlModulator). The
+*	aftertouch value is the highest pressure of all held notes.
+*/
+class ControllerStateBuffer
+{
+public:
+
+	enum SpecialControllers
+	{
+		AftertouchNumber = 128,
+		PitchWheelNumber,
+		NumControllers
+	};
+
+	/** A value change of a controller. */
+	struct Breakpoint
+	{
+		int timestamp = 0; ///< the position relative to the start of the block
+		float value = 0.0f; ///< the normalised value (0...1)
+		int channel = 0; ///< the MIDI channel of the message
+		int next = -1; ///< the index of the next breakpoint of the same controller
+	};
+
+	/** Reads the breakpoints of the current block for a subscriber.
+	*
+	*	It remembers the position that was already read, so a breakpoint is never passed twice in the same block.
+	*	The positions are divided by the downsampling factor, so you can use the control rate positions of the modulator.
+	*/
+	class Reader
+	{
+	public:
+
+		Reader(int downsamplingFactor_=HISE_CONTROL_RATE_DOWNSAMPLING_FACTOR) :
+			downsamplingFactor(downsamplingFactor_)
+		{};
+
+		void setState(const ControllerStateBuffer* newState) noexcept
+		{
+			state = newState;
+			blockIndex = 0;
+			previousBlockIndex = 0;
+			readPosition = 0;
+		}
+
+		bool isConnected() const noexcept { return state != nullptr; }
+
+		/** Returns the start of the given range that wasn't read in this block (or the end if it was read completely).
+		*
+		*	Use this if you render the smoothed signal into a buffer that is shared by multiple voices.
+		*/
+		int getUnreadStart(int startSample, int numSamples) noexcept
+		{
+			updateBlockIndex();
+
+			const int unreadStart = (readPosition + downsamplingFactor - 1) / downsamplingFactor;
+			return jlimit<int>(startSample, startSample + numSamples, unreadStart);
+		}
+
+		/** Calls f(position, breakpoint) for every breakpoint of the controller in the given range that wasn't read yet. */
+		template <typename F> void read(int controllerNumber, int startSample, int numSamples, const F& f)
+		{
+			if (state == nullptr || !isPositiveAndBelow(controllerNumber, (int)NumControllers))
+				return;
+
+			updateBlockIndex();
+
+			const int start = jmax<int>(startSample * downsamplingFactor, readPosition);
+			const int end = (startSample + numSamples) * downsamplingFactor;
+
+			for (auto b = state->getFirstBreakpoint(controllerNumber); b != nullptr && b->timestamp < end; b = state->getNextBreakpoint(*b))
+			{
+				if (b->timestamp >= start)
+					f(b->timestamp / downsamplingFactor, *b);
+			}
+
+			readPosition = jmax<int>(readPosition, end);
+		}
+
+		/** Checks if the controller changed in a block that this reader didn't read.
+		*
+		*	This happens if the modulator isn't rendered in every block (eg. an envelope without active voices or 
+		*	a suspended effect). Call this once per block before read(). It returns the value at the start of the 
+		*	current block if a change was missed or -1 otherwise.
+		*/
+		float getMissedValue(int controllerNumber) noexcept
+		{
+			if (state == nullptr || !isPositiveAndBelow(controllerNumber, (int)NumControllers))
+				return -1.0f;
+
+			updateBlockIndex();
+
+			const bool missed = state->getLastChangeBeforeBlock(controllerNumber) > previousBlockIndex;
+
+			// Only report the missed value once per block
+			previousBlockIndex = blockIndex - 1;
+
+			return missed ? state->getValueAtBlockStart(controllerNumber) : -1.0f;
+		}
+
+	private:
+
+		void updateBlockIndex() noexcept
+		{
+			if (state != nullptr && blockIndex != state->getBlockIndex())
+			{
+				previousBlockIndex = blockIndex;
+				blockIndex = state->getBlockIndex();
+				readPosition = 0;
+			}
+		}
+
+		const ControllerStateBuffer* state = nullptr;
+		const int downsamplingFactor;
+
+		uint32 blockIndex = 0;
+		uint32 previousBlockIndex = 0;
+		int readPosition = 0;
+	};
+
+	/** Smoothes the steps between the breakpoints like the Smoother, but renders whole segments with vector operations.
+	*
+	*	The lowpass approaches the target exponentially, so the segment can be calculated with the closed form
+	*	target + (start - target) * a^n. Once the value is close enough to the target, the rest is a simple fill.
+	*/
+	class ExponentialRamp
+	{
+	public:
+
+		/** The distance to the target where the smoothing stops (same as the ControlModulator). */
+		static constexpr float Threshold = 0.001f;
+
+		/** Sets the rate of the rendered signal (eg. the control rate of a time variant modulator). */
+		void prepare(double newSampleRate);
+
+		/** Sets the smoothing time in milliseconds. Zero disables the smoothing. */
+		void setSmoothingTime(float newSmoothingTime);
+
+		void setTargetValue(float newTargetValue) noexcept { targetValue = newTargetValue; }
+
+		/** Sets the value without smoothing. */
+		void setValue(float newValue) noexcept { currentValue = targetValue = newValue; }
+
+		float getTargetValue() const noexcept { return targetValue; }
+		float getCurrentValue() const noexcept { return currentValue; }
+
+		/** Renders the next samples towards the target value. */
+		void render(float* data, int numSamples) noexcept;
+
+	private:
+
+		void updateCoefficient();
+
+		double sampleRate = 0.0;
+		float smoothingTime = 0.0f;
+		float coefficient = 0.0f;
+		float logCoefficient = 0.0f;
+
+		float currentValue = 0.0f;
+		float targetValue = 0.0f;
+	};
+
+	ControllerStateBuffer();
+
+	/** Decodes the controller messages of the buffer. Call this from the audio thread once per block. */
+	void processEvents(const HiseEventBuffer& events, int numSamples);
+
+	/** Returns the first breakpoint of the controller in the current block or nullptr if it didn't change. */
+	const Breakpoint* getFirstBreakpoint(int controllerNumber) const noexcept
+	{
+		const int index = firstIndexes[controllerNumber];
+		return index != -1 ? breakpoints + index : nullptr;
+	}
+
+	const Breakpoint* getNextBreakpoint(const Breakpoint& b) const noexcept
+	{
+		return b.next != -1 ? breakpoints + b.next : nullptr;
+	}
+
+	/** Returns the last received value of the controller or -1 if there was no message yet. */
+	float getLastValue(int controllerNumber) const noexcept { return lastValues[controllerNumber]; }
+
+	/** Returns the value of the controller before the first breakpoint of the current block or -1 if there was no message yet. */
+	float getValueAtBlockStart(int controllerNumber) const noexcept
+	{
+		return firstIndexes[controllerNumber] != -1 ? blockStartValues[controllerNumber] : lastValues[controllerNumber];
+	}
+
+	/** Returns the index of the last block before the current one in which the controller changed (or 0 if it never changed). */
+	uint32 getLastChangeBeforeBlock(int controllerNumber) const noexcept
+	{
+		return firstIndexes[controllerNumber] != -1 ? previousChangeBlocks[controllerNumber] : lastChangeBlocks[controllerNumber];
+	}
+
+	int getNumBreakpoints() const noexcept { return numBreakpoints; }
+
+	/** Returns a counter that is incremented with every call to processEvents(). */
+	uint32 getBlockIndex() const noexcept { return blockIndex; }
+
+private:
+
+	void addBreakpoint(int controllerNumber, int timestamp, float value, int channel);
+
+	Breakpoint breakpoints[HISE_EVENT_BUFFER_SIZE];
+	int numBreakpoints = 0;
+
+	int firstIndexes[NumControllers];
+	int lastIndexes[NumControllers];
+	float lastValues[NumControllers];
+	float blockStartValues[NumControllers];
+	uint32 lastChangeBlocks[NumControllers];
+	uint32 previousChangeBlocks[NumControllers];
+
+	// The pressure of every note for the polyphonic aftertouch (-1 if the note isn't pressed)
+	float polyAftertouchValues[128];
+
+	// The controllers that have breakpoints (so only those need to be cleared in the next block)
+	int changedControllers[NumControllers];
+	int numChangedControllers = 0;
+
+	uint32 blockIndex = 0;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ControllerStateBuffer);
 };
 
 } // namespace hise
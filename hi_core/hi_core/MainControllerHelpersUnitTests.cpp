@@ -0,0 +1,770 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "AppConfig.h"
+
+#if HI_RUN_UNIT_TESTS
+
+#include  "JuceHeader.h"
+
+using namespace hise;
+
+class ControllerStateBufferUnitTest : public UnitTest
+{
+public:
+
+	ControllerStateBufferUnitTest() :
+		UnitTest("Testing controller state buffer")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testControllerStateBuffer();
+		testMissedValues();
+		testPolyAftertouch();
+	}
+
+private:
+
+	static void addController(HiseEventBuffer& b, int number, int value, int timestamp, int channel=1)
+	{
+		HiseEvent e(HiseEvent::Type::Controller, (uint8)number, (uint8)value, (uint8)channel);
+		e.setTimeStamp(timestamp);
+		b.addEvent(e);
+	}
+
+	void testControllerStateBuffer()
+	{
+		beginTest("Testing ControllerStateBuffer");
+
+		using Breakpoint = ControllerStateBuffer::Breakpoint;
+
+		ControllerStateBuffer state;
+
+		HiseEventBuffer events;
+
+		addController(events, 1, 127, 64);
+		addController(events, 7, 64, 0);
+		addController(events, 1, 0, 256, 2);
+
+		HiseEvent pitch(HiseEvent::Type::PitchBend, 0, 0, 1);
+		pitch.setPitchWheelValue(16383);
+		pitch.setTimeStamp(128);
+		events.addEvent(pitch);
+
+		HiseEvent ignored(HiseEvent::Type::Controller, 1, 50, 1);
+		ignored.setTimeStamp(300);
+		ignored.ignoreEvent(true);
+		events.addEvent(ignored);
+
+		state.processEvents(events, 512);
+
+		expectEquals<int>(state.getNumBreakpoints(), 4, "Ignored events are skipped");
+
+		auto b = state.getFirstBreakpoint(1);
+		expect(b != nullptr && b->timestamp == 64 && b->value == 1.0f, "First breakpoint of CC1");
+
+		b = state.getNextBreakpoint(*b);
+		expect(b != nullptr && b->timestamp == 256 && b->value == 0.0f && b->channel == 2, "Second breakpoint of CC1");
+		expect(state.getNextBreakpoint(*b) == nullptr, "End of the list");
+
+		b = state.getFirstBreakpoint(ControllerStateBuffer::PitchWheelNumber);
+		expect(b != nullptr && b->timestamp == 128 && b->value == 1.0f, "Pitch wheel");
+
+		expectEquals<float>(state.getLastValue(7), 64.0f / 127.0f, "Last value of CC7");
+		expectEquals<float>(state.getLastValue(2), -1.0f, "No value without message");
+
+		// The reader uses a downsampling factor of 8, so the breakpoints are at 8 and 32
+		ControllerStateBuffer::Reader reader(8);
+
+		expectEquals<int>(reader.getUnreadStart(0, 16), 0, "Nothing is read before connecting");
+
+		reader.setState(&state);
+
+		Array<int> positions;
+		auto collect = [&](int position, const Breakpoint&) { positions.add(position); };
+
+		reader.read(1, 0, 16, collect);
+		expect(positions.size() == 1 && positions[0] == 8, "Breakpoint in the first range");
+
+		expectEquals<int>(reader.getUnreadStart(0, 16), 16, "The range was read");
+		reader.read(1, 0, 16, collect);
+		expectEquals<int>(positions.size(), 1, "Don't read a breakpoint twice");
+
+		expectEquals<int>(reader.getUnreadStart(8, 32), 16, "A part of the range is unread");
+		reader.read(1, 8, 56, collect);
+		expect(positions.size() == 2 && positions[1] == 32, "Breakpoint in the second range");
+
+		// The next block clears the breakpoints of the last block
+		events.clear();
+		addController(events, 7, 127, 600);
+		state.processEvents(events, 512);
+
+		expect(state.getFirstBreakpoint(1) == nullptr, "CC1 didn't change");
+		expectEquals<float>(state.getLastValue(1), 0.0f, "Keep the last value");
+
+		b = state.getFirstBreakpoint(7);
+		expect(b != nullptr && b->timestamp == 511, "Clamp the timestamp to the block");
+
+		positions.clear();
+		reader.read(7, 0, 64, collect);
+		expect(positions.size() == 1 && positions[0] == 63, "The new block can be read again");
+
+		beginTest("Testing ControllerStateBuffer::ExponentialRamp");
+
+		const double sampleRate = 44100.0 / (double)HISE_CONTROL_RATE_DOWNSAMPLING_FACTOR;
+
+		Smoother smoother;
+		smoother.prepareToPlay(sampleRate);
+		smoother.setSmoothingTime(200.0f);
+		smoother.setDefaultValue(0.0f);
+
+		ControllerStateBuffer::ExponentialRamp ramp;
+		ramp.prepare(sampleRate);
+		ramp.setSmoothingTime(200.0f);
+		ramp.setValue(0.0f);
+		ramp.setTargetValue(1.0f);
+
+		HeapBlock<float> data;
+		data.calloc(4096);
+
+		// Render with odd sizes to test the scalar remainder
+		for (int i = 0; i < 4096; i += 37)
+			ramp.render(data + i, jmin<int>(37, 4096 - i));
+
+		float maxError = 0.0f;
+		int numSmoothed = 0;
+
+		for (int i = 0; i < 4096; i++)
+		{
+			const float expected = smoother.smooth(1.0f);
+
+			if (std::abs(1.0f - expected) > ControllerStateBuffer::ExponentialRamp::Threshold)
+			{
+				maxError = jmax<float>(maxError, std::abs(expected - data[i]));
+				numSmoothed++;
+			}
+		}
+
+		expect(numSmoothed > 100, "The smoothing takes some time");
+		expectLessThan<float>(maxError, 0.0001f, "Same curve as the Smoother");
+		expectEquals<float>(data[4095], 1.0f, "Reach the target");
+		expectEquals<float>(ramp.getCurrentValue(), 1.0f, "Current value");
+
+		ramp.setSmoothingTime(0.0f);
+		ramp.setTargetValue(0.25f);
+		ramp.render(data, 16);
+
+		expect(data[0] == 0.25f && data[15] == 0.25f, "No smoothing");
+	}
+
+	void testMissedValues()
+	{
+		beginTest("Testing missed controller values");
+
+		ControllerStateBuffer state;
+		ControllerStateBuffer::Reader reader(1);
+		HiseEventBuffer events;
+
+		addController(events, 1, 127, 0);
+		state.processEvents(events, 512);
+
+		reader.setState(&state);
+
+		auto ignore = [](int, const ControllerStateBuffer::Breakpoint&) {};
+
+		expectEquals<float>(reader.getMissedValue(1), -1.0f, "A change in the current block isn't missed");
+		reader.read(1, 0, 512, ignore);
+
+		// The reader skips the next two blocks
+		events.clear();
+		addController(events, 1, 0, 20);
+		state.processEvents(events, 512);
+
+		events.clear();
+		state.processEvents(events, 512);
+
+		events.clear();
+		addController(events, 1, 64, 100);
+		state.processEvents(events, 512);
+
+		expectEquals<float>(state.getValueAtBlockStart(1), 0.0f, "Value before the first breakpoint");
+		expectEquals<float>(reader.getMissedValue(1), 0.0f, "The change in the skipped block is reported");
+		expectEquals<float>(reader.getMissedValue(1), -1.0f, "Only report the missed value once");
+		expectEquals<float>(reader.getMissedValue(7), -1.0f, "Other controllers didn't change");
+
+		reader.read(1, 0, 512, ignore);
+
+		events.clear();
+		state.processEvents(events, 512);
+
+		expectEquals<float>(reader.getMissedValue(1), -1.0f, "Nothing was missed");
+
+		// A new reader catches up with the last value
+		ControllerStateBuffer::Reader newReader(1);
+		newReader.setState(&state);
+
+		expectEquals<float>(newReader.getMissedValue(1), 64.0f / 127.0f, "A new reader gets the last value");
+	}
+
+	void testPolyAftertouch()
+	{
+		beginTest("Testing polyphonic aftertouch");
+
+		ControllerStateBuffer state;
+		HiseEventBuffer events;
+
+		auto addAftertouch = [&](int noteNumber, int value, int timestamp)
+		{
+			HiseEvent e(HiseEvent::Type::Aftertouch, (uint8)noteNumber, (uint8)value, 1);
+			e.setTimeStamp(timestamp);
+			events.addEvent(e);
+		};
+
+		addAftertouch(60, 100, 0);
+		addAftertouch(64, 50, 10);
+
+		state.processEvents(events, 512);
+
+		auto b = state.getFirstBreakpoint(ControllerStateBuffer::AftertouchNumber);
+		expect(b != nullptr && b->value == 100.0f / 127.0f, "First aftertouch");
+
+		b = state.getNextBreakpoint(*b);
+		expect(b != nullptr && b->timestamp == 10 && b->value == 100.0f / 127.0f, "Use the highest pressure");
+
+		events.clear();
+
+		HiseEvent noteOff(HiseEvent::Type::NoteOff, 60, 0, 1);
+		events.addEvent(noteOff);
+		addAftertouch(64, 30, 20);
+
+		state.processEvents(events, 512);
+
+		expectEquals<float>(state.getLastValue(ControllerStateBuffer::AftertouchNumber), 30.0f / 127.0f, "Released notes are ignored");
+	}
+};
+
+static ControllerStateBufferUnitTest controllerStateBufferTestInstance;
+
+class SidechainBusUnitTest : public UnitTest
+{
+public:
+
+	SidechainBusUnitTest() :
+		UnitTest("Testing sidechain bus")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testChannels();
+	}
+
+private:
+
+	void testChannels()
+	{
+		beginTest("Testing SidechainBus");
+
+		using Mode = SidechainBus::EnvelopeDetector::Mode;
+
+		SidechainBus bus;
+
+		// The subscriber can resolve the channel before the publisher exists
+		auto subscriber = bus.getChannel("Collector");
+
+		bus.prepare(44100.0, 512);
+
+		auto publisher = bus.getChannel("Collector");
+
+		expect(subscriber == publisher, "Same channel for the same name");
+		expect(bus.getChannel("Other") != publisher, "Different channel for another name");
+
+		publisher->setDetector(Mode::Peak, 0.01, 0.01);
+
+		AudioSampleBuffer b(2, 512);
+		b.clear();
+		FloatVectorOperations::fill(b.getWritePointer(0), 0.5f, 512);
+		FloatVectorOperations::fill(b.getWritePointer(1), -0.75f, 512);
+
+		bus.advance();
+		publisher->write(b, 0, 512);
+
+		expectEquals<float>(subscriber->getEnvelopeValue(100), 0.0f, "The signal is not readable in the same block");
+
+		bus.advance();
+
+		expectWithinAbsoluteError<float>(subscriber->getEnvelopeValue(100), 0.75f, 0.001f, "Peak of both channels");
+		expectWithinAbsoluteError<float>(subscriber->getCurrentValue(), 0.75f, 0.001f, "Current value");
+
+		float data[512];
+		subscriber->readAudio(1, data, 0, 512);
+		expectEquals<float>(data[511], -0.75f, "Audio signal");
+
+		// A shorter block holds the last envelope value and clears the audio
+		publisher->write(b, 0, 128);
+		bus.advance();
+
+		subscriber->readEnvelope(data, 0, 512);
+		expectWithinAbsoluteError<float>(data[400], 0.75f, 0.001f, "Hold the last envelope value");
+
+		subscriber->readAudio(0, data, 0, 512);
+		expectEquals<float>(data[400], 0.0f, "Clear the audio after the last written sample");
+
+		// No write means silence
+		bus.advance();
+		expectEquals<float>(subscriber->getCurrentValue(), 0.0f, "Silence without publisher");
+
+		// The RMS and loudness of a full scale sine at 1kHz
+		auto measure = [&](Mode m)
+		{
+			publisher->setDetector(m, 200.0, 200.0);
+
+			float value = 0.0f;
+
+			for (int block = 0; block < 200; block++)
+			{
+				for (int i = 0; i < 512; i++)
+				{
+					const float v = std::sin(2.0f * float_Pi * 1000.0f * (float)(block * 512 + i) / 44100.0f);
+					b.setSample(0, i, v);
+					b.setSample(1, i, v);
+				}
+
+				publisher->write(b, 0, 512);
+				bus.advance();
+				value = subscriber->getCurrentValue();
+			}
+
+			return Decibels::gainToDecibels(value);
+		};
+
+		expectWithinAbsoluteError<float>(measure(Mode::RMS), -3.01f, 0.1f, "RMS of a sine");
+
+		// 1kHz is boosted by 0.69dB, then the two channels are summed and the offset is subtracted
+		expectWithinAbsoluteError<float>(measure(Mode::LUFS), 0.0f, 0.1f, "Loudness of a stereo sine");
+	}
+};
+
+static SidechainBusUnitTest sidechainBusTestInstance;
+
+class EventInboxUnitTest : public UnitTest
+{
+public:
+
+	EventInboxUnitTest() :
+		UnitTest("Testing event inbox")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testEventInbox();
+	}
+
+private:
+
+	void testEventInbox()
+	{
+		beginTest("Testing EventInbox");
+
+		EventInbox inbox;
+		HiseEventBuffer b;
+
+		HiseEvent on(HiseEvent::Type::NoteOn, 64, 100, 1);
+		HiseEvent off(HiseEvent::Type::NoteOff, 64, 0, 1);
+		HiseEvent cc(HiseEvent::Type::Controller, 1, 64, 1);
+
+		expect(inbox.push(off, 600), "Push note off");
+		expect(inbox.push(on, 100), "Push note on");
+		expect(inbox.push(cc), "Push controller");
+
+		inbox.processBlock(b, 512);
+
+		expectEquals<int>(b.getNumUsed(), 2, "Events in first block");
+		expect(b.getEvent(0).isController(), "Controller is first");
+		expectEquals<int>(b.getEvent(0).getTimeStamp(), 0, "Controller timestamp");
+		expect(b.getEvent(1).isNoteOn(), "Note on is second");
+		expectEquals<int>(b.getEvent(1).getTimeStamp(), 100, "Note on timestamp");
+
+		b.clear();
+		inbox.processBlock(b, 512);
+
+		expectEquals<int>(b.getNumUsed(), 1, "Events in second block");
+		expect(b.getEvent(0).isNoteOff(), "Note off in second block");
+		expectEquals<int>(b.getEvent(0).getTimeStamp(), 88, "Note off timestamp");
+		expect(inbox.getCurrentSamplePosition() == 1024, "Sample position");
+
+		b.clear();
+		inbox.push(on, 1024 + 32);
+		inbox.push(off, 1024 + 32);
+		inbox.processBlock(b, 512);
+
+		expectEquals<int>(b.getNumUsed(), 2, "Events with same position");
+		expect(b.getEvent(0).isNoteOn() && b.getEvent(1).isNoteOff(), "Push order is kept");
+
+		// A reserved ID is kept by the ID handler, the following note ons get new IDs
+		HiseEventBuffer master;
+		EventIdHandler handler(master);
+
+		const uint16 reservedId = handler.reserveEventId();
+
+		HiseEvent reserved(HiseEvent::Type::NoteOn, 60, 100, 1);
+		reserved.setEventId(reservedId);
+
+		master.addEvent(reserved);
+		master.addEvent(HiseEvent(HiseEvent::Type::NoteOn, 61, 100, 1));
+		master.addEvent(HiseEvent(HiseEvent::Type::NoteOff, 60, 0, 1));
+
+		handler.handleEventIds();
+
+		expectEquals<int>(master.getEvent(0).getEventId(), reservedId, "Reserved ID is kept");
+		expect(master.getEvent(1).getEventId() != reservedId, "Next note on gets a new ID");
+		expectEquals<int>(master.getEvent(2).getEventId(), reservedId, "Note off gets the reserved ID");
+	}
+};
+
+static EventInboxUnitTest eventInboxTestInstance;
+
+class RasterBlockSplitterUnitTest : public UnitTest
+{
+public:
+
+	RasterBlockSplitterUnitTest() :
+		UnitTest("Testing raster block splitter")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testRasterBlockSplitter(RasterBlockSplitter::Mode::RenderAhead, false);
+		testRasterBlockSplitter(RasterBlockSplitter::Mode::RenderAhead, true);
+		testRasterBlockSplitter(RasterBlockSplitter::Mode::DelayedInput, true);
+		testRasterBlockSplitter(RasterBlockSplitter::Mode::Passthrough, true);
+	}
+
+private:
+
+	/** Renders a signal that only depends on the sample position, so the output must not depend on the block size. */
+	struct PositionRenderer : public RasterBlockSplitter::Renderer
+	{
+		PositionRenderer(bool addToInput_) :
+			addToInput(addToInput_)
+		{};
+
+		static float getSignal(int64 position, int channel)
+		{
+			return (float)((position * 7 + channel * 13) % 101) / 101.0f - 0.5f;
+		}
+
+		void renderBlock(AudioSampleBuffer& buffer, MidiBuffer& midiMessages, int /*offsetInHostBuffer*/) override
+		{
+			const int numSamples = buffer.getNumSamples();
+
+			allBlocksAligned &= (numSamples % HISE_EVENT_RASTER) == 0;
+			maxBlockSize = jmax<int>(maxBlockSize, numSamples);
+
+			for (int c = 0; c < buffer.getNumChannels(); c++)
+			{
+				auto d = buffer.getWritePointer(c);
+
+				for (int i = 0; i < numSamples; i++)
+					d[i] = (addToInput ? d[i] : 0.0f) + getSignal(position + i, c);
+			}
+
+			MidiBuffer::Iterator it(midiMessages);
+			MidiMessage m;
+			int samplePos;
+
+			while (it.getNextEvent(m, samplePos))
+			{
+				eventPositions.add(position + samplePos);
+				eventNumbers.add(m.getNoteNumber());
+			}
+
+			midiMessages.clear();
+			position += numSamples;
+		}
+
+		bool addsToInput() const override { return addToInput; }
+
+		const bool addToInput;
+
+		int64 position = 0;
+		bool allBlocksAligned = true;
+		int maxBlockSize = 0;
+
+		Array<int64> eventPositions;
+		Array<int> eventNumbers;
+	};
+
+	void testRasterBlockSplitter(RasterBlockSplitter::Mode mode, bool addToInput)
+	{
+		beginTest("Testing RasterBlockSplitter with mode " + String((int)mode) + (addToInput ? " (adding to the input)" : ""));
+
+		const int numChannels = 2;
+		const int maxBlockSize = 512;
+		const int numTotal = 16384;
+
+		RasterBlockSplitter splitter;
+		splitter.prepare(mode, numChannels, maxBlockSize, maxBlockSize);
+
+		const int latency = splitter.getLatency();
+
+		AudioSampleBuffer input(numChannels, numTotal + maxBlockSize);
+		input.clear();
+
+		for (int c = 0; c < numChannels; c++)
+			for (int i = 0; i < numTotal; i++)
+				input.setSample(c, i, PositionRenderer::getSignal(3 * i + 5, c + 2));
+
+		PositionRenderer reference(addToInput);
+		AudioSampleBuffer expected(input);
+		MidiBuffer empty;
+
+		for (int i = 0; i < numTotal; i += 256)
+		{
+			AudioSampleBuffer b(expected.getArrayOfWritePointers(), numChannels, i, 256);
+			reference.renderBlock(b, empty, 0);
+		}
+
+		PositionRenderer r(addToInput);
+		AudioSampleBuffer output(input);
+		MidiBuffer m;
+		Random rng(2019);
+		Array<int64> sentPositions;
+
+		int pos = 0;
+		int blockIndex = 0;
+
+		while (pos < numTotal + maxBlockSize)
+		{
+			int numThisTime;
+
+			if (pos >= numTotal)
+				numThisTime = maxBlockSize; // flush the remaining samples and events
+			else if (++blockIndex % 10 == 0)
+				numThisTime = jmin<int>(maxBlockSize + 100, numTotal - pos); // exceed the prepared block size
+			else
+				numThisTime = jmin<int>(rng.nextInt(maxBlockSize + 1), numTotal - pos);
+
+			m.clear();
+
+			if (numThisTime > 0 && pos < numTotal && rng.nextBool())
+			{
+				const int offset = rng.nextInt(numThisTime);
+				m.addEvent(MidiMessage::noteOn(1, sentPositions.size() % 128, (uint8)100), offset);
+				sentPositions.add(pos + offset);
+			}
+
+			AudioSampleBuffer b(output.getArrayOfWritePointers(), numChannels, pos, numThisTime);
+			splitter.process(b, m, r);
+
+			pos += numThisTime;
+		}
+
+		if (mode != RasterBlockSplitter::Mode::Passthrough)
+			expect(r.allBlocksAligned, "Sub blocks are aligned to the raster");
+
+		expect(r.maxBlockSize <= maxBlockSize, "Sub blocks don't exceed the maximum block size");
+
+		int numErrors = 0;
+
+		for (int c = 0; c < numChannels; c++)
+		{
+			for (int i = 0; i < numTotal; i++)
+			{
+				const float expectedValue = i < latency ? 0.0f : expected.getSample(c, i - latency);
+
+				if (output.getSample(c, i) != expectedValue)
+					numErrors++;
+			}
+		}
+
+		expectEquals<int>(numErrors, 0, "Output matches the rendering with a fixed block size");
+		expectEquals<int>(r.eventPositions.size(), sentPositions.size(), "All events are delivered");
+
+		bool eventsMatch = r.eventPositions.size() == sentPositions.size();
+
+		for (int i = 0; eventsMatch && i < sentPositions.size(); i++)
+		{
+			const int64 delta = r.eventPositions[i] - sentPositions[i];
+
+			// Events that fall into a rendered ahead block are delayed to the next sub block
+			const int64 maxDelta = mode == RasterBlockSplitter::Mode::RenderAhead ? HISE_EVENT_RASTER - 1 : 0;
+
+			eventsMatch &= r.eventNumbers[i] == i % 128;
+			eventsMatch &= delta >= 0 && delta <= maxDelta;
+		}
+
+		expect(eventsMatch, "Events keep their order and position");
+	}
+};
+
+static RasterBlockSplitterUnitTest rasterBlockSplitterTestInstance;
+
+class MidiControllerAutomationHandlerUnitTest : public UnitTest
+{
+public:
+
+	MidiControllerAutomationHandlerUnitTest() :
+		UnitTest("Testing MIDI controller automation")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testControllerDecoder();
+		testLearning();
+	}
+
+private:
+
+	void testControllerDecoder()
+	{
+		beginTest("Testing 14-bit and NRPN controller decoding");
+
+		using Type = MidiControllerAutomationHandler::ControllerType;
+
+		MidiControllerAutomationHandler::ControllerDecoder decoder;
+		MidiControllerAutomationHandler::ControllerValue values[MidiControllerAutomationHandler::ControllerDecoder::MaxNumValues];
+
+		auto decode = [&](int channel, int number, int value)
+		{
+			return decoder.decode(MidiMessage::controllerEvent(channel, number, value), values);
+		};
+
+		expectEquals(decode(1, 74, 64), 1, "A normal controller only creates a 7-bit value");
+		expect(values[0].type == Type::CC && values[0].number == 74);
+		expectWithinAbsoluteError(values[0].normalisedValue, 64.0 / 127.0, 1e-9);
+
+		expectEquals(decode(1, 1, 100), 2, "The MSB creates a 7-bit and a 14-bit value");
+		expect(values[1].type == Type::CC14 && values[1].number == 1);
+		expectWithinAbsoluteError(values[1].normalisedValue, (100.0 * 128.0) / 16383.0, 1e-9);
+
+		expectEquals(decode(1, 33, 127), 2, "The LSB updates the 14-bit value");
+		expect(values[1].type == Type::CC14 && values[1].number == 1);
+		expectWithinAbsoluteError(values[1].normalisedValue, (100.0 * 128.0 + 127.0) / 16383.0, 1e-9);
+
+		decode(2, 1, 5);
+		decode(1, 33, 0);
+		expectWithinAbsoluteError(values[1].normalisedValue, (100.0 * 128.0) / 16383.0, 1e-9, "The MSB is stored per channel");
+
+		expectEquals(decode(3, 99, 8), 1, "Selecting the NRPN doesn't create a value");
+		decode(3, 98, 1);
+		expectEquals(decode(3, 6, 127), 2);
+		expect(values[1].type == Type::NRPN && values[1].number == 8 * 128 + 1, "Data entry MSB");
+		decode(3, 38, 127);
+		expect(values[1].type == Type::NRPN && values[1].normalisedValue == 1.0, "Data entry LSB");
+
+		decode(3, 101, 0);
+		decode(3, 100, 0);
+		decode(3, 6, 2);
+		expect(values[1].type == Type::RPN && values[1].number == 0, "Pitch bend range RPN");
+
+		decode(3, 101, 127);
+		decode(3, 100, 127);
+		decode(3, 6, 64);
+		expect(values[1].type == Type::CC14 && values[1].number == 6, "The RPN null function deselects the parameter");
+
+		decoder.reset();
+		decode(3, 38, 1);
+		expect(values[1].type == Type::CC14 && values[1].number == 6, "Reset clears the selected parameter");
+	}
+
+	void testLearning()
+	{
+		beginTest("Testing controller learning");
+
+		ScopedPointer<BackendProcessor> bp = new BackendProcessor(nullptr, nullptr);
+
+		auto handler = bp->getMacroManager().getMidiControlAutomationHandler();
+		auto chain = bp->getMainSynthChain();
+
+		auto sendControllers = [&](std::initializer_list<std::pair<int, int>> controllers)
+		{
+			MidiBuffer b;
+			int pos = 0;
+
+			for (const auto& c : controllers)
+				b.addEvent(MidiMessage::controllerEvent(1, c.first, c.second), pos++);
+
+			handler->handleParameterData(b, 512);
+
+			// Let the smoothing finish
+			for (int i = 0; i < 64; i++)
+			{
+				MidiBuffer empty;
+				handler->handleParameterData(empty, 512);
+			}
+		};
+
+		// A 7-bit controller in the LSB range must not be learned as 14-bit pair
+		handler->addMidiControlledParameter(chain, ModulatorSynth::Gain, NormalisableRange<double>(0.0, 1.0), -1);
+		sendControllers({ { 40, 64 } });
+		handler->commitLearnedController(dontSendNotification);
+
+		expectEquals(handler->getMidiControllerName(chain, ModulatorSynth::Gain), String("CC 40"), "7-bit controller above 32");
+
+		sendControllers({ { 40, 127 } });
+		expectWithinAbsoluteError<float>(chain->getAttribute(ModulatorSynth::Gain), 1.0f, 0.001f, "Full range of the 7-bit controller");
+
+		handler->removeMidiControlledParameter(chain, ModulatorSynth::Gain, dontSendNotification);
+
+		// The MSB followed by the LSB is learned as 14-bit pair
+		handler->addMidiControlledParameter(chain, ModulatorSynth::Gain, NormalisableRange<double>(0.0, 1.0), -1);
+		sendControllers({ { 8, 0 }, { 40, 0 } });
+		handler->commitLearnedController(dontSendNotification);
+
+		expectEquals(handler->getMidiControllerName(chain, ModulatorSynth::Gain), String("CC 8/40"), "14-bit pair");
+
+		sendControllers({ { 8, 127 }, { 40, 127 } });
+		expectWithinAbsoluteError<float>(chain->getAttribute(ModulatorSynth::Gain), 1.0f, 0.001f, "Maximum of the 14-bit pair");
+
+		sendControllers({ { 8, 64 }, { 40, 0 } });
+		expectWithinAbsoluteError<float>(chain->getAttribute(ModulatorSynth::Gain), 8192.0f / 16383.0f, 0.001f, "14-bit resolution");
+
+		sendControllers({ { 40, 127 } });
+		expectWithinAbsoluteError<float>(chain->getAttribute(ModulatorSynth::Gain), 8319.0f / 16383.0f, 0.001f, "The LSB changes the pair value");
+	}
+};
+
+static MidiControllerAutomationHandlerUnitTest midiControllerAutomationTestInstance;
+
+#endif
@@ -38,7 +38,7 @@ MainController::MacroManager::MacroManager(MainController *mc_) :
 	mc(mc_),
 	midiControllerHandler(mc_)
 {
-	for (int i = 0; i < 8; i++)
+	for (int i = 0; i < MaxNumMacros; i++)
 	{
 		macroControllerNumbers[i] = -1;
 	};
@@ -51,7 +51,7 @@ void MainController::MacroManager::removeMacroControlsFor(Processor *p)
 
 	if (macroChain == nullptr) return;
 
-	for (int i = 0; i < 8; i++)
+	for (int i = 0; i < macroChain->getNumMacroControls(); i++)
 	{
 		macroChain->getMacroControlData(i)->removeAllParametersWithProcessor(p);
 	}
@@ -65,7 +65,7 @@ void MainController::MacroManager::removeMacroControlsFor(Processor *p, Identifi
 
 	if (macroChain == nullptr) return;
 
-	for (int i = 0; i < 8; i++)
+	for (int i = 0; i < macroChain->getNumMacroControls(); i++)
 	{
 		MacroControlBroadcaster::MacroControlData *data = macroChain->getMacroControlData(i);
 
@@ -95,7 +95,7 @@ const MidiControllerAutomationHandler * MainController::MacroManager::getMidiCon
 
 void MainController::MacroManager::setMidiControllerForMacro(int midiControllerNumber)
 {
-	if (macroIndexForCurrentMidiLearnMode >= 0 && macroIndexForCurrentMidiLearnMode < 8)
+	if (isPositiveAndBelow(macroIndexForCurrentMidiLearnMode, (int)MaxNumMacros))
 	{
 		macroControllerNumbers[macroIndexForCurrentMidiLearnMode] = midiControllerNumber;
 
@@ -107,7 +107,7 @@ void MainController::MacroManager::setMidiControllerForMacro(int midiControllerN
 
 void MainController::MacroManager::setMidiControllerForMacro(int macroIndex, int midiControllerNumber)
 {
-	if (macroIndex < 8)
+	if (isPositiveAndBelow(macroIndex, (int)MaxNumMacros))
 	{
 		macroControllerNumbers[macroIndex] = midiControllerNumber;
 	}
@@ -115,7 +115,7 @@ void MainController::MacroManager::setMidiControllerForMacro(int macroIndex, int
 
 bool MainController::MacroManager::midiMacroControlActive() const
 {
-	for (int i = 0; i < 8; i++)
+	for (int i = 0; i < MaxNumMacros; i++)
 	{
 		if (macroControllerNumbers[i] != -1) return true;
 	}
@@ -131,7 +131,7 @@ void MainController::MacroManager::setMacroControlMidiLearnMode(ModulatorSynthCh
 
 int MainController::MacroManager::getMacroControlForMidiController(int midiController)
 {
-	for (int i = 0; i < 8; i++)
+	for (int i = 0; i < MaxNumMacros; i++)
 	{
 		if (macroControllerNumbers[i] == midiController) return i;
 	}
@@ -141,7 +141,7 @@ int MainController::MacroManager::getMacroControlForMidiController(int midiContr
 
 int MainController::MacroManager::getMidiControllerForMacro(int macroIndex)
 {
-	if (macroIndex < 8)
+	if (isPositiveAndBelow(macroIndex, (int)MaxNumMacros))
 	{
 		return macroControllerNumbers[macroIndex];
 	}
@@ -153,7 +153,7 @@ int MainController::MacroManager::getMidiControllerForMacro(int macroIndex)
 
 bool MainController::MacroManager::midiControlActiveForMacro(int macroIndex) const
 {
-	if (macroIndex < 8)
+	if (isPositiveAndBelow(macroIndex, (int)MaxNumMacros))
 	{
 		return macroControllerNumbers[macroIndex] != -1;
 	}
@@ -166,7 +166,7 @@ bool MainController::MacroManager::midiControlActiveForMacro(int macroIndex) con
 
 void MainController::MacroManager::removeMidiController(int macroIndex)
 {
-	if (macroIndex < 8)
+	if (isPositiveAndBelow(macroIndex, (int)MaxNumMacros))
 	{
 		macroControllerNumbers[macroIndex] = -1;
 	}
@@ -0,0 +1,153 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "AppConfig.h"
+
+#if HI_RUN_UNIT_TESTS
+
+#include  "JuceHeader.h"
+
+using namespace hise;
+
+class TransportStepClockUnitTest : public UnitTest
+{
+public:
+
+	TransportStepClockUnitTest() :
+		UnitTest("Testing transport step clock")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testTransportStepClock(20.0, 0.25, 0.0, true);
+		testTransportStepClock(999.0, 0.25, 0.0, true);
+		testTransportStepClock(999.0, 0.125 / 3.0, 0.5, true);
+		testTransportStepClock(20.0, 0.25, 0.3, false);
+		testTransportStepClock(999.0, 0.125 / 3.0, 0.0, false);
+	}
+
+private:
+
+	void testTransportStepClock(double bpm, double stepLength, double shuffle, bool hostIsPlaying)
+	{
+		beginTest("Testing TransportStepClock with " + String(bpm) + " BPM" + (hostIsPlaying ? " (host transport)" : " (free running)"));
+
+		const double sampleRate = 44100.0;
+		const double samplesPerQuarter = sampleRate * 60.0 / bpm;
+		const int64 numTotal = (int64)sampleRate * 60;
+		const int64 startSample = 12345;
+		const double hostOffset = 3.7;
+
+		TransportStepClock clock;
+		clock.prepare(sampleRate);
+		clock.setStepLength(stepLength);
+		clock.setShuffle(shuffle);
+
+		Random rng(2020);
+		Array<int64> positions;
+		int timestamps[64];
+		int64 pos = 0;
+
+		while (pos < numTotal)
+		{
+			const int numThisTime = (int)jmin<int64>(1 + rng.nextInt(2048), numTotal - pos);
+
+			clock.advance(hostIsPlaying, hostOffset + (double)pos / samplesPerQuarter, bpm, numThisTime);
+
+			if (startSample >= pos && startSample < pos + numThisTime)
+				clock.start((int)(startSample - pos));
+
+			const int numSteps = clock.getNextSteps(timestamps, 64);
+
+			for (int i = 0; i < numSteps; i++)
+				positions.add(pos + timestamps[i]);
+
+			pos += numThisTime;
+		}
+
+		// The reference calculates every step from the start of the timeline
+		auto getStepPosition = [&](int64 index)
+		{
+			return (double)index * stepLength + ((index % 2) != 0 ? shuffle * 0.5 * stepLength : 0.0);
+		};
+
+		Array<int64> expected;
+
+		if (hostIsPlaying)
+		{
+			const double startPosition = hostOffset + (double)startSample / samplesPerQuarter;
+
+			int64 firstStep = 0;
+
+			while (std::abs(getStepPosition(firstStep + 1) - startPosition) < std::abs(getStepPosition(firstStep) - startPosition))
+				firstStep++;
+
+			for (int64 i = firstStep + 1;; i++)
+			{
+				const int64 samplePos = (int64)std::ceil((getStepPosition(i) - hostOffset) * samplesPerQuarter - 0.001);
+
+				if (samplePos >= numTotal)
+					break;
+
+				expected.add(samplePos);
+			}
+		}
+		else
+		{
+			for (int64 i = 1;; i++)
+			{
+				const int64 samplePos = startSample + (int64)std::ceil(getStepPosition(i) * samplesPerQuarter - 0.001);
+
+				if (samplePos >= numTotal)
+					break;
+
+				expected.add(samplePos);
+			}
+		}
+
+		expectEquals<int>(positions.size(), expected.size(), "Step amount");
+
+		int numErrors = 0;
+
+		for (int i = 0; i < jmin<int>(positions.size(), expected.size()); i++)
+			numErrors += positions[i] != expected[i] ? 1 : 0;
+
+		expectEquals<int>(numErrors, 0, "Steps match the offline calculation");
+	}
+};
+
+static TransportStepClockUnitTest transportStepClockTestInstance;
+
+#endif
@@ -452,6 +452,110 @@ String BalanceCalculator::getBalanceAsString(int balanceValue)
 	else return String(abs(balanceValue)) + (balanceValue > 0 ? " R" : " L");
 }
 
+void TransportStepClock::prepare(double newSampleRate)
+{
+	if (newSampleRate > 0.0)
+		sampleRate = newSampleRate;
+}
+
+void TransportStepClock::setStepLength(double newLengthInQuarters)
+{
+	stepLength = jmax<double>(0.001, newLengthInQuarters);
+}
+
+void TransportStepClock::setShuffle(double newShuffleAmount)
+{
+	shuffleAmount = jlimit<double>(0.0, 1.0, newShuffleAmount);
+}
+
+void TransportStepClock::advance(bool hostIsPlaying, double ppqPosition, double bpm, int numSamples)
+{
+	const double expectedPosition = blockPosition + (double)blockSize * quartersPerSample;
+
+	quartersPerSample = (bpm > 0.0 ? bpm : 120.0) / (60.0 * sampleRate);
+	blockSize = numSamples;
+	followsHost = hostIsPlaying;
+
+	if (hostIsPlaying)
+	{
+		// Tempo changes within the last block cause a small deviation, but anything
+		// bigger than half a step is a jump of the host transport
+		if (running && std::abs(ppqPosition - expectedPosition) > 0.5 * stepLength)
+			lastStepIndex = getFirstStepAfter(ppqPosition) - 1;
+
+		blockPosition = ppqPosition;
+	}
+	else
+	{
+		blockPosition = expectedPosition;
+	}
+}
+
+void TransportStepClock::start(int offsetInBlock)
+{
+	const double position = blockPosition + (double)offsetInBlock * quartersPerSample;
+
+	if (followsHost)
+	{
+		auto nextStep = getFirstStepAfter(position);
+
+		if (position - getStepPosition(nextStep - 1) < getStepPosition(nextStep) - position)
+			nextStep--;
+
+		lastStepIndex = nextStep;
+	}
+	else
+	{
+		blockPosition = -(double)offsetInBlock * quartersPerSample;
+		lastStepIndex = 0;
+	}
+
+	running = true;
+}
+
+int TransportStepClock::getNextSteps(int* timestamps, int maxNumSteps)
+{
+	if (!running || quartersPerSample == 0.0)
+		return 0;
+
+	// Allows rounding errors of the ppq position without moving the step to the next sample
+	static constexpr double tolerance = 0.001;
+
+	int numSteps = 0;
+
+	while (numSteps < maxNumSteps)
+	{
+		const double delta = (getStepPosition(lastStepIndex + 1) - blockPosition) / quartersPerSample;
+		const int timestamp = (int)std::ceil(delta - tolerance);
+
+		if (timestamp >= blockSize)
+			break;
+
+		timestamps[numSteps++] = jmax<int>(0, timestamp);
+		lastStepIndex++;
+	}
+
+	return numSteps;
+}
+
+double TransportStepClock::getStepPosition(int64 stepIndex) const noexcept
+{
+	const bool isOdd = (stepIndex % 2) != 0;
+
+	return (double)stepIndex * stepLength + (isOdd ? shuffleAmount * 0.5 * stepLength : 0.0);
+}
+
+int64 TransportStepClock::getFirstStepAfter(double ppqPosition) const noexcept
+{
+	// The shuffle is less than a step, so the search starts one step before the unshuffled grid
+	auto stepIndex = (int64)std::floor(ppqPosition / stepLength) - 1;
+
+	while (getStepPosition(stepIndex) < ppqPosition)
+		stepIndex++;
+
+	return stepIndex;
+}
+
 SafeFunctionCall::SafeFunctionCall(Processor* p_, const Function& f_) noexcept:
 	p(p_),
 	f(f_)
@@ -637,19 +637,96 @@ public:
 		tempoNames.add("1/64T");	tempoFactors[SixtyForthTriplet] = 0.125f / 3.0f;
 	}
 
-private:
-
+	/** Returns the length of the tempo in quarter notes. */
 	static float getTempoFactor(Tempo t)
     {
         jassert(t < numTempos);
         return t < numTempos ? tempoFactors[(int)t] : tempoFactors[(int)Tempo::Quarter];
     };
 
+private:
+
 	static StringArray tempoNames;
 	static float tempoFactors[numTempos];
 
 };
 
+/** Calculates the sample positions of a rhythmic grid from the host transport.
+*	@ingroup utility
+*
+*	The steps are placed at multiples of the step length on the timeline of the host, so they stay in sync with the
+*	song position and don't accumulate rounding errors like a timer that adds the interval to the last callback.
+*	If the host isn't playing, the clock continues on its own timeline.
+*
+*	Every odd step can be delayed by the shuffle amount (a value of 1.0 moves it by half a step).
+*
+*	Call advance() once per block, then start() (if a note starts the clock) and getNextSteps(). It doesn't allocate,
+*	so all methods can be called on the audio thread.
+*/
+class TransportStepClock
+{
+public:
+
+	TransportStepClock() {};
+
+	/** Sets the sample rate. */
+	void prepare(double newSampleRate);
+
+	/** Sets the distance between two steps in quarter notes. */
+	void setStepLength(double newLengthInQuarters);
+
+	/** Sets the amount (0.0 - 1.0) of half a step that every odd step is delayed. */
+	void setShuffle(double newShuffleAmount);
+
+	/** Moves the clock to the next block.
+	*
+	*	If the host is playing, the block starts at the given ppq position. Otherwise the clock continues where the
+	*	last block ended. If the host jumps (eg. when looping), the steps that were skipped are not reported.
+	*/
+	void advance(bool hostIsPlaying, double ppqPosition, double bpm, int numSamples);
+
+	/** Starts the clock at the given offset of the current block.
+	*
+	*	The step at this position counts as played, so the first reported step is the one after it. If the host is
+	*	playing, this is the grid step that is closest to the offset. Otherwise the timeline of the clock is moved so
+	*	that a step starts at the offset.
+	*/
+	void start(int offsetInBlock);
+
+	void stop() noexcept { running = false; }
+
+	bool isRunning() const noexcept { return running; }
+
+	/** Writes the timestamps of the steps in the current block that haven't been reported yet and returns their number. 
+	*
+	*	A step belongs to the first sample at or after its position.
+	*/
+	int getNextSteps(int* timestamps, int maxNumSteps);
+
+	/** Returns the index of the last reported step on the timeline. */
+	int64 getLastStepIndex() const noexcept { return lastStepIndex; }
+
+	/** Returns the position of the step in quarter notes. */
+	double getStepPosition(int64 stepIndex) const noexcept;
+
+private:
+
+	/** Returns the first step that starts at or after the given position. */
+	int64 getFirstStepAfter(double ppqPosition) const noexcept;
+
+	double sampleRate = 44100.0;
+	double stepLength = 0.25;
+	double shuffleAmount = 0.0;
+
+	double blockPosition = 0.0;
+	double quartersPerSample = 0.0;
+	int blockSize = 0;
+	bool followsHost = false;
+
+	int64 lastStepIndex = 0;
+	bool running = false;
+};
+
 class Processor;
 
 
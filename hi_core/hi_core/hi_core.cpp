@@ -56,6 +56,7 @@
 #include "DepentUtilityFunctions.cpp"
 
 #include "UtilityClasses.cpp"
+#include "FFTService.cpp"
 #include "DebugLogger.cpp"
 #include "ThreadWithQuasiModalProgressWindow.cpp"
 #include "ExternalFilePool.cpp"
@@ -76,6 +76,7 @@
 *	The most important classes in HISE.
 */
 #include "UtilityClasses.h"
+#include "FFTService.h"
 
 #include "DebugLogger.h"
 #include "ThreadWithQuasiModalProgressWindow.h"
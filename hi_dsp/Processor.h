@@ -423,6 +423,8 @@ public:
 			idAsIdentifier = Identifier();
 		}
 
+		idChanged();
+
 		sendChangeMessage();
 
 		if (notifyChangeHandler)
@@ -430,6 +432,9 @@ public:
 				MainController::ProcessorChangeHandler::EventType::ProcessorRenamed, false);
 	};
 
+	/** Overwrite this if the Processor uses its ID to register itself somewhere. This is called by setId(). */
+	virtual void idChanged() {};
+
 	const Identifier& getIDAsIdentifier() const
 	{
 		return idAsIdentifier;
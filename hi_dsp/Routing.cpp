@@ -38,7 +38,9 @@ numSourceChannels(2),
 numDestinationChannels(2),
 resizeAllowed(false),
 allowEnablingOnly(false),
-editorShown(false)
+editorShown(false),
+requestedSourceGainValues(0),
+requestedTargetGainValues(0)
 {
 	
     
@@ -460,6 +462,23 @@ void RoutableProcessor::MatrixData::setGainValues(float *numMaxChannelValues, bo
 	memcpy(isSourceValue ? sourceGainValues : targetGainValues, numMaxChannelValues, (isSourceValue ? numSourceChannels : numDestinationChannels) * sizeof(float));
 }
 
+void RoutableProcessor::MatrixData::setGainValue(int channelIndex, bool isSourceValue, float value) noexcept
+{
+	if (isPositiveAndBelow(channelIndex, NUM_MAX_CHANNELS))
+		(isSourceValue ? sourceGainValues : targetGainValues)[channelIndex] = value;
+}
+
+void RoutableProcessor::MatrixData::requestGainValues(uint32 sourceChannelMask, uint32 destinationChannelMask) noexcept
+{
+	requestedSourceGainValues |= sourceChannelMask;
+	requestedTargetGainValues |= destinationChannelMask;
+}
+
+uint32 RoutableProcessor::MatrixData::getRequestedGainValues(bool getSourceChannels) noexcept
+{
+	return (getSourceChannels ? requestedSourceGainValues : requestedTargetGainValues).exchange(0);
+}
+
 void RoutableProcessor::MatrixData::loadPreset(Presets newPreset)
 {
 	Presets pr = (Presets)newPreset;
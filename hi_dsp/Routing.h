@@ -111,6 +111,18 @@ public:
 		void setGainValues(float *numMaxChannelValues, bool isSourceValue);
 		float getGainValue(int channelIndex, bool getSourceValue) const { return getSourceValue ? sourceGainValues[channelIndex] : targetGainValues[channelIndex]; };
 
+		/** Sets a single gain value without locking (use this on the audio thread). */
+		void setGainValue(int channelIndex, bool isSourceValue, float value) noexcept;
+
+		/** Requests new gain values for the meters of the given channels (one bit per channel).
+		*
+		*	A processor that supports it only calculates the gain values that were requested since the last block.
+		*/
+		void requestGainValues(uint32 sourceChannelMask, uint32 destinationChannelMask) noexcept;
+
+		/** Returns the channels whose gain value was requested and clears the request. */
+		uint32 getRequestedGainValues(bool getSourceChannels) noexcept;
+
 		void init()
 		{
 			thisAsProcessor = dynamic_cast<Processor*>(owningProcessor);
@@ -141,6 +153,8 @@ public:
 
 		float sourceGainValues[NUM_MAX_CHANNELS];
 		float targetGainValues[NUM_MAX_CHANNELS];
+		std::atomic<uint32> requestedSourceGainValues;
+		std::atomic<uint32> requestedTargetGainValues;
         int channelConnections[NUM_MAX_CHANNELS];
 		int sendConnections[NUM_MAX_CHANNELS];
 	};
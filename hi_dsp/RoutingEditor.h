@@ -87,14 +87,26 @@ public:
 
 	void timerCallback() override
 	{
+		uint32 sourceMask = 0;
+		uint32 destinationMask = 0;
+
 		for (int i = 0; i < sourceChannels.size(); i++)
 		{
 			sourceChannels[i]->setGainValue(data->getGainValue(i, true) * 2.0f);
+
+			if (sourceChannels[i]->isShowing())
+				sourceMask |= (1u << i);
 		}
 		for (int i = 0; i < destinationChannels.size(); i++)
 		{
 			destinationChannels[i]->setGainValue(data->getGainValue(i, false) * 2.0f);
+
+			if (destinationChannels[i]->isShowing())
+				destinationMask |= (1u << i);
 		}
+
+		// The values for the next callback are only calculated for the visible meters
+		data->requestGainValues(sourceMask, destinationMask);
 	}
 
 	void deselectAll();
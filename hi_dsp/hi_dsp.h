@@ -100,6 +100,7 @@ class ProcessorEditor;
 #include "modules/MidiProcessor.h"
 #include "modules/MidiPlayer.h"
 
+#include "modules/DspCoreModules.h"
 
 #include "modules/EffectProcessor.h"
 #include "modules/EffectProcessorChain.h"
@@ -107,7 +108,6 @@ class ProcessorEditor;
 #include "modules/ModulatorSynth.h"
 #include "modules/ModulatorSynthChain.h"
 #include "modules/ModulatorSynthGroup.h"
-#include "modules/DspCoreModules.h"
 
 // Plugin Parameters
 
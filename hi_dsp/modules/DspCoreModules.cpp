@@ -0,0 +1,321 @@
+namespace hise { using namespace juce;
+
+LatencyCompensation::LatencyCompensation(int numChannels)
+{
+	for (int i = 0; i < numChannels; i++)
+		channels.add(new Channel());
+}
+
+void LatencyCompensation::setDelay(int channelIndex, int delayInSamples)
+{
+	if (auto c = channels[channelIndex])
+	{
+		c->delay = jmax<int>(0, delayInSamples);
+		c->writeIndex = 0;
+
+		if (c->delay == 0)
+		{
+			c->data.free();
+			c->mask = 0;
+			return;
+		}
+
+		// The write position must never be read, so the buffer needs at least one more slot than the delay
+		const int size = nextPowerOfTwo(c->delay + 1);
+
+		c->data.calloc(size);
+		c->mask = size - 1;
+	}
+}
+
+int LatencyCompensation::getDelay(int channelIndex) const noexcept
+{
+	if (auto c = channels[channelIndex])
+		return c->delay;
+
+	return 0;
+}
+
+bool LatencyCompensation::isActive() const noexcept
+{
+	for (auto c : channels)
+	{
+		if (c->delay != 0)
+			return true;
+	}
+
+	return false;
+}
+
+void LatencyCompensation::processChannel(int channelIndex, float* data, int numSamples) noexcept
+{
+	auto c = channels[channelIndex];
+
+	if (c == nullptr || c->delay == 0)
+		return;
+
+	auto d = c->data.get();
+	const int mask = c->mask;
+	const int delay = c->delay;
+	int w = c->writeIndex;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		d[w] = data[i];
+		data[i] = d[(w - delay) & mask];
+		w = (w + 1) & mask;
+	}
+
+	c->writeIndex = w;
+}
+
+void LatencyCompensation::processChannelAndAdd(int channelIndex, const float* source, float* destination, int numSamples) noexcept
+{
+	auto c = channels[channelIndex];
+
+	if (c == nullptr || c->delay == 0)
+	{
+		FloatVectorOperations::add(destination, source, numSamples);
+		return;
+	}
+
+	auto d = c->data.get();
+	const int mask = c->mask;
+	const int delay = c->delay;
+	int w = c->writeIndex;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		d[w] = source[i];
+		destination[i] += d[(w - delay) & mask];
+		w = (w + 1) & mask;
+	}
+
+	c->writeIndex = w;
+}
+
+void LatencyCompensation::process(AudioSampleBuffer& b) noexcept
+{
+	const int numChannels = jmin<int>(b.getNumChannels(), channels.size());
+
+	for (int i = 0; i < numChannels; i++)
+		processChannel(i, b.getWritePointer(i), b.getNumSamples());
+}
+
+void LatencyCompensation::clear() noexcept
+{
+	for (auto c : channels)
+	{
+		if (c->delay != 0)
+			FloatVectorOperations::clear(c->data.get(), c->mask + 1);
+
+		c->writeIndex = 0;
+	}
+}
+
+class SpectralProcessor::Engine
+{
+public:
+
+	Engine(const Config& c) :
+		config(c),
+		plan(fftService->getPlan(c.fftSize))
+	{
+		fftSize = config.fftSize;
+		hopSize = fftSize / config.overlap;
+		numBins = plan->getNumBins();
+
+		window.calloc(fftSize);
+		synthesisWindow.calloc(fftSize);
+		frame.calloc(fftSize);
+		re.calloc(numBins);
+		im.calloc(numBins);
+
+		input.setSize(config.numChannels, fftSize);
+		output.setSize(config.numChannels, fftSize);
+		clear();
+
+		createWindow();
+	}
+
+	void clear()
+	{
+		input.clear();
+		output.clear();
+		position = 0;
+		hopCounter = 0;
+	}
+
+	void process(float** data, int numChannels, int numSamples, Callback& cb)
+	{
+		numChannels = jmin<int>(numChannels, config.numChannels);
+
+		int offset = 0;
+
+		while (offset < numSamples)
+		{
+			const int numThisTime = jmin<int>(numSamples - offset, hopSize - hopCounter, fftSize - position);
+
+			for (int c = 0; c < numChannels; c++)
+			{
+				float* d = data[c] + offset;
+
+				FloatVectorOperations::copy(input.getWritePointer(c, position), d, numThisTime);
+				FloatVectorOperations::copy(d, output.getReadPointer(c, position), numThisTime);
+				FloatVectorOperations::clear(output.getWritePointer(c, position), numThisTime);
+			}
+
+			offset += numThisTime;
+			hopCounter += numThisTime;
+			position = (position + numThisTime) % fftSize;
+
+			if (hopCounter == hopSize)
+			{
+				hopCounter = 0;
+
+				for (int c = 0; c < numChannels; c++)
+					processFrame(c, cb);
+			}
+		}
+	}
+
+private:
+
+	void processFrame(int channelIndex, Callback& cb)
+	{
+		// The oldest sample is at the write position
+		const int numToEnd = fftSize - position;
+
+		FloatVectorOperations::copy(frame, input.getReadPointer(channelIndex, position), numToEnd);
+		FloatVectorOperations::copy(frame + numToEnd, input.getReadPointer(channelIndex, 0), position);
+		FloatVectorOperations::multiply(frame, window, fftSize);
+
+		plan->forward(frame, re, im);
+		cb.processSpectrum(channelIndex, re, im, numBins);
+		plan->inverse(frame, re, im);
+
+		FloatVectorOperations::multiply(frame, synthesisWindow, fftSize);
+
+		FloatVectorOperations::add(output.getWritePointer(channelIndex, position), frame, numToEnd);
+		FloatVectorOperations::add(output.getWritePointer(channelIndex, 0), frame + numToEnd, position);
+	}
+
+	void createWindow()
+	{
+		const double n = (double)fftSize;
+
+		for (int i = 0; i < fftSize; i++)
+		{
+			const double x = 2.0 * double_Pi * (double)i / n;
+
+			switch (config.window)
+			{
+			case WindowType::Hann:			 window[i] = (float)(0.5 - 0.5 * std::cos(x)); break;
+			case WindowType::BlackmanHarris: window[i] = (float)(0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x) - 0.01168 * std::cos(3.0 * x)); break;
+			case WindowType::Sine:			 window[i] = (float)std::sin(double_Pi * ((double)i + 0.5) / n); break;
+			case WindowType::Rectangle:
+			case WindowType::numWindowTypes: window[i] = 1.0f; break;
+			}
+		}
+
+		// The window is applied twice, so every output sample is divided by the sum of the squared windows that
+		// overlap at its position. This is only constant for some window / overlap pairs (eg. Hann with 4 frames).
+		for (int i = 0; i < hopSize; i++)
+		{
+			double sum = 0.0;
+
+			for (int j = i; j < fftSize; j += hopSize)
+				sum += (double)window[j] * (double)window[j];
+
+			// Samples that are (almost) cancelled by the window can't be restored
+			const float gain = sum > 1e-4 ? (float)(1.0 / sum) : 0.0f;
+
+			for (int j = i; j < fftSize; j += hopSize)
+				synthesisWindow[j] = window[j] * gain;
+		}
+	}
+
+	const Config config;
+
+	SharedResourcePointer<FFTService> fftService;
+	FFTService::Plan::Ptr plan;
+
+	int fftSize;
+	int hopSize;
+	int numBins;
+
+	HeapBlock<float> window;
+	HeapBlock<float> synthesisWindow;
+	HeapBlock<float> frame;
+	HeapBlock<float> re;
+	HeapBlock<float> im;
+
+	AudioSampleBuffer input;
+	AudioSampleBuffer output;
+
+	int position = 0;
+	int hopCounter = 0;
+};
+
+SpectralProcessor::SpectralProcessor(Callback& c) :
+	callback(c),
+	pendingEngine(nullptr),
+	retiredEngine(nullptr),
+	resetFlag(false)
+{
+	setConfig(config);
+}
+
+SpectralProcessor::~SpectralProcessor()
+{
+	delete pendingEngine.exchange(nullptr);
+	delete retiredEngine.exchange(nullptr);
+	delete currentEngine;
+}
+
+void SpectralProcessor::setConfig(const Config& newConfig)
+{
+	ScopedLock sl(configLock);
+
+	config.fftSize = nextPowerOfTwo(jlimit<int>(64, 32768, newConfig.fftSize));
+	config.overlap = jmin<int>(nextPowerOfTwo(jlimit<int>(1, 16, newConfig.overlap)), config.fftSize);
+	config.window = newConfig.window;
+	config.numChannels = jmax<int>(1, newConfig.numChannels);
+
+	deleteUnusedEngines();
+
+	// If the audio thread didn't pick up the last engine, it's replaced with this one
+	delete pendingEngine.exchange(new Engine(config));
+}
+
+void SpectralProcessor::deleteUnusedEngines()
+{
+	delete retiredEngine.exchange(nullptr);
+}
+
+void SpectralProcessor::process(float** data, int numChannels, int numSamples) noexcept
+{
+	if (pendingEngine.load() != nullptr)
+	{
+		Engine* expected = nullptr;
+
+		// The message thread hasn't deleted the last engine yet, so we keep the current one until the next block
+		if (retiredEngine.compare_exchange_strong(expected, currentEngine))
+			currentEngine = pendingEngine.exchange(nullptr);
+	}
+
+	if (currentEngine == nullptr)
+		return;
+
+	if (resetFlag.exchange(false))
+		currentEngine->clear();
+
+	currentEngine->process(data, numChannels, numSamples, callback);
+}
+
+void SpectralProcessor::process(AudioSampleBuffer& b) noexcept
+{
+	process(b.getArrayOfWritePointers(), b.getNumChannels(), b.getNumSamples());
+}
+
+} // namespace hise
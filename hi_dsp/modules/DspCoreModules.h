@@ -195,6 +195,143 @@ private:
 };
 
 
+/** A set of integer delay lines that align channels with different latencies.
+*
+*	The delay times are set on a non-realtime thread (this allocates the memory), the processing methods
+*	can be called from the audio thread. Changing the delay time of a running instance will cause a click, 
+*	so the usual workflow is to create a new instance and swap it with the old one.
+*/
+class LatencyCompensation
+{
+public:
+
+	LatencyCompensation(int numChannels);
+
+	/** Sets the delay for the given channel. This allocates, so never call it on the audio thread. */
+	void setDelay(int channelIndex, int delayInSamples);
+
+	/** Returns the delay for the given channel in samples. */
+	int getDelay(int channelIndex) const noexcept;
+
+	/** Returns true if at least one channel is delayed. */
+	bool isActive() const noexcept;
+
+	/** Delays the channel data in place. */
+	void processChannel(int channelIndex, float* data, int numSamples) noexcept;
+
+	/** Delays the source data and adds it to the destination. The source data is not changed. */
+	void processChannelAndAdd(int channelIndex, const float* source, float* destination, int numSamples) noexcept;
+
+	/** Delays every channel of the buffer in place. */
+	void process(AudioSampleBuffer& b) noexcept;
+
+	/** Clears the delay lines. */
+	void clear() noexcept;
+
+private:
+
+	struct Channel
+	{
+		HeapBlock<float> data;
+		int delay = 0;
+		int mask = 0;
+		int writeIndex = 0;
+	};
+
+	OwnedArray<Channel> channels;
+
+	JUCE_DECLARE_NON_COPYABLE(LatencyCompensation);
+};
+
+
+/** A short time fourier transform with overlap-add resynthesis.
+*
+*	The input is collected until the next frame is due, so the FFT size doesn't depend on the block size. Every hop,
+*	the last fftSize input samples are windowed, transformed and passed to the Callback. The modified spectrum is
+*	transformed back, windowed again and added to the output, which is delayed by the FFT size (see getLatency()).
+*
+*	Changing the configuration doesn't lock the audio thread: setConfig() creates a new engine with all buffers and
+*	process() switches to it at the start of the next block. The old engine is deleted with the next call to
+*	setConfig() or in the destructor, so the audio thread never allocates or deallocates anything.
+*/
+class SpectralProcessor
+{
+public:
+
+	enum class WindowType
+	{
+		Rectangle = 0,
+		Hann,
+		BlackmanHarris,
+		Sine,
+		numWindowTypes
+	};
+
+	struct Config
+	{
+		int fftSize = 2048;						///< a power of two between 64 and 32768
+		int overlap = 4;						///< the amount of frames per FFT size (the hop size is fftSize / overlap)
+		WindowType window = WindowType::Hann;	///< the window for analysis and resynthesis
+		int numChannels = 2;
+	};
+
+	/** The interface for the spectral processing. */
+	class Callback
+	{
+	public:
+
+		virtual ~Callback() {};
+
+		/** Modify the spectrum of the given channel. This is called on the audio thread once per hop and channel.
+		*
+		*	@param re: the real part of the spectrum with 'numBins' elements (fftSize / 2 + 1)
+		*	@param im: the imaginary part of the spectrum with 'numBins' elements.
+		*/
+		virtual void processSpectrum(int channelIndex, float* re, float* im, int numBins) = 0;
+	};
+
+	SpectralProcessor(Callback& c);
+	~SpectralProcessor();
+
+	/** Creates a new engine with the given configuration. This allocates, so never call it on the audio thread. */
+	void setConfig(const Config& newConfig);
+
+	/** Returns the last configuration that was passed to setConfig(). */
+	Config getConfig() const noexcept { return config; }
+
+	/** Returns the latency of the last configuration in samples. */
+	int getLatency() const noexcept { return config.fftSize; }
+
+	/** Processes the channels in place. Channels that exceed the configured channel amount are not changed. */
+	void process(float** data, int numChannels, int numSamples) noexcept;
+
+	/** Processes every channel of the buffer in place. */
+	void process(AudioSampleBuffer& b) noexcept;
+
+	/** Clears the input and output of the current engine with the next call to process(). */
+	void reset() noexcept { resetFlag.store(true); }
+
+private:
+
+	class Engine;
+
+	/** Deletes the engines that the audio thread doesn't need anymore. */
+	void deleteUnusedEngines();
+
+	Callback& callback;
+
+	Config config;
+
+	Engine* currentEngine = nullptr;
+	std::atomic<Engine*> pendingEngine;
+	std::atomic<Engine*> retiredEngine;
+	std::atomic<bool> resetFlag;
+
+	CriticalSection configLock;
+
+	JUCE_DECLARE_NON_COPYABLE(SpectralProcessor);
+};
+
 } // namespace hise
 
 #endif  // DSPCOREMODULES_H_INCLUDED
@@ -96,6 +96,75 @@ juce::Path VoiceEffectProcessor::getSpecialSymbol() const
 	return path;
 }
 
+void EffectProcessor::sendLatencyChangeMessage()
+{
+	if (auto root = getMainController()->getMainSynthChain())
+		root->triggerLatencyUpdate();
+}
+
+void MasterEffectProcessor::updateChannelLatencies(Array<int>& channelLatencies)
+{
+	const int latency = getLatency();
+
+	if (latency == 0)
+		return;
+
+	const int l = getLeftSourceChannel();
+	const int r = getRightSourceChannel();
+
+	// renderWholeBuffer() only processes the channels if both of them are valid
+	if (isPositiveAndBelow(l, channelLatencies.size()) && isPositiveAndBelow(r, channelLatencies.size()))
+	{
+		channelLatencies.set(l, channelLatencies[l] + latency);
+		channelLatencies.set(r, channelLatencies[r] + latency);
+	}
+}
+
+uint32 MasterEffectProcessor::getChannelPairMask() const
+{
+	uint32 mask = 0;
+
+	const int l = getLeftSourceChannel();
+	const int r = getRightSourceChannel();
+
+	if (isPositiveAndBelow(l, NUM_MAX_CHANNELS))
+		mask |= (1u << (l / 2));
+
+	if (isPositiveAndBelow(r, NUM_MAX_CHANNELS))
+		mask |= (1u << (r / 2));
+
+	return mask;
+}
+
+bool MasterEffectProcessor::updateSuspension(bool inputIsSilent, int numSamples) noexcept
+{
+	if (!inputIsSilent)
+	{
+		if (suspended)
+			resumeAfterSuspension();
+
+		numSilentInputSamples = 0;
+		suspended = false;
+		return false;
+	}
+
+	// The first sample of this block depends on the input that arrived before it
+	const int64 numSilentBeforeBlock = numSilentInputSamples;
+
+	numSilentInputSamples += (int64)numSamples;
+
+	suspended = outputIsSilent && numSilentBeforeBlock >= (int64)getNumSilentSamplesBeforeSuspension();
+
+	if (suspended)
+	{
+		isTailing = false;
+		currentValues.outL = 0.0f;
+		currentValues.outR = 0.0f;
+	}
+
+	return suspended;
+}
+
 bool MasterEffectProcessor::isFadeOutPending() const noexcept
 {
 	return softBypassState == Pending && softBypassRamper.getTargetValue() < 0.5f;
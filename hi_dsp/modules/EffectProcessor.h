@@ -107,6 +107,16 @@ public:
 
 	/** Overwrite this method if the effect has a tail (produces sound if no input is active */
 	virtual bool hasTail() const = 0;
+
+	/** Overwrite this method if the effect delays the signal (eg. lookahead or linear phase processing).
+	*
+	*	The latency of all master effects is summed along the signal chain and parallel paths are delayed
+	*	so that they stay aligned. Call sendLatencyChangeMessage() whenever the value changes.
+	*/
+	virtual int getLatency() const { return 0; }
+
+	/** Recalculates the delay compensation of the module tree asynchronously. */
+	void sendLatencyChangeMessage();
 	
 	/** Checks if the effect is tailing off. This simply returns the calculated value, but the EffectChain overwrites this. */
 	bool isTailingOff() const {	return isTailing; };
@@ -227,8 +237,18 @@ public:
 	{
 		Processor::setBypassed(shouldBeBypassed, notifyChangeHandler);
 		setSoftBypass(shouldBeBypassed);
+
+		if (getLatency() != 0)
+			sendLatencyChangeMessage();
 	}
 
+	/** Adds the latency of this effect to the channels that it processes.
+	*
+	*	Effects that mix channels (like the RouteEffect) can override this and align their inputs.
+	*	This is called on the message thread whenever the delay compensation is recalculated.
+	*/
+	virtual void updateChannelLatencies(Array<int>& channelLatencies);
+
 	virtual bool isFadeOutPending() const noexcept;
 
 	virtual void updateSoftBypass()
@@ -280,8 +300,55 @@ public:
 
 		if (sampleRate > 0.0 && samplesPerBlock > 0)
 			softBypassRamper.reset(sampleRate / (double)samplesPerBlock, 0.1);
+
+		numSilentInputSamples = 0;
+		outputIsSilent = false;
+		suspended = false;
+	}
+
+	/** Returns the number of samples that the input must be silent before the effect stops processing.
+	*
+	*	The EffectProcessorChain skips the effect if all channel pairs it processes were silent for at least this
+	*	amount of samples and the last output of the effect was silent too. Return the longest time that your effect
+	*	can stay silent before it produces a signal from past input (eg. the delay time).
+	*
+	*	The default returns -1, which means that the effect is always processed. Don't change this for effects that
+	*	generate a signal without input.
+	*
+	*	The modulation chains are rendered in renderNextBlock(), so they keep running while the effect is suspended.
+	*/
+	virtual int getNumSilentSamplesBeforeSuspension() const { return -1; }
+
+	/** Called on the audio thread before the first block that is processed after the effect was suspended.
+	*
+	*	Override this to reset state that would otherwise be applied to the new input (eg. envelope followers).
+	*/
+	virtual void resumeAfterSuspension() {}
+
+	/** Returns the channel pairs that this effect processes as bit mask (the first bit is the pair 1+2).
+	*
+	*	The default uses the pairs of the left and right source channel. If you override renderWholeBuffer() to process
+	*	other channels and allow suspension, you need to override this method too.
+	*/
+	virtual uint32 getChannelPairMask() const;
+
+	/** Returns true if the effect can be suspended when its input is silent. */
+	bool canBeSuspended() const noexcept
+	{
+		return softBypassState == Inactive && getNumSilentSamplesBeforeSuspension() >= 0;
 	}
 
+	/** Updates the silence counter of the input and returns true if the effect can skip the processing of this block.
+	*
+	*	This is called by the EffectProcessorChain before renderWholeBuffer(). */
+	bool updateSuspension(bool inputIsSilent, int numSamples) noexcept;
+
+	/** Tells the effect whether its last output was silent. */
+	void setOutputIsSilent(bool isSilent_) noexcept { outputIsSilent = isSilent_; }
+
+	/** Returns true if the effect skipped the processing of the last block because its input was silent. */
+	bool isSuspended() const noexcept { return suspended; }
+
 	/** A wrapper function around the actual processing.
 	*
 	*	You can assume that all internal chains are processed and the numSample amount is set according to the stepsize calculated with
@@ -410,6 +477,10 @@ private:
 	SoftBypassState softBypassState = Inactive;
 	LinearSmoothedValue<float> softBypassRamper;
 
+	int64 numSilentInputSamples = 0;
+	bool outputIsSilent = false;
+	bool suspended = false;
+
 	
 };
 
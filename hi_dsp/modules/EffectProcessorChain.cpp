@@ -55,7 +55,34 @@ void EffectProcessorChain::renderMasterEffects(AudioSampleBuffer &b)
 
 	ADD_GLITCH_DETECTOR(parentProcessor, DebugLogger::Location::MasterEffectRendering);
 
-	FOR_EACH_MASTER_EFFECT(renderWholeBuffer(b));
+	pairActivity.reset();
+
+	const int numSamples = b.getNumSamples();
+
+	for (auto fx : masterEffects)
+	{
+		if (fx->isSoftBypassed())
+			continue;
+
+		if (!fx->canBeSuspended())
+		{
+			fx->renderWholeBuffer(b);
+
+			// We don't know which channels the effect has changed
+			pairActivity.invalidate(0xFFFFFFFF);
+			continue;
+		}
+
+		const auto pairMask = fx->getChannelPairMask();
+
+		if (fx->updateSuspension(pairActivity.isSilent(b, pairMask), numSamples))
+			continue;
+
+		fx->renderWholeBuffer(b);
+
+		pairActivity.invalidate(pairMask);
+		fx->setOutputIsSilent(pairActivity.isSilent(b, pairMask));
+	}
 
 	const auto prev = resetCounter;
 
@@ -79,6 +106,50 @@ void EffectProcessorChain::renderMasterEffects(AudioSampleBuffer &b)
 #endif
 }
 
+bool EffectProcessorChain::ChannelPairActivity::isSilent(const AudioSampleBuffer& b, uint32 pairMask) noexcept
+{
+	// about -90dB, so that reverb tails fade out completely before the effect is suspended
+	static constexpr float SilenceThreshold = 0.00003f;
+
+	const int numChannels = jmin<int>(b.getNumChannels(), NUM_MAX_CHANNELS);
+	const int numSamples = b.getNumSamples();
+
+	for (int i = 0; i < NumPairs; i++)
+	{
+		const uint32 bit = 1u << i;
+
+		if ((pairMask & bit) == 0 || (measuredPairs & bit) != 0)
+			continue;
+
+		// Pairs that are not in the buffer are always silent
+		bool silent = true;
+
+		for (int c = i * 2; c < jmin<int>(i * 2 + 2, numChannels); c++)
+			silent &= b.getMagnitude(c, 0, numSamples) < SilenceThreshold;
+
+		measuredPairs |= bit;
+
+		if (silent)
+			silentPairs |= bit;
+		else
+			silentPairs &= ~bit;
+	}
+
+	return (silentPairs & pairMask) == pairMask;
+}
+
+void EffectProcessorChain::updateChannelLatencies(Array<int>& channelLatencies)
+{
+	if (isBypassed())
+		return;
+
+	for (auto fx : masterEffects)
+	{
+		if (!fx->isBypassed())
+			fx->updateChannelLatencies(channelLatencies);
+	}
+}
+
 ProcessorEditorBody *EffectProcessorChain::EffectProcessorChain::createEditor(ProcessorEditor *parentEditor)
 {
 #if USE_BACKEND
@@ -224,6 +295,9 @@ void EffectProcessorChain::EffectChainHandler::add(Processor *newProcessor, Proc
 		sp->compileScript();
 	}
 
+	if (auto mep = dynamic_cast<MasterEffectProcessor*>(newProcessor))
+		mep->sendLatencyChangeMessage();
+
 	notifyListeners(Listener::ProcessorAdded, newProcessor);
 }
 
@@ -259,6 +333,9 @@ void EffectProcessorChain::EffectChainHandler::remove(Processor *processorToBeRe
 		ownedProcessorToRemove = nullptr;
 	else
 		ownedProcessorToRemove.release();
+
+	if (auto root = chain->getMainController()->getMainSynthChain())
+		root->triggerLatencyUpdate();
 }
 
 void EffectProcessorChain::EffectChainHandler::moveProcessor(Processor *processorInChain, int delta)
@@ -280,6 +357,8 @@ void EffectProcessorChain::EffectChainHandler::moveProcessor(Processor *processo
 			chain->masterEffects.swap(indexOfProcessor, indexOfSwapProcessor);
 			chain->allEffects.swap(indexOfProcessorInAllEffects, indexOfSwapProcessorInAllEfects);
 		}
+
+		mep->sendLatencyChangeMessage();
 	}
 }
 
@@ -139,6 +139,30 @@ public:
 
 	};
 
+	/** Returns true if any effect in this chain processes the synth buffer in renderNextBlock(). 
+	*
+	*	Master effects only calculate their modulation there and render the buffer later in renderMasterEffects().
+	*/
+	bool processesBufferInRenderCallback() const
+	{
+		if (isBypassed())
+			return false;
+
+		for (auto fx : voiceEffects)
+		{
+			if (!fx->isBypassed())
+				return true;
+		}
+
+		for (auto fx : monoEffects)
+		{
+			if (!fx->isBypassed())
+				return true;
+		}
+
+		return false;
+	}
+
 	bool hasTailingMasterEffects() const noexcept
 	{
 		return resetCounter > 0;
@@ -213,6 +237,9 @@ public:
 
 	void renderMasterEffects(AudioSampleBuffer &b);
 
+	/** Adds the latency of the active master effects to the given channel latencies in processing order. */
+	void updateChannelLatencies(Array<int>& channelLatencies);
+
 	void startVoice(int voiceIndex, int noteNumber) 
 	{
 		if(isBypassed()) return;
@@ -289,6 +316,30 @@ public:
 
 private:
 
+	/** Keeps track of the channel pairs that are silent at the current position in the master effect chain.
+	*
+	*	The pairs are only measured if an effect that can be suspended asks for them and every effect that was
+	*	processed invalidates the pairs it might have changed.
+	*/
+	struct ChannelPairActivity
+	{
+		static constexpr int NumPairs = NUM_MAX_CHANNELS / 2;
+
+		/** Forgets all measurements. Call this at the start of each block. */
+		void reset() noexcept { measuredPairs = 0; silentPairs = 0; }
+
+		/** Marks the given pairs as changed. */
+		void invalidate(uint32 pairMask) noexcept { measuredPairs &= ~pairMask; }
+
+		/** Returns true if all given pairs are silent. Pairs that are not measured yet are checked now. */
+		bool isSilent(const AudioSampleBuffer& b, uint32 pairMask) noexcept;
+
+		uint32 measuredPairs = 0;
+		uint32 silentPairs = 0;
+	};
+
+	ChannelPairActivity pairActivity;
+
 	bool renderPolyFxAsMono = false;
 
 	// Gives it a limit of 6 million years...
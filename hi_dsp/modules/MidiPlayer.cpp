@@ -543,8 +543,189 @@ void MidiPlayer::EditAction::writeArrayToSequence(HiseMidiSequence::Ptr destinat
 	destination->swapCurrentSequence(newSeq.release());
 }
 
+MidiRecordingBuffer::MidiRecordingBuffer(int queueSize) :
+	fifo(jmax<int>(2, queueSize + 1)),
+	queueData(fifo.getTotalSize())
+{
+	existingEvents.ensureStorageAllocated(2048);
+	recordedEvents.ensureStorageAllocated(2048);
+}
+
+bool MidiRecordingBuffer::push(const HiseEvent& e) noexcept
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+	if (size1 + size2 == 0)
+	{
+		numDropped.fetch_add(1);
+		return false;
+	}
+
+	queueData[size1 > 0 ? start1 : start2] = e;
+	fifo.finishedWrite(1);
+	return true;
+}
+
+void MidiRecordingBuffer::reset(Array<HiseEvent>& newExistingEvents, int newLastTimestamp)
+{
+	ScopedLock sl(consolidationLock);
+
+	clearPending.store(true);
+	clearIfPending();
+
+	existingEvents.swapWith(newExistingEvents);
+	lastTimestamp = newLastTimestamp;
+}
+
+int MidiRecordingBuffer::consolidate()
+{
+	ScopedLock sl(consolidationLock);
+
+	clearIfPending();
+
+	const int numReady = fifo.getNumReady();
+
+	if (numReady == 0)
+		return 0;
+
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+	for (int i = 0; i < size1; i++)
+		addRecordedEvent(queueData[start1 + i]);
+
+	for (int i = 0; i < size2; i++)
+		addRecordedEvent(queueData[start2 + i]);
+
+	fifo.finishedRead(size1 + size2);
+
+	return size1 + size2;
+}
+
+void MidiRecordingBuffer::finish(int newLastTimestamp, Array<HiseEvent>& mergedList)
+{
+	ScopedLock sl(consolidationLock);
+
+	lastTimestamp = newLastTimestamp;
+
+	consolidate();
+
+	// Close all notes that are still pressed at the end of the sequence
+	for (HashMap<int, HiseEvent>::Iterator it(openNotes); it.next();)
+	{
+		auto noteOn = it.getValue();
+
+		HiseEvent artificialNoteOff(HiseEvent::Type::NoteOff, (uint8)noteOn.getNoteNumber(), 1, (uint8)noteOn.getChannel());
+		artificialNoteOff.setTimeStamp(lastTimestamp);
+		artificialNoteOff.setEventId(noteOn.getEventId());
+		addRecordedEvent(artificialNoteOff);
+	}
+
+	openNotes.clear();
+
+	mergeInto(mergedList);
+
+	// The merged list is the starting point for the next take
+	existingEvents = mergedList;
+	recordedEvents.clearQuick();
+}
+
+void MidiRecordingBuffer::getEvents(Array<HiseEvent>& mergedList)
+{
+	ScopedLock sl(consolidationLock);
+
+	consolidate();
+	mergeInto(mergedList);
+}
+
+void MidiRecordingBuffer::addRecordedEvent(const HiseEvent& e)
+{
+	HiseEvent copy(e);
+
+	if (copy.isNoteOn())
+	{
+		openNotes.set(copy.getEventId(), copy);
+	}
+	else if (copy.isNoteOff())
+	{
+		const int id = copy.getEventId();
+
+		// The note on was pressed before the recording started
+		if (!openNotes.contains(id))
+			return;
+
+		// The note off wrapped around the loop end
+		if (copy.getTimeStamp() < openNotes[id].getTimeStamp())
+			copy.setTimeStamp(lastTimestamp);
+
+		openNotes.remove(id);
+	}
+
+	const int timestamp = copy.getTimeStamp();
+
+	// The events arrive in chronological order most of the time, so this is usually a simple append
+	if (recordedEvents.isEmpty() || recordedEvents.getLast().getTimeStamp() <= timestamp)
+	{
+		recordedEvents.add(copy);
+		return;
+	}
+
+	int lower = 0;
+	int upper = recordedEvents.size();
+
+	while (lower < upper)
+	{
+		const int mid = (lower + upper) / 2;
+
+		if (recordedEvents.getReference(mid).getTimeStamp() <= timestamp)
+			lower = mid + 1;
+		else
+			upper = mid;
+	}
+
+	recordedEvents.insert(lower, copy);
+}
+
+void MidiRecordingBuffer::clearIfPending()
+{
+	if (!clearPending.exchange(false))
+		return;
+
+	const int numReady = fifo.getNumReady();
+
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(numReady, start1, size1, start2, size2);
+	fifo.finishedRead(size1 + size2);
+
+	existingEvents.clearQuick();
+	recordedEvents.clearQuick();
+	openNotes.clear();
+}
+
+void MidiRecordingBuffer::mergeInto(Array<HiseEvent>& mergedList) const
+{
+	mergedList.clearQuick();
+	mergedList.ensureStorageAllocated(existingEvents.size() + recordedEvents.size());
+
+	int e = 0;
+	int r = 0;
+
+	while (e < existingEvents.size() || r < recordedEvents.size())
+	{
+		const bool useExisting = r == recordedEvents.size() ||
+			(e < existingEvents.size() && existingEvents.getReference(e).getTimeStamp() <= recordedEvents.getReference(r).getTimeStamp());
+
+		if (useExisting)
+			mergedList.add(existingEvents.getReference(e++));
+		else
+			mergedList.add(recordedEvents.getReference(r++));
+	}
+}
+
 MidiPlayer::MidiPlayer(MainController *mc, const String &id, ModulatorSynth* ) :
 	MidiProcessor(mc, id),
+	recordingConsolidator(*this),
 	undoManager(new UndoManager())
 {
 	addAttributeID(Stop);
@@ -642,7 +823,7 @@ void MidiPlayer::clearSequences(NotificationType notifyListeners)
 	currentlyLoadedFiles.clear();
 
 	currentSequenceIndex = -1;
-	currentlyRecordedEvents.clear();
+	recordingBuffer.clear();
 	recordState.store(RecordState::Idle);
 
 
@@ -712,7 +893,7 @@ void MidiPlayer::setInternalAttribute(int index, float newAmount)
 
 		currentSequenceIndex = jlimit<int>(-1, currentSequences.size(), (int)(newAmount - 1)); 
 
-		currentlyRecordedEvents.clear();
+		recordingBuffer.clear();
 		recordState.store(RecordState::Idle);
 
 		if (auto seq = getCurrentSequence())
@@ -737,7 +918,7 @@ void MidiPlayer::setInternalAttribute(int index, float newAmount)
 		if(auto seq = getCurrentSequence())
 			seq->setCurrentTrackIndex(currentTrackIndex);
 
-		currentlyRecordedEvents.clear();
+		recordingBuffer.clear();
 		recordState.store(RecordState::Idle);
 
 		break;
@@ -911,7 +1092,7 @@ void MidiPlayer::processHiseEvent(HiseEvent &m) noexcept
 			HiseEvent copy(m);
 			copy.setTimeStamp(timestampSamples);
 
-			currentlyRecordedEvents.add(copy);
+			recordingBuffer.push(copy);
 		}
 	}
 }
@@ -1014,7 +1195,7 @@ void MidiPlayer::flushEdit(const Array<HiseEvent>& newEvents)
 
 void MidiPlayer::clearCurrentSequence()
 {
-	currentlyRecordedEvents.clear();
+	recordingBuffer.clear();
 	flushEdit({});
 }
 
@@ -1117,20 +1298,21 @@ void MidiPlayer::prepareForRecording(bool copyExistingEvents/*=true*/)
 	{
 		auto mp = static_cast<MidiPlayer*>(p);
 
-		Array<HiseEvent> newEvents;
+		Array<HiseEvent> existingEvents;
+		int lastTimestamp = 0;
 
 		if (auto seq = mp->getCurrentSequence())
 		{
 			if (copyExistingEvents)
-            {
-                auto newList = seq->getEventList(p->getSampleRate(), p->getMainController()->getBpm());
-				newEvents.swapWith(newList);            
-      }
-		}
+			{
+				auto newList = seq->getEventList(p->getSampleRate(), p->getMainController()->getBpm());
+				existingEvents.swapWith(newList);
+			}
 
-		newEvents.ensureStorageAllocated(2048);
+			lastTimestamp = mp->getLastRecordingTimestamp();
+		}
 
-		mp->currentlyRecordedEvents.swapWith(newEvents);
+		mp->recordingBuffer.reset(existingEvents, lastTimestamp);
 		mp->recordState.store(RecordState::Prepared);
 
 		return SafeFunctionCall::OK;
@@ -1146,62 +1328,12 @@ void MidiPlayer::finishRecording()
 	{
 		auto mp = static_cast<MidiPlayer*>(p);
 
-		auto& l = mp->currentlyRecordedEvents;
-
-		int lastTimestamp = (int)MidiPlayerHelpers::ticksToSamples(mp->getCurrentSequence()->getLength(), mp->getMainController()->getBpm(), mp->getSampleRate()) - 1;
-
-		for (int i = 0; i < l.size(); i++)
-		{
-			auto currentEvent = l[i];
-
-			if (currentEvent.isNoteOn())
-			{
-				bool found = false;
-
-				for (int j = 0; j < l.size(); j++)
-				{
-					if (l[j].isNoteOff() && l[j].getEventId() == currentEvent.getEventId())
-					{
-						if (l[j].getTimeStamp() < currentEvent.getTimeStamp())
-						{
-							l.getReference(j).setTimeStamp(lastTimestamp);
-						}
-						
-						found = true;
-						break;
-					}
-				}
-
-				if (!found)
-				{
-					HiseEvent artificialNoteOff(HiseEvent::Type::NoteOff, (uint8)currentEvent.getNoteNumber(), 1, (uint8)currentEvent.getChannel());
-					artificialNoteOff.setTimeStamp(lastTimestamp);
-					artificialNoteOff.setEventId(currentEvent.getEventId());
-					l.add(artificialNoteOff);
-				}
-			}
-
-			if (currentEvent.isNoteOff())
-			{
-				bool found = false;
-
-				for (int j = 0; j < l.size(); j++)
-				{
-					if (l[j].isNoteOn() && currentEvent.getEventId() == l[j].getEventId())
-					{
-						found = true;
-						break;
-					}
-				}
-
-				if (!found)
-					l.remove(i--);
-			}
-		}
+		Array<HiseEvent> newEvents;
+		mp->recordingBuffer.finish(mp->getLastRecordingTimestamp(), newEvents);
 
-		mp->flushEdit(mp->currentlyRecordedEvents);
+		mp->flushEdit(newEvents);
 
-		// This is a shortcut because the preparation would just fill it with the current sequence.
+		// This is a shortcut because the recording buffer already contains the new sequence.
 		mp->recordState.store(RecordState::Prepared);
 
 		return SafeFunctionCall::OK;
@@ -1211,11 +1343,29 @@ void MidiPlayer::finishRecording()
 	recordState.store(RecordState::FlushPending);
 }
 
+int MidiPlayer::getLastRecordingTimestamp() const
+{
+	if (auto seq = getCurrentSequence())
+		return (int)MidiPlayerHelpers::ticksToSamples(seq->getLength(), getMainController()->getBpm(), getSampleRate()) - 1;
+
+	return 0;
+}
+
+void MidiPlayer::RecordingConsolidator::timerCallback()
+{
+	if (parent.recordState == RecordState::Prepared)
+		parent.recordingBuffer.consolidate();
+}
+
 hise::HiseMidiSequence::Ptr MidiPlayer::getListOfCurrentlyRecordedEvents()
 {
 	HiseMidiSequence::Ptr recordedList = new HiseMidiSequence();
 	recordedList->createEmptyTrack();
-	EditAction::writeArrayToSequence(recordedList, currentlyRecordedEvents, getMainController()->getBpm(), getSampleRate());
+
+	Array<HiseEvent> events;
+	recordingBuffer.getEvents(events);
+
+	EditAction::writeArrayToSequence(recordedList, events, getMainController()->getBpm(), getSampleRate());
 	return recordedList;
 }
 
@@ -183,6 +183,81 @@ private:
 };
 
 
+#ifndef HISE_MIDI_RECORDING_QUEUE_SIZE
+#define HISE_MIDI_RECORDING_QUEUE_SIZE 8192
+#endif
+
+/** Collects the events that are recorded by a MidiPlayer.
+
+	The audio thread only writes the events into a preallocated single producer / single consumer ring buffer
+	with push(), so recording never allocates or locks.
+
+	A background thread drains the ring buffer with consolidate(). This keeps the recorded events sorted by their
+	timestamp and pairs the note offs with their note ons using a hash map of the event IDs, so finishing a take
+	is just a merge with the existing events of the sequence.
+*/
+class MidiRecordingBuffer
+{
+public:
+
+	MidiRecordingBuffer(int queueSize=HISE_MIDI_RECORDING_QUEUE_SIZE);
+
+	/** Writes the event into the ring buffer. Call this from the audio thread only.
+
+		If the ring buffer is full (because it wasn't drained in time), the event is dropped and this returns false. */
+	bool push(const HiseEvent& e) noexcept;
+
+	/** Prepares a new recording.
+
+		The existing events (sorted by timestamp) will be kept for overdubbing. The last timestamp is the length
+		of the sequence in samples and is used for note offs that wrapped around the loop end. */
+	void reset(Array<HiseEvent>& existingEvents, int lastTimestamp);
+
+	/** Discards all events. This doesn't lock or allocate, the events will be removed at the next consolidation. */
+	void clear() noexcept { clearPending.store(true); }
+
+	/** Drains the ring buffer into the sorted list of recorded events. Returns the number of new events. */
+	int consolidate();
+
+	/** Consolidates the remaining events, closes all notes that are still pressed and writes the merged list.
+
+		The merged list will be used as existing events for the next take. */
+	void finish(int lastTimestamp, Array<HiseEvent>& mergedList);
+
+	/** Writes the existing and the recorded events into the given list. */
+	void getEvents(Array<HiseEvent>& mergedList);
+
+	/** Returns the number of events that were dropped because the ring buffer was full. */
+	int getNumDroppedEvents() const noexcept { return numDropped.load(); }
+
+	/** Returns the number of events that can be written to the ring buffer before it must be drained. */
+	int getQueueSize() const noexcept { return fifo.getTotalSize() - 1; }
+
+private:
+
+	void addRecordedEvent(const HiseEvent& e);
+
+	void clearIfPending();
+
+	void mergeInto(Array<HiseEvent>& mergedList) const;
+
+	AbstractFifo fifo;
+	HeapBlock<HiseEvent> queueData;
+
+	std::atomic<int> numDropped = { 0 };
+	std::atomic<bool> clearPending = { false };
+
+	// Everything below is only accessed by the consolidation threads
+	CriticalSection consolidationLock;
+
+	Array<HiseEvent> existingEvents;
+	Array<HiseEvent> recordedEvents;
+	HashMap<int, HiseEvent> openNotes;
+	int lastTimestamp = 0;
+
+	JUCE_DECLARE_NON_COPYABLE(MidiRecordingBuffer);
+};
+
 
 /** A player for MIDI sequences.
 *	@ingroup midiTypes
@@ -399,14 +474,31 @@ public:
 
 private:
 
-	Array<HiseEvent> currentlyRecordedEvents;
+	/** Drains the recording buffer on the message thread while recording. */
+	struct RecordingConsolidator : public Timer
+	{
+		RecordingConsolidator(MidiPlayer& parent_) :
+			parent(parent_)
+		{
+			startTimer(50);
+		};
 
+		void timerCallback() override;
 
-  std::atomic<RecordState> recordState{ RecordState::Idle};
+		MidiPlayer& parent;
+	};
+
+	MidiRecordingBuffer recordingBuffer;
+	RecordingConsolidator recordingConsolidator;
+
+	std::atomic<RecordState> recordState{ RecordState::Idle};
 
 
 	bool isRecording() const noexcept { return getPlayState() == PlayState::Record; }
 
+	/** Returns the timestamp of the last sample in the current sequence. */
+	int getLastRecordingTimestamp() const;
+
 	void sendSequenceUpdateMessage(NotificationType notification);
 
 	ScopedPointer<UndoManager> undoManager;
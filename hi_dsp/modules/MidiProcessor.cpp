@@ -110,25 +110,27 @@ void MidiProcessorChain::renderNextHiseEventBuffer(HiseEventBuffer &buffer, int
 			wmp->preprocessBuffer(buffer, numSamples);
 	}
 
-	if (buffer.isEmpty() && futureEventBuffer.isEmpty() && artificialEvents.isEmpty()) return;
+	if (!buffer.isEmpty())
+	{
+		HiseEventBuffer::Iterator it(buffer);
 
-	HiseEventBuffer::Iterator it(buffer);
-	
-	jassert(buffer.timeStampsAreSorted());
+		jassert(buffer.timeStampsAreSorted());
 
-	while (HiseEvent* e = it.getNextEventPointer(true, false))
-	{
-		processHiseEvent(*e);
-	}
+		while (HiseEvent* e = it.getNextEventPointer(true, false))
+		{
+			processHiseEvent(*e);
+		}
 
-	buffer.sortTimestamps();
-	artificialEvents.sortTimestamps();
+		buffer.sortTimestamps();
 
-	jassert(buffer.timeStampsAreSorted());
+		jassert(buffer.timeStampsAreSorted());
+
+		// Events that were delayed past this block are scheduled for later
+		buffer.moveEventsAbove(artificialEvents, numSamples);
+	}
 
-	artificialEvents.moveEventsBelow(buffer, numSamples);
-	buffer.moveEventsAbove(artificialEvents, numSamples);
-	artificialEvents.subtractFromTimeStamps(numSamples);
+	// This must be called for every block so that the scheduler keeps track of the position
+	artificialEvents.moveDueEvents(buffer, numSamples);
 }
 
 MidiProcessorFactoryType::MidiProcessorFactoryType(Processor *p) :
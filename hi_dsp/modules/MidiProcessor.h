@@ -92,6 +92,12 @@ public:
 
 	virtual bool isProcessingWholeBuffer() const { return false; }
 
+	/** Return false if a processor that processes the whole buffer should keep its position in the chain. 
+	
+		By default it is moved before any other processor so that the events it adds go through the entire chain.
+		If it only adds events for itself (eg. timer events), it can stay where it is. */
+	virtual bool needsToBeFirstInChain() const { return isProcessingWholeBuffer(); }
+
 	/** Normally a MidiProcessor has no child processors, but it is virtual for the MidiProcessorChain. */
 	virtual Processor *getChildProcessor(int /*processorIndex*/) override {return nullptr;};
 
@@ -245,10 +251,16 @@ public:
 
 		jassert(index != -1);
 		
+		if (!midiProcessor->needsToBeFirstInChain())
+		{
+			wholeBufferProcessors.addIfNotAlreadyThere(midiProcessor);
+			return;
+		}
+
 		// Bubble it up the chain so it will be before any non-whole processor
 		for (int i = index-1; i >= 0 ; i--)
 		{
-			if (!processors[i]->isProcessingWholeBuffer())
+			if (!processors[i]->needsToBeFirstInChain())
 			{
 				processors.swap(i, index);
 				index = i;
@@ -334,8 +346,7 @@ private:
 
 	Array<WeakReference<MidiProcessor>> wholeBufferProcessors;
 
-	HiseEventBuffer futureEventBuffer;
-	HiseEventBuffer artificialEvents;
+	HiseEventScheduler artificialEvents;
 
 };
 
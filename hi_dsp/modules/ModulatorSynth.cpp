@@ -336,6 +336,8 @@ void ModulatorSynth::processHiseEventBuffer(const HiseEventBuffer &inputBuffer,
 	midiProcessorChain->renderNextHiseEventBuffer(eventBuffer, numSamples);
 
 	eventBuffer.alignEventsToRaster<HISE_EVENT_RASTER>(numSamples);
+
+	controllerState.processEvents(eventBuffer, numSamples);
 }
 
 void ModulatorSynth::addProcessorsWhenEmpty()
@@ -387,7 +389,14 @@ void ModulatorSynth::renderNextBlockWithModulators(AudioSampleBuffer& outputBuff
 	HiseEvent m;
 	int midiEventPos;
 
+	const bool deferVoiceRendering = supportsDeferredVoiceRendering() &&
+									 (isChainDisabled(EffectChain) || !effectChain->processesBufferInRenderCallback());
 
+	if (deferVoiceRendering)
+	{
+		renderBlockWithDeferredVoices(eventIterator, numSamplesFixed);
+		numSamples = 0;
+	}
 
 	while (numSamples > 0)
 	{
@@ -435,6 +444,8 @@ void ModulatorSynth::renderNextBlockWithModulators(AudioSampleBuffer& outputBuff
 
 	effectChain->renderMasterEffects(thisInternalBuffer);
 
+	applyLatencyCompensation(thisInternalBuffer);
+
 	for (int i = 0; i < thisInternalBuffer.getNumChannels(); i++)
 	{
 		const int destinationChannel = getMatrix().getConnectionForSourceChannel(i);
@@ -495,6 +506,92 @@ void ModulatorSynth::renderVoice(int startSample, int numThisTime)
 };
 
 	
+void ModulatorSynth::renderBlockWithDeferredVoices(HiseEventBuffer::Iterator& eventIterator, int numSamples)
+{
+	for (auto v : activeVoices)
+		v->setRenderPosition(0);
+
+	int startSample = 0;
+
+	deferredRenderPosition = 0;
+
+	HiseEvent m;
+	int midiEventPos;
+
+	while (eventIterator.getNextEvent(m, midiEventPos, true, false))
+	{
+		const int eventPos = jmin<int>(midiEventPos, numSamples);
+		const int samplesToNextMidiMessage = eventPos - startSample;
+
+		jassert(eventPos % HISE_EVENT_RASTER == 0);
+
+		if (samplesToNextMidiMessage > 0)
+		{
+			preVoiceRendering(startSample, samplesToNextMidiMessage);
+
+			if (!isChainDisabled(EffectChain)) 
+				effectChain->renderNextBlock(internalBuffer, startSample, samplesToNextMidiMessage);
+
+			startSample = eventPos;
+		}
+
+		// A note on only adds new voices, so the playing voices can keep on rendering. 
+		// If it steals or kills a voice, renderDeferredVoice() will be called for it.
+		if (m.isNoteOn())
+			deferredRenderPosition = startSample;
+		else
+			renderDeferredVoicesUntil(startSample);
+
+		handleHiseEvent(m);
+	}
+
+	if (startSample < numSamples)
+	{
+		preVoiceRendering(startSample, numSamples - startSample);
+
+		if (!isChainDisabled(EffectChain))
+			effectChain->renderNextBlock(internalBuffer, startSample, numSamples - startSample);
+	}
+
+	renderDeferredVoicesUntil(numSamples);
+
+	deferredRenderPosition = -1;
+
+	applyMonophonicGainModulation(0, numSamples);
+}
+
+void ModulatorSynth::renderDeferredVoicesUntil(int samplePosition)
+{
+	ADD_GLITCH_DETECTOR(this, DebugLogger::Location::SynthVoiceRendering);
+
+	deferredRenderPosition = samplePosition;
+
+	clearPendingRemoveVoices();
+
+	for (auto v : activeVoices)
+		renderDeferredVoice(v);
+
+	clearPendingRemoveVoices();
+}
+
+void ModulatorSynth::renderDeferredVoice(ModulatorSynthVoice* v)
+{
+	if (deferredRenderPosition < 0 || v->isInactive())
+		return;
+
+	const int startSample = v->getRenderPosition();
+	const int numThisTime = deferredRenderPosition - startSample;
+
+	if (numThisTime <= 0)
+		return;
+
+	// Set this before rendering so that a kill from within the voice callback doesn't end up here again
+	v->setRenderPosition(deferredRenderPosition);
+
+	calculateModulationValuesForVoice(v, startSample, numThisTime);
+	v->renderNextBlock(internalBuffer, startSample, numThisTime);
+}
+
 void ModulatorSynth::calculateModulationValuesForVoice(ModulatorSynthVoice * v, int startSample, int numThisTime)
 {
 	auto index = v->getVoiceIndex();
@@ -539,6 +636,13 @@ void ModulatorSynth::clearPendingRemoveVoices()
 }
 
 void ModulatorSynth::postVoiceRendering(int startSample, int numThisTime)
+{
+	applyMonophonicGainModulation(startSample, numThisTime);
+	
+	if (!isChainDisabled(EffectChain)) effectChain->renderNextBlock(internalBuffer, startSample, numThisTime);
+}
+
+void ModulatorSynth::applyMonophonicGainModulation(int startSample, int numThisTime)
 {
 	modChains[BasicChains::GainChain].expandMonophonicValuesToAudioRate(startSample, numThisTime);
 	auto monoValues = modChains[BasicChains::GainChain].getMonophonicModulationValues(startSample);
@@ -557,8 +661,6 @@ void ModulatorSynth::postVoiceRendering(int startSample, int numThisTime)
 			CHECK_AND_LOG_BUFFER_DATA_WITH_ID(this, getIDAsIdentifier(), DebugLogger::Location::SynthPostVoiceRendering, internalBuffer.getReadPointer(i, startSample), i % 2 != 0, numThisTime);
 		}
 	}
-	
-	if (!isChainDisabled(EffectChain)) effectChain->renderNextBlock(internalBuffer, startSample, numThisTime);
 }
 
 void ModulatorSynth::handlePeakDisplay(int numSamplesInOutputBuffer)
@@ -778,6 +880,9 @@ void ModulatorSynth::startVoiceWithHiseEvent(ModulatorSynthVoice* voice, Synthes
 
 	Synthesiser::startVoice(static_cast<SynthesiserVoice*>(voice), sound, e.getChannel(), e.getNoteNumber(), e.getFloatVelocity());
 
+	// Set this after the start so that a stolen voice renders its previous note up to the event position
+	voice->setRenderPosition(jmax<int>(0, deferredRenderPosition));
+
 	voice->saveStartUptimeDelta();
 }
 
@@ -855,6 +960,71 @@ void ModulatorSynth::prepareToPlay(double newSampleRate, int samplesPerBlock)
 }
 
 	
+int ModulatorSynth::calculateLatency()
+{
+	return calculateLatencyWithInput(0);
+}
+
+int ModulatorSynth::calculateLatencyWithInput(int inputLatency)
+{
+	Array<int> channelLatencies;
+
+	for (int i = 0; i < getMatrix().getNumSourceChannels(); i++)
+		channelLatencies.add(inputLatency);
+
+	effectChain->updateChannelLatencies(channelLatencies);
+
+	int maxLatency = 0;
+
+	for (auto l : channelLatencies)
+		maxLatency = jmax<int>(maxLatency, l);
+
+	outputLatencies.swapWith(channelLatencies);
+	latency = maxLatency;
+
+	return latency;
+}
+
+void ModulatorSynth::setLatencyCompensation(int targetLatency)
+{
+	WARN_IF_AUDIO_THREAD(true, MainController::KillStateHandler::IllegalOps::ProcessorInsertion);
+
+	ScopedPointer<LatencyCompensation> newCompensation;
+
+	for (int i = 0; i < outputLatencies.size(); i++)
+	{
+		const int delay = targetLatency - outputLatencies[i];
+
+		if (delay > 0)
+		{
+			if (newCompensation == nullptr)
+				newCompensation = new LatencyCompensation(outputLatencies.size());
+
+			newCompensation->setDelay(i, delay);
+		}
+	}
+
+	if (newCompensation == nullptr && latencyCompensation == nullptr)
+		return;
+
+	if (newCompensation != nullptr && latencyCompensation != nullptr)
+	{
+		bool changed = false;
+
+		for (int i = 0; i < outputLatencies.size(); i++)
+			changed |= newCompensation->getDelay(i) != latencyCompensation->getDelay(i);
+
+		// Keep the old delay lines so that the signal isn't interrupted
+		if (!changed)
+			return;
+	}
+
+	{
+		LOCK_PROCESSING_CHAIN(this);
+		latencyCompensation.swapWith(newCompensation);
+	}
+}
+
 void ModulatorSynth::numSourceChannelsChanged()
 {
 	ScopedLock sl(getMainController()->getLock());
@@ -875,6 +1045,10 @@ void ModulatorSynth::numSourceChannelsChanged()
 			rp->getMatrix().setNumDestinationChannels(getMatrix().getNumSourceChannels());
 		}
 	}
+
+	// The delay compensation needs one delay line per channel
+	if (auto root = getMainController()->getMainSynthChain())
+		root->triggerLatencyUpdate();
 }
 
 void ModulatorSynth::numDestinationChannelsChanged()
@@ -902,7 +1076,8 @@ void ModulatorSynth::softBypassStateChanged(bool isBypassedNow)
 {
 	bypassState.store(isBypassedNow);
 
-	
+	if (auto chain = dynamic_cast<ModulatorSynthChain*>(getParentProcessor(true, false)))
+		chain->compileRenderSchedule();
 }
 
 void ModulatorSynth::setSoftBypass(bool shouldBeBypassed, bool bypassFXToo)
@@ -1327,6 +1502,8 @@ void ModulatorSynthVoice::stopNote(float, bool)
 	LOG_SYNTH_EVENT("Stop Note for " + getOwnerSynth()->getId() + " with index " + String(voiceIndex));
     
 	ModulatorSynth *os = getOwnerSynth();
+	os->renderDeferredVoice(this);
+
 	isTailing = true;
 	os->preStopVoice(voiceIndex);
 	checkRelease();
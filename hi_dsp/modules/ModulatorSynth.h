@@ -171,6 +171,13 @@ public:
 
 	void calculateModulationValuesForVoice(ModulatorSynthVoice * v, int startSample, int numThisTime);;
 
+	/** Renders the voice up to the position of the event that is currently handled.
+	*
+	*	If the voices are rendered in deferred mode, this is called before the state of a playing voice 
+	*	changes (eg. if it's stolen or killed by a note on message). Otherwise it does nothing.
+	*/
+	void renderDeferredVoice(ModulatorSynthVoice* v);
+
 	void clearPendingRemoveVoices();
 
 	/** This method is called to handle all modulatorchains after the voice rendering and handles the GUI metering. It assumes stereo mode.
@@ -219,6 +226,24 @@ public:
 
 	// ===================================================================================================================
 
+	/** Returns the latency of this synth's output in samples (the maximum latency of all its output channels). */
+	int getLatency() const noexcept { return latency; }
+
+	/** Recalculates the latency of this synth (and its children) and returns the maximum latency of its output channels.
+	*
+	*	This is called on the message thread by the main synth chain whenever the latency of a module changes.
+	*/
+	virtual int calculateLatency();
+
+	/** Delays the output channels so that each one of them has the given latency.
+	*
+	*	The parent chain calls this to align its children, so they can be summed without phase issues.
+	*	This allocates and locks the audio thread briefly, so don't call it from the audio thread.
+	*/
+	void setLatencyCompensation(int targetLatency);
+
+	// ===================================================================================================================
+
 	void numSourceChannelsChanged() override;
 	void numDestinationChannelsChanged() override;
 
@@ -358,6 +383,9 @@ public:
 
 	const ModulatorSynth* getPlayingSynth() const;
 
+	/** Returns the controller messages of the current block. Synths in a group use the state of the group. */
+	const ControllerStateBuffer& getControllerState() const { return getPlayingSynth()->controllerState; }
+
 	/** Sets the interval for the internal clock callback. */
 	void setClockSpeed(ClockSpeed newClockSpeed)
 	{
@@ -446,6 +474,9 @@ public:
 	HiseEventBuffer eventBuffer;
 	AudioSampleBuffer internalBuffer;
 
+	/** The controller messages of the eventBuffer, decoded once for all modulators. */
+	ControllerStateBuffer controllerState;
+
 	UpdateMerger vuMerger;
 
 	AudioSampleBuffer pitchBuffer;
@@ -480,7 +511,19 @@ protected:
 
 	
 	void finaliseModChains();
+
+	/** Adds the latency of the master effects to the given input latency of all channels and returns the maximum. */
+	int calculateLatencyWithInput(int inputLatency);
+
+	/** Delays the channels with a lower latency than the synth's latency. Call this after the master effects. */
+	void applyLatencyCompensation(AudioSampleBuffer& b) noexcept
+	{
+		if (latencyCompensation != nullptr)
+			latencyCompensation->process(b);
+	}
 	
+	/** Override this and return false if the voices can't be rendered independently from the event positions. */
+	virtual bool supportsDeferredVoiceRendering() const { return true; }
 
 	bool finalised = false;
 
@@ -513,9 +556,28 @@ protected:
 private:
 
     void updateShouldHaveEnvelope();
+
+	/** Renders the block without splitting the voices at note on messages.
+	*
+	*	The monophonic modulation is still calculated between the events, but a playing voice is only
+	*	rendered in one go up to the next event that might change its state (note offs, controllers etc.), 
+	*	and new voices start rendering at their event position.
+	*/
+	void renderBlockWithDeferredVoices(HiseEventBuffer::Iterator& eventIterator, int numSamples);
+
+	void renderDeferredVoicesUntil(int samplePosition);
+
+	void applyMonophonicGainModulation(int startSample, int numThisTime);
 	
 	bool shouldHaveEnvelope = true;
 
+	// The position of the currently handled event if the voices are rendered in deferred mode (or -1)
+	int deferredRenderPosition = -1;
+
+	Array<int> outputLatencies;
+	int latency = 0;
+	ScopedPointer<LatencyCompensation> latencyCompensation;
+
 
 
 	int numActiveVoices;
@@ -706,6 +768,8 @@ public:
 	/** This kills the note with a short fade time. */
 	void killVoice()
 	{
+		getOwnerSynth()->renderDeferredVoice(this);
+
 		//stopNote(true);
 		killThisVoice = true;	
 	}
@@ -835,6 +899,11 @@ public:
 
 	void applyGainModulation(int startSample, int numSamples, bool copyLeftChannel);
 
+	/** The sample position in the current block up to which this voice was rendered (only used for deferred rendering). */
+	int getRenderPosition() const noexcept { return renderPosition; }
+
+	void setRenderPosition(int newRenderPosition) noexcept { renderPosition = newRenderPosition; }
+
 protected:
 
 	
@@ -891,6 +960,8 @@ private:
 	
 	double startUptime;
 
+	int renderPosition = 0;
+
 	ModulatorSynth* const ownerSynth;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulatorSynthVoice)
@@ -38,6 +38,7 @@ ModulatorSynthChain::ModulatorSynthChain(MainController *mc, const String &id, i
 #if USE_BACKEND
 	ViewManager(this, viewUndoManager),
 #endif
+	latencyUpdater(*this),
 	numVoices(numVoices_),
 	handler(this),
 	vuValue(0.0f)
@@ -125,7 +126,11 @@ void ModulatorSynthChain::prepareToPlay(double newSampleRate, int samplesPerBloc
 {
 	ModulatorSynth::prepareToPlay(newSampleRate, samplesPerBlock);
 
+	prepareMacroControls(newSampleRate);
+
 	for (int i = 0; i < synths.size(); i++) synths[i]->prepareToPlay(newSampleRate, samplesPerBlock);
+
+	compileRenderSchedule();
 }
 
 void ModulatorSynthChain::numSourceChannelsChanged()
@@ -160,6 +165,7 @@ ValueTree ModulatorSynthChain::exportAsValueTree() const
 	if (this == getMainController()->getMainSynthChain())
 	{
 		v.setProperty("packageName", packageName, nullptr);
+		v.setProperty("RandomSeed", (int64)getMainController()->getRandomNumberService().getProjectSeed(), nullptr);
 
 		MacroControlBroadcaster::saveMacrosToValueTree(v);
 
@@ -220,11 +226,15 @@ void ModulatorSynthChain::renderNextBlockWithModulators(AudioSampleBuffer &buffe
 
 	initRenderCallback();
 
+	processMacroSmoothing(numSamples);
+
 #if FRONTEND_IS_PLUGIN
 
 	effectChain->renderNextBlock(buffer, 0, numSamples);
 	effectChain->renderMasterEffects(buffer);
 
+	applyLatencyCompensation(buffer);
+
 	eventBuffer.clear();
 
 	processHiseEventBuffer(inputMidiBuffer, numSamples);
@@ -244,11 +254,8 @@ void ModulatorSynthChain::renderNextBlockWithModulators(AudioSampleBuffer &buffe
 	internalBuffer.setSize(getMatrix().getNumSourceChannels(), numSamples, true, false, true);
 
 	// Process the Synths and add store their output in the internal buffer
-	for (int i = 0; i < synths.size(); i++)
-    {
-        if (!synths[i]->isSoftBypassed())
-            synths[i]->renderNextBlockWithModulators(internalBuffer, eventBuffer);
-    }
+	for (auto s : renderSchedule)
+		s->renderNextBlockWithModulators(internalBuffer, eventBuffer);
 
 	HiseEventBuffer::Iterator eventIterator(eventBuffer);
 
@@ -268,6 +275,8 @@ void ModulatorSynthChain::renderNextBlockWithModulators(AudioSampleBuffer &buffe
 
 	effectChain->renderMasterEffects(internalBuffer);
 
+	applyLatencyCompensation(internalBuffer);
+
 	if (internalBuffer.getNumChannels() != 2)
 	{
 		jassert(internalBuffer.getNumChannels() == getMatrix().getNumSourceChannels());
@@ -319,6 +328,15 @@ void ModulatorSynthChain::restoreFromValueTree(const ValueTree &v)
 {
 	packageName = v.getProperty("packageName", "");
 
+	if (this == getMainController()->getMainSynthChain())
+	{
+		// Older projects don't have a seed, so we derive it from the project name
+		const int64 defaultSeed = (int64)RandomNumberService::getStreamId(v.getProperty("ID").toString());
+		const int64 seed = v.getProperty("RandomSeed", defaultSeed);
+
+		getMainController()->getRandomNumberService().setProjectSeed((uint64)seed);
+	}
+
 	ModulatorSynth::restoreFromValueTree(v);
 
 	if (!getMainController()->shouldSkipCompiling())
@@ -434,6 +452,111 @@ bool ModulatorSynthChain::areVoicesActive() const
 	return effectChain->hasTailingMasterEffects();
 }
 
+void ModulatorSynthChain::compileRenderSchedule()
+{
+	WARN_IF_AUDIO_THREAD(true, MainController::KillStateHandler::IllegalOps::ProcessorInsertion);
+
+	Array<ModulatorSynth*> newSchedule;
+	Array<WeakReference<Processor>> newSharedChildren;
+
+	newSchedule.ensureStorageAllocated(synths.size());
+
+	int numSharedChannels = 0;
+
+	for (auto s : synths)
+	{
+		if (s->isSoftBypassed())
+			continue;
+
+		newSchedule.add(s);
+
+		// A nested chain resizes its buffer in the audio callback, so it must keep its own memory
+		if (dynamic_cast<ModulatorSynthChain*>(s) == nullptr)
+		{
+			newSharedChildren.add(s);
+			numSharedChannels = jmax<int>(numSharedChannels, s->getMatrix().getNumSourceChannels());
+		}
+	}
+
+	const int numSamples = getLargestBlockSize();
+
+	ScopedPointer<AudioSampleBuffer> newSharedBuffer;
+
+	if (numSamples > 0 && numSharedChannels > 0)
+		newSharedBuffer = new AudioSampleBuffer(numSharedChannels, numSamples);
+	else
+		newSharedChildren.clear();
+
+	{
+		LOCK_PROCESSING_CHAIN(this);
+
+		for (auto p : childrenUsingSharedBuffer)
+		{
+			if (!newSharedChildren.contains(p))
+				detachFromSharedBuffer(dynamic_cast<ModulatorSynth*>(p.get()));
+		}
+
+		for (auto p : newSharedChildren)
+		{
+			auto s = static_cast<ModulatorSynth*>(p.get());
+
+			// The child render callback always leaves the buffer in a non-cleared state,
+			// so the clear() in initRenderCallback() won't be skipped for stale data of its siblings
+			s->internalBuffer.setDataToReferTo(newSharedBuffer->getArrayOfWritePointers(), s->getMatrix().getNumSourceChannels(), numSamples);
+		}
+
+		renderSchedule.swapWith(newSchedule);
+		childrenUsingSharedBuffer.swapWith(newSharedChildren);
+		sharedChildBuffer.swapWith(newSharedBuffer);
+	}
+
+	// Bypassed children don't contribute to the latency
+	if (auto root = getMainController()->getMainSynthChain())
+		root->triggerLatencyUpdate();
+}
+
+int ModulatorSynthChain::calculateLatency()
+{
+	int childLatency = 0;
+
+	for (auto s : synths)
+	{
+		const int l = s->calculateLatency();
+
+		if (!s->isSoftBypassed())
+			childLatency = jmax<int>(childLatency, l);
+	}
+
+	for (auto s : synths)
+		s->setLatencyCompensation(childLatency);
+
+	return calculateLatencyWithInput(childLatency);
+}
+
+void ModulatorSynthChain::updateLatencyCompensation()
+{
+	jassert(this == getMainController()->getMainSynthChain());
+
+	const int totalLatency = calculateLatency();
+
+	// The output channels of the main chain must be aligned too
+	setLatencyCompensation(totalLatency);
+
+	if (auto ap = dynamic_cast<AudioProcessor*>(getMainController()))
+		ap->setLatencySamples(getMainController()->getDelayedRenderer().getLatency() + totalLatency);
+}
+
+void ModulatorSynthChain::detachFromSharedBuffer(ModulatorSynth* s)
+{
+	if (s == nullptr || !childrenUsingSharedBuffer.contains(s))
+		return;
+
+	AudioSampleBuffer ownBuffer(s->getMatrix().getNumSourceChannels(), jmax<int>(0, getLargestBlockSize()));
+	ownBuffer.clear();
+
+	s->internalBuffer = std::move(ownBuffer);
+	childrenUsingSharedBuffer.removeAllInstancesOf(s);
+}
 
 void ModulatorSynthChain::saveInterfaceValues(ValueTree &v)
 {
@@ -549,6 +672,8 @@ void ModulatorSynthChain::ModulatorSynthChainHandler::add(Processor *newProcesso
 		synth->synths.insert(index, ms);
 	}
 
+	synth->compileRenderSchedule();
+
 	notifyListeners(Listener::ProcessorAdded, newProcessor);
 }
 
@@ -561,6 +686,8 @@ void ModulatorSynthChain::ModulatorSynthChainHandler::remove(Processor *processo
 	{
 		LOCK_PROCESSING_CHAIN(synth);
 		processorToBeRemoved->setIsOnAir(false);
+		synth->renderSchedule.removeAllInstancesOf(dynamic_cast<ModulatorSynth*>(processorToBeRemoved));
+		synth->detachFromSharedBuffer(dynamic_cast<ModulatorSynth*>(processorToBeRemoved));
 		synth->synths.removeObject(dynamic_cast<ModulatorSynth*>(processorToBeRemoved), false);
 	}
 
@@ -592,6 +719,8 @@ void ModulatorSynthChain::ModulatorSynthChainHandler::clear()
 
 	ScopedLock sl(synth->getMainController()->getLock());
 
+	synth->renderSchedule.clear();
+	synth->childrenUsingSharedBuffer.clear();
 	synth->synths.clear();
 }
 
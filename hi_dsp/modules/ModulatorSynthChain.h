@@ -188,6 +188,26 @@ public:
 
 	bool areVoicesActive() const override;
 
+	/** Rebuilds the flat list of child synths that are rendered in the audio callback.
+	*
+	*	Bypassed children are removed from the list, and the remaining direct children share a 
+	*	single render buffer (they are processed serially so their buffer lifetimes never overlap).
+	*	This is called automatically on structural changes. Don't call it from the audio thread.
+	*/
+	void compileRenderSchedule();
+
+	/** Aligns the children to the child with the highest latency and adds the latency of the master effects. */
+	int calculateLatency() override;
+
+	/** Recalculates the delay compensation of the whole module tree and reports the latency to the host.
+	*
+	*	Call this on the main synth chain. Don't call it from the audio thread, use triggerLatencyUpdate() instead.
+	*/
+	void updateLatencyCompensation();
+
+	/** Calls updateLatencyCompensation() asynchronously on the message thread. */
+	void triggerLatencyUpdate() { latencyUpdater.triggerAsyncUpdate(); }
+
 	/** Handles the ModulatorSynthChain. */
 	class ModulatorSynthChainHandler: public Chain::Handler
 	{
@@ -234,11 +254,29 @@ public:
 
 private:
 
+	/** Gives the synth its own render buffer if it was using the shared buffer of this chain. */
+	void detachFromSharedBuffer(ModulatorSynth* s);
+
+	struct LatencyUpdater : public AsyncUpdater
+	{
+		LatencyUpdater(ModulatorSynthChain& parent_) : parent(parent_) {};
+
+		void handleAsyncUpdate() override { parent.updateLatencyCompensation(); }
+
+		ModulatorSynthChain& parent;
+	};
+
+	LatencyUpdater latencyUpdater;
+
 	HiseEvent::ChannelFilterData activeChannels;
 	ModulatorSynthChainHandler handler;
 	int numVoices;
 	float vuValue;
 	OwnedArray<ModulatorSynth> synths;
+
+	Array<ModulatorSynth*> renderSchedule;
+	Array<WeakReference<Processor>> childrenUsingSharedBuffer;
+	ScopedPointer<AudioSampleBuffer> sharedChildBuffer;
 	ScopedPointer<FactoryType> modulatorSynthFactory;
 	ScopedPointer<FactoryType::Constrainer> constrainer;
 	String packageName;
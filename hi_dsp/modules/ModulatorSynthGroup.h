@@ -506,6 +506,9 @@ public:
 
 	void preVoiceRendering(int startSample, int numThisTime) override;;
 
+	/** The group voices render the child voices with the modulation of the current event fragment. */
+	bool supportsDeferredVoiceRendering() const override { return false; }
+
 	void handleRetriggeredNote(ModulatorSynthVoice *voice) override;
 
 	bool handleVoiceLimit(int numVoicesToClear) override;
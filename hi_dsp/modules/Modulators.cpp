@@ -178,6 +178,15 @@ void Modulator::setColour(Colour c)
 	}
 };;;
 
+void Modulator::connectToControllerState(ControllerStateBuffer::Reader& reader) const
+{
+	if (reader.isConnected())
+		return;
+
+	if (auto synth = dynamic_cast<const ModulatorSynth*>(getParentProcessor(true, false)))
+		reader.setState(&synth->getControllerState());
+}
+
 void TimeModulation::applyTimeModulation(float* destinationBuffer, int startIndex, int samplesToCopy)
 {
 	float *dest = destinationBuffer + startIndex;
@@ -320,6 +320,13 @@ public:
 
 	virtual Colour getColour() const override { return colour; };
 
+	/** Connects the reader to the controller state of the sound generator that processes the events for this modulator.
+	*
+	*	Call this in the rendering callback before reading. It only looks up the parent synth until it succeeds
+	*	(the modulator is prepared before it's added to its chain, so this can't be done in prepareToPlay()).
+	*/
+	void connectToControllerState(ControllerStateBuffer::Reader& reader) const;
+
 	
 
 	UpdateMerger editorUpdater;
@@ -27,6 +27,15 @@ bool DspBaseObject::getConstant(int index, char* text, size_t& size) const noexc
 bool DspBaseObject::getConstant(int index, float** data, int &size) noexcept		{ return false; }
 bool DspBaseObject::getConstant(int index, float& value) const noexcept				{ return false; }
 
+PolyDspBaseObject::PolyDspBaseObject() {}
+PolyDspBaseObject::~PolyDspBaseObject() {}
+
+void PolyDspBaseObject::stopVoice(void* voiceState) {}
+
+int PolyDspBaseObject::getSimdWidth() const		{ return 4; }
+int PolyDspBaseObject::getLatencySamples() const	{ return 0; }
+int PolyDspBaseObject::getTailSamples() const		{ return 0; }
+
 #pragma warning( pop )
 
 } // namespace hise
\ No newline at end of file
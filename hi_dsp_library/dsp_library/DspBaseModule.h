@@ -155,6 +155,9 @@ public:
 	*	@param data: a 'numChannels' sized-array of 'numSamples'-sized float arrays 
 	*	@param numChannels: the channel amount. This can be either '1' or '2', so you must handle both cases.
 	*	@param numSamples: the sample amount: this will be max. the amount specified in the last prepareToPlay() call.
+	*
+	*	If the host has parameter events for this block, it splits the block at their exact sample positions and calls
+	*	setParameter() between the sub blocks. A sub block can have any size and doesn't need to be aligned.
 	*/
 	virtual void processBlock(float **data, int numChannels, int numSamples) = 0;
 
@@ -241,6 +244,98 @@ public:
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DspBaseObject)
 };
 
+/** The version of the module API that this header defines.
+*
+*	Libraries export this number with getAbiVersion(). Libraries that were built before this function existed are treated
+*	as version 1, which means that they can only create DspBaseObject modules.
+*/
+#define HISE_DSP_ABI_VERSION 2
+
+/** A sample accurate parameter change that is passed to PolyDspBaseObject::processVoice().
+*
+*	This is a plain C struct so it can be passed across the library boundary.
+*/
+struct DspParameterEvent
+{
+	int timestamp;		 ///< the sample position of the change relative to the start of the block
+	int parameterIndex;  ///< the index of the parameter (see DspBaseObject::getNumParameters())
+	float value;		 ///< the new value
+};
+
+/** The data of a block that is rendered for a single voice.
+*
+*	Every channel pointer is aligned to PolyDspBaseObject::getSimdWidth() floats, so you can use aligned SIMD loads
+*	without checking the start of the buffer.
+*/
+struct DspVoiceBlock
+{
+	float** data;						///< a 'numChannels' sized array of 'numSamples' sized float arrays
+	int numChannels;					///< the channel amount (either '1' or '2')
+	int numSamples;						///< the sample amount (max. the block size from the last prepareToPlay() call)
+	const DspParameterEvent* events;	///< the parameter changes within this block sorted by their timestamp
+	int numEvents;						///< the amount of parameter changes
+};
+
+/** The base class for polyphonic modules (version 2 of the module API).
+*
+*	A polyphonic module doesn't store the state of its voices itself. Instead it tells the host how much memory
+*	one voice needs and the host passes a pointer to this memory to every voice callback. This way the module doesn't
+*	need to know the voice amount and the host can allocate all states in one aligned block:
+*
+*	- startVoice() is called when a voice starts and must initialise the state.
+*	- processVoice() renders the voice and applies the parameter events at their sample position.
+*	- stopVoice() is called when the voice is killed.
+*
+*	The parameters that are set with setParameter() are the global values that a new voice should start with. The
+*	parameter events that are passed to processVoice() only affect the voice that is rendered.
+*
+*	You still have to implement processBlock() (it will be used for the global, monophonic processing and by hosts that
+*	only support the first version of the API).
+*/
+class PolyDspBaseObject : public DspBaseObject
+{
+public:
+
+	// ================================================================================================================
+
+	PolyDspBaseObject();
+	virtual ~PolyDspBaseObject();
+
+	// ================================================================================================================
+
+	/** Return the size of the state of one voice in bytes. This must be a constant. */
+	virtual int getVoiceStateSize() const = 0;
+
+	/** Overwrite this method and initialise the state of a new voice.
+	*
+	*	@param voiceState: a pointer to 'getVoiceStateSize()' bytes aligned to getSimdWidth() floats.
+	*	@param noteNumber: the note number that started the voice.
+	*	@param velocity: the velocity of the note from 0.0 to 1.0.
+	*/
+	virtual void startVoice(void* voiceState, int noteNumber, float velocity) = 0;
+
+	/** This will be called when the voice is killed. The default implementation does nothing. */
+	virtual void stopVoice(void* voiceState);
+
+	/** Overwrite this method and render the voice with the given state. */
+	virtual void processVoice(void* voiceState, DspVoiceBlock& block) = 0;
+
+	// ================================================================================================================
+
+	/** Return the amount of floats that the buffers and voice states must be aligned to. The default is 4 (SSE). */
+	virtual int getSimdWidth() const;
+
+	/** Return the latency of the processing in samples. The default is zero. */
+	virtual int getLatencySamples() const;
+
+	/** Return the amount of samples that the module produces after the input became silent. The default is zero. */
+	virtual int getTailSamples() const;
+
+	// =================================================================================================================
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PolyDspBaseObject)
+};
+
 } // namespace hise
 
 #endif  // DSPBASEMODULE_H_INCLUDED
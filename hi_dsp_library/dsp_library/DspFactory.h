@@ -68,6 +68,12 @@ public:
 	/** This method is called by the DspInstance object's destructor to delete the module. */
 	virtual void destroyDspBaseObject(DspBaseObject *object) const = 0;
 
+	/** Returns the version of the module API that the modules of this factory implement. */
+	virtual int getAbiVersion() const { return 1; }
+
+	/** Returns the polyphonic interface of the module or nullptr if the module (or the factory) doesn't support it. */
+	virtual PolyDspBaseObject* getPolyphonicObject(DspBaseObject* /*object*/) const { return nullptr; }
+
 	/** This method must return an array with all module names that can be created. */
 	virtual var getModuleList() const = 0;
 
@@ -81,6 +87,9 @@ public:
 
 	Processor* currentProcessor = nullptr;
 
+	/** The amount of modules that got a random stream since the current processor loaded the library. */
+	int numRandomStreams = 0;
+
 	typedef ReferenceCountedObjectPtr<DspFactory> Ptr;
 };
 
@@ -106,6 +115,9 @@ public:
 	DspBaseObject *createDspBaseObject(const String &moduleName) const override;
 	void destroyDspBaseObject(DspBaseObject* handle) const override;
 
+	int getAbiVersion() const override { return HISE_DSP_ABI_VERSION; }
+	PolyDspBaseObject* getPolyphonicObject(DspBaseObject* object) const override { return dynamic_cast<PolyDspBaseObject*>(object); }
+
 	/** Overwrite this method and register every module you want to create with this factory using registerDspModule<Type>(). */
 	virtual void registerModules() = 0;
 
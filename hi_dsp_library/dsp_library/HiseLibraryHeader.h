@@ -140,6 +140,11 @@ Notice the const keyword when assigning a module. This allows faster code becaus
 
 That's it. Take a look at the DspBaseObject documentation on how to use the modules in Javascript.
 
+### Polyphonic modules
+
+If your module should process single voices with sample accurate parameter changes, subclass PolyDspBaseObject instead.
+Libraries that were built with an older version of this header can still be loaded, but their modules will be monophonic.
+
 ## Copyright
 
 This header (and its included files) are less restrictively licenced than the rest of the HISE codebase.
@@ -229,6 +234,15 @@ namespace InternalLibraryFunctions
 
 	/** Destroys the given module that was created using createDspObject(). */
 	DLL_EXPORT void destroyDspObject(DspBaseObject* handle);
+
+	/** Returns the version of the module API that this library was built with (HISE_DSP_ABI_VERSION). */
+	DLL_EXPORT int getAbiVersion();
+
+	/** Returns the polyphonic interface of the given module or nullptr if it is a monophonic module.
+	*
+	*	The cast is done inside the library, so the host doesn't rely on RTTI across the library boundary.
+	*/
+	DLL_EXPORT PolyDspBaseObject* getPolyphonicDspObject(DspBaseObject* handle);
 }
 
 
@@ -242,6 +256,10 @@ DLL_EXPORT DspBaseObject* InternalLibraryFunctions::createDspObject(const char *
 
 DLL_EXPORT void InternalLibraryFunctions::destroyDspObject(DspBaseObject* handle) {	delete handle; }
 
+DLL_EXPORT int InternalLibraryFunctions::getAbiVersion() { return HISE_DSP_ABI_VERSION; }
+
+DLL_EXPORT PolyDspBaseObject* InternalLibraryFunctions::getPolyphonicDspObject(DspBaseObject* handle) { return dynamic_cast<PolyDspBaseObject*>(handle); }
+
 
 /** Overwrite this method and register all modules that you want to create with this library
 *
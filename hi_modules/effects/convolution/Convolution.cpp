@@ -90,8 +90,11 @@ void ConvolutionEffect::createEngine(audiofft::ImplementationType fftType)
 		convolverL = nullptr;
 		convolverR = nullptr;
 
-		convolverL = new MultithreadedConvolver(fftType);
-		convolverR = new MultithreadedConvolver(fftType);
+		// The benchmark of BestAvailable might pick another implementation on every run, which would change the output
+		const auto engineType = fftType == audiofft::ImplementationType::BestAvailable ? audiofft::AudioFFT::getDefaultImplementation() : fftType;
+
+		convolverL = new MultithreadedConvolver(engineType);
+		convolverR = new MultithreadedConvolver(engineType);
 
 		convolverL->reset();
 		convolverR->reset();
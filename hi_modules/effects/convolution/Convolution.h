@@ -310,7 +310,7 @@ public:
 		Predelay, ///< delays the reverb tail by the given amount in milliseconds
 		HiCut, ///< applies a low pass filter to the impulse response
 		Damping, ///< applies a fade-out to the impulse response
-		FFTType, ///< the FFT implementation. It picks the best available but for some weird use cases you can force to use another one.
+		FFTType, ///< the FFT implementation. The default uses Apple Accelerate or IPP if available, otherwise Ooura (so renders don't depend on a benchmark), but for some weird use cases you can force to use another one.
 		numEffectParameters
 	};
 
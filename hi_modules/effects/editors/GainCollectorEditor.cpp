@@ -54,6 +54,16 @@ GainCollectorEditor::GainCollectorEditor (ProcessorEditor *pe)
     modeSelector->addItem (TRANS("Attack / Release"), 2);
     modeSelector->addListener (this);
 
+    addAndMakeVisible (detectorSelector = new HiComboBox ("new combo box"));
+    detectorSelector->setEditableText (false);
+    detectorSelector->setJustificationType (Justification::centredLeft);
+    detectorSelector->setTextWhenNothingSelected (TRANS("Detector"));
+    detectorSelector->setTextWhenNoChoicesAvailable (TRANS("(no choices)"));
+    detectorSelector->addItem (TRANS("Peak"), 1);
+    detectorSelector->addItem (TRANS("RMS"), 2);
+    detectorSelector->addItem (TRANS("LUFS"), 3);
+    detectorSelector->addListener (this);
+
     addAndMakeVisible (attackSlider = new HiSlider ("Mix"));
     attackSlider->setRange (0, 100, 1);
     attackSlider->setSliderStyle (Slider::RotaryHorizontalVerticalDrag);
@@ -81,6 +91,7 @@ GainCollectorEditor::GainCollectorEditor (ProcessorEditor *pe)
 	smoothSlider->setup(getProcessor(), GainCollector::Smoothing, "Smoothing Time");
 	smoothSlider->setMode(HiSlider::Time);
 	modeSelector->setup(getProcessor(), GainCollector::Mode, "Mode");
+	detectorSelector->setup(getProcessor(), GainCollector::Detector, "Detector");
 	attackSlider->setup(getProcessor(), GainCollector::Attack, "Attack Time");
 	attackSlider->setMode(HiSlider::Time);
 	releaseSlider->setup(getProcessor(), GainCollector::Release, "Release Time");
@@ -113,6 +124,7 @@ GainCollectorEditor::~GainCollectorEditor()
     smoothSlider = nullptr;
     gainMeter = nullptr;
     modeSelector = nullptr;
+    detectorSelector = nullptr;
     attackSlider = nullptr;
     releaseSlider = nullptr;
     label = nullptr;
@@ -146,6 +158,7 @@ void GainCollectorEditor::resized()
     smoothSlider->setBounds ((getWidth() / 2) + -162 - (128 / 2), 72, 128, 48);
     gainMeter->setBounds ((getWidth() / 2) + -242 - 40, 24, 40, 104);
     modeSelector->setBounds ((getWidth() / 2) + -231, 24, 128, 24);
+    detectorSelector->setBounds ((getWidth() / 2) + -95, 24, 128, 24);
     attackSlider->setBounds ((getWidth() / 2) + -10 - (128 / 2), 72, 128, 48);
     releaseSlider->setBounds ((getWidth() / 2) + 134 - (128 / 2), 72, 128, 48);
     label->setBounds ((getWidth() / 2) + 299 - 264, 6, 264, 40);
@@ -188,6 +201,11 @@ void GainCollectorEditor::comboBoxChanged (ComboBox* comboBoxThatHasChanged)
         //[UserComboBoxCode_modeSelector] -- add your combo box handling code here..
         //[/UserComboBoxCode_modeSelector]
     }
+    else if (comboBoxThatHasChanged == detectorSelector)
+    {
+        //[UserComboBoxCode_detectorSelector] -- add your combo box handling code here..
+        //[/UserComboBoxCode_detectorSelector]
+    }
 
     //[UsercomboBoxChanged_Post]
     //[/UsercomboBoxChanged_Post]
@@ -229,6 +247,10 @@ BEGIN_JUCER_METADATA
             virtualName="HiComboBox" explicitFocusOrder="0" pos="-231C 24 128 24"
             posRelativeX="3b242d8d6cab6cc3" editable="0" layout="33" items="Simple LP&#10;Attack / Release"
             textWhenNonSelected="Filter mode" textWhenNoItems="(no choices)"/>
+  <COMBOBOX name="new combo box" id="7c1e2f5b9a04d3e6" memberName="detectorSelector"
+            virtualName="HiComboBox" explicitFocusOrder="0" pos="-95C 24 128 24"
+            posRelativeX="3b242d8d6cab6cc3" editable="0" layout="33" items="Peak&#10;RMS&#10;LUFS"
+            textWhenNonSelected="Detector" textWhenNoItems="(no choices)"/>
   <SLIDER name="Mix" id="43cfb0cd079133bb" memberName="attackSlider" virtualName="HiSlider"
           explicitFocusOrder="0" pos="-10Cc 72 128 48" posRelativeX="f930000f86c6c8b6"
           min="0" max="100" int="1" style="RotaryHorizontalVerticalDrag"
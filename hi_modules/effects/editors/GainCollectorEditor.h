@@ -76,6 +76,7 @@ private:
     ScopedPointer<HiSlider> smoothSlider;
     ScopedPointer<VuMeter> gainMeter;
     ScopedPointer<HiComboBox> modeSelector;
+    ScopedPointer<HiComboBox> detectorSelector;
     ScopedPointer<HiSlider> attackSlider;
     ScopedPointer<HiSlider> releaseSlider;
     ScopedPointer<Label> label;
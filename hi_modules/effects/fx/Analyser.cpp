@@ -261,8 +261,6 @@ void FFTDisplay::paint(Graphics& g)
 {
 	g.fillAll(getColourForAnalyser(AudioAnalyserComponent::bgColour));
 
-#if USE_IPP
-    
 	auto an = getAnalyser();
 
 	ScopedReadLock sl(an->getBufferLock());
@@ -283,6 +281,9 @@ void FFTDisplay::paint(Graphics& g)
 		icstdsp::VectorFunctions::blackman(windowBuffer.getWritePointer(0), size);
 	}
 
+	if (fftPlan == nullptr || fftPlan->getSize() != size)
+		fftPlan = fftService->getPlan(size);
+
 	AudioSampleBuffer b2(2, b.getNumSamples());
 
 	auto data = b2.getWritePointer(0);
@@ -304,17 +305,15 @@ void FFTDisplay::paint(Graphics& g)
 	
 	auto sampleRate = getAnalyser()->getSampleRate();
 
-	fftObject.realFFTInplace(data, size);
+	// The second channel is used for the magnitudes of the bins
+	auto magnitudes = b2.getWritePointer(1);
 
-	for (int i = 2; i < size; i+= 2)
-	{
-		data[i] = sqrtf(data[i] * data[i] + data[i + 1] * data[i + 1]);
-		data[i + 1] = data[i];
-	}
+	fftPlan->forwardMagnitudes(data, magnitudes);
 
-	//fftObject.realFFT(b.getReadPointer(1), b2.getWritePointer(1), b2.getNumSamples());
+	// Every bin covers two values (the display code below expects the interleaved layout)
+	for (int i = 0; i < size; i++)
+		data[i] = magnitudes[i / 2];
 
-	FloatVectorOperations::abs(data, b2.getReadPointer(0), size);
 	FloatVectorOperations::multiply(data, 1.0f / 95.0f, size);
 	
 	int stride = roundToInt((float)size / getWidth());
@@ -407,14 +406,6 @@ void FFTDisplay::paint(Graphics& g)
 	
 	g.setColour(getColourForAnalyser(AudioAnalyserComponent::fillColour));
 	g.fillPath(lPath);
-    
-#else
-    
-    g.setColour(getColourForAnalyser(AudioAnalyserComponent::fillColour));
-    g.setFont(GLOBAL_BOLD_FONT());
-    g.drawText("You need IPP for the FFT Analyser", 0.0f, 0.0f, (float)getWidth(), (float)getHeight(), Justification::centred, false);
-    
-#endif
 }
 
 Component* AudioAnalyserComponent::Panel::createContentComponent(int index)
@@ -268,21 +268,15 @@ class FFTDisplay : public AudioAnalyserComponent
 public:
 
 	FFTDisplay(Processor* p) :
-#if USE_IPP
-        AudioAnalyserComponent(p),
-		fftObject(IppFFT::DataType::RealFloat)
-#else
-       AudioAnalyserComponent(p)
-#endif
+		AudioAnalyserComponent(p)
 	{};
 
 	void paint(Graphics& g) override;
 
 private:
 
-#if USE_IPP
-	IppFFT fftObject;
-#endif
+	SharedResourcePointer<FFTService> fftService;
+	FFTService::Plan::Ptr fftPlan;
 
 	Path lPath;
 	Path rPath;
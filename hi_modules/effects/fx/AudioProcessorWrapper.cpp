@@ -34,17 +34,31 @@ namespace hise { using namespace juce;
 
 AudioProcessorWrapper::AudioProcessorWrapper(MainController *mc, const String &uid):
 MasterEffectProcessor(mc, uid),
-wetAmountChain(new ModulatorChain(mc, "Wet Amount", 1, Modulation::GainMode, this)),
-wetAmountBuffer(1, 0),
+updater(*this),
+currentInstance(nullptr),
+nextInstance(nullptr),
+retiredInstance(nullptr),
 loadedProcessorId(Identifier("unused"))
 {
-    
+	modChains += {this, "Wet Amount"};
+
+	finaliseModChains();
+
+	modChains[InternalChains::WetAmountChain].setExpandToAudioRate(true);
+
+	editorStateIdentifiers.add("WetAmountChainShown");
 }
 
 
 
 AudioProcessorWrapper::~AudioProcessorWrapper()
 {
+	// A running job might restart the timer, so wait for it before stopping the timer
+	if (loaderPool != nullptr)
+		loaderPool->removeAllJobs(true, 5000);
+
+	updater.stopTimer();
+
 	for (int i = 0; i < connectedEditors.size(); i++)
 	{
 		if (connectedEditors[i].getComponent() != nullptr)
@@ -53,26 +67,44 @@ AudioProcessorWrapper::~AudioProcessorWrapper()
 		}
 	}
 
-	wrappedAudioProcessor = nullptr;
+	modChains.clear();
+
+	// The audio thread is not running anymore, so we can just delete every instance here
+	delete nextInstance.exchange(nullptr);
+	delete retiredInstance.exchange(nullptr);
+	delete activeInstance;
+	delete fadingInstance;
+
+	queuedInstance = nullptr;
+	instancesToDelete.clear();
 }
 
 void AudioProcessorWrapper::setInternalAttribute(int parameterIndex, float newValue)
 {
-	ScopedLock sl(wrapperLock);
-
-	if (wrappedAudioProcessor.get() != nullptr)
+	if (!isPositiveAndBelow(parameterIndex, (int)MaxNumParameters))
 	{
-		wrappedAudioProcessor->setParameter(parameterIndex, newValue);
+		jassertfalse;
+		return;
 	}
+
+	auto& slot = parameterSlots[parameterIndex];
+
+	slot.value.store(newValue);
+	slot.changed.store(true);
+	slot.pending.store(true);
+
+	parametersPending.store(true);
 }
 
 float AudioProcessorWrapper::getAttribute(int parameterIndex) const
 {
-	ScopedLock sl(wrapperLock);
+	// Report the value that will be applied, not the old one of the instance
+	if (isPositiveAndBelow(parameterIndex, (int)MaxNumParameters) && parameterSlots[parameterIndex].pending.load())
+		return parameterSlots[parameterIndex].value.load();
 
-	if (wrappedAudioProcessor.get() != nullptr)
+	if (auto p = currentInstance.load())
 	{
-		return wrappedAudioProcessor->getParameter(parameterIndex);
+		return p->getParameter(parameterIndex);
 	}
 	else
 	{
@@ -82,11 +114,9 @@ float AudioProcessorWrapper::getAttribute(int parameterIndex) const
 
 float AudioProcessorWrapper::getDefaultValue(int parameterIndex) const
 {
-	ScopedLock sl(wrapperLock);
-
-	if (wrappedAudioProcessor.get() != nullptr)
+	if (auto p = currentInstance.load())
 	{
-		return wrappedAudioProcessor->getParameterDefaultValue(parameterIndex);
+		return p->getParameterDefaultValue(parameterIndex);
 	}
 	else
 	{
@@ -100,15 +130,19 @@ void AudioProcessorWrapper::restoreFromValueTree(const ValueTree &v)
 
 	const Identifier processorId = Identifier(v.getProperty("AudioProcessorId", "unused").toString());
 
-	setAudioProcessor(processorId);
+	// The stored state contains the parameter values of the new instance
+	clearChangedParameters();
 
-	if (wrappedAudioProcessor != nullptr)
+	// We're already on a loading thread, so the instance can be created synchronously
+	if (auto p = createInstance(processorId))
 	{
 		MemoryBlock mb;
 
 		mb.fromBase64Encoding(v.getProperty("AudioProcessorData", "").toString());
 
-		wrappedAudioProcessor->setStateInformation(mb.getData(), (int)mb.getSize());
+		p->setStateInformation(mb.getData(), (int)mb.getSize());
+
+		queueInstance(p, processorId);
 	}
 }
 
@@ -116,13 +150,15 @@ ValueTree AudioProcessorWrapper::exportAsValueTree() const
 {
 	ValueTree v = MasterEffectProcessor::exportAsValueTree();
 
+	ScopedLock sl(instanceLock);
+
 	v.setProperty("AudioProcessorId", loadedProcessorId.toString(), nullptr);
 
-	if (wrappedAudioProcessor != nullptr)
+	if (auto p = currentInstance.load())
 	{
 		MemoryBlock mb;
 
-		wrappedAudioProcessor->getStateInformation(mb);
+		p->getStateInformation(mb);
 
 		const String dataAsString = mb.toBase64Encoding();
 
@@ -146,42 +182,140 @@ ProcessorEditorBody * AudioProcessorWrapper::createEditor(ProcessorEditor *paren
 void AudioProcessorWrapper::applyEffect(AudioSampleBuffer &buffer, int startSample, int numSamples)
 {
 	jassert(startSample == 0);
+	jassert(numSamples <= fadeBuffer.getNumSamples());
 
 	ignoreUnused(startSample);
 
-	ScopedLock sl(wrapperLock);
+	const bool crossfade = swapInstances();
 
-	MidiBuffer messages;
+	applyPendingParameterChanges();
 
-	if (wrappedAudioProcessor != nullptr)
+	if (crossfade)
 	{
-		if (!wetAmountChain->isBypassed() && wetAmountChain->getNumChildProcessors() != 0)
+		AudioSampleBuffer fadeOutBuffer(fadeBuffer.getArrayOfWritePointers(), 2, numSamples);
+
+		fadeOutBuffer.copyFrom(0, 0, buffer, 0, 0, numSamples);
+		fadeOutBuffer.copyFrom(1, 0, buffer, 1, 0, numSamples);
+
+		processInstance(fadingInstance, fadeOutBuffer);
+		processInstance(activeInstance, buffer);
+
+		for (int i = 0; i < 2; i++)
 		{
-			
+			buffer.applyGainRamp(i, 0, numSamples, 0.0f, 1.0f);
+			buffer.addFromWithRamp(i, 0, fadeOutBuffer.getReadPointer(i), numSamples, 1.0f, 0.0f);
+		}
+	}
+	else
+	{
+		processInstance(activeInstance, buffer);
+	}
+}
 
-			FloatVectorOperations::copy(tempBuffer.getWritePointer(0), buffer.getReadPointer(0), numSamples);
-			FloatVectorOperations::copy(tempBuffer.getWritePointer(1), buffer.getReadPointer(1), numSamples);
+bool AudioProcessorWrapper::swapInstances() noexcept
+{
+	if (fadingInstance != nullptr)
+	{
+		AudioProcessor* expected = nullptr;
 
-			wrappedAudioProcessor->processBlock(tempBuffer, messages);
+		// The message thread hasn't collected the last retired instance yet, so we have to wait with the next swap
+		if (!retiredInstance.compare_exchange_strong(expected, fadingInstance))
+			return false;
 
-			float *modValues = wetAmountBuffer.getWritePointer(0);
+		fadingInstance = nullptr;
+	}
 
-			FloatVectorOperations::multiply(tempBuffer.getWritePointer(0), modValues, numSamples);
-			FloatVectorOperations::multiply(tempBuffer.getWritePointer(1), modValues, numSamples);
+	if (auto next = nextInstance.exchange(nullptr))
+	{
+		fadingInstance = activeInstance;
+		activeInstance = next;
 
-			FloatVectorOperations::multiply(modValues, -1.0f, numSamples);
-			FloatVectorOperations::add(modValues, 1.0f, numSamples);
+		return true;
+	}
 
-			FloatVectorOperations::multiply(buffer.getWritePointer(0), modValues, numSamples);
-			FloatVectorOperations::multiply(buffer.getWritePointer(1), modValues, numSamples);
+	return false;
+}
 
-			FloatVectorOperations::add(buffer.getWritePointer(0), tempBuffer.getReadPointer(0), numSamples);
-			FloatVectorOperations::add(buffer.getWritePointer(1), tempBuffer.getReadPointer(1), numSamples);
-		}
+void AudioProcessorWrapper::applyPendingParameterChanges() noexcept
+{
+	// Keep the changes until there is an instance to apply them to
+	if (activeInstance == nullptr || !parametersPending.exchange(false))
+		return;
+
+	const int numParameters = jmin<int>(MaxNumParameters, activeInstance->getNumParameters());
+
+	for (int i = 0; i < numParameters; i++)
+	{
+		auto& slot = parameterSlots[i];
+
+		if (slot.pending.exchange(false))
+			activeInstance->setParameter(i, slot.value.load());
+	}
+}
+
+void AudioProcessorWrapper::applyChangedParameters(AudioProcessor* p)
+{
+	if (p == nullptr)
+		return;
+
+	const int numParameters = jmin<int>(MaxNumParameters, p->getNumParameters());
+
+	for (int i = 0; i < numParameters; i++)
+	{
+		auto& slot = parameterSlots[i];
+
+		if (slot.changed.load())
+			p->setParameter(i, slot.value.load());
+	}
+}
+
+void AudioProcessorWrapper::clearChangedParameters()
+{
+	for (auto& slot : parameterSlots)
+		slot.changed.store(false);
+}
+
+void AudioProcessorWrapper::processInstance(AudioProcessor* p, AudioSampleBuffer& b)
+{
+	// A null instance just passes the dry signal (this is used when fading in the first instance)
+	if (p == nullptr)
+		return;
+
+	auto& wetChain = modChains[InternalChains::WetAmountChain];
+
+	const int numSamples = b.getNumSamples();
+	auto modValues = wetChain.getReadPointerForVoiceValues(0);
+	const float constantWet = wetChain.getConstantModulationValue();
+
+	if (modValues == nullptr && constantWet == 1.0f)
+	{
+		p->processBlock(b, midiBuffer);
+		midiBuffer.clear();
+		return;
+	}
+
+	AudioSampleBuffer dry(tempBuffer.getArrayOfWritePointers(), 2, numSamples);
+
+	dry.copyFrom(0, 0, b, 0, 0, numSamples);
+	dry.copyFrom(1, 0, b, 1, 0, numSamples);
+
+	p->processBlock(b, midiBuffer);
+	midiBuffer.clear();
+
+	for (int i = 0; i < 2; i++)
+	{
+		float* wet = b.getWritePointer(i);
+		const float* d = dry.getReadPointer(i);
+
+		// wet * amount + dry * (1 - amount) == dry + (wet - dry) * amount
+		FloatVectorOperations::subtract(wet, d, numSamples);
+
+		if (modValues != nullptr)
+			FloatVectorOperations::multiply(wet, modValues, numSamples);
 		else
-		{
-			wrappedAudioProcessor->processBlock(buffer, messages);
-		}
+			FloatVectorOperations::multiply(wet, constantWet, numSamples);
+
+		FloatVectorOperations::add(wet, d, numSamples);
 	}
 }
 
@@ -189,14 +323,22 @@ void AudioProcessorWrapper::prepareToPlay(double sampleRate, int samplesPerBlock
 {
 	MasterEffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
 
-	ScopedLock sl(wrapperLock);
+	if (sampleRate <= 0.0 || samplesPerBlock <= 0)
+		return;
+
+	// The audio thread is suspended during this call, so we can access its instances here
+	prepareInstance(activeInstance);
+	prepareInstance(fadingInstance);
+	prepareInstance(nextInstance.load());
 
-	if (wrappedAudioProcessor != nullptr)
 	{
-		wrappedAudioProcessor->prepareToPlay(sampleRate, samplesPerBlock);
+		ScopedLock sl(instanceLock);
+		prepareInstance(queuedInstance.get());
 	}
 
-	tempBuffer = AudioSampleBuffer(2, samplesPerBlock);
+	tempBuffer.setSize(2, samplesPerBlock);
+	fadeBuffer.setSize(2, samplesPerBlock);
+	midiBuffer.ensureSize(512);
 }
 
 void AudioProcessorWrapper::addAudioProcessorToList(const Identifier id, createAudioProcessorFunction *function)
@@ -213,42 +355,139 @@ void AudioProcessorWrapper::addAudioProcessorToList(const Identifier id, createA
 
 void AudioProcessorWrapper::setAudioProcessor(const Identifier& processorId)
 {
-	ScopedLock sl(wrapperLock);
+	if (processorId.isNull())
+		return;
+
+	ScopedLock sl(instanceLock);
+
+	// The changes that are made from now on will be applied to the new instance
+	clearChangedParameters();
+
+	if (loaderPool == nullptr)
+		loaderPool = new ThreadPool(1);
+
+	loaderPool->addJob(new LoadJob(*this, processorId), true);
+}
 
+AudioProcessor* AudioProcessorWrapper::createInstance(const Identifier& processorId) const
+{
 	for (int i = 0; i < numRegisteredProcessors; i++)
 	{
 		if (!processorId.isNull() && registeredAudioProcessors[i].id == processorId)
 		{
-			wrappedAudioProcessor = nullptr;
-
 			createAudioProcessorFunction *createProcessor = registeredAudioProcessors[i].function;
 
-			wrappedAudioProcessor = (*createProcessor)();
-
-			if (wrappedAudioProcessor != nullptr)
+			if (auto p = (*createProcessor)())
 			{
-				if (getSampleRate() > 0.0)
-				{
-					wrappedAudioProcessor->prepareToPlay(getSampleRate(), getLargestBlockSize());
-				}
-
-				loadedProcessorId = processorId;
-
-				for (int j = 0; j < connectedEditors.size(); j++)
-				{
-					if (connectedEditors[j].getComponent() != nullptr)
-					{
-						dynamic_cast<WrappedAudioProcessorEditorContent*>(connectedEditors[j].getComponent())->setAudioProcessor(wrappedAudioProcessor);
-					}
-					else
-					{
-						connectedEditors.remove(j);
-						j--;
-					}
-				}
+				prepareInstance(p);
+				return p;
 			}
 		}
 	}
+
+	return nullptr;
+}
+
+void AudioProcessorWrapper::prepareInstance(AudioProcessor* p) const
+{
+	if (p == nullptr || getSampleRate() <= 0.0)
+		return;
+
+	if (p->getSampleRate() == getSampleRate() && p->getBlockSize() == getLargestBlockSize())
+		return;
+
+	p->setPlayConfigDetails(2, 2, getSampleRate(), getLargestBlockSize());
+	p->prepareToPlay(getSampleRate(), getLargestBlockSize());
+}
+
+void AudioProcessorWrapper::queueInstance(AudioProcessor* p, const Identifier& processorId)
+{
+	jassert(p != nullptr);
+
+	{
+		ScopedLock sl(instanceLock);
+
+		// An instance that was never handed over might still be displayed, so it's deleted in the timer callback
+		if (queuedInstance != nullptr)
+			instancesToDelete.add(queuedInstance.release());
+
+		// The instance isn't visible to the audio thread yet, so apply the changes that were made while it was loading
+		applyChangedParameters(p);
+
+		queuedInstance = p;
+		currentInstance.store(p);
+		loadedProcessorId = processorId;
+		editorsNeedUpdate = true;
+	}
+
+	updater.startTimer(30);
+
+	sendLatencyChangeMessage();
+}
+
+void AudioProcessorWrapper::refreshEditors()
+{
+	auto p = currentInstance.load();
+
+	for (int j = 0; j < connectedEditors.size(); j++)
+	{
+		if (connectedEditors[j].getComponent() != nullptr)
+		{
+			dynamic_cast<WrappedAudioProcessorEditorContent*>(connectedEditors[j].getComponent())->setAudioProcessor(p);
+		}
+		else
+		{
+			connectedEditors.remove(j);
+			j--;
+		}
+	}
+}
+
+ThreadPoolJob::JobStatus AudioProcessorWrapper::LoadJob::runJob()
+{
+	if (auto p = parent.createInstance(id))
+		parent.queueInstance(p, id);
+
+	return jobHasFinished;
+}
+
+void AudioProcessorWrapper::InstanceUpdater::timerCallback()
+{
+	OwnedArray<AudioProcessor> deleteList;
+	bool updateEditors = false;
+
+	{
+		ScopedLock sl(parent.instanceLock);
+
+		if (parent.queuedInstance != nullptr)
+		{
+			// The playback settings might have changed while the instance was waiting
+			parent.prepareInstance(parent.queuedInstance);
+
+			// Apply the changes that the audio thread might have delivered to the old instance
+			parent.applyChangedParameters(parent.queuedInstance);
+
+			// Take back an instance that the audio thread didn't pick up yet (eg. because it is suspended)
+			if (auto stale = parent.nextInstance.exchange(nullptr))
+				parent.instancesToDelete.add(stale);
+
+			parent.nextInstance.store(parent.queuedInstance.release());
+		}
+
+		if (auto retired = parent.retiredInstance.exchange(nullptr))
+			parent.instancesToDelete.add(retired);
+
+		deleteList.swapWith(parent.instancesToDelete);
+
+		updateEditors = parent.editorsNeedUpdate;
+		parent.editorsNeedUpdate = false;
+	}
+
+	// Update the editors before deleting the instances they might be pointing to
+	if (updateEditors)
+		parent.refreshEditors();
+
+	deleteList.clear();
 }
 
 AudioProcessorWrapper::ListEntry AudioProcessorWrapper::registeredAudioProcessors[1024];
@@ -38,7 +38,7 @@ namespace hise { using namespace juce;
 
 typedef AudioProcessor *(createAudioProcessorFunction)();
 
-/** This module is a wrapper for the general purpose AudioProcessor class from JUCE (non-functional at the moment).
+/** This module is a wrapper for the general purpose AudioProcessor class from JUCE.
 	@ingroup effects
 *
 *	This allows to embed other plugin code directly into HISE.
@@ -46,6 +46,15 @@ typedef AudioProcessor *(createAudioProcessorFunction)();
 *	by calling AudioProcessorWrapper::addAudioProcessorToList("YourAudioProcessorIdentifier", &yourCreateAudioProcessorFunction);
 *
 *	The editor of your plugin will be automatically created. You can even display one in your scripted interface using "Content.addAudioProcessorEditor("id");"
+*
+*	The audio thread never waits for a lock in this class:
+*
+*	- parameter changes are stored in a fixed slot per parameter and applied to the wrapped processor at the start of
+*	  the next block, so multiple changes of the same parameter are coalesced. Changes that were made after a new
+*	  processor was requested are also applied to the new instance before it's handed over.
+*	- a new processor instance is created and prepared on a background thread and handed over to the audio thread, which
+*	  crossfades from the old instance to the new one during the next block.
+*	- the old instance is handed back to the message thread and deleted there after the editors have been updated.
 */
 class AudioProcessorWrapper : public MasterEffectProcessor
 {
@@ -78,8 +87,8 @@ public:
 
 	bool hasTail() const override { return false; };
 
-	Processor *getChildProcessor(int /*processorIndex*/) override { return wetAmountChain; };
-	const Processor *getChildProcessor(int /*processorIndex*/) const override { return wetAmountChain; };
+	Processor *getChildProcessor(int processorIndex) override { return modChains[processorIndex].getChain(); };
+	const Processor *getChildProcessor(int processorIndex) const override { return modChains[processorIndex].getChain(); };
 	int getNumInternalChains() const override { return numInternalChains; };
 	int getNumChildProcessors() const override { return numInternalChains; };
 
@@ -90,16 +99,26 @@ public:
 
 	static void addAudioProcessorToList(const Identifier id, createAudioProcessorFunction *function);
 
-
+	/** Returns the most recently loaded processor instance. 
+	*
+	*	This might not be the instance that is currently processed by the audio thread if the swap is still pending.
+	*/
 	AudioProcessor *getWrappedAudioProcessor()
 	{
-		return wrappedAudioProcessor.get();
+		return currentInstance.load();
 	}
 
     const AudioProcessor *getWrappedAudioProcessor() const
     {
-        return wrappedAudioProcessor.get();
+        return currentInstance.load();
     }
+
+	/** Returns the latency of the loaded processor instance in samples. */
+	int getLatency() const override
+	{
+		auto p = currentInstance.load();
+		return p != nullptr ? p->getLatencySamples() : 0;
+	}
     
 	/** Returns a list of all registered processors. */
 	static StringArray getRegisteredProcessorList()
@@ -114,7 +133,7 @@ public:
 		return sa;
 	}
 
-	/** Loads a registered AudioProcessor and starts processing it. */
+	/** Loads a registered AudioProcessor on a background thread and crossfades to it once it's ready. */
 	void setAudioProcessor(const Identifier& processorId);
 
 	void addEditor(Component *editor)
@@ -145,17 +164,92 @@ public:
 
 private:
 
-	CriticalSection wrapperLock;
+	/** The number of parameters of the wrapped processor that can be set with setAttribute(). */
+	static constexpr int MaxNumParameters = 1024;
 
-	ScopedPointer<AudioProcessor> wrappedAudioProcessor;
+	struct ParameterSlot
+	{
+		std::atomic<float> value { 0.0f };
+		std::atomic<bool> pending { false }; ///< not yet applied by the audio thread
+		std::atomic<bool> changed { false }; ///< set since the last processor was requested
+	};
 
-	Identifier loadedProcessorId;
+	class LoadJob : public ThreadPoolJob
+	{
+	public:
+
+		LoadJob(AudioProcessorWrapper& parent_, const Identifier& id_) :
+			ThreadPoolJob("Load " + id_.toString()),
+			parent(parent_),
+			id(id_)
+		{}
+
+		JobStatus runJob() override;
+
+	private:
+
+		AudioProcessorWrapper& parent;
+		const Identifier id;
+	};
+
+	/** Hands the queued instance over to the audio thread and deletes retired instances on the message thread. */
+	struct InstanceUpdater : public Timer
+	{
+		InstanceUpdater(AudioProcessorWrapper& parent_) : parent(parent_) {};
+
+		void timerCallback() override;
+
+		AudioProcessorWrapper& parent;
+	};
+
+	/** Creates and prepares a new instance. This must not be called on the audio thread. */
+	AudioProcessor* createInstance(const Identifier& processorId) const;
+
+	/** Prepares the instance with the current playback settings. */
+	void prepareInstance(AudioProcessor* p) const;
+
+	/** Queues the instance for the audio thread and makes it the current instance. */
+	void queueInstance(AudioProcessor* p, const Identifier& processorId);
+
+	void refreshEditors();
+
+	/** Picks up a new instance on the audio thread. Returns true if the block needs to be crossfaded. */
+	bool swapInstances() noexcept;
 
-	ScopedPointer<ModulatorChain> wetAmountChain;
+	void applyPendingParameterChanges() noexcept;
 
-	AudioSampleBuffer wetAmountBuffer;
+	/** Applies every parameter that was changed since the processor was requested to the instance before it's handed over. */
+	void applyChangedParameters(AudioProcessor* p);
+
+	/** Forgets the parameter changes (call this when a new processor is requested). */
+	void clearChangedParameters();
+
+	void processInstance(AudioProcessor* p, AudioSampleBuffer& b);
+
+	// Used by non-realtime threads only
+	CriticalSection instanceLock;
+	ScopedPointer<AudioProcessor> queuedInstance;
+	OwnedArray<AudioProcessor> instancesToDelete;
+	ScopedPointer<ThreadPool> loaderPool;
+	InstanceUpdater updater;
+	bool editorsNeedUpdate = false;
+
+	std::atomic<AudioProcessor*> currentInstance;
+	std::atomic<AudioProcessor*> nextInstance;
+	std::atomic<AudioProcessor*> retiredInstance;
+
+	// Used by the audio thread only
+	AudioProcessor* activeInstance = nullptr;
+	AudioProcessor* fadingInstance = nullptr;
+
+	ParameterSlot parameterSlots[MaxNumParameters];
+	std::atomic<bool> parametersPending { false };
+
+	Identifier loadedProcessorId;
 
 	AudioSampleBuffer tempBuffer;
+	AudioSampleBuffer fadeBuffer;
+	MidiBuffer midiBuffer;
 
 	Array<Component::SafePointer<Component>> connectedEditors;
 
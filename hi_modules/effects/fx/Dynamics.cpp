@@ -10,16 +10,323 @@
 
 namespace hise { using namespace juce;
 
+BlockDynamics::BlockDynamics()
+{
+	lookaheadBuffer.calloc(2 * (MaxLookahead + 1 + BlockSize));
+
+	setSampleRate(44100.0);
+
+	// Same defaults as the chunkware classes
+	setAttack(Gate, 1.0);
+	setRelease(Gate, 100.0);
+	setAttack(Compressor, 10.0);
+	setRelease(Compressor, 100.0);
+	setAttack(Limiter, 1.0);
+	setRelease(Limiter, 10.0);
+
+	reset();
+}
+
+void BlockDynamics::setSampleRate(double newSampleRate)
+{
+	sampleRate = newSampleRate;
+
+	for (int i = 0; i < numStages; i++)
+	{
+		setAttack((Stage)i, stages[i].attack.ms);
+		setRelease((Stage)i, stages[i].release.ms);
+	}
+}
+
+void BlockDynamics::reset()
+{
+	resetEnvelopes();
+
+	writeIndex = 0;
+	FloatVectorOperations::clear(lookaheadBuffer, 2 * (MaxLookahead + 1 + BlockSize));
+}
+
+void BlockDynamics::resetEnvelopes()
+{
+	stages[Gate].state = chunkware_simple::DC_OFFSET;
+	stages[Compressor].state = chunkware_simple::DC_OFFSET;
+	stages[Limiter].state = stages[Limiter].threshold;
+
+	peakTimer = 0;
+	maxPeak = stages[Limiter].threshold;
+}
+
+int BlockDynamics::getTailLength() const noexcept
+{
+	double maxReleaseMs = 0.0;
+
+	for (const auto& s : stages)
+	{
+		if (s.enabled)
+			maxReleaseMs = jmax(maxReleaseMs, s.release.ms);
+	}
+
+	return getLatency() + (int)std::ceil(0.001 * maxReleaseMs * sampleRate);
+}
+
+void BlockDynamics::setEnabled(Stage s, bool shouldBeEnabled)
+{
+	if (s == Limiter && shouldBeEnabled != stages[Limiter].enabled)
+		limiterFadePending = true;
+
+	stages[s].enabled = shouldBeEnabled;
+}
+
+void BlockDynamics::setThreshold(Stage s, double newThresholdDb)
+{
+	stages[s].thresholdDb = newThresholdDb;
+	stages[s].threshold = chunkware_simple::dB2lin(newThresholdDb);
+}
+
+void BlockDynamics::setAttack(Stage s, double attackMs)
+{
+	if (s == Limiter)
+	{
+		attackMs = jmax(0.02, attackMs);
+		lookahead = jmin(MaxLookahead, (int)(0.001 * attackMs * sampleRate));
+	}
+
+	stages[s].attack.setTime(attackMs, sampleRate, s == Limiter);
+}
+
+void BlockDynamics::setRelease(Stage s, double releaseMs)
+{
+	stages[s].release.setTime(releaseMs, sampleRate, s == Limiter);
+}
+
+void BlockDynamics::Envelope::setTime(double newMs, double sampleRate, bool fastEnvelope)
+{
+	ms = jmax(0.01, newMs);
+	fast = fastEnvelope;
+
+	// The limiter uses the faster coefficient of chunkware's FastEnvelope
+	coef = fast ? pow(0.01, 1000.0 / (ms * sampleRate)) : exp(-1000.0 / (ms * sampleRate));
+}
+
+void BlockDynamics::process(float* l, float* r, int numSamples, const float* externalKey)
+{
+	while (numSamples > 0)
+	{
+		const int numThisTime = jmin(numSamples, (int)BlockSize);
+
+		processBlock(l, r, numThisTime, externalKey);
+
+		l += numThisTime;
+		r += numThisTime;
+		numSamples -= numThisTime;
+
+		if (externalKey != nullptr)
+			externalKey += numThisTime;
+	}
+}
+
+void BlockDynamics::processBlock(float* l, float* r, int numSamples, const float* externalKey)
+{
+	using namespace chunkware_simple;
+
+	float key[BlockSize];
+	float gain[BlockSize];
+
+	if (externalKey != nullptr)
+	{
+		FloatVectorOperations::copy(key, externalKey, numSamples);
+	}
+	else
+	{
+		// stereo linked sidechain key
+		FloatVectorOperations::abs(key, l, numSamples);
+		FloatVectorOperations::abs(gain, r, numSamples);
+		FloatVectorOperations::max(key, key, gain, numSamples);
+	}
+
+	auto& gate = stages[Gate];
+	auto& comp = stages[Compressor];
+	auto& limiter = stages[Limiter];
+
+	if (gate.enabled || comp.enabled)
+	{
+		const double compressorThresholdWithOffset = comp.threshold - DC_OFFSET;
+		const double compressorMakeup = comp.enabled ? (double)comp.makeupGain : 1.0;
+
+		gate.blockMax = 0.0f;
+		comp.blockMax = 0.0f;
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			double g = 1.0;
+
+			if (gate.enabled)
+			{
+				const double over = (key[i] > gate.threshold ? 1.0 : 0.0) + DC_OFFSET;
+				gate.state = over + (over > gate.state ? gate.attack.coef : gate.release.coef) * (gate.state - over);
+				g = gate.state - DC_OFFSET;
+
+				gate.blockMax = jmax(gate.blockMax, (float)g);
+			}
+
+			if (comp.enabled)
+			{
+				const double k = (double)key[i] * g;
+
+				// Skip the logarithm if the key is below the threshold
+				double overDb = k > compressorThresholdWithOffset ? lin2dB(k + DC_OFFSET) - comp.thresholdDb : 0.0;
+
+				overDb = jmax(0.0, overDb) + DC_OFFSET;
+				comp.state = overDb + (overDb > comp.state ? comp.attack.coef : comp.release.coef) * (comp.state - overDb);
+				overDb = comp.state - DC_OFFSET;
+
+				// The envelope never reaches zero, but this is less than 0.0001dB
+				const double compressorGain = overDb > 1e-5 ? dB2lin(overDb * (ratio - 1.0)) : 1.0;
+
+				comp.blockMax = jmax(comp.blockMax, (float)compressorGain);
+
+				g *= compressorGain * compressorMakeup;
+			}
+
+			gain[i] = (float)g;
+		}
+
+		FloatVectorOperations::multiply(l, gain, numSamples);
+		FloatVectorOperations::multiply(r, gain, numSamples);
+
+		if (limiter.enabled || limiterFadePending)
+			FloatVectorOperations::multiply(key, gain, numSamples);
+
+		if (gate.enabled)
+			updateMeter(gate, numSamples);
+
+		if (comp.enabled)
+			updateMeter(comp, numSamples);
+	}
+
+	if (limiterFadePending)
+	{
+		float dry[2][BlockSize];
+
+		FloatVectorOperations::copy(dry[0], l, numSamples);
+		FloatVectorOperations::copy(dry[1], r, numSamples);
+
+		if (!limiterActive)
+		{
+			limiter.state = limiter.threshold;
+			maxPeak = limiter.threshold;
+			peakTimer = 0;
+		}
+
+		processLimiter(l, r, key, numSamples);
+
+		// Crossfade between the dry and the limited signal
+		const float wetStart = limiter.enabled ? 0.0f : 1.0f;
+		const float delta = (1.0f - 2.0f * wetStart) / (float)numSamples;
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			const float wet = wetStart + delta * (float)i;
+
+			l[i] = wet * l[i] + (1.0f - wet) * dry[0][i];
+			r[i] = wet * r[i] + (1.0f - wet) * dry[1][i];
+		}
+
+		limiterActive = limiter.enabled;
+		limiterFadePending = false;
+	}
+	else if (limiter.enabled)
+	{
+		processLimiter(l, r, key, numSamples);
+	}
+	else
+	{
+		// Keep the lookahead buffer running so that enabling the limiter doesn't play old samples
+		const int size = MaxLookahead + 1 + BlockSize;
+		const int numBeforeWrap = jmin(numSamples, size - writeIndex);
+
+		for (int c = 0; c < 2; c++)
+		{
+			float* d = lookaheadBuffer + c * size;
+			const float* src = c == 0 ? l : r;
+
+			FloatVectorOperations::copy(d + writeIndex, src, numBeforeWrap);
+			FloatVectorOperations::copy(d, src + numBeforeWrap, numSamples - numBeforeWrap);
+		}
+
+		writeIndex = (writeIndex + numSamples) % size;
+	}
+}
+
+void BlockDynamics::processLimiter(float* l, float* r, const float* key, int numSamples)
+{
+	auto& limiter = stages[Limiter];
+
+	float gain[BlockSize];
+
+	limiter.blockMax = 0.0f;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		const double k = jmax((double)key[i], limiter.threshold);
+
+		if ((++peakTimer >= lookahead) || (k > maxPeak))
+		{
+			peakTimer = 0;
+			maxPeak = k;
+		}
+
+		limiter.state = maxPeak + (maxPeak > limiter.state ? limiter.attack.coef : limiter.release.coef) * (limiter.state - maxPeak);
+
+		const float g = (float)(limiter.threshold / limiter.state);
+		limiter.blockMax = jmax(limiter.blockMax, g);
+		gain[i] = g * limiter.makeupGain;
+	}
+
+	// Write the block into the lookahead buffer and read the delayed signal
+	const int size = MaxLookahead + 1 + BlockSize;
+	int readIndex = writeIndex - lookahead;
+
+	if (readIndex < 0)
+		readIndex += size;
+
+	const int numBeforeWrap = jmin(numSamples, size - writeIndex);
+	const int numBeforeReadWrap = jmin(numSamples, size - readIndex);
+
+	for (int c = 0; c < 2; c++)
+	{
+		float* d = lookaheadBuffer + c * size;
+		float* signal = c == 0 ? l : r;
+
+		FloatVectorOperations::copy(d + writeIndex, signal, numBeforeWrap);
+		FloatVectorOperations::copy(d, signal + numBeforeWrap, numSamples - numBeforeWrap);
+
+		FloatVectorOperations::multiply(signal, d + readIndex, gain, numBeforeReadWrap);
+		FloatVectorOperations::multiply(signal + numBeforeReadWrap, d, gain + numBeforeReadWrap, numSamples - numBeforeReadWrap);
+	}
+
+	writeIndex = (writeIndex + numSamples) % size;
+
+	updateMeter(limiter, numSamples);
+}
+
+void BlockDynamics::updateMeter(StageData& s, int numSamples)
+{
+	if (s.blockMax > s.gainReduction)
+		s.gainReduction = s.blockMax;
+	else
+		s.gainReduction *= std::pow(0.9999f, (float)numSamples);
+}
+
 DynamicsEffect::DynamicsEffect(MainController *mc, const String &uid) :
 	MasterEffectProcessor(mc, uid),
-	gateEnabled(false),
-	compressorEnabled(false),
-	limiterEnabled(false),
-	limiterPending(false),
-	limiterMakeupGain(1.0f),
-	compressorMakeupGain(1.0f),
+	latencyReporter(*this),
+	sidechainChannel(nullptr),
 	limiterMakeup(false),
-	compressorMakeup(false)
+	compressorMakeup(false),
+	gateReduction(0.0f),
+	limiterReduction(0.0f),
+	compressorReduction(0.0f)
 {
 	finaliseModChains();
 
@@ -49,27 +356,23 @@ void DynamicsEffect::setInternalAttribute(int parameterIndex, float newValue)
 {
 	auto p = (Parameters)parameterIndex;
 
+	const int oldLatency = getLatency();
+
 	switch (p)
 	{
-	case GateEnabled:			gateEnabled = newValue > 0.5f; break;
-	case CompressorEnabled:		compressorEnabled = newValue > 0.5f; break;
-	case LimiterEnabled:
-	{
-		const bool isEnabled = newValue > 0.5f;
-		limiterPending = isEnabled != limiterEnabled;
-		limiterEnabled = isEnabled;
-		break;
-	}
-	case GateThreshold:			gate.setThresh((SimpleDataType)newValue); break;
-	case CompressorThreshold:	compressor.setThresh((SimpleDataType)newValue); updateMakeupValues(false); break;
-	case LimiterThreshold:		limiter.setThresh((SimpleDataType)newValue); updateMakeupValues(true); break;
-	case GateAttack:			gate.setAttack((SimpleDataType)newValue); break;
-	case CompressorAttack:		compressor.setAttack((SimpleDataType)newValue); break;
-	case LimiterAttack:			limiter.setAttack((SimpleDataType)newValue); break;
-	case GateRelease:			gate.setRelease((SimpleDataType)newValue); break;
-	case CompressorRelease:		compressor.setRelease((SimpleDataType)newValue); break;
-	case LimiterRelease:		limiter.setRelease((SimpleDataType)newValue); break;
-	case CompressorRatio:		compressor.setRatio((SimpleDataType)(1.0f / newValue)); updateMakeupValues(false); break;
+	case GateEnabled:			dynamics.setEnabled(BlockDynamics::Gate, newValue > 0.5f); break;
+	case CompressorEnabled:		dynamics.setEnabled(BlockDynamics::Compressor, newValue > 0.5f); break;
+	case LimiterEnabled:		dynamics.setEnabled(BlockDynamics::Limiter, newValue > 0.5f); break;
+	case GateThreshold:			dynamics.setThreshold(BlockDynamics::Gate, (double)newValue); break;
+	case CompressorThreshold:	dynamics.setThreshold(BlockDynamics::Compressor, (double)newValue); updateMakeupValues(false); break;
+	case LimiterThreshold:		dynamics.setThreshold(BlockDynamics::Limiter, (double)newValue); updateMakeupValues(true); break;
+	case GateAttack:			dynamics.setAttack(BlockDynamics::Gate, (double)newValue); break;
+	case CompressorAttack:		dynamics.setAttack(BlockDynamics::Compressor, (double)newValue); break;
+	case LimiterAttack:			dynamics.setAttack(BlockDynamics::Limiter, (double)newValue); break;
+	case GateRelease:			dynamics.setRelease(BlockDynamics::Gate, (double)newValue); break;
+	case CompressorRelease:		dynamics.setRelease(BlockDynamics::Compressor, (double)newValue); break;
+	case LimiterRelease:		dynamics.setRelease(BlockDynamics::Limiter, (double)newValue); break;
+	case CompressorRatio:		dynamics.setRatio((double)(1.0f / newValue)); updateMakeupValues(false); break;
 	case CompressorMakeup:		compressorMakeup = newValue > 0.5f; updateMakeupValues(false); break;
 	case LimiterMakeup:			limiterMakeup = newValue > 0.5f; updateMakeupValues(true); break;
 	case GateReduction:
@@ -80,6 +383,10 @@ void DynamicsEffect::setInternalAttribute(int parameterIndex, float newValue)
 	default:
 		break;
 	}
+
+	// The limiter's lookahead depends on its attack time
+	if (getLatency() != oldLatency)
+		latencyReporter.triggerAsyncUpdate();
 }
 
 float DynamicsEffect::getAttribute(int parameterIndex) const
@@ -88,19 +395,19 @@ float DynamicsEffect::getAttribute(int parameterIndex) const
 
 	switch (p)
 	{
-	case GateEnabled:			return gateEnabled ? 1.0f : 0.0f;
-	case CompressorEnabled:		return compressorEnabled ? 1.0f : 0.0f;
-	case LimiterEnabled:		return limiterEnabled ? 1.0f : 0.0f;
-	case GateThreshold:			return (float)gate.getThresh();
-	case CompressorThreshold:	return (float)compressor.getThresh(); 
-	case LimiterThreshold:		return (float)limiter.getThresh();
-	case GateAttack:			return (float)gate.getAttack();
-	case CompressorAttack:		return (float)compressor.getAttack();
-	case LimiterAttack:			return (float)limiter.getAttack();
-	case GateRelease:			return (float)gate.getRelease();
-	case CompressorRelease:		return (float)compressor.getRelease();
-	case LimiterRelease:		return (float)limiter.getRelease();
-	case CompressorRatio:		return 1.0f / (float)compressor.getRatio();
+	case GateEnabled:			return dynamics.isEnabled(BlockDynamics::Gate) ? 1.0f : 0.0f;
+	case CompressorEnabled:		return dynamics.isEnabled(BlockDynamics::Compressor) ? 1.0f : 0.0f;
+	case LimiterEnabled:		return dynamics.isEnabled(BlockDynamics::Limiter) ? 1.0f : 0.0f;
+	case GateThreshold:			return (float)dynamics.getThreshold(BlockDynamics::Gate);
+	case CompressorThreshold:	return (float)dynamics.getThreshold(BlockDynamics::Compressor);
+	case LimiterThreshold:		return (float)dynamics.getThreshold(BlockDynamics::Limiter);
+	case GateAttack:			return (float)dynamics.getAttack(BlockDynamics::Gate);
+	case CompressorAttack:		return (float)dynamics.getAttack(BlockDynamics::Compressor);
+	case LimiterAttack:			return (float)dynamics.getAttack(BlockDynamics::Limiter);
+	case GateRelease:			return (float)dynamics.getRelease(BlockDynamics::Gate);
+	case CompressorRelease:		return (float)dynamics.getRelease(BlockDynamics::Compressor);
+	case LimiterRelease:		return (float)dynamics.getRelease(BlockDynamics::Limiter);
+	case CompressorRatio:		return 1.0f / (float)dynamics.getRatio();
 	case GateReduction:			return gateReduction;
 	case CompressorReduction:	return compressorReduction;
 	case LimiterReduction:		return limiterReduction;
@@ -165,6 +472,13 @@ void DynamicsEffect::restoreFromValueTree(const ValueTree &v)
 	loadAttribute(LimiterRelease, "LimiterRelease");
 	loadAttribute(CompressorMakeup, "CompressorMakeup");
 	loadAttribute(LimiterMakeup, "LimiterMakeup");
+
+	setSidechainId(v.getProperty("SidechainId", ""));
+
+	// Don't wait for the debounce timer when a preset is loaded
+	latencyReporter.cancelPendingUpdate();
+	latencyReporter.stopTimer();
+	latencyReporter.reportLatency();
 }
 
 ValueTree DynamicsEffect::exportAsValueTree() const
@@ -187,6 +501,9 @@ ValueTree DynamicsEffect::exportAsValueTree() const
 	saveAttribute(CompressorMakeup, "CompressorMakeup");
 	saveAttribute(LimiterMakeup, "LimiterMakeup");
 
+	if (sidechainId.isNotEmpty())
+		v.setProperty("SidechainId", sidechainId, nullptr);
+
 	return v;
 }
 
@@ -209,162 +526,90 @@ void DynamicsEffect::applyEffect(AudioSampleBuffer &buffer, int startSample, int
 {
 	const int numToProcess = numSamples - startSample;
 
-	if (gateEnabled)
-	{
-		float* l = buffer.getWritePointer(0, startSample);
-		float* r = buffer.getWritePointer(1, startSample);
-
-		for (int i = 0; i < numToProcess; i++)
-		{
-			SimpleDataType l_ = (SimpleDataType)*l;
-			SimpleDataType r_ = (SimpleDataType)*r;
-
-			gate.process(l_, r_);
-
-			const float gR = (float)gate.getGainReduction();
+	const float* externalKey = nullptr;
 
-			if (gR > gateReduction)
-				gateReduction = gR;
-			else
-				gateReduction = gateReduction * 0.9999f;
-
-			*l++ = (float)l_;
-			*r++ = (float)r_;
-		}
-	}
-
-	if (compressorEnabled)
+	if (auto c = sidechainChannel.load())
 	{
-		float* l = buffer.getWritePointer(0, startSample);
-		float* r = buffer.getWritePointer(1, startSample);
-
-		for (int i = 0; i < numToProcess; i++)
+		if (numToProcess <= sidechainKey.getNumSamples())
 		{
-			SimpleDataType l_ = (SimpleDataType)*l;
-			SimpleDataType r_ = (SimpleDataType)*r;
-
-			compressor.process(l_, r_);
+			float* key = sidechainKey.getWritePointer(0);
+			float* temp = sidechainKey.getWritePointer(1);
 
-			const float gR = (float)compressor.getGainReduction();
+			c->readAudio(0, key, startSample, numToProcess);
+			c->readAudio(1, temp, startSample, numToProcess);
 
-			if (gR > compressorReduction)
-				compressorReduction = gR;
-			else
-				compressorReduction = compressorReduction * 0.9999f;
+			FloatVectorOperations::abs(key, key, numToProcess);
+			FloatVectorOperations::abs(temp, temp, numToProcess);
+			FloatVectorOperations::max(key, key, temp, numToProcess);
 
-			*l++ = (float)l_;
-			*r++ = (float)r_;
-		}
-
-		if (compressorMakeup)
-		{
-			FloatVectorOperations::multiply(buffer.getWritePointer(0, startSample), compressorMakeupGain, numToProcess);
-			FloatVectorOperations::multiply(buffer.getWritePointer(1, startSample), compressorMakeupGain, numToProcess);
+			externalKey = key;
 		}
 	}
 
-	if (limiterEnabled || limiterPending)
-	{
-		if (limiterPending)
-		{
-			float* temp[2];
-
-			temp[0] = (float*)alloca(sizeof(float) * numToProcess);
-			temp[1] = (float*)alloca(sizeof(float) * numToProcess);
-
-			const float dryRampStart = limiterEnabled ? 1.0f : 0.0f;
-			const float dryRampEnd = 1.0f - dryRampStart;
-			const float wetRampStart = dryRampEnd;
-			const float wetRampEnd = dryRampStart;
-
-			AudioSampleBuffer tempBuffer(temp, 2, numToProcess);
-			tempBuffer.clear();
-			tempBuffer.copyFromWithRamp(0, 0, buffer.getReadPointer(0, startSample), numToProcess, dryRampStart, dryRampEnd);
-			tempBuffer.copyFromWithRamp(1, 0, buffer.getReadPointer(1, startSample), numToProcess, dryRampStart, dryRampEnd);
+	dynamics.process(buffer.getWritePointer(0, startSample), buffer.getWritePointer(1, startSample), numToProcess, externalKey);
 
-			applyLimiter(buffer, startSample, numToProcess);
-
-			buffer.applyGainRamp(startSample, numToProcess, wetRampStart, wetRampEnd);
-			
-			FloatVectorOperations::add(buffer.getWritePointer(0, startSample), temp[0], numToProcess);
-			FloatVectorOperations::add(buffer.getWritePointer(1, startSample), temp[1], numToProcess);
-
-			limiterPending = false;
-		}
-		else
-		{
-			applyLimiter(buffer, startSample, numToProcess);
-		}
-	}
+	gateReduction = dynamics.getGainReduction(BlockDynamics::Gate);
+	compressorReduction = dynamics.getGainReduction(BlockDynamics::Compressor);
+	limiterReduction = dynamics.getGainReduction(BlockDynamics::Limiter);
 }
 
-void DynamicsEffect::applyLimiter(AudioSampleBuffer &buffer, int startSample, const int numToProcess)
+void DynamicsEffect::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	float* l = buffer.getWritePointer(0, startSample);
-	float* r = buffer.getWritePointer(1, startSample);
-
-
+	MasterEffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
 
-	for (int i = 0; i < numToProcess; i++)
-	{
-		SimpleDataType l_ = (SimpleDataType)*l;
-		SimpleDataType r_ = (SimpleDataType)*r;
+	dynamics.setSampleRate(sampleRate);
+	dynamics.reset();
 
-		limiter.process(l_, r_);
+	sidechainKey.setSize(2, samplesPerBlock);
+}
 
-		const float gR = (float)limiter.getGainReduction();
+void DynamicsEffect::setSidechainId(const String& newId)
+{
+	sidechainId = newId;
 
-		if (gR > limiterReduction)
-			limiterReduction = gR;
-		else
-			limiterReduction = limiterReduction * 0.9999f;
+	// The channel is created if the publisher doesn't exist yet, so the loading order doesn't matter
+	sidechainChannel.store(newId.isEmpty() ? nullptr : getMainController()->getSidechainBus().getChannel(newId));
+}
 
-		*l++ = (float)l_;
-		*r++ = (float)r_;
-	}
 
-	if (limiterMakeup)
-	{
-		FloatVectorOperations::multiply(buffer.getWritePointer(0, startSample), limiterMakeupGain, numToProcess);
-		FloatVectorOperations::multiply(buffer.getWritePointer(1, startSample), limiterMakeupGain, numToProcess);
-	}
+void DynamicsEffect::LatencyReporter::timerCallback()
+{
+	stopTimer();
+	reportLatency();
 }
 
-void DynamicsEffect::prepareToPlay(double sampleRate, int samplesPerBlock)
+void DynamicsEffect::LatencyReporter::reportLatency()
 {
-	MasterEffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
-
-	gate.initRuntime();
-	compressor.initRuntime();
-	limiter.initRuntime();
+	const int latency = parent.getLatency();
 
-	gate.setSampleRate(sampleRate);
-	compressor.setSampleRate(sampleRate);
-	limiter.setSampleRate(sampleRate);
+	if (latency != lastReportedLatency)
+	{
+		lastReportedLatency = latency;
+		parent.sendLatencyChangeMessage();
+	}
 }
 
-
 void DynamicsEffect::updateMakeupValues(bool updateLimiter)
 {
 	if (updateLimiter)
 	{
 		if (limiterMakeup)
-			limiterMakeupGain = (float)Decibels::decibelsToGain(limiter.getThresh() * -1.0);
+			dynamics.setMakeupGain(BlockDynamics::Limiter, (float)Decibels::decibelsToGain(dynamics.getThreshold(BlockDynamics::Limiter) * -1.0));
 		else
-			limiterMakeupGain = 1.0f;
+			dynamics.setMakeupGain(BlockDynamics::Limiter, 1.0f);
 	}
 	else
 	{
 		if (compressorMakeup)
 		{
-			auto attenuation = compressor.getThresh();
-			auto ratio = compressor.getRatio();
+			auto attenuation = dynamics.getThreshold(BlockDynamics::Compressor);
+			auto ratio = dynamics.getRatio();
 			auto gainDb = (1.0 - ratio) * attenuation * -1.0;
 
-			compressorMakeupGain = (float)Decibels::decibelsToGain(gainDb);
+			dynamics.setMakeupGain(BlockDynamics::Compressor, (float)Decibels::decibelsToGain(gainDb));
 		}
 		else
-			compressorMakeupGain = 1.0f;
+			dynamics.setMakeupGain(BlockDynamics::Compressor, 1.0f);
 	}
 }
 
@@ -35,6 +35,127 @@
 
 namespace hise { using namespace juce;
 
+/** A stereo linked gate, compressor and lookahead limiter that are processed in a single pass.
+*
+*	The envelope detection is the same as in chunkware's SimpleGate, SimpleComp and SimpleLimit, but the signal
+*	is processed in blocks: the sidechain key is calculated with vector operations, then one loop advances the
+*	envelopes of all enabled stages and writes a gain curve which is applied with a single multiplication per channel.
+*
+*	Because the gain is applied to both channels, the key of a later stage is the input key multiplied with the
+*	gain of the previous stages, so the signal doesn't need to be processed between the stages.
+*
+*	The limiter delays the signal by its attack time so that the gain reduction is applied before the peak
+*	arrives. Use getLatency() to get the lookahead in samples.
+*/
+class BlockDynamics
+{
+public:
+
+	enum Stage
+	{
+		Gate = 0,
+		Compressor,
+		Limiter,
+		numStages
+	};
+
+	/** The maximum number of samples that are processed with one gain curve. */
+	static constexpr int BlockSize = 256;
+
+	/** The maximum lookahead of the limiter in samples. */
+	static constexpr int MaxLookahead = 4095;
+
+	BlockDynamics();
+
+	void setSampleRate(double newSampleRate);
+
+	/** Resets the envelopes and clears the lookahead buffer. */
+	void reset();
+
+	/** Enables the stage. Enabling or disabling the limiter will crossfade during the next block. */
+	void setEnabled(Stage s, bool shouldBeEnabled);
+	bool isEnabled(Stage s) const noexcept { return stages[s].enabled; }
+
+	void setThreshold(Stage s, double newThresholdDb);
+	void setAttack(Stage s, double attackMs);
+	void setRelease(Stage s, double releaseMs);
+
+	/** Sets the ratio of the compressor (< 1.0 compresses, > 1.0 expands). */
+	void setRatio(double newRatio) noexcept { ratio = newRatio; }
+
+	/** Sets a gain that is applied after the stage (only the compressor and the limiter support this). */
+	void setMakeupGain(Stage s, float newGain) noexcept { stages[s].makeupGain = newGain; }
+
+	double getThreshold(Stage s) const noexcept { return stages[s].thresholdDb; }
+	double getAttack(Stage s) const noexcept { return stages[s].attack.ms; }
+	double getRelease(Stage s) const noexcept { return stages[s].release.ms; }
+	double getRatio() const noexcept { return ratio; }
+
+	/** Returns the gain reduction value that is displayed in the meter of the stage. */
+	float getGainReduction(Stage s) const noexcept { return stages[s].gainReduction; }
+
+	/** Returns the amount of samples that the limiter delays the signal (or zero if the limiter is disabled). */
+	int getLatency() const noexcept { return stages[Limiter].enabled ? lookahead : 0; }
+
+	/** Returns the amount of samples until a silent input has flushed the lookahead buffer and the envelopes of the enabled stages have released. */
+	int getTailLength() const noexcept;
+
+	/** Resets the envelopes of all stages (the lookahead buffer is not cleared). */
+	void resetEnvelopes();
+
+	/** Processes the stereo signal in place.
+	*
+	*	If you pass in an external key (the absolute peak value of a sidechain signal), it will be used for the
+	*	envelope detection instead of the signal itself.
+	*/
+	void process(float* l, float* r, int numSamples, const float* externalKey=nullptr);
+
+private:
+
+	struct Envelope
+	{
+		void setTime(double newMs, double sampleRate, bool fastEnvelope);
+
+		double ms = 10.0;
+		double coef = 0.0;
+		bool fast = false;
+	};
+
+	struct StageData
+	{
+		bool enabled = false;
+		double thresholdDb = 0.0;
+		double threshold = 1.0;
+		Envelope attack;
+		Envelope release;
+		double state = 0.0;
+		float makeupGain = 1.0f;
+		float gainReduction = 0.0f;
+		float blockMax = 0.0f;
+	};
+
+	void processBlock(float* l, float* r, int numSamples, const float* externalKey);
+	void processLimiter(float* l, float* r, const float* key, int numSamples);
+	void updateMeter(StageData& s, int numSamples);
+
+	StageData stages[numStages];
+
+	double sampleRate = 44100.0;
+	double ratio = 1.0;
+
+	bool limiterActive = false;
+	bool limiterFadePending = false;
+
+	int lookahead = 0;
+	int peakTimer = 0;
+	double maxPeak = 1.0;
+
+	int writeIndex = 0;
+	HeapBlock<float> lookaheadBuffer;
+	
+	JUCE_DECLARE_NON_COPYABLE(BlockDynamics);
+};
+
 /** A general purpose dynamics processor based on chunkware's SimpleCompressor.
 	@ingroup effectTypes
 */
@@ -70,7 +191,10 @@ public:
 	DynamicsEffect(MainController *mc, const String &uid);;
 
 	~DynamicsEffect()
-	{};
+	{
+		latencyReporter.cancelPendingUpdate();
+		latencyReporter.stopTimer();
+	};
 
 	void setInternalAttribute(int parameterIndex, float newValue) override;;
 	float getAttribute(int parameterIndex) const override;
@@ -89,22 +213,50 @@ public:
 
 	void applyEffect(AudioSampleBuffer &buffer, int startSample, int numSamples) override;
 
-	void applyLimiter(AudioSampleBuffer &buffer, int startSample, const int numToProcess);
-
 	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
 
+	/** Returns the lookahead of the limiter in samples. */
+	int getLatency() const override { return dynamics.getLatency(); }
+
+	/** The lookahead buffer still contains the last input and the envelopes need their release time to settle. */
+	int getNumSilentSamplesBeforeSuspension() const override { return dynamics.getTailLength(); }
+
+	void resumeAfterSuspension() override { dynamics.resetEnvelopes(); }
+
+	/** Uses the signal of the given SidechainBus channel as key for the envelope detection (or the input if the ID is empty). */
+	void setSidechainId(const String& newId);
+
+	String getSidechainId() const { return sidechainId; }
+
 private:
 
+	/** Sends the latency change message once the limiter settings stop changing (eg. while dragging the attack slider). */
+	struct LatencyReporter : public AsyncUpdater,
+							 public Timer
+	{
+		static constexpr int DebounceMilliseconds = 300;
+
+		LatencyReporter(DynamicsEffect& parent_) : parent(parent_) {};
+
+		void handleAsyncUpdate() override { startTimer(DebounceMilliseconds); }
+		void timerCallback() override;
+
+		/** Sends the message immediately if the latency has changed. */
+		void reportLatency();
+
+		DynamicsEffect& parent;
+		int lastReportedLatency = 0;
+	};
+
 	void updateMakeupValues(bool updateLimiter);
 
-	chunkware_simple::SimpleGate gate;
-	chunkware_simple::SimpleComp compressor;
-	chunkware_simple::SimpleLimit limiter;
+	BlockDynamics dynamics;
+
+	LatencyReporter latencyReporter;
 
-	std::atomic<bool> gateEnabled;
-	std::atomic<bool> compressorEnabled;
-	std::atomic<bool> limiterEnabled;
-	std::atomic<bool> limiterPending;
+	String sidechainId;
+	std::atomic<SidechainBus::Channel*> sidechainChannel;
+	AudioSampleBuffer sidechainKey;
 
 	std::atomic<bool> compressorMakeup;
 	std::atomic<bool> limiterMakeup;
@@ -112,9 +264,6 @@ private:
 	std::atomic<float> gateReduction;
 	std::atomic<float> limiterReduction;
 	std::atomic<float> compressorReduction;
-
-	std::atomic<float> compressorMakeupGain;
-	std::atomic<float> limiterMakeupGain;
 };
 
 
@@ -34,16 +34,20 @@ namespace hise { using namespace juce;
 
 GainCollector::GainCollector(MainController *mc, const String &id) :
 MasterEffectProcessor(mc, id),
+channel(mc->getSidechainBus().getChannel(id)),
 smoothingTime(200.0f),
 mode(SimpleLP),
 attack(50.0f),
 release(50.0f),
-currentGain(1.0f)
+detector(SidechainBus::EnvelopeDetector::Mode::Peak)
 {
 	parameterNames.add("Smoothing");
 	parameterNames.add("Mode");
 	parameterNames.add("Attack");
 	parameterNames.add("Release");
+	parameterNames.add("Detector");
+
+	updateDetector();
 }
 
 float GainCollector::getAttribute(int parameterIndex) const
@@ -64,6 +68,9 @@ float GainCollector::getAttribute(int parameterIndex) const
 	case GainCollector::Release:
 		return release;
 		break;
+	case GainCollector::Detector:
+		return (float)(int)detector;
+		break;
 	case GainCollector::numEffectParameters:
 	default:
 		return -1.0f;
@@ -79,10 +86,9 @@ void GainCollector::setInternalAttribute(int parameterIndex, float value)
 	{
 	case GainCollector::Smoothing:
 		smoothingTime = value;
-		smoother.setSmoothingTime(smoothingTime);
 		break;
 	case GainCollector::Mode:
-		mode = (EnvelopeFollowerMode)(int)value;
+		mode = (EnvelopeFollowerMode)jlimit<int>(0, numEnvelopeFollowerModes - 1, (int)value);
 		break;
 	case GainCollector::Attack:
 		attack = value;
@@ -90,11 +96,39 @@ void GainCollector::setInternalAttribute(int parameterIndex, float value)
 	case GainCollector::Release:
 		release = value;
 		break;
+	case GainCollector::Detector:
+		detector = (SidechainBus::EnvelopeDetector::Mode)jlimit<int>(0, (int)SidechainBus::EnvelopeDetector::Mode::numModes - 1, (int)value);
+		break;
 	case GainCollector::numEffectParameters:
 	default:
 		break;
 	}
 
+	updateDetector();
+}
+
+void GainCollector::updateDetector()
+{
+	auto c = channel.load();
+
+	if (c == nullptr)
+		return;
+
+	if (mode == SimpleLP)
+		c->setDetector(detector, smoothingTime, smoothingTime);
+	else
+		c->setDetector(detector, attack, release);
+}
+
+void GainCollector::idChanged()
+{
+	auto c = channel.load();
+
+	if (c != nullptr && c->getName() == getId())
+		return;
+
+	channel.store(getMainController()->getSidechainBus().getChannel(getId()));
+	updateDetector();
 }
 
 
@@ -106,7 +140,7 @@ void GainCollector::restoreFromValueTree(const ValueTree &v)
 	loadAttribute(Parameters::Mode, "Mode");
 	loadAttribute(Attack, "Attack");
 	loadAttribute(Release, "Release");
-
+	setAttribute(Detector, v.getProperty("Detector", 0), dontSendNotification);
 }
 
 ValueTree GainCollector::exportAsValueTree() const
@@ -117,6 +151,7 @@ ValueTree GainCollector::exportAsValueTree() const
 	saveAttribute(Parameters::Mode, "Mode");
 	saveAttribute(Attack, "Attack");
 	saveAttribute(Release, "Release");
+	saveAttribute(Detector, "Detector");
 
 	return v;
 }
@@ -124,24 +159,12 @@ ValueTree GainCollector::exportAsValueTree() const
 void GainCollector::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
 	EffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
-
-	smoother.prepareToPlay(sampleRate);
 }
 
 void GainCollector::applyEffect(AudioSampleBuffer &buffer, int startSample, int numSamples)
 {
-	const float *samples = buffer.getReadPointer(0, startSample);
-	int i = 0;
-	float maximumThisTime = 0.0f;
-
-	while (--numSamples >= 0)
-	{
-		float value = EnvelopeFollower::prepareAudioInput(samples[i++], 1.0f);
-		value = EnvelopeFollower::constrainTo0To1(value);
-		if (value > maximumThisTime) maximumThisTime = value;
-
-		currentGain = smoother.smooth(maximumThisTime);
-	}
+	if (auto c = channel.load())
+		c->write(buffer, startSample, numSamples);
 }
 
 ProcessorEditorBody *GainCollector::createEditor(ProcessorEditor *parentEditor)
@@ -35,6 +35,11 @@
 
 namespace hise { using namespace juce;
 
+/** Publishes the signal and its envelope on the SidechainBus.
+*
+*	The channel uses the ID of the collector as name, so any module that subscribes to this name
+*	(eg. the GainMatcher modulators or the Dynamics effect) can read the signal at audio rate.
+*/
 class GainCollector : public MasterEffectProcessor
 {
 public:
@@ -48,6 +53,7 @@ public:
 		Mode,
 		Attack,
 		Release,
+		Detector,
 		numEffectParameters
 	};
 
@@ -76,18 +82,28 @@ public:
 
 	ProcessorEditorBody *createEditor(ProcessorEditor *parentEditor)  override;
 
-	float getCurrentGain() const { return currentGain; }
+	/** Publishes the signal under the new ID. */
+	void idChanged() override;
+
+	/** Returns the envelope value of the last block. */
+	float getCurrentGain() const
+	{
+		auto c = channel.load();
+		return c != nullptr ? c->getCurrentValue() : 0.0f;
+	}
 
 private:
 
-	Smoother smoother;
+	void updateDetector();
+
+	std::atomic<SidechainBus::Channel*> channel;
 
 	float smoothingTime;
 	EnvelopeFollowerMode mode;
 	float attack;
 	float release;
 
-	float currentGain;
+	SidechainBus::EnvelopeDetector::Mode detector;
 
 };
 
@@ -102,7 +102,8 @@ public:
 	SET_PROCESSOR_NAME("MidiMetronome", "MidiMetronome", "A simple metronome that connects to a MIDI player.");
 
 	MidiMetronome(MainController *mc, const String &uid) :
-		MasterEffectProcessor(mc, uid)
+		MasterEffectProcessor(mc, uid),
+		noiseGenerator(mc->getRandomNumberService().createGenerator(RandomNumberService::getStreamId(uid)))
 	{
 		finaliseModChains();
 	};
@@ -202,6 +203,9 @@ public:
 			{
 				rampValue = 1.0f;
 
+				// Every click uses the same noise
+				noiseGenerator.setPosition(0);
+
 				uptimeDelta = JUCE_LIVE_CONSTANT(0.1);
 				uptime = 0.0;
 
@@ -220,7 +224,7 @@ public:
 				{
 					rampValue *= JUCE_LIVE_CONSTANT_OFF(0.9988f);
 
-					auto n = (Random::getSystemRandom().nextFloat() * 0.5f - 0.5f) * rampValue;
+					auto n = (noiseGenerator.nextFloat() * 0.5f - 0.5f) * rampValue;
 
 					auto s = std::sin(uptime) * rampValue;
 
@@ -273,6 +277,8 @@ public:
 	double lastPos = 0.0;
 	double uptime = 0.0;
 	double uptimeDelta = 0.0;
+
+	PhiloxRandom noiseGenerator;
 };
 
 
@@ -331,6 +337,9 @@ public:
 
 	bool hasTail() const override { return false; };
 
+	/** The output of the static delay is the only thing that can follow a silent input. */
+	int getNumSilentSamplesBeforeSuspension() const override { return roundToInt(delay * 0.001 * getSampleRate()); }
+
 	Processor *getChildProcessor(int processorIndex) override
     {
         switch(processorIndex)
@@ -38,6 +38,74 @@ MasterEffectProcessor(mc, uid)
 	finaliseModChains();
 
 	getMatrix().setOnlyEnablingAllowed(false);
+
+	for (int i = 0; i < NumSendChannels; i++)
+	{
+		destinationUsed[i] = false;
+
+		for (int j = 0; j < NumSendChannels; j++)
+			sendGains[i][j] = -1.0f;
+	}
+
+	rebuildSendList();
+}
+
+void RouteEffect::restoreFromValueTree(const ValueTree &v)
+{
+	MasterEffectProcessor::restoreFromValueTree(v);
+
+	for (int i = 0; i < NumSendChannels; i++)
+		for (int j = 0; j < NumSendChannels; j++)
+			sendGains[i][j] = -1.0f;
+
+	ValueTree sends = v.getChildWithName("Sends");
+
+	for (int i = 0; i < sends.getNumChildren(); i++)
+	{
+		ValueTree s = sends.getChild(i);
+
+		const int source = s.getProperty("Source", -1);
+		const int destination = s.getProperty("Destination", -1);
+
+		if (isValidSendChannel(source) && isValidSendChannel(destination))
+			sendGains[source][destination] = jmax<float>(0.0f, (float)s.getProperty("Gain", 1.0f));
+	}
+
+	setAuxReturnSource(v.getProperty("AuxReturn", "").toString());
+
+	connectionChanged();
+}
+
+ValueTree RouteEffect::exportAsValueTree() const
+{
+	ValueTree v = MasterEffectProcessor::exportAsValueTree();
+
+	ValueTree sends("Sends");
+
+	for (int i = 0; i < NumSendChannels; i++)
+	{
+		for (int j = 0; j < NumSendChannels; j++)
+		{
+			if (sendGains[i][j] >= 0.0f)
+			{
+				ValueTree s("Send");
+
+				s.setProperty("Source", i, nullptr);
+				s.setProperty("Destination", j, nullptr);
+				s.setProperty("Gain", sendGains[i][j], nullptr);
+
+				sends.addChild(s, -1, nullptr);
+			}
+		}
+	}
+
+	if (sends.getNumChildren() != 0)
+		v.addChild(sends, -1, nullptr);
+
+	if (auxReturnId.isNotEmpty())
+		v.setProperty("AuxReturn", auxReturnId, nullptr);
+
+	return v;
 }
 
 ProcessorEditorBody *RouteEffect::createEditor(ProcessorEditor *parentEditor)
@@ -55,51 +123,232 @@ ProcessorEditorBody *RouteEffect::createEditor(ProcessorEditor *parentEditor)
 #endif
 }
 
-void RouteEffect::renderWholeBuffer(AudioSampleBuffer &b)
+void RouteEffect::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-	
+	MasterEffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
+
+	// The sends are summed here before they are added, so a send never reads the signal of another send.
+	// The aux channels at the end are read by the returning RouteEffect.
+	sendBuffer.setSize(NumSendChannels, samplesPerBlock);
+	sendBuffer.clear();
 
+	// The first channel holds the delayed source, the second one the gain ramp
+	scratchBuffer.setSize(2, samplesPerBlock);
+
+	if (auxReturnId.isNotEmpty() && auxReturnSource.get() == nullptr)
+		setAuxReturnSource(auxReturnId);
+}
+
+void RouteEffect::renderWholeBuffer(AudioSampleBuffer &b)
+{
 	const int numSamples = b.getNumSamples();
+	const int numChannels = b.getNumChannels();
 
 	if (getMatrix().isEditorShown())
+		updateGainValues(b, true);
+
+	if (destinationDelays != nullptr)
+		destinationDelays->process(b);
+
+	if (sendList != nullptr && lastSendListVersion != sendListVersion)
+		updateSendStates(*sendList);
+
+	if (numActiveSends == 0)
 	{
-		float gainValues[NUM_MAX_CHANNELS];
+		if (getMatrix().isEditorShown())
+			updateGainValues(b, false);
 
-		jassert(getMatrix().getNumSourceChannels() == b.getNumChannels());
+		return;
+	}
 
-		for (int i = 0; i < b.getNumChannels(); i++)
+	if (numSamples > sendBuffer.getNumSamples())
+	{
+		// prepareToPlay() wasn't called with the correct block size
+		jassertfalse;
+		return;
+	}
+
+	if (auto source = static_cast<RouteEffect*>(auxReturnSource.get()))
+	{
+		// Only use the aux signal if it was sent since the last block
+		auxReturnIsValid = source->auxBlockCounter != lastAuxBlockCounter && source->auxNumSamples == numSamples;
+		lastAuxBlockCounter = source->auxBlockCounter;
+	}
+	else
+	{
+		auxReturnIsValid = false;
+	}
+
+	memset(destinationUsed, 0, sizeof(destinationUsed));
+
+	auto rampData = scratchBuffer.getWritePointer(1);
+
+	for (int i = numActiveSends - 1; i >= 0; i--)
+	{
+		const int index = activeSends[i];
+		const int source = index / NumSendChannels;
+		const int destination = index % NumSendChannels;
+
+		auto& s = sendStates[source][destination];
+
+		const bool isRamping = s.numRampSamples > 0;
+
+		if (isRamping)
+		{
+			const int numRampSamples = jmin<int>(s.numRampSamples, numSamples);
+
+			float gain = s.gain;
+
+			for (int k = 0; k < numRampSamples; k++)
+			{
+				gain += s.delta;
+				rampData[k] = gain;
+			}
+
+			s.numRampSamples -= numRampSamples;
+			s.gain = s.numRampSamples == 0 ? s.targetGain : gain;
+
+			if (numRampSamples < numSamples)
+				FloatVectorOperations::fill(rampData + numRampSamples, s.gain, numSamples - numRampSamples);
+		}
+		else if (s.gain == 0.0f)
+		{
+			// The send was removed and has faded out
+			// The last element was already processed, so it can take this slot
+			s.active = false;
+			activeSends[i] = activeSends[--numActiveSends];
+			continue;
+		}
+
+		const float* sourceData = nullptr;
+
+		if (source < NUM_MAX_CHANNELS)
+			sourceData = source < numChannels ? b.getReadPointer(source) : nullptr;
+		else
+			sourceData = getAuxReturnChannel(source - NUM_MAX_CHANNELS);
+
+		if (sourceData == nullptr || (destination < NUM_MAX_CHANNELS && destination >= numChannels))
+			continue;
+
+		if (sendDelays != nullptr && source < numSendDelayChannels && destination < numSendDelayChannels)
 		{
-			gainValues[i] = b.getMagnitude(i, 0, b.getNumSamples());
+			const int delayIndex = source * numSendDelayChannels + destination;
+
+			if (sendDelays->getDelay(delayIndex) != 0)
+			{
+				auto delayedData = scratchBuffer.getWritePointer(0);
+
+				FloatVectorOperations::copy(delayedData, sourceData, numSamples);
+				sendDelays->processChannel(delayIndex, delayedData, numSamples);
+				sourceData = delayedData;
+			}
 		}
 
-		getMatrix().setGainValues(gainValues, true);
+		auto destinationData = sendBuffer.getWritePointer(destination);
+
+		if (!destinationUsed[destination])
+		{
+			FloatVectorOperations::clear(destinationData, numSamples);
+			destinationUsed[destination] = true;
+		}
+
+		if (isRamping)
+			FloatVectorOperations::addWithMultiply(destinationData, sourceData, rampData, numSamples);
+		else
+			FloatVectorOperations::addWithMultiply(destinationData, sourceData, s.gain, numSamples);
 	}
 
-	for (int i = 0; i < b.getNumChannels(); i++)
+	for (int i = 0; i < numChannels; i++)
 	{
-		const int j = getMatrix().getSendForSourceChannel(i);
+		if (destinationUsed[i])
+			FloatVectorOperations::add(b.getWritePointer(i), sendBuffer.getReadPointer(i), numSamples);
+	}
+
+	bool auxChannelsUsed = false;
 
-		if (j != -1)
+	for (int i = 0; i < NumAuxChannels; i++)
+		auxChannelsUsed |= destinationUsed[getAuxChannelIndex(i)];
+
+	if (auxChannelsUsed)
+	{
+		for (int i = 0; i < NumAuxChannels; i++)
 		{
-			FloatVectorOperations::add(b.getWritePointer(j), b.getReadPointer(i), numSamples);
+			if (!destinationUsed[getAuxChannelIndex(i)])
+				FloatVectorOperations::clear(sendBuffer.getWritePointer(getAuxChannelIndex(i)), numSamples);
 		}
+
+		auxBlockCounter++;
+		auxNumSamples = numSamples;
 	}
 
 	if (getMatrix().isEditorShown())
+		updateGainValues(b, false);
+}
+
+void RouteEffect::updateChannelLatencies(Array<int>& channelLatencies)
+{
+	const int numChannels = jmin<int>(channelLatencies.size(), NUM_MAX_CHANNELS);
+
+	Array<int> targetLatencies(channelLatencies);
+
+	for (int i = 0; i < numChannels; i++)
 	{
-		float gainValues[NUM_MAX_CHANNELS];
+		for (int j = 0; j < numChannels; j++)
+		{
+			if (getSendGain(i, j) > 0.0f)
+				targetLatencies.set(j, jmax<int>(targetLatencies[j], channelLatencies[i]));
+		}
+	}
 
-		jassert(getMatrix().getNumDestinationChannels() == b.getNumChannels());
+	ScopedPointer<LatencyCompensation> newDestinationDelays;
+	ScopedPointer<LatencyCompensation> newSendDelays;
 
-		for (int i = 0; i < b.getNumChannels(); i++)
+	for (int i = 0; i < numChannels; i++)
+	{
+		const int destinationDelay = targetLatencies[i] - channelLatencies[i];
+
+		if (destinationDelay > 0)
 		{
-			gainValues[i] = b.getMagnitude(i, 0, b.getNumSamples());
+			if (newDestinationDelays == nullptr)
+				newDestinationDelays = new LatencyCompensation(numChannels);
+
+			newDestinationDelays->setDelay(i, destinationDelay);
 		}
 
-		getMatrix().setGainValues(gainValues, false);
+		for (int j = 0; j < numChannels; j++)
+		{
+			if (getSendGain(i, j) <= 0.0f)
+				continue;
+
+			// The destination channel is already delayed when the send is added
+			const int sendDelay = targetLatencies[j] - targetLatencies[i];
+
+			if (sendDelay > 0)
+			{
+				if (newSendDelays == nullptr)
+					newSendDelays = new LatencyCompensation(numChannels * numChannels);
+
+				newSendDelays->setDelay(i * numChannels + j, sendDelay);
+			}
+		}
 	}
-	
 
+	if (newDestinationDelays != nullptr || newSendDelays != nullptr || destinationDelays != nullptr || sendDelays != nullptr)
+	{
+		LOCK_PROCESSING_CHAIN(this);
+
+		destinationDelays.swapWith(newDestinationDelays);
+		sendDelays.swapWith(newSendDelays);
+		numSendDelayChannels = numChannels;
+	}
+
+	channelLatencies.swapWith(targetLatencies);
+}
+
+void RouteEffect::connectionChanged()
+{
+	rebuildSendList();
+	sendLatencyChangeMessage();
 }
 
 void RouteEffect::applyEffect(AudioSampleBuffer &, int, int /*numSamples*/)
@@ -107,4 +356,149 @@ void RouteEffect::applyEffect(AudioSampleBuffer &, int, int /*numSamples*/)
 	
 }
 
+void RouteEffect::setSendGain(int sourceChannel, int destinationChannel, float gain)
+{
+	if (!isValidSendChannel(sourceChannel) || !isValidSendChannel(destinationChannel))
+	{
+		jassertfalse;
+		return;
+	}
+
+	sendGains[sourceChannel][destinationChannel] = jmax<float>(0.0f, gain);
+	connectionChanged();
+}
+
+float RouteEffect::getSendGain(int sourceChannel, int destinationChannel) const
+{
+	if (!isValidSendChannel(sourceChannel) || !isValidSendChannel(destinationChannel))
+		return 0.0f;
+
+	const float gain = sendGains[sourceChannel][destinationChannel];
+
+	if (gain >= 0.0f)
+		return gain;
+
+	const int matrixSend = sourceChannel < NUM_MAX_CHANNELS ? getMatrix().getSendForSourceChannel(sourceChannel) : -1;
+
+	return matrixSend == destinationChannel ? 1.0f : 0.0f;
+}
+
+void RouteEffect::removeSend(int sourceChannel, int destinationChannel)
+{
+	if (isValidSendChannel(sourceChannel) && isValidSendChannel(destinationChannel))
+	{
+		sendGains[sourceChannel][destinationChannel] = -1.0f;
+		connectionChanged();
+	}
+}
+
+void RouteEffect::clearSends()
+{
+	for (int i = 0; i < NumSendChannels; i++)
+		for (int j = 0; j < NumSendChannels; j++)
+			sendGains[i][j] = -1.0f;
+
+	connectionChanged();
+}
+
+void RouteEffect::setAuxReturnSource(const String& routeEffectId)
+{
+	auxReturnId = routeEffectId;
+
+	Processor* p = nullptr;
+
+	if (routeEffectId.isNotEmpty())
+		p = ProcessorHelpers::getFirstProcessorWithName(getMainController()->getMainSynthChain(), routeEffectId);
+
+	// It might not be restored yet, so prepareToPlay() tries it again
+	if (dynamic_cast<RouteEffect*>(p) == nullptr || p == this)
+		p = nullptr;
+
+	LOCK_PROCESSING_CHAIN(this);
+
+	auxReturnSource = p;
+	lastAuxBlockCounter = -1;
+}
+
+void RouteEffect::rebuildSendList()
+{
+	ScopedPointer<SendList> newList = new SendList();
+
+	for (int i = 0; i < NumSendChannels; i++)
+	{
+		for (int j = 0; j < NumSendChannels; j++)
+		{
+			const float gain = getSendGain(i, j);
+
+			if (gain > 0.0f)
+				newList->sends[newList->numSends++] = { i, j, gain };
+		}
+	}
+
+	LOCK_PROCESSING_CHAIN(this);
+
+	sendList.swapWith(newList);
+	sendListVersion++;
+}
+
+void RouteEffect::updateSendStates(const SendList& list)
+{
+	lastSendListVersion = sendListVersion;
+
+	for (int i = 0; i < numActiveSends; i++)
+		sendStates[activeSends[i] / NumSendChannels][activeSends[i] % NumSendChannels].targetGain = 0.0f;
+
+	for (int i = 0; i < list.numSends; i++)
+	{
+		const auto& send = list.sends[i];
+		auto& s = sendStates[send.source][send.destination];
+
+		s.targetGain = send.gain;
+
+		if (!s.active)
+		{
+			s.active = true;
+			activeSends[numActiveSends++] = send.source * NumSendChannels + send.destination;
+		}
+	}
+
+	const int numRampSamples = jmax<int>(1, (int)(getSampleRate() * SendRampTimeMs * 0.001));
+
+	for (int i = 0; i < numActiveSends; i++)
+	{
+		auto& s = sendStates[activeSends[i] / NumSendChannels][activeSends[i] % NumSendChannels];
+
+		if (s.targetGain != s.gain)
+		{
+			s.numRampSamples = numRampSamples;
+			s.delta = (s.targetGain - s.gain) / (float)numRampSamples;
+		}
+	}
+}
+
+const float* RouteEffect::getAuxReturnChannel(int auxChannel) const noexcept
+{
+	if (!auxReturnIsValid)
+		return nullptr;
+
+	auto source = static_cast<const RouteEffect*>(auxReturnSource.get());
+
+	return source->sendBuffer.getReadPointer(getAuxChannelIndex(auxChannel));
+}
+
+void RouteEffect::updateGainValues(const AudioSampleBuffer& b, bool isSource)
+{
+	// Only the meters that are shown and were painted since the last update are calculated
+	const uint32 requestedChannels = getMatrix().getRequestedGainValues(isSource);
+
+	if (requestedChannels == 0)
+		return;
+
+	for (int i = 0; i < b.getNumChannels(); i++)
+	{
+		if ((requestedChannels & (1u << i)) != 0)
+			getMatrix().setGainValue(i, isSource, b.getMagnitude(i, 0, b.getNumSamples()));
+	}
+}
+
 } // namespace hise
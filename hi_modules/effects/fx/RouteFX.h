@@ -40,11 +40,27 @@ namespace hise { using namespace juce;
 /** A signal chain tool that allows to duplicate and send the signal to other channels to build AUX signal paths.
 	@ingroup effectTypes.
 
+	Besides the send of the routing matrix (one per source channel with unity gain), any channel can be sent to any
+	amount of channels with its own gain. Gain changes are ramped sample accurately, so they can be automated.
+
+	The destination of a send can also be one of the aux channels of this effect (use getAuxChannelIndex()). Another
+	RouteEffect in a different signal chain can use these channels as sources by calling setAuxReturnSource(). If the
+	returning effect is processed before the sending one, the aux signal is delayed by one block. The aux channels are
+	not part of the latency compensation.
 */
 class RouteEffect : public MasterEffectProcessor
 {
 public:
 
+	/** The number of aux channels that can be used as send destination. */
+	static constexpr int NumAuxChannels = 8;
+
+	/** The amount of channels that can be addressed by a send (the audio channels followed by the aux channels). */
+	static constexpr int NumSendChannels = NUM_MAX_CHANNELS + NumAuxChannels;
+
+	/** The time of the gain ramp when a send is changed. */
+	static constexpr double SendRampTimeMs = 20.0;
+
 	SET_PROCESSOR_NAME("RouteFX", "Routing Matrix", "A signal chain tool that allows to duplicate and send the signal to other channels to build AUX signal paths.");
 
 	RouteEffect(MainController *mc, const String &uid);;
@@ -56,17 +72,9 @@ public:
 	void setInternalAttribute(int , float ) override {};
 
 
-	void restoreFromValueTree(const ValueTree &v) override
-	{
-		MasterEffectProcessor::restoreFromValueTree(v);
-	};
+	void restoreFromValueTree(const ValueTree &v) override;
 
-	ValueTree exportAsValueTree() const override
-	{
-		ValueTree v = MasterEffectProcessor::exportAsValueTree();
-		
-		return v;
-	}
+	ValueTree exportAsValueTree() const override;
 
 
 	int getNumInternalChains() const override { return 0; };
@@ -81,19 +89,100 @@ public:
 
 	ProcessorEditorBody *createEditor(ProcessorEditor *parentEditor)  override;
 
-	void prepareToPlay(double sampleRate, int samplesPerBlock)
-	{
-		MasterEffectProcessor::prepareToPlay(sampleRate, samplesPerBlock);
-	}
+	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
 
 	void renderWholeBuffer(AudioSampleBuffer &buffer) override;
+
+	/** Delays the send signal or the destination channel so that they are aligned when they are summed. */
+	void updateChannelLatencies(Array<int>& channelLatencies) override;
+
+	void connectionChanged() override;
 	
 
 	void applyEffect(AudioSampleBuffer &/*b*/, int /*startSample*/, int /*numSamples*/) override;
 
+	/** Returns the send channel index of the given aux channel. */
+	static constexpr int getAuxChannelIndex(int auxChannel) { return NUM_MAX_CHANNELS + auxChannel; }
+
+	/** Adds a send or changes its gain. This overrides the unity gain of a send from the routing matrix. */
+	void setSendGain(int sourceChannel, int destinationChannel, float gain);
+
+	/** Returns the gain of the send (or zero if the channels are not connected). */
+	float getSendGain(int sourceChannel, int destinationChannel) const;
+
+	/** Removes the send (unless it's a send of the routing matrix). */
+	void removeSend(int sourceChannel, int destinationChannel);
+
+	/** Removes all sends that were added with setSendGain(). */
+	void clearSends();
+
+	/** Uses the aux channels of the RouteEffect with the given ID as source for the aux channel indexes. */
+	void setAuxReturnSource(const String& routeEffectId);
+
 private:
 
-	
+	struct Send
+	{
+		int source;
+		int destination;
+		float gain;
+	};
+
+	/** The sends that are used by the audio thread. A new list is created whenever a connection changes. */
+	struct SendList
+	{
+		int numSends = 0;
+		Send sends[NumSendChannels * NumSendChannels];
+	};
+
+	/** The gain of a send on the audio thread. It keeps ramping after the send was removed until it's silent. */
+	struct SendState
+	{
+		float gain = 0.0f;
+		float targetGain = 0.0f;
+		float delta = 0.0f;
+		int numRampSamples = 0;
+		bool active = false;
+	};
+
+	static bool isValidSendChannel(int channelIndex) noexcept { return isPositiveAndBelow(channelIndex, NumSendChannels); }
+
+	void rebuildSendList();
+
+	void updateSendStates(const SendList& list);
+
+	const float* getAuxReturnChannel(int auxChannel) const noexcept;
+
+	void updateGainValues(const AudioSampleBuffer& b, bool isSource);
+
+	/** The explicit send gains (a negative value means that no gain was set). */
+	float sendGains[NumSendChannels][NumSendChannels];
+
+	ScopedPointer<SendList> sendList;
+	int sendListVersion = 0;
+	int lastSendListVersion = -1;
+
+	SendState sendStates[NumSendChannels][NumSendChannels];
+
+	/** The indexes of the sends that are currently processed (the order doesn't matter). */
+	int activeSends[NumSendChannels * NumSendChannels];
+	int numActiveSends = 0;
+
+	AudioSampleBuffer sendBuffer;
+	AudioSampleBuffer scratchBuffer;
+	bool destinationUsed[NumSendChannels];
+
+	int auxBlockCounter = 0;
+	int auxNumSamples = 0;
+	int lastAuxBlockCounter = -1;
+	bool auxReturnIsValid = false;
+
+	String auxReturnId;
+	WeakReference<Processor> auxReturnSource;
+
+	int numSendDelayChannels = 0;
+	ScopedPointer<LatencyCompensation> destinationDelays;
+	ScopedPointer<LatencyCompensation> sendDelays;
 
 };
 
@@ -499,6 +499,14 @@ void ShapeFX::updateOversampling()
 		if (getSampleRate() > 0.0)
 			bitCrushSmoother.reset(getSampleRate() * oversampleFactor, 0.04);
 	}
+
+	const int newLatency = oversampleFactor != 1 ? latency : 0;
+
+	if (newLatency != oversamplingLatency)
+	{
+		oversamplingLatency = newLatency;
+		sendLatencyChangeMessage();
+	}
 }
 
 void ShapeFX::updateGain()
@@ -247,6 +247,9 @@ public:
 	Rectangle<float> getPeakValues() const { return { inPeakValueL, inPeakValueR, outPeakValueL, outPeakValueR }; }
 
 	void updateOversampling();
+
+	/** Returns the latency of the oversampling filters (the dry signal is delayed by the same amount). */
+	int getLatency() const override { return oversamplingLatency; }
 	
 
 	void updateFilter(bool updateLowPass);
@@ -314,6 +317,7 @@ private:
 
 	SpinLock oversamplerLock;
 	ScopedPointer<Oversampler> oversampler;
+	int oversamplingLatency = 0;
 	
 	ShapeMode mode;
 
@@ -165,6 +165,9 @@ public:
 
 	bool hasTail() const override {return true; };
 
+	/** The longest comb filter of the reverb is about 40ms. The tail itself is checked by the chain. */
+	int getNumSilentSamplesBeforeSuspension() const override { return roundToInt(0.05 * getSampleRate()); }
+
 	
 	int getNumChildProcessors() const override { return 0; };
 
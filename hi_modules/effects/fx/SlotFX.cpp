@@ -172,6 +172,8 @@ bool SlotFX::setEffect(const String& typeName, bool /*synchronously*/)
 				sp->compileScript();
 			}
 
+			sendLatencyChangeMessage();
+
 			return true;
 		}
 		else
@@ -35,6 +35,11 @@ public:
 		return wrappedEffect != nullptr ? wrappedEffect->hasTail() : false;
 	};
 
+	int getLatency() const override
+	{
+		return wrappedEffect != nullptr ? wrappedEffect->getLatency() : 0;
+	}
+
 	Processor *getChildProcessor(int /*processorIndex*/) override
 	{
 		return getCurrentEffect();
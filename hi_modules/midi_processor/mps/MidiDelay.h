@@ -50,53 +50,18 @@ public:
 		delayTime(44100)
 	{};
 
+	/** Moves the event by the delay time. The MidiProcessorChain schedules it for the block where it is due. */
 	void processHiseEvent(HiseEvent &m) override
 	{
-		m.setTimeStamp(delayTime);
+		m.addToTimeStamp(delayTime);
 	};
 
-	
-
 	float getAttribute(int) const override { return (float)delayTime; };
 
-	void setInternalAttribute(int, float newValue) override { delayTime = (int)newValue;	};
+	void setInternalAttribute(int, float newValue) override { delayTime = jmax<int>(0, (int)newValue);	};
 
 private:
 
-	/** Returns the event id of the note message or -1 if none found. */
-	int findEventIdToMatch(const MidiMessage &noteOff, bool deleteIfMatched)
-	{
-		if(noteOff.isNoteOff())
-			{
-			for(int i = 0; i < events.size(); i++)
-			{
-				if(events[i].m.getNoteNumber() == noteOff.getNoteNumber())
-				{
-					const int thisId = events[i].eventId;
-
-					if(deleteIfMatched) events.remove(i);
-
-					return thisId;
-				}
-
-			};
-		}
-
-		return -1;
-
-	}
-
-	struct MidiEvent
-	{
-		MidiMessage m;
-		int eventId;
-
-		
-
-	};
-
-	Array<MidiEvent> events;
-
 	int delayTime;
 };
 
@@ -145,6 +145,10 @@ void CCDucker::setInternalAttribute(int parameterIndex, float newValue)
 
 void CCDucker::handleHiseEvent(const HiseEvent &m)
 {
+	// The controller messages are read from the controller state of the synth in calculateBlock()
+	if (controllerReader.isConnected())
+		return;
+
 	if (m.isControllerOfType(ccNumber))
 	{
 		currentUptime = 0.0f;
@@ -163,6 +167,35 @@ void CCDucker::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 void CCDucker::calculateBlock(int startSample, int numSamples)
 {
+	connectToControllerState(controllerReader);
+
+	// A message in a block that wasn't rendered restarts the ducking at the start of this block
+	if (controllerReader.getMissedValue(ccNumber) >= 0.0f)
+	{
+		currentUptime = 0.0f;
+		targetValue = -1.0f;
+	}
+
+	int position = startSample;
+
+	// Restart the ducking at the position of every controller message
+	controllerReader.read(ccNumber, startSample, numSamples, [&](int breakpointPosition, const ControllerStateBuffer::Breakpoint&)
+	{
+		renderSegment(position, breakpointPosition - position);
+		position = breakpointPosition;
+
+		currentUptime = 0.0f;
+		targetValue = -1.0f;
+	});
+
+	renderSegment(position, startSample + numSamples - position);
+}
+
+void CCDucker::renderSegment(int startSample, int numSamples)
+{
+	if (numSamples <= 0)
+		return;
+
 	const bool smoothThisBlock = fabsf(targetValue - currentValue) > 0.001f;
 
 	if (currentUptime == -1.0f)
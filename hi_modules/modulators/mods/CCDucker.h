@@ -84,9 +84,15 @@ public:
 private:
 
 	void setDuckingTime(float newValue);
+
+	/** Renders the ducking envelope between two controller messages. */
+	void renderSegment(int startSample, int numSamples);
+
 	float getNextValue();
 	Smoother smoother;
 
+	ControllerStateBuffer::Reader controllerReader;
+
 	float smoothTime;
 	float attackTime;
 	int ccNumber;
@@ -43,7 +43,6 @@ hold(20),
 decay(20),
 learnMode(false),
 inputValue(0.0f),
-targetValue(0.0f),
 fixedNoteOff(true),
 startLevel(1.0f),
 endLevel(1.0f),
@@ -51,6 +50,8 @@ smoothedCCValue(1.0f),
 dutyVoice(INT_MAX)
 {
 
+	ramp.setValue(0.0f);
+
 	table = new SampleLookupTable();
 
 	table->setLengthInSamples(512);
@@ -173,7 +174,7 @@ void CCEnvelope::setInternalAttribute(int parameter_index, float newValue)
 	{
 		smoothTime = newValue;
 		
-		smoother.setSmoothingTime(smoothTime);
+		ramp.setSmoothingTime(smoothTime);
 		
 		break;
 	}
@@ -183,7 +184,10 @@ void CCEnvelope::setInternalAttribute(int parameter_index, float newValue)
 	{
 		defaultValue = newValue;
 
-		handleHiseEvent(HiseEvent(HiseEvent::Type::Controller, (uint8)controllerNumber, (uint8)defaultValue, 1));
+		// The aftertouch and the pitch wheel can't be sent as controller message, so they don't use the default value
+		if (isPositiveAndBelow(controllerNumber, 128))
+			setControllerValue((float)(uint8)defaultValue / 127.0f);
+
 		break;
 	}
 	case StartLevel:
@@ -301,13 +305,21 @@ void CCEnvelope::reset(int voiceIndex)
 
 void CCEnvelope::calculateBlock(int startSample, int numSamples)
 {
-	if (--numSamples >= 0)
-	{
-		int voiceIndex = polyManager.getCurrentVoice();
+	int voiceIndex = polyManager.getCurrentVoice();
+
+	if (dutyVoice == INT_MAX) dutyVoice = voiceIndex;
 
-		if (dutyVoice == INT_MAX) dutyVoice = voiceIndex;
+	// The first active voice renders the smoothed controller values for all voices
+	if (voiceIndex == dutyVoice)
+		renderControllerValues(startSample, numSamples);
+
+	jassert(startSample + numSamples <= controllerValues.getNumSamples());
+
+	const float* ccValues = controllerValues.getReadPointer(0);
 
-		const float value = calculateNewValue();
+	if (--numSamples >= 0)
+	{
+		const float value = calculateNewValue(ccValues[startSample]);
 		internalBuffer.setSample(0, startSample, value);
 		++startSample;
 
@@ -325,11 +337,52 @@ void CCEnvelope::calculateBlock(int startSample, int numSamples)
 
 	while (--numSamples >= 0)
 	{
-		internalBuffer.setSample(0, startSample, calculateNewValue());
+		internalBuffer.setSample(0, startSample, calculateNewValue(ccValues[startSample]));
 		++startSample;
 	}
 }
 
+void CCEnvelope::renderControllerValues(int startSample, int numSamples)
+{
+	connectToControllerState(controllerReader);
+
+	// Catch up with the messages of the blocks that weren't rendered (eg. without active voices)
+	const float missedValue = controllerReader.getMissedValue(controllerNumber);
+
+	if (missedValue >= 0.0f)
+		setControllerValue(missedValue);
+
+	// Another voice might have rendered a part of this range already
+	const int endSample = startSample + numSamples;
+	int position = controllerReader.getUnreadStart(startSample, numSamples);
+
+	float* data = controllerValues.getWritePointer(0);
+
+	controllerReader.read(controllerNumber, startSample, numSamples, [&](int breakpointPosition, const ControllerStateBuffer::Breakpoint& b)
+	{
+		ramp.render(data + position, breakpointPosition - position);
+		position = breakpointPosition;
+
+		setControllerValue(b.value);
+	});
+
+	ramp.render(data + position, endSample - position);
+
+	smoothedCCValue = ramp.getCurrentValue();
+}
+
+void CCEnvelope::setControllerValue(float normalisedValue)
+{
+	inputValue = normalisedValue;
+
+	float value;
+
+	if (useTable) value = table->getInterpolatedValue(inputValue * (float)SAMPLE_LOOKUP_TABLE_SIZE);
+	else value = inputValue;
+
+	ramp.setTargetValue(value);
+}
+
 void CCEnvelope::handleHiseEvent(const HiseEvent& e)
 {
 	holdChain->handleHiseEvent(e);
@@ -356,6 +409,10 @@ void CCEnvelope::handleHiseEvent(const HiseEvent& e)
 		}
 	}
 
+	// The values are read from the controller state of the synth in calculateBlock()
+	if (controllerReader.isConnected())
+		return;
+
 	const bool isAftertouch = controllerNumber == 128 && (e.isAftertouch() || e.isChannelPressure());
 
 	if (isAftertouch || e.isControllerOfType(controllerNumber) || e.isPitchWheel())
@@ -377,12 +434,7 @@ void CCEnvelope::handleHiseEvent(const HiseEvent& e)
 			inputValue = e.getAfterTouchValue() / 127.0f;
 		}
 
-		float value;
-
-		if (useTable) value = table->getInterpolatedValue(inputValue * (float)SAMPLE_LOOKUP_TABLE_SIZE);
-		else value = inputValue;
-
-		targetValue = value;
+		setControllerValue(inputValue);
 	}
 };
 
@@ -398,7 +450,11 @@ void CCEnvelope::prepareToPlay(double sampleRate, int samplesPerBlock)
 	startLevelChain->prepareToPlay(sampleRate, samplesPerBlock);
 	endLevelChain->prepareToPlay(sampleRate, samplesPerBlock);
 
-	smoother.prepareToPlay(getSampleRate());
+	ramp.prepare(getSampleRate());
+
+	// The envelope is calculated with the control rate
+	controllerValues.setSize(1, jmax<int>(0, samplesPerBlock) / HISE_CONTROL_RATE_DOWNSAMPLING_FACTOR + 1);
+	controllerValues.clear();
 
 	if (sampleRate != -1.0) setInternalAttribute(SmoothTime, smoothTime);
 
@@ -410,17 +466,11 @@ bool CCEnvelope::isPlaying(int voiceIndex) const
 	return state->current_state != CCEnvelopeState::IDLE;
 }
 
-float CCEnvelope::calculateNewValue()
+float CCEnvelope::calculateNewValue(float ccValue)
 {
 	const int voiceIndex = polyManager.getCurrentVoice();
 	
 	jassert(dutyVoice != INT_MAX);
-
-	if (voiceIndex == dutyVoice)
-	{
-		smoothedCCValue = getSmoothedCCValue(targetValue);
-	}
-
 	jassert(voiceIndex < states.size());
 	 
 	CCEnvelopeState *state = static_cast<CCEnvelopeState*>(states[voiceIndex]);
@@ -452,14 +502,14 @@ float CCEnvelope::calculateNewValue()
 
 				jassert(alpha <= 1.0f);
 
-				state->actualValue = Interpolator::interpolateLinear(state->voiceEndLevel, smoothedCCValue, alpha);
+				state->actualValue = Interpolator::interpolateLinear(state->voiceEndLevel, ccValue, alpha);
 				state->uptime++;
 
 				break;
 			}
 		}
 		case CCEnvelopeState::SUSTAIN:
-			state->actualValue = smoothedCCValue;
+			state->actualValue = ccValue;
 			break;
 		case CCEnvelopeState::IDLE:
 			state->actualValue = state->idleValue;
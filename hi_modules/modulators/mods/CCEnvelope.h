@@ -186,14 +186,13 @@ private:
 		float actualValue;
 	};
 
-	float calculateNewValue();
+	float calculateNewValue(float ccValue);
 
-	float getSmoothedCCValue(float newTargetValue)
-	{
-		smoothedCCValue = smoother.smooth(newTargetValue);
+	/** Renders the smoothed controller values of the given range into the buffer that is shared by all voices. */
+	void renderControllerValues(int startSample, int numSamples);
 
-		return smoothedCCValue;
-	}
+	/** Applies the table to the normalised controller value and sets it as new target. */
+	void setControllerValue(float normalisedValue);
 
 	int dutyVoice; // the first active voice will handle the smoothing
 
@@ -218,13 +217,13 @@ private:
 
 	bool learnMode;
 	float inputValue;
-	float targetValue;
 	
 	float smoothedCCValue;
 
-	
+	ControllerStateBuffer::Reader controllerReader;
+	ControllerStateBuffer::ExponentialRamp ramp;
 
-	Smoother smoother;
+	AudioSampleBuffer controllerValues;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CCEnvelope)
 };
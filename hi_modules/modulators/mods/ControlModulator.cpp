@@ -34,19 +34,19 @@ namespace hise { using namespace juce;
 
 ControlModulator::ControlModulator(MainController *mc, const String &id, Modulation::Mode m):
 	TimeVariantModulator(mc, id, m),
-    targetValue(1.0f),
 	Modulation(m),
 	intensity(1.0f),
 	inverted(false),
 	useTable(false),
 	table(new SampleLookupTable()),
 	smoothTime(200.0f),
-	currentValue(1.0f),
 	learnMode(false),
 	controllerNumber(1),
 	defaultValue(0.0f)
 {
 	this->enableConsoleOutput(false);
+
+	ramp.setValue(1.0f);
 	
 	table->setLengthInSamples(512);
 	
@@ -154,7 +154,7 @@ void ControlModulator::setInternalAttribute (int parameter_index, float newValue
 		{
 			smoothTime = newValue; 
 
-			smoother.setSmoothingTime(smoothTime);		
+			ramp.setSmoothingTime(smoothTime);		
 			break;
 		}
 
@@ -165,7 +165,9 @@ void ControlModulator::setInternalAttribute (int parameter_index, float newValue
 		{
 		defaultValue = newValue;
 
-		handleHiseEvent(HiseEvent(HiseEvent::Type::Controller, (uint8)controllerNumber, (uint8)defaultValue, 1));
+		// The aftertouch and the pitch wheel can't be sent as controller message, so they don't use the default value
+		if (isPositiveAndBelow(controllerNumber, 128))
+			setControllerValue((float)(uint8)defaultValue / 127.0f);
 
 		break;
 
@@ -181,7 +183,7 @@ void ControlModulator::setInternalAttribute (int parameter_index, float newValue
 void ControlModulator::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
 	TimeVariantModulator::prepareToPlay(sampleRate, samplesPerBlock);
-	smoother.prepareToPlay(getControlRate());
+	ramp.prepare(getControlRate());
 
 	if (sampleRate != -1.0) setInternalAttribute(SmoothTime, smoothTime);
 }
@@ -189,22 +191,30 @@ void ControlModulator::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 void ControlModulator::calculateBlock(int startSample, int numSamples)
 {
-	const bool smoothThisBlock = fabsf(targetValue - currentValue) > 0.001f;
+	connectToControllerState(controllerReader);
 
-	if (smoothThisBlock)
-	{
-		while (--numSamples >= 0)
-		{
-			currentValue = smoother.smooth(targetValue);
-			internalBuffer.setSample(0, startSample, currentValue);
-			++startSample;
-		}
-	}
-	else
+	// Catch up with the messages of the blocks that weren't rendered
+	const float missedValue = controllerReader.getMissedValue(controllerNumber);
+
+	if (missedValue >= 0.0f)
+		setControllerValue(missedValue);
+
+	float* data = internalBuffer.getWritePointer(0, 0);
+	int position = startSample;
+
+	// Render the segments between the controller messages of this range
+	controllerReader.read(controllerNumber, startSample, numSamples, [&](int breakpointPosition, const ControllerStateBuffer::Breakpoint& b)
 	{
-		currentValue = targetValue;
-		FloatVectorOperations::fill(internalBuffer.getWritePointer(0, startSample), currentValue, numSamples);
-	}
+		if (mpeEnabled && b.channel != 1)
+			return;
+
+		ramp.render(data + position, breakpointPosition - position);
+		position = breakpointPosition;
+
+		setControllerValue(b.value);
+	});
+
+	ramp.render(data + position, startSample + numSamples - position);
 
 	if (useTable && lastInputValue != inputValue)
     {
@@ -213,13 +223,18 @@ void ControlModulator::calculateBlock(int startSample, int numSamples)
     }
 }
 
-float ControlModulator::calculateNewValue()
+void ControlModulator::setControllerValue(float normalisedValue)
 {
-	currentValue = (fabsf(targetValue - currentValue) < 0.001) ? targetValue : smoother.smooth(targetValue);
-	
-	
+	inputValue = CONSTRAIN_TO_0_1(normalisedValue);
+
+	float value;
+
+	if(useTable) value = table->getInterpolatedValue(inputValue * (float)SAMPLE_LOOKUP_TABLE_SIZE);
+	else value = inputValue;
+
+	if(inverted) value = 1.0f - value;
 
-	return currentValue;
+	ramp.setTargetValue(value);
 }
 
 	/** sets the new target value if the controller number matches. */
@@ -253,6 +268,10 @@ void ControlModulator::handleHiseEvent(const HiseEvent &m)
 		}
 	}
 
+	// The values are read from the controller state of the synth in calculateBlock()
+	if (controllerReader.isConnected())
+		return;
+
 	const bool isAftertouch = controllerNumber == 128 && (m.isAftertouch() || m.isChannelPressure());
 
 	const bool isPitchWheel = controllerNumber == 129 && m.isPitchWheel();
@@ -289,16 +308,7 @@ void ControlModulator::handleHiseEvent(const HiseEvent &m)
 			jassertfalse;
 		}
 
-		inputValue = CONSTRAIN_TO_0_1(inputValue);
-		
-		float value;
-
-		if(useTable) value = table->getInterpolatedValue(inputValue * (float)SAMPLE_LOOKUP_TABLE_SIZE);
-		else value = inputValue;
-
-		if(inverted) value = 1.0f - value;
-
-		targetValue = value;
+		setControllerValue(inputValue);
 	}
 }
 } // namespace hise
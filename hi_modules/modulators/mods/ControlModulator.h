@@ -39,7 +39,8 @@
 *
 *	@ingroup modulatorTypes
 *
-*	It uses a simple low pass filter to smooth value changes.  
+*	It reads the controller messages from the decoded controller state of its sound generator, so the value changes
+*	are sample accurate, and smoothes them with a simple low pass filter.
 */
 class ControlModulator: public TimeVariantModulator,
 						public LookupTableProcessor,
@@ -101,7 +102,8 @@ private:
 
 	bool mpeEnabled = false;
 
-	float calculateNewValue();
+	/** Applies the table and the inversion to the normalised controller value and sets it as new target. */
+	void setControllerValue(float normalisedValue);
 
 	int controllerNumber;
 	float defaultValue;
@@ -112,17 +114,18 @@ private:
 	float polyValues[128];
 
 	bool learnMode;
-	float targetValue;
 	int64 uptime;
 	float inputValue;
     float lastInputValue = -1.0f;
 
-	// the smoothed version of the target value
-	float currentValue;
 	float lastCurrentValue;
 	float intensity;
 
-	Smoother smoother;
+	ControllerStateBuffer::Reader controllerReader;
+
+	// smoothes the target value
+	ControllerStateBuffer::ExponentialRamp ramp;
+
 	ScopedPointer<SampleLookupTable> table;
 
 	JUCE_DECLARE_WEAK_REFERENCEABLE(ControlModulator);
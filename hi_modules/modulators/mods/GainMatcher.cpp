@@ -33,7 +33,8 @@
 namespace hise { using namespace juce;
 
 GainMatcherModulator::GainMatcherModulator():
-table(new SampleLookupTable())
+table(new SampleLookupTable()),
+channel(nullptr)
 {
 
 }
@@ -47,33 +48,24 @@ StringArray GainMatcherModulator::getListOfAllGainCollectors()
 
 String GainMatcherModulator::getConnectedCollectorId() const
 {
-
-	if (connectedCollector.get() != nullptr)
-	{
-		return connectedCollector.get()->getId();
-	}
-	else return String();
+	return connectedId;
 }
 
 void GainMatcherModulator::setConnectedCollectorId(const String &newId)
 {
 	Modulator* thisAsMod = dynamic_cast<Modulator*>(this);
 
-	connectedCollector = ProcessorHelpers::getFirstProcessorWithName(thisAsMod->getMainController()->getMainSynthChain(), newId);
-}
+	connectedId = newId;
 
-
-const GainCollector * GainMatcherModulator::getCollector() const
-{
-	return dynamic_cast<const GainCollector*>(connectedCollector.get());
+	// The channel is created if the collector doesn't exist yet, so the loading order doesn't matter
+	channel.store(newId.isEmpty() ? nullptr : thisAsMod->getMainController()->getSidechainBus().getChannel(newId));
 }
 
 GainMatcherVoiceStartModulator::GainMatcherVoiceStartModulator(MainController *mc, const String &id, int numVoices, Modulation::Mode m) :
 VoiceStartModulator(mc, id, numVoices, m),
 Modulation(m),
 
-useTable(false),
-generator(Random(Time::currentTimeMillis()))
+useTable(false)
 {
 	this->enableConsoleOutput(false);
 
@@ -138,12 +130,13 @@ float GainMatcherVoiceStartModulator::getAttribute(int parameterIndex) const
 	}
 }
 
-float GainMatcherVoiceStartModulator::calculateVoiceStartValue(const HiseEvent &)
+float GainMatcherVoiceStartModulator::calculateVoiceStartValue(const HiseEvent &m)
 {
+	auto c = getChannel();
 
-	if (getCollector() == nullptr) return 1.0f;
+	if (c == nullptr) return 1.0f;
 
-	currentValue =  getCollector()->getCurrentGain();
+	currentValue = EnvelopeFollower::constrainTo0To1(c->getEnvelopeValue(m.getTimeStamp()));
 
 	if (useTable)
 	{
@@ -241,21 +234,18 @@ void GainMatcherTimeVariantModulator::prepareToPlay(double sampleRate, int sampl
 
 void GainMatcherTimeVariantModulator::calculateBlock(int startSample, int numSamples)
 {
-	const float newValue = getCollector() != nullptr ? getCollector()->getCurrentGain() : 1.0f;
+	float* data = internalBuffer.getWritePointer(0, startSample);
 
-	r.setTarget(currentValue, newValue, numSamples);
-
-	while (--numSamples >= 0)
-	{	
-		r.ramp(currentValue);
-
-		currentValue = EnvelopeFollower::constrainTo0To1(currentValue);
-
-		internalBuffer.setSample(0, startSample, currentValue);
-		++startSample;
+	if (auto c = getChannel())
+	{
+		c->readEnvelope(data, startSample, numSamples);
+		FloatVectorOperations::clip(data, data, 0.0f, 1.0f, numSamples);
 	}
-	
-	currentValue = newValue;
+	else
+		FloatVectorOperations::fill(data, 1.0f, numSamples);
+
+	if (numSamples > 0)
+		currentValue = data[numSamples - 1];
 
 	if (useTable)sendTableIndexChangeMessage(false, table, currentValue);
 
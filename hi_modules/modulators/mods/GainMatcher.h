@@ -37,6 +37,11 @@
 
 class GainCollector;
 
+/** The base class for the modulators that read the envelope of a GainCollector.
+*
+*	The modulators subscribe to the channel of the collector on the SidechainBus, so the envelope can be
+*	read at audio rate (with one block of latency) without looking up the collector during the rendering.
+*/
 class GainMatcherModulator : public LookupTableProcessor
 {
 public:
@@ -59,7 +64,8 @@ public:
 
 	Table *getTable(int = 0) const override { return table; };
 
-	const GainCollector *getCollector() const;
+	/** Returns the channel of the connected collector (or nullptr if it's not connected). */
+	const SidechainBus::Channel* getChannel() const noexcept { return channel.load(); }
 
 protected:
 
@@ -67,7 +73,9 @@ protected:
 
 private:
 
-	WeakReference<Processor> connectedCollector;
+	String connectedId;
+
+	std::atomic<SidechainBus::Channel*> channel;
 	
 };
 
@@ -95,7 +103,6 @@ private:
 
 	float currentValue;
 	bool useTable;
-	Random generator;
 	
 };
 
@@ -132,8 +139,6 @@ private:
 
 	float currentValue;
 
-	Ramper r;
-
 	bool useTable;
 
 };
@@ -90,7 +90,7 @@ LfoModulator::LfoModulator(MainController *mc, const String &id, Modulation::Mod
 
 	frequencyUpdater.setManualCountLimit(4096/HISE_CONTROL_RATE_DOWNSAMPLING_FACTOR);
 
-	randomGenerator.setSeedRandomly();
+	randomGenerator = mc->getRandomNumberService().createGenerator(RandomNumberService::getStreamId(id));
 
 	getMainController()->addTempoListener(this);
 
@@ -483,7 +483,8 @@ void LfoModulator::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 		valueUpdater.setManualCountLimit(LFO_DOWNSAMPLING_FACTOR);
 
-		randomGenerator.setSeedRandomly();
+		// Restart the random stream so that every render produces the same values
+		randomGenerator.setPosition(0);
 	}
 
 	// Use the block size to ramp the blocks.
@@ -328,7 +328,7 @@ private:
 
 	bool run;
 
-	juce::Random randomGenerator;
+	PhiloxRandom randomGenerator;
 
 	UpdateMerger inputMerger;
 
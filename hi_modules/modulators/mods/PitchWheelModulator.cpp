@@ -34,16 +34,16 @@ namespace hise { using namespace juce;
 
 PitchwheelModulator::PitchwheelModulator(MainController *mc, const String &id, Modulation::Mode m):
 	TimeVariantModulator(mc, id, m),
-    targetValue(0.5f),
 	Modulation(m),
 	intensity(1.0f),
 	inverted(false),
 	useTable(false),
 	table(new MidiTable()),
-	smoothTime(200.0f),
-	currentValue(0.5f)
+	smoothTime(200.0f)
 {
 	this->enableConsoleOutput(false);
+
+	ramp.setValue(0.5f);
 	
 	table->setXTextConverter(Modulation::getDomainAsPitchBendRange);
 
@@ -103,7 +103,7 @@ void PitchwheelModulator::setInternalAttribute (int parameter_index, float newVa
 		{
 			smoothTime = newValue; 
 
-			smoother.setSmoothingTime(smoothTime);		
+			ramp.setSmoothingTime(smoothTime);		
 			break;
 		}
 	case Parameters::UseTable:
@@ -118,31 +118,44 @@ void PitchwheelModulator::setInternalAttribute (int parameter_index, float newVa
 
 void PitchwheelModulator::calculateBlock(int startSample, int numSamples)
 {
-	const bool smoothThisBlock = fabsf(targetValue - currentValue) > 0.001f;
+	connectToControllerState(controllerReader);
 
-	if (smoothThisBlock)
-	{
-		while (--numSamples >= 0)
-		{
-			currentValue = smoother.smooth(targetValue);
-			internalBuffer.setSample(0, startSample, currentValue);
-			++startSample;
-		}
-	}
-	else
+	// Catch up with the messages of the blocks that weren't rendered
+	const float missedValue = controllerReader.getMissedValue(ControllerStateBuffer::PitchWheelNumber);
+
+	if (missedValue >= 0.0f)
+		setPitchWheelValue(missedValue);
+
+	float* data = internalBuffer.getWritePointer(0, 0);
+	int position = startSample;
+
+	controllerReader.read(ControllerStateBuffer::PitchWheelNumber, startSample, numSamples, [&](int breakpointPosition, const ControllerStateBuffer::Breakpoint& b)
 	{
-		currentValue = targetValue;
-		FloatVectorOperations::fill(internalBuffer.getWritePointer(0, startSample), currentValue, numSamples);
-	}
+		if (mpeEnabled && b.channel != 1)
+			return;
+
+		ramp.render(data + position, breakpointPosition - position);
+		position = breakpointPosition;
+
+		setPitchWheelValue(b.value);
+	});
+
+	ramp.render(data + position, startSample + numSamples - position);
 
 	if (useTable) sendTableIndexChangeMessage(false, table, inputValue);
 }
 
-float PitchwheelModulator::calculateNewValue ()
+void PitchwheelModulator::setPitchWheelValue(float normalisedValue)
 {
-	currentValue = (fabsf(targetValue - currentValue) < 0.001) ? targetValue : smoother.smooth(targetValue);
-	
-	return currentValue;
+	inputValue = normalisedValue;
+	float value;
+
+	if(useTable) value = table->get((int)(inputValue * 127.0f));
+	else value = inputValue;
+
+	if(inverted) value = 1.0f - value;
+
+	ramp.setTargetValue(value);
 }
 
 	/** sets the new target value if the controller number matches. */
@@ -151,19 +164,13 @@ void PitchwheelModulator::handleHiseEvent (const HiseEvent &m)
 	if (mpeEnabled && m.getChannel() != 1)
 		return;
 
+	// The values are read from the controller state of the synth in calculateBlock()
+	if (controllerReader.isConnected())
+		return;
+
 	if(m.isPitchWheel())
 	{
-		inputValue = m.getPitchWheelValue() / 16383.0f;
-		float value;
-
-		if(useTable) value = table->get((int)(inputValue * 127.0f));
-		else value = inputValue;
-
-		if(inverted) value = 1.0f - value;
-
-		targetValue = value;
-
-		
+		setPitchWheelValue(m.getPitchWheelValue() / 16383.0f);
 	};
 }
 
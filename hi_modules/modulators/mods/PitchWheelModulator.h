@@ -39,7 +39,8 @@ namespace hise { using namespace juce;
 *
 *	@ingroup modulatorTypes
 *
-*	It uses a simple low pass filter to smooth value changes.  
+*	It reads the pitch wheel messages from the decoded controller state of its sound generator and smoothes them
+*	with a simple low pass filter.
 */
 class PitchwheelModulator: public TimeVariantModulator,
 						   public LookupTableProcessor,
@@ -123,7 +124,7 @@ public:
 	virtual void prepareToPlay(double sampleRate, int samplesPerBlock) override
 	{
 		TimeVariantModulator::prepareToPlay(sampleRate, samplesPerBlock);
-		smoother.prepareToPlay(getControlRate());
+		ramp.prepare(getControlRate());
 
 		if(sampleRate != -1.0) setInternalAttribute(SmoothTime, smoothTime);
 	};
@@ -132,20 +133,13 @@ private:
 
 	bool mpeEnabled = false;
 
-	/** Returns a smoothed value of the current control value. 
-	*	Don't use this for GUI stuff, since it advances the smoothing! 
-	*/
-	float calculateNewValue();
-
-	float targetValue;
+	/** Applies the table and the inversion to the normalised pitch wheel value and sets it as new target. */
+	void setPitchWheelValue(float normalisedValue);
 
 	int64 uptime;
 
 	float inputValue;
 
-	// the smoothed version of the target value
-	float currentValue;
-
 	float lastCurrentValue;
 
 	float intensity;
@@ -156,7 +150,10 @@ private:
 
 	bool useTable;
 	
-	Smoother smoother;
+	ControllerStateBuffer::Reader controllerReader;
+
+	// smoothes the target value
+	ControllerStateBuffer::ExponentialRamp ramp;
 
 	ScopedPointer<MidiTable> table;
 
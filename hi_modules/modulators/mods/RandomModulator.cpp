@@ -37,7 +37,7 @@ RandomModulator::RandomModulator(MainController *mc, const String &id, int numVo
 		Modulation(m),
 		table(new MidiTable()),
 		useTable(false),
-		generator(Random (Time::currentTimeMillis()))
+		randomStreamId(RandomNumberService::getStreamId(id))
 {
 	this->enableConsoleOutput(false);
 
@@ -99,8 +99,10 @@ float RandomModulator::getAttribute(int parameterIndex) const
 	}
 }
 
-float RandomModulator::calculateVoiceStartValue(const HiseEvent &)
+float RandomModulator::calculateVoiceStartValue(const HiseEvent &m)
 {
+	auto generator = getMainController()->getRandomNumberService().createGenerator(randomStreamId, -1, m.getEventId());
+
 	float randomValue;
 
 	if (useTable)
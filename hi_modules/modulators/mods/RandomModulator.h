@@ -64,7 +64,10 @@ public:
 	void setInternalAttribute(int parameterIndex, float newValue) override;;
 	float getAttribute(int parameterIndex) const override;;
 
-	/** Calculates a new random value. If the table is used, it is converted to 7bit.*/
+	/** Calculates a new random value. If the table is used, it is converted to 7bit.
+	*
+	*	The value is derived from the project seed and the event ID, so the same notes yield the same values.
+	*/
 	float calculateVoiceStartValue(const HiseEvent& ) override;;
 
 	/** returns a pointer to the look up table. Don't delete it! */
@@ -74,7 +77,7 @@ private:
 
 	volatile float currentValue;
 	bool useTable;
-	Random generator;
+	const uint32 randomStreamId;
 
 	ScopedPointer<MidiTable> table;
 };
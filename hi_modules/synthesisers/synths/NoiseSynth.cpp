@@ -75,17 +75,10 @@ void NoiseVoice::calculateBlock(int startSample, int numSamples)
 	{
 	case hise::NoiseSynth::Normal:
 	{
-		while (--numSamples >= 0)
-		{
-			const float currentSample = getNextValue();
-
-			// Stereo mode assumed
-			voiceBuffer.setSample(0, startSample, currentSample);
-
-			voiceUptime += uptimeDelta;
+		// Stereo mode assumed
+		noiseGenerator.fillBipolar(voiceBuffer.getWritePointer(0, startSample), numSamples);
 
-			++startSample;
-		}
+		voiceUptime += uptimeDelta * (double)numSamples;
 		break;
 	}
 	case hise::NoiseSynth::DC:
@@ -218,17 +211,10 @@ void NoiseVoice::calculateBlock(int startSample, int numSamples)
 
 #else
 
-	while (--numSamples >= 0)
-	{
-		const float currentSample = getNextValue();
-
-		// Stereo mode assumed
-		voiceBuffer.setSample(0, startSample, currentSample);
-
-		voiceUptime += uptimeDelta;
+	// Stereo mode assumed
+	noiseGenerator.fillBipolar(voiceBuffer.getWritePointer(0, startSample), numSamples);
 
-		++startSample;
-	}
+	voiceUptime += uptimeDelta * (double)numSamples;
 	
 
 #endif
@@ -64,6 +64,13 @@ public:
         voiceUptime = 0.0;
         
         uptimeDelta = 1.0;
+
+		// Every voice gets its own stream that depends on the event, so renders are reproducible
+		auto synth = getOwnerSynth();
+		const uint32 streamId = RandomNumberService::getStreamId(synth->getId());
+
+		noiseGenerator = synth->getMainController()->getRandomNumberService().createGenerator(streamId, voiceIndex, getCurrentHiseEvent().getEventId());
+
 #if HI_RUN_UNIT_TESTS
 		lastUptime = -1.0;
 #endif
@@ -77,13 +84,7 @@ private:
 	double lastUptime = 0.0;
 #endif
 
-	inline float getNextValue() const
-	{
-		return 2.0f * ((float)(rand()) / (float)(RAND_MAX)) - 1.0f;
-	};
-
-	
-
+	PhiloxRandom noiseGenerator;
 };
 
 /** A simple noise generator.
@@ -79,6 +79,9 @@ public:
 
     void sync(double phase);
 
+	/** Replaces the random generator for the noise waveform (eg. with a stream for the current voice). */
+	void setNoiseGenerator(const hise::PhiloxRandom& newGenerator) { noiseGenerator = newGenerator; }
+
 protected:
     Waveform waveform;
     double sampleRate;
@@ -92,7 +95,7 @@ protected:
     double pulseWidth; // [0.0..1.0]
     double t; // The current phase [0.0..1.0) of the oscillator.
 
-	mutable Random noiseGenerator;
+	mutable hise::PhiloxRandom noiseGenerator;
 
     void setdt(double time);
 
@@ -379,6 +379,13 @@ void WaveSynthVoice::startNote(int midiNoteNumber, float /*velocity*/, Synthesis
 	if(enableSecondOsc)
 		rightGenerator.setStartOffset((double)getCurrentHiseEvent().getStartOffset());
 
+	// The noise streams depend on the voice and the event, so renders are reproducible
+	const uint32 streamId = RandomNumberService::getStreamId(getOwnerSynth()->getId());
+	auto& randomService = getOwnerSynth()->getMainController()->getRandomNumberService();
+
+	leftGenerator.setNoiseGenerator(randomService.createGenerator(streamId, voiceIndex, getCurrentHiseEvent().getEventId()));
+	rightGenerator.setNoiseGenerator(randomService.createGenerator(streamId + 1, voiceIndex, getCurrentHiseEvent().getEventId()));
+
 #else
 
 	cyclesPerSample = cyclesPerSecond / getSampleRate();
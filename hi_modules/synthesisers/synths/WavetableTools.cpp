@@ -185,14 +185,13 @@ struct ResynthesisHelpers
 	*/
 	static bool calculateHarmonicSpectrum(const AudioSampleBuffer &buffer, double sampleRate, AudioSampleBuffer& harmonicSpectrum, double pitch, SampleMapToWavetableConverter::WindowType windowType)
 	{
-		
-
-#if USE_IPP
 		if (pitch != 0.0)
 		{
 			int size = buffer.getNumSamples();
 
-			IppFFT fft(IppFFT::DataType::RealFloat, 16);
+			SharedResourcePointer<FFTService> fftService;
+			auto plan = fftService->getPlan(size);
+			const int numBins = plan->getNumBins();
 
 			float* dl = (float*)alloca(sizeof(float)*size);
 			float* dr = (float*)alloca(sizeof(float)*size);
@@ -220,20 +219,17 @@ struct ResynthesisHelpers
 			FloatVectorOperations::multiply(dl, w, size);
 			FloatVectorOperations::multiply(dr, w, size);
 
-			fft.realFFTInplace(dl, size);
-			fft.realFFTInplace(dr, size);
+			float* re[2] = { (float*)alloca(sizeof(float)*numBins), (float*)alloca(sizeof(float)*numBins) };
+			float* im[2] = { (float*)alloca(sizeof(float)*numBins), (float*)alloca(sizeof(float)*numBins) };
+			const float* input[2] = { dl, dr };
 
-			float* magL = (float*)alloca(sizeof(float)*size / 2);
-			float* magR = (float*)alloca(sizeof(float)*size / 2);
+			plan->forwardBatch(input, re, im, 2);
 
-			for (int i = 0; i < size / 2; i++)
-			{
-				magL[i] = dl[2 * i] * dl[2 * i] + dl[2 * i + 1] * dl[2 * i + 1];
-				magL[i] = sqrtf(magL[i]);
+			float* magL = (float*)alloca(sizeof(float)*numBins);
+			float* magR = (float*)alloca(sizeof(float)*numBins);
 
-				magR[i] = dr[2 * i] * dr[2 * i] + dr[2 * i + 1] * dr[2 * i + 1];
-				magR[i] = sqrtf(magR[i]);
-			}
+			FFTService::calculateMagnitudes(re[0], im[0], magL, numBins);
+			FFTService::calculateMagnitudes(re[1], im[1], magR, numBins);
 
 			auto halfSize = (double)size / 2.0;
 
@@ -289,9 +285,6 @@ struct ResynthesisHelpers
 		{
 			return false;
 		}
-#else
-		return false;
-#endif
 	}
 
 	static int getWavetableLength(int noteNumber, double sampleRate)
@@ -302,39 +295,59 @@ struct ResynthesisHelpers
 		return sampleNumber;
 	};
 
-	static void createWavetableFromHarmonicSpectrum(const float* hmx, int numHarmonics, float* data, int noteNumber, double sampleRate = 48000.0)
+	/** Returns the length of a single cycle rounded up to the next power of two.
+	*
+	*	The WavetableSynth calculates the pitch from the table size, so the tables don't need the exact cycle length
+	*	and can be resynthesised with a single inverse FFT.
+	*/
+	static int getWavetableTableLength(int noteNumber, double sampleRate)
 	{
-		auto length = getWavetableLength(noteNumber, sampleRate);
+		return nextPowerOfTwo(jmax<int>(4, getWavetableLength(noteNumber, sampleRate)));
+	}
 
-		FloatVectorOperations::clear(data, length);
+	/** Creates a single cycle with the given harmonic gains for each channel.
+	*
+	*	The harmonics are written into the sine part of the spectrum (so the phase matches the additive synthesis
+	*	of the previous implementation), transformed back with one inverse FFT per channel and normalised. The length
+	*	of the table is the size of the plan, so harmonics above its nyquist frequency are skipped.
+	*/
+	static void createWavetablesFromHarmonicSpectrum(const float* const* hmx, int numHarmonics, float* const* data, int numChannels, FFTService::Plan& plan)
+	{
+		const int length = plan.getSize();
+		const int numBins = plan.getNumBins();
 
+		HeapBlock<float> re, im;
+		re.calloc(numBins * numChannels);
+		im.calloc(numBins * numChannels);
 
+		float* reChannels[2] = { re.get(), re.get() + numBins };
+		float* imChannels[2] = { im.get(), im.get() + numBins };
 
+		jassert(numChannels <= 2);
 
-		double rootDelta = 2.0 * double_Pi / (double)length;
+		const int numHarmonicsToUse = jmin<int>(numHarmonics, length / 2 - 1);
 
-		for (int h = 0; h < numHarmonics; h++)
+		for (int c = 0; c < numChannels; c++)
 		{
-			float harmonicGain = hmx[h];
-
-			if (harmonicGain <= 0.0001f)
-				continue;
-
-			double uptime = 0.0;
-
-			for (int i = 0; i < length; i++)
+			for (int h = 0; h < numHarmonicsToUse; h++)
 			{
-				data[i] += harmonicGain * (float)sin(uptime);
-				uptime += rootDelta * (double)(h + 1);
+				const float harmonicGain = hmx[c][h];
+
+				if (harmonicGain > 0.0001f)
+					imChannels[c][h + 1] = -harmonicGain;
 			}
 		}
 
-		auto range = FloatVectorOperations::findMinAndMax(data, length);
+		plan.inverseBatch(data, reChannels, imChannels, numChannels);
 
-		auto maxLevel = jmax<float>(fabsf(range.getStart()), fabsf(range.getEnd()));
-
-		FloatVectorOperations::multiply(data, 1.0f / maxLevel, length);
+		for (int c = 0; c < numChannels; c++)
+		{
+			auto range = FloatVectorOperations::findMinAndMax(data[c], length);
+			auto maxLevel = jmax<float>(fabsf(range.getStart()), fabsf(range.getEnd()));
 
+			if (maxLevel > 0.0f)
+				FloatVectorOperations::multiply(data[c], 1.0f / maxLevel, length);
+		}
 	}
 
 };
@@ -474,15 +487,9 @@ juce::Result SampleMapToWavetableConverter::parseSampleMap(const File& sampleMap
 	return result;
 }
 
-int SampleMapToWavetableConverter::getLowestPossibleFFTSize() const
+int SampleMapToWavetableConverter::getLowestPossibleFFTSize(const HarmonicMap& m) const
 {
-	if (currentIndex < harmonicMaps.size())
-	{
-		return 2 * nextPowerOfTwo(harmonicMaps.getReference(currentIndex).wavetableLength);
-	}
-
-	jassertfalse;
-	return 512;
+	return 2 * nextPowerOfTwo(m.wavetableLength);
 }
 
 juce::Result SampleMapToWavetableConverter::calculateHarmonicMap()
@@ -495,19 +502,40 @@ juce::Result SampleMapToWavetableConverter::calculateHarmonicMap()
 
 	auto& m = harmonicMaps.getReference(currentIndex);
 
+	SampleReference ref;
+
+	auto result = getSampleReference(m.index.sampleIndex, ref);
+
+	if (result.failed())
+		return result;
+
+	result = analyseMap(m, ref, afm);
+
+	if (result.failed())
+		return result;
+
+	MessageManagerLock mm;
+	sendSynchronousChangeMessage();
+
+	return result;
+}
+
+juce::Result SampleMapToWavetableConverter::analyseMap(HarmonicMap& m, const SampleReference& ref, AudioFormatManager& formatManager) const
+{
 	Result result = Result::ok();
 
 	// Read entire sample & repitch
 	AudioSampleBuffer buffer;
 
-	result = readSample(buffer, m.index.sampleIndex, m.index.noteNumber);
+	result = readSample(buffer, ref, m.index.noteNumber, formatManager);
 
 	if (result.failed())
 		return result;
 
-	m.wavetableLength = ResynthesisHelpers::getWavetableLength(m.index.noteNumber, sampleRate);
+	m.originalSampleLength = ref.range.getLength();
+	m.wavetableLength = ResynthesisHelpers::getWavetableTableLength(m.index.noteNumber, sampleRate);
 
-	auto parts = splitSample(buffer);
+	auto parts = splitSample(buffer, fftSize > 0 ? fftSize : getLowestPossibleFFTSize(m));
 
 	auto nyquist = sampleRate / 2.0;
 
@@ -581,9 +609,6 @@ juce::Result SampleMapToWavetableConverter::calculateHarmonicMap()
 
 	m.analysed = true;
 
-	MessageManagerLock mm;
-	sendSynchronousChangeMessage();
-
 	return result;
 }
 
@@ -606,6 +631,149 @@ void SampleMapToWavetableConverter::renderAllWavetablesFromHarmonicMaps(double&
 	}
 }
 
+Result SampleMapToWavetableConverter::convertAllMaps(ProgressReporter& reporter)
+{
+	StringArray failedNotes;
+
+	// Stage 1: pitch detection and harmonic analysis of all notes that weren't analysed yet
+	{
+		Array<int> mapsToAnalyse;
+		Array<SampleReference> references;
+
+		for (int i = 0; i < harmonicMaps.size(); i++)
+		{
+			const auto& m = harmonicMaps.getReference(i);
+
+			if (m.analysed)
+				continue;
+
+			SampleReference ref;
+
+			// The sample map & the project handler are only accessed from this thread
+			if (getSampleReference(m.index.sampleIndex, ref).wasOk())
+			{
+				mapsToAnalyse.add(i);
+				references.add(ref);
+			}
+			else
+				failedNotes.add(MidiMessage::getMidiNoteName(m.index.noteNumber, true, true, 3));
+		}
+
+		reporter.stageChanged("Analysing " + String(mapsToAnalyse.size()) + " samples");
+
+		auto analyse = [&](int i)
+		{
+			// the format managers are not thread safe, so every call uses its own
+			AudioFormatManager formatManager;
+			formatManager.registerBasicFormats();
+			formatManager.registerFormat(new hlac::HiseLosslessAudioFormat(), false);
+
+			analyseMap(harmonicMaps.getReference(mapsToAnalyse[i]), references.getReference(i), formatManager);
+		};
+
+		if (!runParallel(mapsToAnalyse.size(), analyse, reporter))
+			return Result::fail("Conversion cancelled");
+
+		// The maps are only flagged as analysed if the analysis was successful
+		for (auto i : mapsToAnalyse)
+		{
+			const auto& m = harmonicMaps.getReference(i);
+
+			if (!m.analysed)
+				failedNotes.add(MidiMessage::getMidiNoteName(m.index.noteNumber, true, true, 3));
+		}
+	}
+
+	// Stage 2: resynthesis of the wavetable banks
+	{
+		Array<int> mapsToRender;
+
+		for (int i = 0; i < harmonicMaps.size(); i++)
+		{
+			if (harmonicMaps.getReference(i).analysed)
+				mapsToRender.add(i);
+		}
+
+		reporter.stageChanged("Creating " + String(mapsToRender.size()) + " wavetable banks");
+
+		Array<AudioSampleBuffer> banks;
+		banks.insertMultiple(0, AudioSampleBuffer(), mapsToRender.size());
+
+		auto render = [&](int i)
+		{
+			banks.getReference(i) = calculateWavetableBank(harmonicMaps.getReference(mapsToRender[i]));
+		};
+
+		if (!runParallel(mapsToRender.size(), render, reporter))
+			return Result::fail("Conversion cancelled");
+
+		reporter.stageChanged("Writing wavetable banks");
+
+		leftValueTree.removeAllChildren(nullptr);
+		rightValueTree.removeAllChildren(nullptr);
+
+		for (int i = 0; i < mapsToRender.size(); i++)
+		{
+			const auto& map = harmonicMaps.getReference(mapsToRender[i]);
+			auto& bank = banks.getReference(i);
+
+			storeData(map.index.noteNumber, bank.getWritePointer(0), leftValueTree, bank.getNumSamples());
+			storeData(map.index.noteNumber, bank.getWritePointer(1), rightValueTree, bank.getNumSamples());
+
+			reporter.progressChanged((double)(i + 1) / (double)mapsToRender.size());
+		}
+	}
+
+	if (!failedNotes.isEmpty())
+		return Result::fail("Couldn't analyse " + failedNotes.joinIntoString(", "));
+
+	return Result::ok();
+}
+
+bool SampleMapToWavetableConverter::runParallel(int numItems, const std::function<void(int)>& f, ProgressReporter& reporter)
+{
+	if (numItems == 0)
+		return !reporter.shouldCancel();
+
+	const int numThreads = jlimit<int>(1, 16, jmin<int>(SystemStats::getNumCpus(), numItems));
+
+	std::atomic<int> nextIndex(0);
+	std::atomic<int> numDone(0);
+	std::atomic<int> numFinishedThreads(0);
+	std::atomic<bool> cancelled(false);
+	WaitableEvent finished;
+
+	ThreadPool pool(numThreads);
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		pool.addJob([&, numThreads]()
+		{
+			for (int index = nextIndex++; index < numItems && !cancelled; index = nextIndex++)
+			{
+				f(index);
+				numDone++;
+			}
+
+			if (++numFinishedThreads == numThreads)
+				finished.signal();
+		});
+	}
+
+	// The reporter is only called from this thread
+	while (!finished.wait(50))
+	{
+		reporter.progressChanged((double)numDone.load() / (double)numItems);
+
+		if (!cancelled && reporter.shouldCancel())
+			cancelled = true;
+	}
+
+	reporter.progressChanged(1.0);
+
+	return !cancelled;
+}
+
 AudioSampleBuffer SampleMapToWavetableConverter::calculateWavetableBank(const HarmonicMap &map)
 {
 	AudioSampleBuffer bank(2, map.wavetableLength * numParts);
@@ -620,11 +788,17 @@ AudioSampleBuffer SampleMapToWavetableConverter::calculateWavetableBank(const Ha
 
 	int partIndex = 0;
 
+	if (map.wavetableLength == 0)
+		return bank;
+
+	auto plan = fftService->getPlan(map.wavetableLength);
+
 	for (int i = 0; i < map.harmonicGains.getNumChannels(); i++)
 	{
-		ResynthesisHelpers::createWavetableFromHarmonicSpectrum(map.harmonicGains.getReadPointer(partIndex), map.harmonicGains.getNumSamples(), dataL + offset, map.index.noteNumber, sampleRate);
+		const float* harmonics[2] = { map.harmonicGains.getReadPointer(partIndex), map.harmonicGainsRight.getReadPointer(partIndex) };
+		float* tables[2] = { dataL + offset, dataR + offset };
 
-		ResynthesisHelpers::createWavetableFromHarmonicSpectrum(map.harmonicGainsRight.getReadPointer(partIndex), map.harmonicGains.getNumSamples(), dataR + offset, map.index.noteNumber, sampleRate);
+		ResynthesisHelpers::createWavetablesFromHarmonicSpectrum(harmonics, map.harmonicGains.getNumSamples(), tables, 2, *plan);
 
 		if (useOriginalGain)
 		{
@@ -741,7 +915,11 @@ juce::AudioSampleBuffer SampleMapToWavetableConverter::getPreviewBuffers(bool or
 
 			int length = currentMap->wavetableLength;
 
-			auto numWavetables = (float)currentSampleLength / (float)length;
+			// The tables are longer than a cycle (see ResynthesisHelpers::getWavetableTableLength())
+			const double rootFrequency = MidiMessage::getMidiNoteInHertz(currentMap->index.noteNumber);
+			const double cycleLength = sampleRate / rootFrequency;
+
+			auto numWavetables = (float)((double)currentMap->originalSampleLength / cycleLength);
 
 			int numWaveTablesPerPart = jmax<int>(1, nextPowerOfTwo(roundToInt(numWavetables / (float)numParts)));
 
@@ -785,9 +963,11 @@ juce::AudioSampleBuffer SampleMapToWavetableConverter::getPreviewBuffers(bool or
 
 			auto playbackRate = chain->getSampleRate();
 
-			if (playbackRate != sampleRate)
+			// one table must be played back as one cycle of the root frequency
+			const double ratio = (double)length * rootFrequency / playbackRate;
+
+			if (std::abs(ratio - 1.0) > 1e-6)
 			{
-				double ratio = sampleRate / playbackRate;
 				int newNumSamples = roundToInt((double)b.getNumSamples() / ratio);
 
 				LagrangeInterpolator interpolator;
@@ -862,9 +1042,24 @@ int SampleMapToWavetableConverter::getSampleIndexForNoteNumber(int noteNumber)
 }
 
 juce::Result SampleMapToWavetableConverter::readSample(AudioSampleBuffer& buffer, int index, int noteNumber)
+{
+	SampleReference ref;
+
+	auto r = getSampleReference(index, ref);
+
+	if (r.failed())
+		return r;
+
+	return readSample(buffer, ref, noteNumber, afm);
+}
+
+juce::Result SampleMapToWavetableConverter::getSampleReference(int index, SampleReference& ref) const
 {
 	auto sample = sampleMap.getChild(index);
 
+	if (!sample.isValid())
+		return Result::fail("Sample not found");
+
 	const bool isMonolith = (int)sampleMap.getProperty("SaveMode") == SampleMap::SaveMode::Monolith;
 
 	int monoOffset = 0;
@@ -889,33 +1084,30 @@ juce::Result SampleMapToWavetableConverter::readSample(AudioSampleBuffer& buffer
 		filePath = GET_PROJECT_HANDLER(chain).getFilePath(fileName, ProjectHandler::SubDirectories::Samples);
 	}
 
-
-
 	jassert(File::isAbsolutePath(filePath));
-	File f = File(filePath);
 
+	ref.file = File(filePath);
 
-	auto range = Range<int>((int)getSampleProperty(sample, SampleIds::SampleStart) + monoOffset,
+	ref.range = Range<int>((int)getSampleProperty(sample, SampleIds::SampleStart) + monoOffset,
 		(int)getSampleProperty(sample, SampleIds::SampleEnd) + monoOffset);
 
+	ref.rootNote = (int)getSampleProperty(sample, SampleIds::Root);
 
-	auto rootNote = (int)getSampleProperty(sample, SampleIds::Root);
-
-
-
+	return Result::ok();
+}
 
+juce::Result SampleMapToWavetableConverter::readSample(AudioSampleBuffer& buffer, const SampleReference& ref, int noteNumber, AudioFormatManager& formatManager) const
+{
+	const auto& f = ref.file;
+	const auto& range = ref.range;
+	const auto rootNote = ref.rootNote;
 
 	if (f.existsAsFile())
 	{
-
-
-		ScopedPointer<AudioFormatReader> reader = afm.createReaderFor(f);
-
-
+		ScopedPointer<AudioFormatReader> reader = formatManager.createReaderFor(f);
 
 		if (reader != nullptr)
 		{
-
 			if (reader->sampleRate == sampleRate && rootNote == noteNumber)
 			{
 				buffer.setSize(2, range.getLength());
@@ -924,8 +1116,6 @@ juce::Result SampleMapToWavetableConverter::readSample(AudioSampleBuffer& buffer
 				return Result::ok();
 			}
 
-			currentSampleLength = range.getLength();
-
 			AudioSampleBuffer unresampled(2, range.getLength());
 			reader->read(&unresampled, 0, range.getLength(), range.getStart(), true, true);
 
@@ -947,7 +1137,7 @@ juce::Result SampleMapToWavetableConverter::readSample(AudioSampleBuffer& buffer
 		}
 		else
 		{
-			return Result::fail("Error opening file " + filePath);
+			return Result::fail("Error opening file " + f.getFullPathName());
 		}
 	}
 	else
@@ -956,12 +1146,12 @@ juce::Result SampleMapToWavetableConverter::readSample(AudioSampleBuffer& buffer
 	}
 }
 
-Array<juce::AudioSampleBuffer> SampleMapToWavetableConverter::splitSample(const AudioSampleBuffer& buffer)
+Array<juce::AudioSampleBuffer> SampleMapToWavetableConverter::splitSample(const AudioSampleBuffer& buffer, int fftSizeToUse) const
 {
 	Array<AudioSampleBuffer> parts;
 	parts.ensureStorageAllocated(numParts);
 
-	int thisFFTSize = fftSize > 0 ? fftSize : getLowestPossibleFFTSize();
+	int thisFFTSize = fftSizeToUse;
 
 	int oversampledLength = thisFFTSize * 1;
 	
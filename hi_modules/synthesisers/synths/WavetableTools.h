@@ -137,9 +137,28 @@ public:
 		double pitchDeviations[64];
 		double lastFrequency = -1.0;
 		int wavetableLength = 0;
+		int originalSampleLength = 0;
 		bool analysed = false;
 	};
 
+	/** Reports the progress of convertAllMaps() and allows to cancel the conversion.
+	*
+	*	All methods are called on the thread that started the conversion (not the worker threads).
+	*/
+	struct ProgressReporter
+	{
+		virtual ~ProgressReporter() {};
+
+		/** Called when a new stage of the conversion starts. */
+		virtual void stageChanged(const String& stageName) = 0;
+
+		/** Called periodically with the progress of the current stage (from 0 to 1). */
+		virtual void progressChanged(double progress) = 0;
+
+		/** Return true if the conversion should be aborted. */
+		virtual bool shouldCancel() = 0;
+	};
+
 	class Preview;
 	class SampleMapPreview;
 
@@ -162,6 +181,13 @@ public:
 
 	void renderAllWavetablesFromHarmonicMaps(double& progress);
 
+	/** Analyses all notes that haven't been analysed yet and renders the wavetables of all notes.
+	*
+	*	The pitch detection, the harmonic analysis and the resynthesis are spread across multiple worker threads.
+	*	Notes that can't be analysed are skipped and reported in the result.
+	*/
+	Result convertAllMaps(ProgressReporter& reporter);
+
 	AudioSampleBuffer calculateWavetableBank(const HarmonicMap& map);
 
 	double sampleRate = 48000.0;
@@ -214,10 +240,23 @@ private:
 		return nullptr;
 	}
 
-	int getLowestPossibleFFTSize() const;
+	struct SampleReference
+	{
+		File file;
+		Range<int> range;
+		int rootNote = -1;
+	};
+
+	int getLowestPossibleFFTSize(const HarmonicMap& m) const;
 
 	Result calculateHarmonicMap();
 
+	/** Reads the sample and calculates the harmonic spectrum of all parts. This can be called from a worker thread. */
+	Result analyseMap(HarmonicMap& m, const SampleReference& ref, AudioFormatManager& formatManager) const;
+
+	/** Runs the function for all indexes on a few worker threads and reports the progress until it's done. */
+	bool runParallel(int numItems, const std::function<void(int)>& f, ProgressReporter& reporter);
+
 	int currentIndex = 0;
 
 	Array<HarmonicMap> harmonicMaps;
@@ -231,7 +270,11 @@ private:
 
 	Result readSample(AudioSampleBuffer& buffer, int index, int noteNumber);
 
-	Array<AudioSampleBuffer> splitSample(const AudioSampleBuffer& buffer);
+	Result getSampleReference(int index, SampleReference& ref) const;
+
+	Result readSample(AudioSampleBuffer& buffer, const SampleReference& ref, int noteNumber, AudioFormatManager& formatManager) const;
+
+	Array<AudioSampleBuffer> splitSample(const AudioSampleBuffer& buffer, int fftSizeToUse) const;
 
 	Result loadSampleMapFromFile(File sampleMapFile);
 
@@ -243,9 +286,10 @@ private:
 	ValueTree leftValueTree;
 	ValueTree rightValueTree;
 
-	int currentSampleLength = 0;
-
 	AudioFormatManager afm;
+
+	// keeps the FFT plans alive while the converter is used
+	SharedResourcePointer<FFTService> fftService;
 };
 
 #endif
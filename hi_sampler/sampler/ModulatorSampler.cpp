@@ -112,6 +112,7 @@ reversed(false),
 numChannels(1),
 repeatMode(RepeatMode::KillSecondOldestNote),
 deactivateUIUpdate(false),
+prefetchLookupUpdater(*this),
 samplePreloadPending(false),
 temporaryVoiceBuffer(DEFAULT_BUFFER_TYPE_IS_FLOAT, 2, 0)
 {
@@ -166,6 +167,12 @@ temporaryVoiceBuffer(DEFAULT_BUFFER_TYPE_IS_FLOAT, 2, 0)
 
 	for (int i = 0; i < 127; i++) samplerDisplayValues.currentNotes[i] = 0;
 
+	if (HISE_NUM_PREFETCH_SLOTS > 0)
+	{
+		prefetchCache = new SamplePrefetchCache(getBackgroundThreadPool());
+		sampleMap->addListener(&prefetchLookupUpdater);
+	}
+
 	setVoiceAmount(numVoices);
 
 
@@ -183,6 +190,7 @@ ModulatorSampler::~ModulatorSampler()
 {
 	sampleMap = nullptr;
 	deleteAllSounds();
+	prefetchCache = nullptr;
 }
 
 int ModulatorSampler::getRRGroupsForMessage(int noteNumber, int velocity)
@@ -555,8 +563,12 @@ void ModulatorSampler::deleteSound(int index)
 				static_cast<ModulatorSamplerVoice*>(voices[i])->resetVoice();
 		}
 
+		if (prefetchCache != nullptr)
+			prefetchCache->clear();
+
 		{
 			LockHelpers::SafeLock sl(getMainController(), LockHelpers::SampleLock);
+			clearPrefetchLookup();
 			removeSound(index);
 		}
 
@@ -581,9 +593,14 @@ void ModulatorSampler::deleteAllSounds()
 		static_cast<ModulatorSamplerVoice*>(getVoice(i))->resetVoice();
 	}
 
+	if (prefetchCache != nullptr)
+		prefetchCache->clear();
+
 	{
 		LockHelpers::SafeLock sl(getMainController(), LockHelpers::SampleLock);
 
+		clearPrefetchLookup();
+
 		// The lifetime could exceed this function, so we need to flag it as pending for delete
 		// so that async tasks will not use this later.
 		for (int i = 0; i < getNumSounds(); i++)
@@ -977,10 +994,15 @@ void ModulatorSampler::preHiseEventCallback(const HiseEvent &m)
 		if (m.isNoteOn())
 		{
 			samplerDisplayValues.currentNotes[m.getNoteNumber() + m.getTransposeAmount()] = m.getVelocity();
+
+			notePredictor.noteOn(m.getNoteNumber() + m.getTransposeAmount());
+			prefetchPredictedSounds(m.getVelocity());
 		}
 		else
 		{
             samplerDisplayValues.currentNotes[m.getNoteNumber() + m.getTransposeAmount()] = 0;
+
+			notePredictor.noteOff(m.getNoteNumber() + m.getTransposeAmount());
 		}
 		
         sendAllocationFreeChangeMessage();
@@ -992,6 +1014,194 @@ void ModulatorSampler::preHiseEventCallback(const HiseEvent &m)
 	}
 }
 
+void ModulatorSampler::prefetchPredictedSounds(int velocity)
+{
+	if (prefetchCache == nullptr || prefetchLookup == nullptr || purged)
+		return;
+
+	int predictedNotes[16];
+	const int numPredictedNotes = notePredictor.fillPredictedNotes(predictedNotes, 16);
+
+	// The round robin group that will be used by the next note on
+	const int nextGroup = useRoundRobinCycleLogic ? (currentRRGroupIndex % jmax<int>(1, rrGroupAmount)) + 1 : currentRRGroupIndex;
+
+	int numRequests = 0;
+
+	for (int i = 0; i < numPredictedNotes; i++)
+	{
+		if (!isPositiveAndBelow(predictedNotes[i], 128))
+			continue;
+
+		for (auto sound : prefetchLookup->soundsForNote[predictedNotes[i]])
+		{
+			// The lookup is updated asynchronously, so we still need to check the mapping
+			if (!sound->appliesToNote(predictedNotes[i]))
+				continue;
+
+			if (!crossfadeGroups && !sound->appliesToRRGroup(nextGroup))
+				continue;
+
+			if (!sound->appliesToVelocity(velocity) || !sound->preloadBufferIsNonZero())
+				continue;
+
+			bool requestedForPreviousNote = false;
+
+			for (int j = 0; j < i && !requestedForPreviousNote; j++)
+				requestedForPreviousNote = sound->appliesToNote(predictedNotes[j]);
+
+			if (requestedForPreviousNote)
+				continue;
+
+			for (int c = 0; c < numChannels; c++)
+			{
+				if (prefetchCache->requestChunk(sound->getReferenceToSound(c)))
+					numRequests++;
+			}
+
+			if (numRequests >= HISE_MAX_PREFETCH_REQUESTS_PER_NOTE)
+				return;
+		}
+	}
+}
+
+void ModulatorSampler::rebuildPrefetchLookup()
+{
+	if (prefetchCache == nullptr)
+		return;
+
+	ScopedPointer<PrefetchLookup> newLookup = new PrefetchLookup();
+
+	LockHelpers::SafeLock sl(getMainController(), LockHelpers::SampleLock);
+
+	for (auto s : sounds)
+	{
+		auto sound = static_cast<ModulatorSamplerSound*>(s);
+
+		if (sound->isDeletePending())
+			continue;
+
+		for (int i = 0; i < 128; i++)
+		{
+			if (sound->appliesToNote(i))
+				newLookup->soundsForNote[i].add(sound);
+		}
+	}
+
+	{
+		LockHelpers::SafeLock al(getMainController(), LockHelpers::AudioLock);
+		prefetchLookup.swapWith(newLookup);
+	}
+}
+
+void ModulatorSampler::clearPrefetchLookup()
+{
+	ScopedPointer<PrefetchLookup> oldLookup;
+
+	{
+		LockHelpers::SafeLock al(getMainController(), LockHelpers::AudioLock);
+		prefetchLookup.swapWith(oldLookup);
+	}
+}
+
+void ModulatorSampler::PrefetchLookupUpdater::samplePropertyWasChanged(ModulatorSamplerSound* /*s*/, const Identifier& id, const var& /*newValue*/)
+{
+	// The other properties are checked when the sounds are requested
+	if (id == SampleIds::LoKey || id == SampleIds::HiKey)
+		triggerAsyncUpdate();
+}
+
+ModulatorSampler::NotePredictor::NotePredictor()
+{
+	FloatVectorOperations::clear(histogram, 128);
+	memset(heldNotes, 0, sizeof(heldNotes));
+}
+
+void ModulatorSampler::NotePredictor::noteOn(int noteNumber)
+{
+	if (!isPositiveAndBelow(noteNumber, 128))
+		return;
+
+	// Let the histogram decay so that it follows the recently played notes
+	FloatVectorOperations::multiply(histogram, 0.9f, 128);
+	histogram[noteNumber] += 1.0f;
+
+	heldNotes[noteNumber] = true;
+
+	lastInterval = lastNote != -1 ? noteNumber - lastNote : 0;
+	lastNote = noteNumber;
+}
+
+void ModulatorSampler::NotePredictor::noteOff(int noteNumber)
+{
+	if (isPositiveAndBelow(noteNumber, 128))
+		heldNotes[noteNumber] = false;
+}
+
+int ModulatorSampler::NotePredictor::fillPredictedNotes(int* predictedNotes, int maxNumNotes) const
+{
+	int numNotes = 0;
+
+	auto addNote = [&](int n)
+	{
+		if (numNotes == maxNumNotes || !isPositiveAndBelow(n, 128))
+			return;
+
+		for (int i = 0; i < numNotes; i++)
+		{
+			if (predictedNotes[i] == n)
+				return;
+		}
+
+		predictedNotes[numNotes++] = n;
+	};
+
+	if (lastNote == -1)
+		return 0;
+
+	// Repetitions and legato transitions of the current note
+	addNote(lastNote);
+
+	// The continuation of a run
+	if (lastInterval != 0 && std::abs(lastInterval) <= 12)
+		addNote(lastNote + lastInterval);
+
+	for (int i = 1; i <= 2; i++)
+	{
+		addNote(lastNote + i);
+		addNote(lastNote - i);
+	}
+
+	// The most played notes of the recent history
+	int mostPlayed = -1;
+	int secondMostPlayed = -1;
+
+	for (int i = 0; i < 128; i++)
+	{
+		if (histogram[i] < 0.1f)
+			continue;
+
+		if (mostPlayed == -1 || histogram[i] > histogram[mostPlayed])
+		{
+			secondMostPlayed = mostPlayed;
+			mostPlayed = i;
+		}
+		else if (secondMostPlayed == -1 || histogram[i] > histogram[secondMostPlayed])
+			secondMostPlayed = i;
+	}
+
+	addNote(mostPlayed);
+	addNote(secondMostPlayed);
+
+	// The other keys that are held down
+	for (int i = 0; i < 128; i++)
+	{
+		if (heldNotes[i])
+			addNote(i);
+	}
+
+	return numNotes;
+}
+
 float* ModulatorSampler::calculateCrossfadeModulationValuesForVoice(int voiceIndex, int startSample, int numSamples, int groupIndex)
 {
 	if (groupIndex > 8) return nullptr;
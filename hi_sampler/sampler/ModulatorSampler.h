@@ -531,6 +531,9 @@ public:
 
 	hlac::HiseSampleBuffer* getTemporaryVoiceBuffer() { return &temporaryVoiceBuffer; }
 
+	/** Returns the cache for the prefetched streaming chunks or nullptr if prefetching is disabled. */
+	SamplePrefetchCache* getPrefetchCache() { return prefetchCache.get(); }
+
 	bool checkAndLogIsSoftBypassed(DebugLogger::Location location) const;
 
 	void setHasPendingSampleLoad(bool hasSamplesPending)
@@ -597,6 +600,56 @@ private:
 		ModulatorSampler *sampler;
 	};
 
+	/** Keeps track of the played notes to predict the notes that are played next. */
+	struct NotePredictor
+	{
+		NotePredictor();
+
+		void noteOn(int noteNumber);
+		void noteOff(int noteNumber);
+
+		/** Writes the predicted notes into the given array and returns the number of notes. */
+		int fillPredictedNotes(int* predictedNotes, int maxNumNotes) const;
+
+	private:
+
+		float histogram[128];
+		bool heldNotes[128];
+		int lastNote = -1;
+		int lastInterval = 0;
+	};
+
+	/** The sounds that are mapped to each note, so that the prefetching doesn't have to check every sound on a note on. */
+	struct PrefetchLookup
+	{
+		Array<ModulatorSamplerSound*> soundsForNote[128];
+	};
+
+	/** Rebuilds the PrefetchLookup on the message thread when the sounds or their key ranges have changed. */
+	struct PrefetchLookupUpdater : public AsyncUpdater,
+								   public SampleMap::Listener
+	{
+		PrefetchLookupUpdater(ModulatorSampler& sampler_) : sampler(sampler_) {};
+
+		void handleAsyncUpdate() override { sampler.rebuildPrefetchLookup(); }
+
+		void sampleMapWasChanged(PoolReference) override { triggerAsyncUpdate(); }
+		void sampleAmountChanged() override { triggerAsyncUpdate(); }
+		void sampleMapCleared() override { triggerAsyncUpdate(); }
+		void samplePropertyWasChanged(ModulatorSamplerSound* s, const Identifier& id, const var& newValue) override;
+
+		ModulatorSampler& sampler;
+	};
+
+	/** Creates the lookup of the current sounds. Call this from the message thread. */
+	void rebuildPrefetchLookup();
+
+	/** Removes the lookup before sounds are deleted. */
+	void clearPrefetchLookup();
+
+	/** Requests the first streaming chunk of the sounds that are started by the predicted notes in the next round robin group. */
+	void prefetchPredictedSounds(int velocity);
+
 	
     /** Sets the streaming buffer and preload buffer sizes. */
     void setPreloadSize(int newPreloadSize);
@@ -654,6 +707,11 @@ private:
 	ModulatorChain* sampleStartChain = nullptr;
 	ModulatorChain* crossFadeChain = nullptr;
 	ScopedPointer<AudioThumbnailCache> soundCache;
+
+	NotePredictor notePredictor;
+	ScopedPointer<SamplePrefetchCache> prefetchCache;
+	ScopedPointer<PrefetchLookup> prefetchLookup;
+	PrefetchLookupUpdater prefetchLookupUpdater;
 	
 #if USE_BACKEND || HI_ENABLE_EXPANSION_EDITING
 	ScopedPointer<SampleEditHandler> sampleEditHandler;
@@ -419,7 +419,7 @@ bool ModulatorSamplerSound::preloadBufferIsNonZero() const noexcept
 
 int ModulatorSamplerSound::getRRGroup() const {	return rrGroup; }
 
-void ModulatorSamplerSound::selectSoundsBasedOnRegex(const String &regexWildcard, ModulatorSampler *sampler, SelectedItemSet<ModulatorSamplerSound::Ptr> &set)
+void ModulatorSamplerSound::selectSoundsBasedOnRegex(const String &regexWildcard, ModulatorSampler *sampler, SampleSelectionSet &set)
 {
 	bool subtractMode = false;
 
@@ -652,7 +652,96 @@ var ModulatorSamplerSound::getSampleProperty(const Identifier& id) const
 
 // ====================================================================================================================
 
+void SampleSelectionSet::setSelection(const SampleSelection& newSelection)
+{
+	selectedItems.clearQuick();
+	lookup.clear();
+
+	selectedItems.ensureStorageAllocated(newSelection.size());
+
+	for (auto s : newSelection)
+		addInternal(s.get());
+
+	sendChangeMessage();
+}
+
+void SampleSelectionSet::addArrayToSelection(const SampleSelection& soundsToAdd)
+{
+	bool changed = false;
+
+	selectedItems.ensureStorageAllocated(selectedItems.size() + soundsToAdd.size());
+
+	for (auto s : soundsToAdd)
+		changed |= addInternal(s.get());
+
+	if (changed)
+		sendChangeMessage();
+}
+
+void SampleSelectionSet::selectOnly(ModulatorSamplerSound* sound)
+{
+	if (getNumSelected() == 1 && isSelected(sound))
+		return;
+
+	selectedItems.clearQuick();
+	lookup.clear();
+	addInternal(sound);
+
+	sendChangeMessage();
+}
+
+void SampleSelectionSet::addToSelection(ModulatorSamplerSound* sound)
+{
+	if (addInternal(sound))
+		sendChangeMessage();
+}
 
+void SampleSelectionSet::addToSelectionBasedOnModifiers(ModulatorSamplerSound* sound, ModifierKeys modifiers)
+{
+	if (modifiers.isShiftDown())
+		addToSelection(sound);
+	else if (modifiers.isCommandDown())
+	{
+		if (isSelected(sound))
+			deselect(sound);
+		else
+			addToSelection(sound);
+	}
+	else
+		selectOnly(sound);
+}
+
+void SampleSelectionSet::deselect(ModulatorSamplerSound* sound)
+{
+	if (!isSelected(sound))
+		return;
+
+	lookup.remove(sound);
+	selectedItems.removeFirstMatchingValue(sound);
+
+	sendChangeMessage();
+}
+
+void SampleSelectionSet::deselectAll()
+{
+	if (selectedItems.isEmpty())
+		return;
+
+	selectedItems.clearQuick();
+	lookup.clear();
+
+	sendChangeMessage();
+}
+
+bool SampleSelectionSet::addInternal(ModulatorSamplerSound* sound)
+{
+	if (sound == nullptr || isSelected(sound))
+		return false;
+
+	lookup.set(sound, true);
+	selectedItems.add(sound);
+	return true;
+}
 
 // ====================================================================================================================
 
@@ -116,6 +116,8 @@ const int numProperties = 23;
 
 #undef DECLARE_ID
 
+class SampleSelectionSet;
+
 /** A ModulatorSamplerSound is a wrapper around a StreamingSamplerSound that allows modulation of parameters.
 *	@ingroup sampler
 *
@@ -373,7 +375,7 @@ public:
 
 	// ====================================================================================================================
 
-	static void selectSoundsBasedOnRegex(const String &regexWildcard, ModulatorSampler *sampler, SelectedItemSet<ModulatorSamplerSound::Ptr> &set);
+	static void selectSoundsBasedOnRegex(const String &regexWildcard, ModulatorSampler *sampler, SampleSelectionSet &set);
 
 
 	ValueTree getData() const { return data; }
@@ -463,6 +465,59 @@ private:
 
 typedef Array<ModulatorSamplerSound::Ptr> SampleSelection;
 
+/** A set of selected sounds that scales to sample maps with many thousand samples.
+*	@ingroup sampler
+*
+*	It has the same interface as the SelectedItemSet that was used before, but keeps a hash set of the
+*	selected sounds next to the ordered item list, so checking the membership doesn't need a linear search
+*	and selecting a whole sample map is not quadratic anymore. Use setSelection() to replace the selection
+*	with a single change message.
+*/
+class SampleSelectionSet : public ChangeBroadcaster
+{
+public:
+
+	using ItemArray = SampleSelection;
+
+	SampleSelectionSet() {};
+
+	/** Replaces the selection with the given sounds and sends a single change message. */
+	void setSelection(const SampleSelection& newSelection);
+
+	/** Adds the given sounds to the selection and sends a single change message. */
+	void addArrayToSelection(const SampleSelection& soundsToAdd);
+
+	void selectOnly(ModulatorSamplerSound* sound);
+
+	void addToSelection(ModulatorSamplerSound* sound);
+
+	void addToSelectionBasedOnModifiers(ModulatorSamplerSound* sound, ModifierKeys modifiers);
+
+	void deselect(ModulatorSamplerSound* sound);
+
+	void deselectAll();
+
+	bool isSelected(const ModulatorSamplerSound* sound) const noexcept { return lookup.contains(sound); }
+
+	int getNumSelected() const noexcept { return selectedItems.size(); }
+
+	ModulatorSamplerSound::Ptr getSelectedItem(int index) const { return selectedItems[index]; }
+
+	const ItemArray& getItemArray() const noexcept { return selectedItems; }
+
+	ModulatorSamplerSound::Ptr* begin() const noexcept { return selectedItems.begin(); }
+	ModulatorSamplerSound::Ptr* end() const noexcept { return selectedItems.end(); }
+
+private:
+
+	bool addInternal(ModulatorSamplerSound* sound);
+
+	ItemArray selectedItems;
+	HashMap<const void*, bool> lookup;
+
+	JUCE_DECLARE_NON_COPYABLE(SampleSelectionSet);
+};
+
 /** This object acts as global pool for all samples used in an instance of the plugin
 *	@ingroup sampler
 *
@@ -298,6 +298,7 @@ wrappedVoice(sampler->getBackgroundThreadPool())
 	wrappedVoice.setTemporaryVoiceBuffer(static_cast<ModulatorSampler*>(ownerSynth)->getTemporaryVoiceBuffer());
 	
 	wrappedVoice.setDebugLogger(&ownerSynth->getMainController()->getDebugLogger());
+	wrappedVoice.setPrefetchCache(sampler->getPrefetchCache());
 };
 
 
@@ -314,6 +315,7 @@ ModulatorSamplerVoice(ownerSynth)
 		wrappedVoices.getLast()->setLoaderBufferSize((int)getOwnerSynth()->getAttribute(ModulatorSampler::BufferSize));
 		wrappedVoices.getLast()->setTemporaryVoiceBuffer(static_cast<ModulatorSampler*>(ownerSynth)->getTemporaryVoiceBuffer());
 		wrappedVoices.getLast()->setDebugLogger(&ownerSynth->getMainController()->getDebugLogger());
+		wrappedVoices.getLast()->setPrefetchCache(static_cast<ModulatorSampler*>(ownerSynth)->getPrefetchCache());
 	}
 }
 
@@ -37,280 +37,872 @@ static const char * sfz_opcodeNames[SfzImporter::numSupportedOpcodes] =
 		"sample",
 		"lokey",
 		"hikey",
+		"key",
+		"pitch_keycenter",
 		"lovel",
 		"hivel",
 		"offset",
 		"end",
 		"loop_mode",
-		"loopstart",
-		"loopend",
+		"loop_start",
+		"loop_end",
+		"loop_crossfade",
 		"tune",
-		"pitch_keycenter",
+		"transpose",
 		"volume",
 		"group_volume",
+		"master_volume",
+		"global_volume",
 		"pan",
+		"xfin_lovel",
+		"xfin_hivel",
+		"xfout_lovel",
+		"xfout_hivel",
+		"seq_length",
+		"seq_position",
+		"trigger",
 		"group_label",
-		"key"
+		"master_label",
+		"default_path",
+		"note_offset",
+		"octave_offset"
 };
 
-Identifier SfzImporter::getSamplerProperty(Opcode opcode)
+const char **SfzImporter::opcodeNames = sfz_opcodeNames;
+
+namespace SfzHelpers
 {
-	switch(opcode)
-	{
-	case sample:			return SampleIds::FileName;
-	case lokey:				return SampleIds::LoKey;
-	case hikey:				return SampleIds::HiKey;
-	case lovel:				return SampleIds::LoVel;
-	case hivel:				return SampleIds::HiVel;
-	case offset:			return SampleIds::SampleStart;
-	case end:				return SampleIds::SampleEnd;
-	case loop_mode:			return SampleIds::LoopEnabled;
-	case loopstart:			return SampleIds::LoopStart;
-	case loopend:			return SampleIds::LoopEnd;
-	case tune:				return SampleIds::Pitch;
-	case pitch_keycenter:	return SampleIds::Root;
-	case volume:			return SampleIds::Volume;
-	case group_volume:		return SampleIds::Volume; // increases the Volume Property.
-	case pan:				return SampleIds::Pan;
-    case numSupportedOpcodes: jassertfalse; 
-	default:				jassertfalse; 
+	struct OpcodeAlias
+	{
+		const char* name;
+		SfzImporter::Opcode opcode;
 	};
 
-	return {};
-}
+	// The SFZ v1 names of some opcodes
+	static const OpcodeAlias aliases[] =
+	{
+		{ "loopstart", SfzImporter::loop_start },
+		{ "loopend", SfzImporter::loop_end },
+		{ "loopmode", SfzImporter::loop_mode },
+		{ "pitch", SfzImporter::tune }
+	};
 
-int getNoteNumberFromNameOrNumber(const String &data)
-{
-    if(RegexFunctions::matchesWildcard("[A-Ga-g]#?-?[0-9]", data))
-    {
-        const String noteName = data.toUpperCase();
-        
-        for(int i = 0; i < 127; i++)
-        {
-            if(noteName.contains(MidiMessage::getMidiNoteName(i, true, true, 3)))
-            {
-                return i;
-            }
-        }
-        return -1;
-    }
-    
-    return data.getIntValue();
-}
+	enum LoopMode
+	{
+		NoLoop = 0,
+		OneShot,
+		LoopContinuous,
+		LoopSustain
+	};
 
-var SfzImporter::getOpcodeValue(Opcode o, const String &valueString) const
-{
-	switch(o)
+	enum TriggerMode
 	{
-	case sample:		return var(fileToImport.getParentDirectory().getFullPathName() + "/" + valueString);
-	case loop_mode:		return (valueString == "loop_continuous") ? var(1) : var(0);
-    case lokey:
-    case hikey:
-    case pitch_keycenter: return var(getNoteNumberFromNameOrNumber(valueString));
-	default:			return var(valueString.getIntValue());
-	}
-}
+		Attack = 0,
+		Release,
+		First,
+		Legato,
+		ReleaseKey
+	};
 
-const char **SfzImporter::opcodeNames = sfz_opcodeNames;
+	static bool matches(const char* text, int length, const char* name)
+	{
+		return strncmp(text, name, (size_t)length) == 0 && name[length] == 0;
+	}
 
+	static int getLoopMode(const String& value)
+	{
+		if (value == "one_shot") return OneShot;
+		if (value == "loop_continuous") return LoopContinuous;
+		if (value == "loop_sustain") return LoopSustain;
 
-void SfzImporter::parseTagLine(const String &restOfLine)
-{
-	StringArray sa = getOpcodeTokens(restOfLine);
+		return NoLoop;
+	}
 
-	for (int i = 0; i < sa.size(); i++)
+	static int getTriggerMode(const String& value)
 	{
-		parseOpcode(sa[i]);
+		if (value == "release") return Release;
+		if (value == "first") return First;
+		if (value == "legato") return Legato;
+		if (value == "release_key") return ReleaseKey;
+
+		return Attack;
 	}
 }
 
-StringArray SfzImporter::getOpcodeTokens(const String &line) const
+/** Splits the SFZ text into headers, opcodes and directives. 
+*
+*	It works directly on the UTF-8 data of the file and only returns pointers into the text.
+*/
+class SfzImporter::Tokeniser
 {
-	String stringToTokenise = line.contains(">") ? line.fromFirstOccurrenceOf(">", false, false) : line; // skip tags
+public:
 
-	StringArray tokens = StringArray::fromTokens(stringToTokenise, " ", "");
+	enum class TokenType
+	{
+		Header,
+		Opcode,
+		Define,
+		Include,
+		EndOfFile
+	};
 
-	tokens.removeEmptyStrings();
+	Tokeniser(const String& content):
+		text(content),
+		p(text.toRawUTF8()),
+		end(p + strlen(p))
+	{}
 
-	for (int i = 0; i < tokens.size(); i++)
+	/** Reads the next token. The name and value point to the text of the file. */
+	TokenType next()
 	{
-		if (!tokens[i].contains("="))
+		skipWhitespaceAndComments();
+
+		name = value = p;
+		nameLength = valueLength = 0;
+
+		if (p >= end)
+			return TokenType::EndOfFile;
+
+		if (*p == '<')
 		{
-			if (i == 0) throw SfzParsingError(currentParseNumber, "Invalid token!");
+			name = ++p;
 
-			tokens.set(i - 1, tokens[i - 1] + " " + tokens[i]);
+			while (p < end && *p != '>' && *p != '\n')
+				p++;
 
-			tokens.remove(i--);
+			if (p >= end || *p != '>')
+				throw SfzParsingError(lineNumber, "Missing '>' after header");
 
-			continue;
+			nameLength = (int)(p++ - name);
+			return TokenType::Header;
 		}
-	}
 
-	return tokens;
-}
+		if (*p == '#')
+		{
+			const char* directive = ++p;
 
-void SfzImporter::parseOpcode(const String &opcode)
-{
-	StringArray opcodeTokens = StringArray::fromTokens(opcode, "=", "");
+			while (p < end && isIdentifierCharacter(*p))
+				p++;
 
-	if(opcodeTokens.size() == 2)
-	{
-		const int opcodeIndex = getOpcode(opcodeTokens[0]);
+			const int directiveLength = (int)(p - directive);
+
+			if (SfzHelpers::matches(directive, directiveLength, "define"))
+			{
+				skipSpaces();
+				name = p;
+
+				while (p < end && !isWhitespace(*p))
+					p++;
+
+				nameLength = (int)(p - name);
 
-		if(opcodeIndex == Opcode::groupName)
+				skipSpaces();
+				value = p;
+
+				while (p < end && *p != '\n' && *p != '\r' && !isComment(p))
+					p++;
+
+				valueLength = (int)(p - value);
+
+				while (valueLength > 0 && isWhitespace(value[valueLength - 1]))
+					valueLength--;
+
+				return TokenType::Define;
+			}
+
+			if (SfzHelpers::matches(directive, directiveLength, "include"))
+			{
+				skipSpaces();
+
+				if (p >= end || *p != '"')
+					throw SfzParsingError(lineNumber, "Expected a quoted file name after #include");
+
+				value = ++p;
+
+				while (p < end && *p != '"' && *p != '\n')
+					p++;
+
+				if (p >= end || *p != '"')
+					throw SfzParsingError(lineNumber, "Missing '\"' after the include file name");
+
+				valueLength = (int)(p++ - value);
+				return TokenType::Include;
+			}
+
+			throw SfzParsingError(lineNumber, "Unknown directive #" + String::fromUTF8(directive, directiveLength));
+		}
+
+		while (p < end && *p != '=' && *p != '<' && !isWhitespace(*p))
+			p++;
+
+		nameLength = (int)(p - name);
+
+		if (p >= end || *p != '=')
+			throw SfzParsingError(lineNumber, "Invalid token: " + String::fromUTF8(name, nameLength));
+
+		value = ++p;
+
+		const char* valueEnd = p;
+
+		// Values can contain spaces (eg. sample names), so they end at the next opcode, header or comment
+		while (p < end && *p != '\n' && *p != '\r' && *p != '<' && !isComment(p))
 		{
-			if(dynamic_cast<Group*>(currentTarget) != nullptr) dynamic_cast<Group*>(currentTarget)->groupName = opcodeTokens[1];
-			else throw SfzParsingError(currentParseNumber, "group name opcode outside of group definition");
+			if (isWhitespace(*p))
+			{
+				auto q = p;
+
+				while (q < end && (*q == ' ' || *q == '\t'))
+					q++;
+
+				if (q >= end || *q == '\n' || *q == '\r' || *q == '<' || isComment(q) || isOpcodeStart(q))
+					break;
+
+				p = q;
+				continue;
+			}
+
+			valueEnd = ++p;
 		}
-		else if(opcodeIndex != -1)
+
+		valueLength = (int)(valueEnd - value);
+		return TokenType::Opcode;
+	}
+
+	const char* name = nullptr;
+	int nameLength = 0;
+	const char* value = nullptr;
+	int valueLength = 0;
+	int lineNumber = 1;
+
+private:
+
+	static bool isWhitespace(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+	static bool isIdentifierCharacter(char c) noexcept 
+	{ 
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$'; 
+	}
+
+	bool isComment(const char* c) const noexcept { return c[0] == '/' && c + 1 < end && (c[1] == '/' || c[1] == '*'); }
+
+	bool isOpcodeStart(const char* c) const noexcept
+	{
+		auto start = c;
+
+		while (c < end && isIdentifierCharacter(*c))
+			c++;
+
+		return c != start && c < end && *c == '=';
+	}
+
+	void skipSpaces()
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+	}
+
+	void skipWhitespaceAndComments()
+	{
+		while (p < end)
 		{
-			if(currentTarget != nullptr)
+			if (*p == '\n')
 			{
-				currentTarget->setOpcodeValue(opcodeIndex, getOpcodeValue((Opcode)opcodeIndex, opcodeTokens[1]));
+				lineNumber++;
+				p++;
 			}
-			else
+			else if (isWhitespace(*p))
+				p++;
+			else if (isComment(p) && p[1] == '/')
+			{
+				while (p < end && *p != '\n')
+					p++;
+			}
+			else if (isComment(p))
 			{
-				throw SfzParsingError(currentParseNumber, "No Region for opcode");
+				p += 2;
+
+				while (p + 1 < end && !(p[0] == '*' && p[1] == '/'))
+				{
+					if (*p == '\n')
+						lineNumber++;
+
+					p++;
+				}
+
+				p = jmin(end, p + 2);
 			}
+			else
+				break;
 		}
-				
 	}
-	else
+
+	const String text;
+	const char* p;
+	const char* end;
+};
+
+void SfzImporter::OpcodeSet::overwriteWith(const OpcodeSet& other) noexcept
+{
+	for (int i = 0; i < numSupportedOpcodes; i++)
+	{
+		if (other.isSet((Opcode)i))
+			values[i] = other.values[i];
+	}
+
+	setMask |= other.setMask;
+}
+
+int SfzImporter::getOpcode(const char* name, int length)
+{
+	for (int i = 0; i < numSupportedOpcodes; i++)
 	{
-		throw SfzParsingError(currentParseNumber, "No opcode found");
+		if (SfzHelpers::matches(name, length, opcodeNames[i]))
+			return i;
 	}
+
+	for (const auto& a : SfzHelpers::aliases)
+	{
+		if (SfzHelpers::matches(name, length, a.name))
+			return a.opcode;
+	}
+
+	return -1;
+}
+
+bool SfzImporter::isStringOpcode(Opcode o)
+{
+	return o == sample || o == loop_mode || o == trigger || o == groupName || o == master_label || o == default_path;
 }
 
-void SfzImporter::parseOpcodes()
+int SfzImporter::getNoteNumberFromName(const String &data)
 {
-	StringArray fileData;
+	auto s = data.trim().toLowerCase();
+
+	if (s.isEmpty())
+		return -1;
+
+	static const int noteOffsets[7] = { 9, 11, 0, 2, 4, 5, 7 }; // a - g
+
+	const juce_wchar first = s[0];
+
+	if (first < 'a' || first > 'g')
+		return s.getIntValue();
+
+	int noteNumber = noteOffsets[first - 'a'];
+	int index = 1;
+
+	if (s[index] == '#')
+	{
+		noteNumber++;
+		index++;
+	}
+	else if (s[index] == 'b')
+	{
+		noteNumber--;
+		index++;
+	}
+
+	// c4 is the middle C (60)
+	const int octave = s.substring(index).getIntValue();
+
+	return noteNumber + (octave + 1) * 12;
+}
 
-	fileToImport.readLines(fileData);
+String SfzImporter::applyDefines(const String& s) const
+{
+	if (!s.containsChar('$'))
+		return s;
 
+	auto result = s;
+	auto keys = defines.getAllKeys();
 
-	for (int i = 0; i < fileData.size(); i++)
+	// Replace the longest names first so that $KEY doesn't replace a part of $KEYCENTER
+	struct LengthSorter
 	{
-		String currentLine = fileData[i].trimStart().upToFirstOccurrenceOf("//", false, false);
+		static int compareElements(const String& a, const String& b) { return b.length() - a.length(); }
+	};
+
+	LengthSorter sorter;
+	keys.strings.sort(sorter);
+
+	for (const auto& k : keys)
+		result = result.replace(k, defines[k]);
+
+	return result;
+}
+
+void SfzImporter::parse()
+{
+	parseFile(fileToImport, 0);
+
+	if (regionIsOpen)
+		finishRegion();
+}
 
-		currentParseNumber++;
+void SfzImporter::parseFile(const File& f, int includeDepth)
+{
+	if (includeDepth > 16)
+		throw SfzParsingError(0, "Too many nested includes in " + f.getFileName());
+
+	if (!f.existsAsFile())
+		throw SfzParsingError(0, "Can't find " + f.getFullPathName());
 
-		if (currentLine.isEmpty() || !currentLine.containsNonWhitespaceChars()) continue; // Skip empty lines
-		if (currentLine.startsWith("//")) continue; // Skip comments
+	Tokeniser t(f.loadFileAsString());
 
-		if (currentLine.startsWith(Global::getTag()))
+	for (;;)
+	{
+		switch (t.next())
 		{
-			currentTarget = globalSfzObject;
+		case Tokeniser::TokenType::EndOfFile:
+			return;
+		case Tokeniser::TokenType::Header:
+			parseHeader(String::fromUTF8(t.name, t.nameLength), t.lineNumber);
+			break;
+		case Tokeniser::TokenType::Define:
+			defines.set(String::fromUTF8(t.name, t.nameLength), String::fromUTF8(t.value, t.valueLength));
+			break;
+		case Tokeniser::TokenType::Include:
+		{
+			auto path = applyDefines(String::fromUTF8(t.value, t.valueLength)).replaceCharacter('\\', '/');
+
+			// The include paths are relative to the main file
+			parseFile(fileToImport.getParentDirectory().getChildFile(path), includeDepth + 1);
+			break;
 		}
-		else if (currentLine.startsWith(Group::getTag()))
+		case Tokeniser::TokenType::Opcode:
 		{
-			if (i < fileData.size() - 1)
+			if (defines.size() > 0 && (memchr(t.name, '$', (size_t)t.nameLength) != nullptr || memchr(t.value, '$', (size_t)t.valueLength) != nullptr))
 			{
-				globalSfzObject->groups.add(new Group());
-
-				currentTarget = globalSfzObject->groups.getLast();
-
-				globalSfzObject->groups.getLast()->groupName = "Group " + String(globalSfzObject->groups.size());
+				auto n = applyDefines(String::fromUTF8(t.name, t.nameLength));
+				auto v = applyDefines(String::fromUTF8(t.value, t.valueLength));
 
+				parseOpcode(n.toRawUTF8(), (int)n.getNumBytesAsUTF8(), v.toRawUTF8(), (int)v.getNumBytesAsUTF8(), t.lineNumber);
 			}
 			else
 			{
-				throw SfzParsingError(i, "Empty Group");
+				parseOpcode(t.name, t.nameLength, t.value, t.valueLength, t.lineNumber);
 			}
+
+			break;
 		}
-		else if (currentLine.startsWith(Region::getTag()))
+		}
+	}
+}
+
+void SfzImporter::parseHeader(const String& name, int /*lineNumber*/)
+{
+	if (regionIsOpen)
+		finishRegion();
+
+	if (name == "region")
+	{
+		headerOpcodes[(int)Header::Region].clear();
+		currentHeader = Header::Region;
+		regionIsOpen = true;
+	}
+	else if (name == "group")
+	{
+		headerOpcodes[(int)Header::Group].clear();
+		currentHeader = Header::Group;
+
+		currentGroup = groupNames.size();
+		groupNames.add(masterLabel.isNotEmpty() ? masterLabel : "Group " + String(currentGroup + 1));
+	}
+	else if (name == "master")
+	{
+		headerOpcodes[(int)Header::Master].clear();
+		headerOpcodes[(int)Header::Group].clear();
+		currentHeader = Header::Master;
+		currentGroup = -1;
+		masterLabel = {};
+	}
+	else if (name == "global")
+	{
+		for (int i = (int)Header::Global; i <= (int)Header::Group; i++)
+			headerOpcodes[i].clear();
+
+		currentHeader = Header::Global;
+		currentGroup = -1;
+		masterLabel = {};
+	}
+	else if (name == "control")
+	{
+		currentHeader = Header::Control;
+	}
+	else
+	{
+		// <curve>, <effect>, <midi> and unknown headers can't be imported
+		currentHeader = Header::Ignored;
+	}
+}
+
+void SfzImporter::parseOpcode(const char* name, int nameLength, const char* valueText, int valueLength, int lineNumber)
+{
+	if (currentHeader == Header::Ignored)
+		return;
+
+	const int index = getOpcode(name, nameLength);
+
+	if (index == -1)
+	{
+		unsupportedOpcodes.set(String::fromUTF8(name, nameLength), 0);
+		return;
+	}
+
+	const Opcode o = (Opcode)index;
+	double v = 0.0;
+
+	if (isStringOpcode(o))
+	{
+		auto s = String::fromUTF8(valueText, valueLength).trim();
+
+		switch (o)
 		{
-			if (globalSfzObject->groups.size() > 0)
-			{
-				globalSfzObject->groups.getLast()->addRegion(new Region());
+		case sample:
+		{
+			auto path = (defaultPath + s).replaceCharacter('\\', '/');
+			auto fullPath = fileToImport.getParentDirectory().getChildFile(path).getFullPathName();
 
-				currentTarget = globalSfzObject->groups.getLast()->regions.getLast();
-			}
-			else
+			if (!sampleIndexes.contains(fullPath))
 			{
-				throw SfzParsingError(i, "No Group for region");
+				SampleMetadata m;
+				m.file = File(fullPath);
+
+				sampleIndexes.set(fullPath, sampleMetadata.size());
+				sampleMetadata.add(m);
 			}
+
+			v = (double)sampleIndexes[fullPath];
+			break;
+		}
+		case loop_mode:		v = (double)SfzHelpers::getLoopMode(s); break;
+		case trigger:		v = (double)SfzHelpers::getTriggerMode(s); break;
+		case groupName:
+			if (currentHeader == Header::Group && isPositiveAndBelow(currentGroup, groupNames.size()))
+				groupNames.set(currentGroup, s);
+
+			return;
+		case master_label:
+			if (currentHeader == Header::Master)
+				masterLabel = s;
+
+			return;
+		case default_path:
+			defaultPath = s.replaceCharacter('\\', '/');
+
+			if (defaultPath.isNotEmpty() && !defaultPath.endsWithChar('/'))
+				defaultPath << '/';
+
+			return;
+		default: jassertfalse; return;
 		}
+	}
+	else if (o == lokey || o == hikey || o == key || o == pitch_keycenter)
+	{
+		const char first = valueLength > 0 ? valueText[0] : 0;
+
+		if ((first >= 'a' && first <= 'g') || (first >= 'A' && first <= 'G'))
+			v = (double)getNoteNumberFromName(String::fromUTF8(valueText, valueLength));
+		else
+			v = (double)String::fromUTF8(valueText, valueLength).getIntValue();
+
+		v += (double)(noteOffset + 12 * octaveOffset);
+	}
+	else
+	{
+		if (valueLength == 0)
+			throw SfzParsingError(lineNumber, "Missing value for " + getOpcodeName(o));
+
+		CharPointer_UTF8 numberText(valueText);
+		v = CharacterFunctions::readDoubleValue(numberText);
+	}
+
+	if (o == note_offset)
+	{
+		noteOffset = roundToInt(v);
+		return;
+	}
+
+	if (o == octave_offset)
+	{
+		octaveOffset = roundToInt(v);
+		return;
+	}
+
+	// The <control> header only accepts the opcodes above
+	if (currentHeader == Header::Control)
+		return;
+
+	if (o == seq_position)
+		usesSequencePositions = true;
+
+	headerOpcodes[(int)currentHeader].set(o, v);
+}
+
+void SfzImporter::finishRegion()
+{
+	regionIsOpen = false;
+
+	if (currentGroup == -1)
+	{
+		// Regions without a group header get their own group
+		currentGroup = groupNames.size();
+		groupNames.add(masterLabel.isNotEmpty() ? masterLabel : "Group " + String(currentGroup + 1));
+	}
+
+	Region r;
+	r.groupIndex = currentGroup;
+	r.opcodes.clear();
 
-		parseTagLine(currentLine);
+	for (int i = (int)Header::Global; i <= (int)Header::Region; i++)
+		r.opcodes.overwriteWith(headerOpcodes[i]);
 
-		
+	const bool hasSample = r.opcodes.isSet(sample);
+	const auto triggerMode = (int)r.opcodes.get(trigger, SfzHelpers::Attack);
+	const bool isReleaseTrigger = triggerMode == SfzHelpers::Release || triggerMode == SfzHelpers::ReleaseKey;
+	const bool isDisabled = r.opcodes.isSet(end) && r.opcodes.values[end] <= 0.0;
 
+	if (!hasSample || isReleaseTrigger || isDisabled)
+	{
+		numSkippedRegions++;
+		return;
 	}
+
+	regions.add(r);
 }
 
+void SfzImporter::resolveSampleFiles()
+{
+	if (sampleMetadata.isEmpty())
+		return;
+
+	const int numThreads = jlimit<int>(1, 16, jmin<int>(SystemStats::getNumCpus(), sampleMetadata.size()));
+
+	std::atomic<int> nextIndex(0);
+	std::atomic<int> numFinished(0);
+	WaitableEvent finished;
+
+	ThreadPool pool(numThreads);
+
+	for (int i = 0; i < numThreads; i++)
+	{
+		pool.addJob([this, &nextIndex, &numFinished, &finished, numThreads]()
+		{
+			AudioFormatManager afm;
+			afm.registerBasicFormats();
+
+			for (int index = nextIndex++; index < sampleMetadata.size(); index = nextIndex++)
+			{
+				auto& m = sampleMetadata.getReference(index);
+
+				m.exists = m.file.existsAsFile();
+
+				if (!m.exists)
+					continue;
 
+				ScopedPointer<AudioFormatReader> reader = afm.createReaderFor(m.file);
 
-void SfzImporter::applyGlobalOpcodesToRegion()
+				if (reader == nullptr)
+					continue;
+
+				m.sampleRate = reader->sampleRate;
+				m.length = reader->lengthInSamples;
+
+				const auto& metadata = reader->metadataValues;
+
+				if (metadata.getValue("NumSampleLoops", "0").getIntValue() > 0)
+				{
+					m.hasLoop = true;
+					m.loopStart = metadata.getValue("Loop0Start", "0").getLargeIntValue();
+					m.loopEnd = metadata.getValue("Loop0End", "0").getLargeIntValue();
+				}
+			}
+
+			if (++numFinished == numThreads)
+				finished.signal();
+		});
+	}
+
+	finished.wait();
+}
+
+bool SfzImporter::createSample(ValueTree& s, const Region& r, int rrGroup) const
 {
-	NamedValueSet *globalSet = &globalSfzObject->opcodes;
+	const auto& o = r.opcodes;
+	const auto& m = sampleMetadata.getReference((int)o.values[sample]);
+
+	s.setProperty(SampleIds::FileName, m.file.getFullPathName(), nullptr);
+
+	// The fine tune is limited to +-100 cents, so bigger values are moved to the root note
+	const double totalCents = o.get(tune, 0.0) + 100.0 * o.get(transpose, 0.0);
+	const int semitones = roundToInt(totalCents / 100.0);
+	const int cents = roundToInt(totalCents - 100.0 * (double)semitones);
+
+	const int keyValue = (int)o.get(key, -1.0);
+	const int root = (int)o.get(pitch_keycenter, keyValue != -1 ? keyValue : 60) - semitones;
+	const int loKey = (int)o.get(lokey, keyValue != -1 ? keyValue : 0);
+	const int hiKey = (int)o.get(hikey, keyValue != -1 ? keyValue : 127);
+	const int loVel = jlimit(0, 127, (int)o.get(lovel, 0));
+	const int hiVel = jlimit(0, 127, (int)o.get(hivel, 127));
+
+	if (loKey > hiKey || loVel > hiVel)
+		return false;
+
+	s.setProperty(SampleIds::Root, jlimit(0, 127, root), nullptr);
+	s.setProperty(SampleIds::LoKey, jlimit(0, 127, loKey), nullptr);
+	s.setProperty(SampleIds::HiKey, jlimit(0, 127, hiKey), nullptr);
+	s.setProperty(SampleIds::LoVel, loVel, nullptr);
+	s.setProperty(SampleIds::HiVel, hiVel, nullptr);
+	s.setProperty(SampleIds::RRGroup, rrGroup, nullptr);
+
+	if (cents != 0)
+		s.setProperty(SampleIds::Pitch, cents, nullptr);
+
+	const double gain = o.get(volume, 0.0) + o.get(group_volume, 0.0) + o.get(master_volume, 0.0) + o.get(global_volume, 0.0);
+
+	if (gain != 0.0)
+		s.setProperty(SampleIds::Volume, gain, nullptr);
+
+	if (o.isSet(pan))
+		s.setProperty(SampleIds::Pan, jlimit(-100, 100, roundToInt(o.values[pan])), nullptr);
 
-	for (int i = 0; i < globalSfzObject->groups.size(); i++)
+	const int64 length = m.length;
+	const int64 sampleStart = (int64)o.get(offset, 0.0);
+
+	if (sampleStart > 0)
+		s.setProperty(SampleIds::SampleStart, sampleStart, nullptr);
+
+	// The end opcodes of SFZ point to the last sample, HISE uses the sample after it
+	if (o.isSet(end))
+	{
+		const int64 sampleEnd = (int64)o.values[end] + 1;
+		s.setProperty(SampleIds::SampleEnd, length > 0 ? jmin(length, sampleEnd) : sampleEnd, nullptr);
+	}
+
+	const int defaultLoopMode = m.hasLoop ? SfzHelpers::LoopContinuous : SfzHelpers::NoLoop;
+	const int loopMode = (int)o.get(loop_mode, defaultLoopMode);
+
+	if (loopMode == SfzHelpers::LoopContinuous || loopMode == SfzHelpers::LoopSustain)
 	{
-		NamedValueSet *groupSet = &globalSfzObject->groups[i]->opcodes;
+		const int64 loopStart = (int64)o.get(loop_start, (double)(m.hasLoop ? m.loopStart : 0));
+		const int64 loopEnd = (int64)o.get(loop_end, (double)(m.hasLoop ? m.loopEnd : length - 1)) + 1;
 
-		ScopedPointer<XmlElement> xml = new XmlElement("a");
+		s.setProperty(SampleIds::LoopEnabled, true, nullptr);
+		s.setProperty(SampleIds::LoopStart, loopStart, nullptr);
 
-		groupSet->copyToXmlAttributes(*xml);
+		if (loopEnd > loopStart)
+			s.setProperty(SampleIds::LoopEnd, loopEnd, nullptr);
 
-		for (int j = 0; j < globalSfzObject->groups[i]->regions.size(); j++)
+		if (o.isSet(loop_crossfade) && m.sampleRate > 0.0 && loopEnd > loopStart)
 		{
-			Region *r = globalSfzObject->groups[i]->regions[j];
-			applyValueSetOnRegion(*globalSet, r);
-			applyValueSetOnRegion(*groupSet, r);
+			const int64 maxLength = jmin<int64>(loopStart - sampleStart, loopEnd - loopStart);
+			const int64 xfade = jlimit<int64>(0, jmax<int64>(0, maxLength), (int64)(o.values[loop_crossfade] * m.sampleRate));
 
-			
+			if (xfade > 0)
+				s.setProperty(SampleIds::LoopXFade, xfade, nullptr);
 		}
 	}
-}
 
+	if (o.isSet(xfin_hivel))
+		s.setProperty(SampleIds::LowerVelocityXFade, jlimit(0, hiVel - loVel, (int)o.values[xfin_hivel] - loVel), nullptr);
+
+	if (o.isSet(xfout_lovel))
+		s.setProperty(SampleIds::UpperVelocityXFade, jlimit(0, hiVel - loVel, hiVel - (int)o.values[xfout_lovel]), nullptr);
+
+	return true;
+}
 
-void SfzImporter::applyValueSetOnRegion(const NamedValueSet &setToApply, Region * r)
+ValueTree SfzImporter::createSampleMapTree(const Array<int>& rrGroupForGroup, int& numRRGroups) const
 {
-	
+	ValueTree v("samplemap");
 
-	for (int i = 0; i < setToApply.size(); i++)
-	{
-		Identifier opcodeId = setToApply.getName(i);
+	v.setProperty("RelativePath", 0, nullptr);
+	v.setProperty("FileName", fileToImport.getFullPathName(), nullptr);
+	v.setProperty("SaveMode", 1, nullptr);
 
-		if (setToApply[opcodeId].isUndefined()) continue;
+	numRRGroups = 1;
+	int id = 0;
+
+	for (const auto& r : regions)
+	{
+		int rrGroup = 1;
 
-		if (r->opcodes[opcodeId].isUndefined())
+		if (usesSequencePositions)
 		{
-			r->opcodes.set(opcodeId, setToApply[opcodeId]);	
+			rrGroup = jmax<int>(1, (int)r.opcodes.get(seq_position, 1.0));
+			numRRGroups = jmax<int>(numRRGroups, (int)r.opcodes.get(seq_length, 1.0));
 		}
+		else
+			rrGroup = rrGroupForGroup[r.groupIndex];
+
+		if (rrGroup <= 0)
+			continue;
+
+		ValueTree s("sample");
+
+		if (!createSample(s, r, rrGroup))
+			continue;
+
+		s.setProperty(SampleIds::ID, ++id, nullptr);
+
+		numRRGroups = jmax<int>(numRRGroups, rrGroup);
+
+		v.addChild(s, -1, nullptr);
 	}
+
+	v.setProperty("RRGroupAmount", numRRGroups, nullptr);
+
+	return v;
 }
 
-SfzImporter::SfzImporter(ModulatorSampler *sampler_, const File &sfzFileToImport) :
-sampler(sampler_),
-fileToImport(sfzFileToImport),
-currentTarget(nullptr),
-currentParseNumber(0)
+StringArray SfzImporter::getUnsupportedOpcodes() const
 {
-	globalSfzObject = new Global();
+	StringArray sa;
+
+	for (HashMap<String, int>::Iterator it(unsupportedOpcodes); it.next();)
+		sa.add(it.getKey());
 
-	currentTarget = globalSfzObject;
+	sa.sort(true);
+
+	return sa;
 }
 
-void SfzImporter::importSfzFile()
+SfzImporter::SfzImporter(ModulatorSampler *sampler_, const File &sfzFileToImport) :
+	fileToImport(sfzFileToImport),
+	sampler(sampler_)
 {
-	parseOpcodes();
+	for (auto& h : headerOpcodes)
+		h.clear();
+}
 
-	applyGlobalOpcodesToRegion();
+ValueTree SfzImporter::createSampleMap(bool shouldResolveSampleFiles)
+{
+	parse();
 
+	if (shouldResolveSampleFiles)
+		resolveSampleFiles();
 
-	ValueTree v("samplemap");
+	Array<int> rrGroupForGroup;
+	rrGroupForGroup.insertMultiple(0, 1, groupNames.size());
 
-	v.setProperty("RelativePath", 0, nullptr);
-	
-	v.setProperty("FileName", fileToImport.getFullPathName(), nullptr);
-	
-	v.setProperty("SaveMode", 1, nullptr);
+	int numRRGroups = 1;
+	return createSampleMapTree(rrGroupForGroup, numRRGroups);
+}
 
-	OwnedArray<SfzGroupSelectorComponent> groupSelectors;
+void SfzImporter::importSfzFile()
+{
+	jassert(sampler != nullptr);
+
+	parse();
+
+	resolveSampleFiles();
+
+	Array<int> rrGroupForGroup;
 
-	if (globalSfzObject->groups.size() > 1)
+	if (groupNames.size() > 1 && !usesSequencePositions)
 	{
+		OwnedArray<SfzGroupSelectorComponent> groupSelectors;
+
 		AlertWindow w("Group Import Settings", String(), AlertWindow::AlertIconType::NoIcon);
 
 		ScopedPointer<Viewport> viewport = new Viewport();
@@ -321,13 +913,11 @@ void SfzImporter::importSfzFile()
 
 		int y = 0;
 
-		
-
-		for (int i = 0; i < globalSfzObject->groups.size(); i++)
+		for (int i = 0; i < groupNames.size(); i++)
 		{
 			SfzGroupSelectorComponent *g = new SfzGroupSelectorComponent();
 
-			g->setData(i, globalSfzObject->groups[i]->groupName, globalSfzObject->groups.size());
+			g->setData(i, groupNames[i], groupNames.size());
 
 			c->addAndMakeVisible(g);
 
@@ -354,99 +944,37 @@ void SfzImporter::importSfzFile()
 
 		if (w.runModalLoop() == 0) return;
 
-		
+		for (auto g : groupSelectors)
+			rrGroupForGroup.add(g->getGroupIndex());
 	}
 	else
 	{
-		groupSelectors.add(new SfzGroupSelectorComponent());
-
-		groupSelectors.getLast()->setFixedReturnValue();
+		rrGroupForGroup.insertMultiple(0, 1, groupNames.size());
 	}
 
-	jassert(groupSelectors.size() == globalSfzObject->groups.size());
-	
-    
-	int id = 0;
-
-	for (int i = 0; i < globalSfzObject->groups.size(); i++)
-	{
-		const int rrGroup = groupSelectors[i]->getGroupIndex();
-
-		if(rrGroup == -1) continue;
-
-		for (int j = 0; j < globalSfzObject->groups[i]->regions.size(); j++)
-		{
-			Region *region = globalSfzObject->groups[i]->regions[j];
-
-			ValueTree sample("sample");
-
-			id++;
-
-			sample.setProperty(SampleIds::ID, id, nullptr);
-
-			sample.setProperty(SampleIds::LoVel, 0, nullptr);
-			sample.setProperty(SampleIds::HiVel, 127, nullptr);
-
-			for(int k = 0; k < Opcode::numSupportedOpcodes; k++)
-			{
-				Identifier opcode = Identifier(getOpcodeName((Opcode)k));
-
-				if (k == Opcode::groupName) continue;
-
-				if ( !region->opcodes[opcode].isUndefined() )
-				{
-					if (k == Opcode::key)
-					{
-						sample.setProperty(SampleIds::Root, region->opcodes[opcode], nullptr);
-						sample.setProperty(SampleIds::LoKey, region->opcodes[opcode], nullptr);
-						sample.setProperty(SampleIds::HiKey, region->opcodes[opcode], nullptr);
-
-						continue;
-					}
-					
-					
-
-					auto p = getSamplerProperty((Opcode)k);
-
-					sample.setProperty(p, region->opcodes[opcode], nullptr);
-				}
-			}
-
-			Identifier groupVolumeOpcode = Identifier(getOpcodeName(group_volume));
-
-			if ( !region->opcodes[groupVolumeOpcode].isUndefined() )
-			{
-				int zoneValue = sample.getProperty(SampleIds::Volume, var(0));
-
-				int groupValue = region->opcodes[groupVolumeOpcode];
-
-				int combinedLevel = zoneValue + groupValue;
+	int numRRGroups = 1;
+	auto v = createSampleMapTree(rrGroupForGroup, numRRGroups);
 
-				sample.setProperty(SampleIds::Volume, combinedLevel, nullptr);
-
-			}
+	int numMissingFiles = 0;
 
-			// Add the group properties
-			sample.setProperty(SampleIds::RRGroup, rrGroup, nullptr);
+	for (const auto& m : sampleMetadata)
+		numMissingFiles += m.exists ? 0 : 1;
 
-			v.addChild(sample, -1, nullptr);
-		}
+	if (numMissingFiles > 0)
+		debugError(sampler, String(numMissingFiles) + " sample files of " + fileToImport.getFileName() + " could not be found");
 
-	}
+	if (numSkippedRegions > 0)
+		debugToConsole(sampler, "Skipped " + String(numSkippedRegions) + " regions without sample or with a release trigger");
 
-	int groupAmount = 0;
+	auto unsupported = getUnsupportedOpcodes();
 
-	for (int i = 0; i < groupSelectors.size(); i++)
-	{
-		groupAmount = jmax(groupAmount, groupSelectors[i]->getGroupIndex());
-	}
+	if (!unsupported.isEmpty())
+		debugToConsole(sampler, "Ignored opcodes: " + unsupported.joinIntoString(", "));
 
-	sampler->setRRGroupAmount(groupAmount);
+	sampler->setRRGroupAmount(numRRGroups);
 
 	sampler->getSampleMap()->loadUnsavedValueTree(v);
 
-	//sampler->getSampleMap()->setRelativeSaveMode(true);
-
 	sampler->refreshPreloadSizes();
 	sampler->refreshMemoryUsage();
 };
@@ -39,31 +39,52 @@ namespace hise { using namespace juce;
 /** Handles the importing of SFZ sample files.
 *	@ingroup sampler
 *
+*	The file is parsed in a single pass over the text (the opcode names and numbers are read directly from the
+*	file content). The opcodes are inherited along the header hierarchy <global> -> <master> -> <group> -> <region>,
+*	and <control> headers, #define and #include directives are resolved while parsing.
+*
+*	After parsing, the sample files are checked and their metadata (length, samplerate and loop points) is read
+*	on multiple threads, then the whole sample map is created at once.
 */
 class SfzImporter
 {
 public:
 
-	/** All supported opcodes. This is far from being complete, but it tries to fetch everything that a ModulatorSamplerSound::Property can handle. */
+	/** All supported opcodes. These are the opcodes that can be mapped to a ModulatorSamplerSound::Property (the rest will be skipped). */
 	enum Opcode
 	{
-		sample = 0, ///< the sample file name (absolute)
+		sample = 0, ///< the sample file name (relative to the SFZ file and the default_path)
 		lokey, ///< the lowest key
 		hikey, ///< the highest key
+		key, ///< sets the lowest key, the highest key and the root note
+		pitch_keycenter, ///< the root note
 		lovel, ///< the lowest velocity
 		hivel, ///< the highest velocity
 		offset, ///< the sample start
-		end, ///< the sample end
-		loop_mode, ///< the loop mode (it will only support yes / no)
-		loopstart, ///< the loop start
-		loopend, ///< the loop end
-		tune, ///< the fine tune
-		pitch_keycenter, ///< the coarse tune
-		volume, ///< the volume
-		group_volume, ///< the group volume (will be consolidated for every sample with the 'volume' opcode
-		pan, ///< the balance
-		groupName,
-		key,
+		end, ///< the last sample (a region with an end of zero or less is skipped)
+		loop_mode, ///< the loop mode (no_loop, one_shot, loop_continuous or loop_sustain)
+		loop_start, ///< the loop start
+		loop_end, ///< the last sample of the loop
+		loop_crossfade, ///< the loop crossfade in seconds
+		tune, ///< the fine tune in cents
+		transpose, ///< the transposition in semitones
+		volume, ///< the volume in decibels
+		group_volume, ///< the group volume (will be added to the volume)
+		master_volume, ///< the master volume (will be added to the volume)
+		global_volume, ///< the global volume (will be added to the volume)
+		pan, ///< the balance (-100 to 100)
+		xfin_lovel, ///< the velocity where the fade in starts
+		xfin_hivel, ///< the velocity where the fade in ends
+		xfout_lovel, ///< the velocity where the fade out starts
+		xfout_hivel, ///< the velocity where the fade out ends
+		seq_length, ///< the number of round robin steps
+		seq_position, ///< the round robin step of the region
+		trigger, ///< the trigger type (regions with release triggers are skipped)
+		groupName, ///< the group name (group_label)
+		master_label, ///< the master name (will be used as group name if the group has no label)
+		default_path, ///< the path that is prepended to the sample names (<control> header)
+		note_offset, ///< the offset for all key opcodes (<control> header)
+		octave_offset, ///< the octave offset for all key opcodes (<control> header)
 		numSupportedOpcodes
 	};
 
@@ -92,95 +113,133 @@ public:
 	*
 	*	It will parse the file with all supported opcodes and replace the SampleMap of the ModulatorSampler with the data from the SFZ file.
 	*
-	*	If multiple groups are found, there will be a dialog box to consolidate groups or ignore them as round robin groups of the ModulatorSampler.
+	*	If multiple groups are found and the regions don't use seq_position, there will be a dialog box to consolidate 
+	*	groups or ignore them as round robin groups of the ModulatorSampler.
 	*/
 	void importSfzFile();
 
+	/** Parses the SFZ file and returns the sample map data without loading it into a sampler (so the sampler can be nullptr).
+	*
+	*	All groups will be mapped to the first round robin group (unless the regions use seq_position). 
+	*	If resolveSampleFiles is true, the sample files are opened to read the loop points and the sample length.
+	*/
+	ValueTree createSampleMap(bool resolveSampleFiles=true);
+
+	/** Returns the names of the opcodes that were found in the file but can't be imported. */
+	StringArray getUnsupportedOpcodes() const;
+
+	/** Returns the number of regions that were skipped (eg. release triggers). */
+	int getNumSkippedRegions() const { return numSkippedRegions; }
+
 private:
 
-	struct SfzOpcodeTarget
+	enum class Header
 	{
-		virtual ~SfzOpcodeTarget() {};
+		Control = 0,
+		Global,
+		Master,
+		Group,
+		Region,
+		Ignored
+	};
 
-		void setOpcodeValue(int opcode, var value) { opcodes.set(Identifier(SfzImporter::getOpcodeName((Opcode)opcode)), value); };
+	/** The opcodes of a header. The sample opcode stores the index of the sample file and the loop mode and trigger opcodes store their enum value. */
+	struct OpcodeSet
+	{
+		void clear() { setMask = 0; }
 
-		NamedValueSet opcodes;
-	};
+		bool isSet(Opcode o) const noexcept { return (setMask & ((uint64)1 << (int)o)) != 0; }
 
+		double get(Opcode o, double defaultValue) const noexcept { return isSet(o) ? values[o] : defaultValue; }
 
-	struct Region: public SfzOpcodeTarget
-	{
-		Region()
+		void set(Opcode o, double value) noexcept 
 		{
-			for (int i = 0; i < numSupportedOpcodes; i++)
-			{
-				setOpcodeValue(i, var::undefined());
-			}
+			values[o] = value;
+			setMask |= (uint64)1 << (int)o;
 		}
 
-		static String getTag() { return "<region>"; };
+		/** Adds all opcodes of the other set that are defined. */
+		void overwriteWith(const OpcodeSet& other) noexcept;
+
+		double values[numSupportedOpcodes];
+		uint64 setMask = 0;
 	};
 
+	struct Region
+	{
+		OpcodeSet opcodes;
+		int groupIndex;
+	};
 
-	struct Group: public SfzOpcodeTarget
-	{	
-		static String getTag() { return "<group>"; };
+	/** The data of a sample file that is read in the background. */
+	struct SampleMetadata
+	{
+		File file;
+		bool exists = false;
+		double sampleRate = 0.0;
+		int64 length = 0;
+		bool hasLoop = false;
+		int64 loopStart = 0;
+		int64 loopEnd = 0;
+	};
 
-		void addRegion(Region *r) {	regions.add(r);	}
+	class Tokeniser;
 
-		String groupName;
+	/** Parses the file and all included files. */
+	void parse();
 
-		OwnedArray<Region> regions;
-	};
+	void parseFile(const File& f, int includeDepth);
 
+	void parseHeader(const String& name, int lineNumber);
 
-	struct Global: public SfzOpcodeTarget
-	{
-		static String getTag() { return "<global>"; };
+	void parseOpcode(const char* name, int nameLength, const char* value, int valueLength, int lineNumber);
 
-		OwnedArray<Group> groups;
-	};
+	void finishRegion();
 
+	void resolveSampleFiles();
 
-	void parseTagLine(const String &restOfLine);
+	ValueTree createSampleMapTree(const Array<int>& rrGroupForGroup, int& numRRGroups) const;
 
-	StringArray getOpcodeTokens(const String &line) const;
+	bool createSample(ValueTree& sample, const Region& r, int rrGroup) const;
 
-	void parseOpcode(const String &opcode);
+	String applyDefines(const String& s) const;
 
-	void parseOpcodes();
+	static int getNoteNumberFromName(const String& s);
 
 	static String getOpcodeName(Opcode opcode) { return String(opcodeNames[opcode]); };
 
-	var getOpcodeValue(Opcode o, const String &valueString) const;
-	
-	static int getOpcode(const StringRef &opcodeName)
-	{
-		for(int i = 0; i < numSupportedOpcodes; i++)
-		{
-			if(StringRef(opcodeNames[i]) == opcodeName) return i;
-		}
+	static int getOpcode(const char* name, int length);
 
-		return -1;
-	}
-
-	static Identifier getSamplerProperty(Opcode opcode);
-	
-	void applyGlobalOpcodesToRegion();
-
-	void applyValueSetOnRegion(const NamedValueSet &setToApply, Region * r);
+	static bool isStringOpcode(Opcode o);
 
 	static const char **opcodeNames;
 
-	const File &fileToImport;
+	const File fileToImport;
 
 	ModulatorSampler *sampler;
 
-	int currentParseNumber;
+	OpcodeSet headerOpcodes[(int)Header::Region + 1];
+
+	Header currentHeader = Header::Global;
+	bool regionIsOpen = false;
+	int currentGroup = -1;
+
+	StringArray groupNames;
+	Array<Region> regions;
+
+	String defaultPath;
+	String masterLabel;
+	int noteOffset = 0;
+	int octaveOffset = 0;
+
+	StringPairArray defines;
+	HashMap<String, int> unsupportedOpcodes;
+	int numSkippedRegions = 0;
 
-	SfzOpcodeTarget *currentTarget;
+	bool usesSequencePositions = false;
 
-	ScopedPointer<Global> globalSfzObject;
+	Array<SampleMetadata> sampleMetadata;
+	HashMap<String, int> sampleIndexes;
 
 	AlertWindowLookAndFeel alaf;
 
@@ -0,0 +1,272 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "AppConfig.h"
+
+#if HI_RUN_UNIT_TESTS
+
+#include  "JuceHeader.h"
+
+using namespace hise;
+
+class SfzImporterUnitTest : public UnitTest
+{
+public:
+
+	SfzImporterUnitTest() :
+		UnitTest("Testing SFZ import")
+	{}
+
+	void runTest() override
+	{
+		root = File::createTempFile("sfz_tests");
+		root.createDirectory();
+
+		testInheritance();
+		testDefinesAndIncludes();
+		testRoundRobinAndCrossfades();
+		testSampleMetadata();
+		testLargeFile(100000);
+
+		root.deleteRecursively();
+	}
+
+private:
+
+	ValueTree import(const String& fileName, const String& content, bool resolveSampleFiles=false)
+	{
+		auto f = root.getChildFile(fileName);
+		f.getParentDirectory().createDirectory();
+		f.replaceWithText(content);
+
+		SfzImporter importer(nullptr, f);
+		return importer.createSampleMap(resolveSampleFiles);
+	}
+
+	void testInheritance()
+	{
+		beginTest("Testing SFZ header inheritance");
+
+		String sfz;
+
+		sfz << "// A comment\n";
+		sfz << "<control> default_path=samples\\ note_offset=1\n";
+		sfz << "<global> volume=-6 lovel=10 /* a block\ncomment */\n";
+		sfz << "<master> master_volume=-3 master_label=Piano\n";
+		sfz << "<group> hivel=100 group_volume=2\n";
+		sfz << "<region> sample=My Piano C4.wav key=c4 tune=-160 pan=-50\n";
+		sfz << "<region>sample=d.wav lokey=61 hikey=63 pitch_keycenter=62 lovel=20 amp_veltrack=50\n";
+		sfz << "<group> group_label=Second\n";
+		sfz << "<region> sample=e.wav loop_mode=loop_continuous loopstart=100 loopend=199 end=0\n";
+		sfz << "<region> sample=f.wav trigger=release\n";
+		sfz << "<region> sample=g.wav offset=10 end=999\n";
+
+		auto v = import("inheritance.sfz", sfz);
+
+		expectEquals(v.getNumChildren(), 3, "Release triggers and disabled regions are skipped");
+
+		auto s1 = v.getChild(0);
+
+		expectEquals(s1[SampleIds::FileName].toString(), root.getChildFile("samples/My Piano C4.wav").getFullPathName(), "Default path and spaces in the sample name");
+		expectEquals<int>(s1[SampleIds::LoKey], 61, "The key opcode uses the note offset");
+		expectEquals<int>(s1[SampleIds::HiKey], 61);
+		expectEquals<int>(s1[SampleIds::Root], 63, "The tune is moved to the root note");
+		expectEquals<int>(s1[SampleIds::Pitch], 40);
+		expectEquals<int>(s1[SampleIds::LoVel], 10, "Global lovel");
+		expectEquals<int>(s1[SampleIds::HiVel], 100, "Group hivel");
+		expectEquals<double>(s1[SampleIds::Volume], -7.0, "The volumes are added");
+		expectEquals<int>(s1[SampleIds::Pan], -50);
+
+		auto s2 = v.getChild(1);
+
+		expectEquals<int>(s2[SampleIds::LoKey], 62);
+		expectEquals<int>(s2[SampleIds::HiKey], 64);
+		expectEquals<int>(s2[SampleIds::Root], 63);
+		expectEquals<int>(s2[SampleIds::LoVel], 20, "The region overrides the global opcode");
+
+		auto s3 = v.getChild(2);
+
+		expectEquals<int>(s3[SampleIds::HiVel], 127, "A new group resets the group opcodes");
+		expectEquals<double>(s3[SampleIds::Volume], -9.0, "Master and global volume");
+		expectEquals<int>(s3[SampleIds::SampleStart], 10);
+		expectEquals<int>(s3[SampleIds::SampleEnd], 1000, "The SFZ end is inclusive");
+
+		bool caughtError = false;
+
+		try
+		{
+			import("error.sfz", "<region> sample=a.wav\nthisisnotanopcode\n");
+		}
+		catch (SfzImporter::SfzParsingError& e)
+		{
+			caughtError = e.lineNumber == 2;
+		}
+
+		expect(caughtError, "Invalid tokens throw an error with the line number");
+	}
+
+	void testDefinesAndIncludes()
+	{
+		beginTest("Testing #define and #include");
+
+		auto includeFile = root.getChildFile("include/regions.sfz");
+		includeFile.getParentDirectory().createDirectory();
+		includeFile.replaceWithText("<region> sample=$NAME.wav key=$KEY\n<region> sample=$NAME_2.wav key=$KEY2\n");
+
+		String sfz;
+		sfz << "#define $KEY 60\n";
+		sfz << "#define $KEY2 62\n";
+		sfz << "#define $NAME piano\n";
+		sfz << "<group> volume=-1\n";
+		sfz << "#include \"include/regions.sfz\"\n";
+
+		auto v = import("defines.sfz", sfz);
+
+		expectEquals(v.getNumChildren(), 2);
+		expectEquals<int>(v.getChild(0)[SampleIds::Root], 60);
+		expectEquals<int>(v.getChild(1)[SampleIds::Root], 62, "$KEY2 isn't replaced by $KEY");
+		expectEquals(File(v.getChild(0)[SampleIds::FileName].toString()).getFileName(), String("piano.wav"));
+		expectEquals(File(v.getChild(1)[SampleIds::FileName].toString()).getFileName(), String("piano_2.wav"));
+		expectEquals<double>(v.getChild(1)[SampleIds::Volume], -1.0, "The included regions inherit the group");
+	}
+
+	void testRoundRobinAndCrossfades()
+	{
+		beginTest("Testing round robin and velocity crossfades");
+
+		String sfz;
+		sfz << "<group> seq_length=3 key=60\n";
+
+		for (int i = 1; i <= 3; i++)
+			sfz << "<region> seq_position=" << i << " sample=rr" << i << ".wav\n";
+
+		sfz << "<group> key=61\n";
+		sfz << "<region> sample=soft.wav lovel=0 hivel=80 xfout_lovel=60 xfout_hivel=80\n";
+		sfz << "<region> sample=loud.wav lovel=60 hivel=127 xfin_lovel=60 xfin_hivel=80\n";
+
+		auto v = import("rr.sfz", sfz);
+
+		expectEquals(v.getNumChildren(), 5);
+		expectEquals<int>(v["RRGroupAmount"], 3, "seq_length sets the RR group amount");
+
+		for (int i = 0; i < 3; i++)
+			expectEquals<int>(v.getChild(i)[SampleIds::RRGroup], i + 1, "seq_position");
+
+		expectEquals<int>(v.getChild(3)[SampleIds::RRGroup], 1);
+		expectEquals<int>(v.getChild(3)[SampleIds::UpperVelocityXFade], 20, "Fade out");
+		expectEquals<int>(v.getChild(4)[SampleIds::LowerVelocityXFade], 20, "Fade in");
+	}
+
+	void testSampleMetadata()
+	{
+		beginTest("Testing sample metadata");
+
+		auto wavFile = root.getChildFile("loop.wav");
+
+		{
+			StringPairArray metadata;
+			metadata.set("NumSampleLoops", "1");
+			metadata.set("Loop0Type", "0");
+			metadata.set("Loop0Start", "1000");
+			metadata.set("Loop0End", "2999");
+
+			WavAudioFormat wav;
+			ScopedPointer<FileOutputStream> fos = new FileOutputStream(wavFile);
+			ScopedPointer<AudioFormatWriter> writer = wav.createWriterFor(fos, 44100.0, 1, 16, metadata, 0);
+
+			if (writer != nullptr)
+			{
+				fos.release();
+
+				AudioSampleBuffer b(1, 4000);
+				b.clear();
+				writer->writeFromAudioSampleBuffer(b, 0, 4000);
+			}
+		}
+
+		String sfz;
+		sfz << "<region> sample=loop.wav loop_crossfade=0.001 end=100000\n";
+		sfz << "<region> sample=loop.wav loop_mode=no_loop\n";
+		sfz << "<region> sample=missing.wav\n";
+
+		auto v = import("metadata.sfz", sfz, true);
+
+		auto s1 = v.getChild(0);
+
+		expect((bool)s1[SampleIds::LoopEnabled], "The loop of the file is used");
+		expectEquals<int>(s1[SampleIds::LoopStart], 1000);
+		expectEquals<int>(s1[SampleIds::LoopEnd], 3000);
+		expectEquals<int>(s1[SampleIds::LoopXFade], 44, "The crossfade uses the samplerate of the file");
+		expectEquals<int>(s1[SampleIds::SampleEnd], 4000, "The end is limited to the file length");
+
+		expect(!v.getChild(1).hasProperty(SampleIds::LoopEnabled), "loop_mode overrides the file loop");
+		expectEquals(v.getNumChildren(), 3, "Missing files are still added");
+	}
+
+	void testLargeFile(int numRegions)
+	{
+		beginTest("Testing SFZ file with " + String(numRegions) + " regions");
+
+		String sfz;
+		sfz.preallocateBytes(numRegions * 80);
+
+		for (int i = 0; i < numRegions; i++)
+		{
+			if (i % 128 == 0)
+				sfz << "<group> lovel=" << (i / 128) % 127 << " volume=-3\n";
+
+			sfz << "<region> sample=samples/sample_" << i << ".wav key=" << i % 128 << " offset=" << i << "\n";
+		}
+
+		auto start = Time::getMillisecondCounterHiRes();
+		auto v = import("large.sfz", sfz);
+		auto duration = Time::getMillisecondCounterHiRes() - start;
+
+		logMessage("Imported " + String(numRegions) + " regions in " + String(duration, 1) + "ms");
+
+		expectEquals(v.getNumChildren(), numRegions);
+
+		auto last = v.getChild(numRegions - 1);
+
+		expectEquals<int>(last[SampleIds::Root], (numRegions - 1) % 128);
+		expectEquals<int>(last[SampleIds::SampleStart], numRegions - 1);
+		expectEquals<int>(last[SampleIds::LoVel], ((numRegions - 1) / 128) % 127);
+		expectEquals<int>(last[SampleIds::ID], numRegions);
+	}
+
+	File root;
+};
+
+static SfzImporterUnitTest sfzImporterTestInstance;
+
+#endif
@@ -114,9 +114,7 @@ void SampleEditHandler::handleMidiSelection()
 
 	if (sampler->getEditorState(ModulatorSampler::MidiSelectActive) && newKeysPressed(x.currentNotes))
 	{
-		selectedSamplerSounds.deselectAll();
-
-		SelectedItemSet<const ModulatorSamplerSound*> midiSounds;
+		SampleSelection midiSounds;
 
 		for (int i = 0; i < 127; i++)
 		{
@@ -131,12 +129,14 @@ void SampleEditHandler::handleMidiSelection()
 				{
 					if (sampler->soundCanBePlayed(sound, 1, noteNumber, (float)velocity / 127.0f))
 					{
-						selectedSamplerSounds.addToSelection(sound.get());
+						midiSounds.add(sound.get());
 					}
 				}
 
 			}
 		}
+
+		selectedSamplerSounds.setSelection(midiSounds);
 	}
 }
 
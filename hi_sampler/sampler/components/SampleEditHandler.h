@@ -83,7 +83,7 @@ public:
 		selectionListeners.removeAllInstancesOf(l);
 	}
 	
-	SelectedItemSet<ModulatorSamplerSound::Ptr> &getSelection()
+	SampleSelectionSet &getSelection()
 	{
 		return selectedSamplerSounds;
 	}
@@ -169,7 +169,7 @@ private:
 
 	int rrIndex = -1;
 
-	SelectedItemSet<ModulatorSamplerSound::Ptr> selectedSamplerSounds;
+	SampleSelectionSet selectedSamplerSounds;
 	
 	int timeSinceLastSelectionChange = 0;
 
@@ -329,21 +329,23 @@ void SampleEditHandler::SampleEditingActions::refreshCrossfades(SampleEditHandle
 
 void SampleEditHandler::SampleEditingActions::selectAllSamples(SampleEditHandler * handler)
 {
-	handler->getSelection().deselectAll();
-
 	ModulatorSampler *s = handler->sampler;
 
 	int thisIndex = handler->getCurrentlyDisplayedRRGroup();  
 	
 	ModulatorSampler::SoundIterator sIter(s);
 
+	SampleSelection newSelection;
+
 	while (auto sound = sIter.getNextSound())
 	{
 		if (thisIndex == -1 || sound->getRRGroup() == thisIndex)
 		{
-			handler->getSelection().addToSelection(sound.get());
+			newSelection.add(sound.get());
 		}
 	}
+
+	handler->getSelection().setSelection(newSelection);
 }
 
 
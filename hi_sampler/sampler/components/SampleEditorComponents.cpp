@@ -127,17 +127,10 @@ void SampleComponent::drawSampleRectangle(Graphics &g, Rectangle<int> areaInt)
 {
     if(sound.get() == nullptr) return;
     
-	ScopedLock sl(map->getSampler()->getExportLock());
-
     Rectangle<float> area((float)areaInt.getX(), (float)areaInt.getY(), (float)areaInt.getWidth(), (float)areaInt.getHeight());
     
-    const int lowerXFade = sound->getSampleProperty(SampleIds::LowerVelocityXFade);
-    const int upperXFade = sound->getSampleProperty(SampleIds::UpperVelocityXFade);
-    
-    if (lowerXFade != 0 || upperXFade != 0)
+    if (hasCrossfade())
     {
-        Range<int> velocityRange = sound->getVelocityRange();
-        
         const float lowerCrossfadeValue = fabsf((float)lowerXFade) / (float)velocityRange.getLength();
         
         const float upperCrossfadeValue = fabsf((float)upperXFade) / (float)velocityRange.getLength();
@@ -198,7 +191,6 @@ SamplerSoundMap::SamplerSoundMap(ModulatorSampler *ownerSampler_):
 	handler(ownerSampler->getSampleEditHandler()),
 	notePosition(-1),
 	veloPosition(-1),
-	selectedSounds(new SelectedItemSet<WeakReference<SampleComponent>>()),
 	sampleLasso(new LassoComponent<WeakReference<SampleComponent>>())
 {
     sampleLasso->setColour(LassoComponent<SampleComponent>::ColourIds::lassoFillColourId, Colours::white.withAlpha(0.1f));
@@ -212,8 +204,6 @@ SamplerSoundMap::SamplerSoundMap(ModulatorSampler *ownerSampler_):
 		pressedKeys[i] = 255;
 	}
 
-	selectedSounds->addChangeListener(this);
-
 	addChildComponent(sampleLasso);
 
 	updateSoundData();
@@ -235,55 +225,52 @@ SamplerSoundMap::~SamplerSoundMap()
 
 void SamplerSoundMap::changeListenerCallback(ChangeBroadcaster *b)
 {
-	if(b == selectedSounds)
+	if (dynamic_cast<ModulatorSamplerSound*>(b) != nullptr)
 	{
-		handler->getSelection().deselectAll();
+		jassertfalse;
+	}
+}
 
-		for(int i = 0; i < sampleComponents.size(); i++)
-		{
-			sampleComponents[i]->setSelected(false);
-		}
+void SamplerSoundMap::setSelectedComponents(const BigInteger& newSelection, bool sendToHandler)
+{
+	selectedComponents = newSelection;
 
-		auto& selectedSampleComponents = selectedSounds->getItemArray();
+	SampleSelection newSounds;
 
-		for(int i = 0; i < selectedSampleComponents.size(); i++)
-		{
-			if (selectedSampleComponents[i].get() != nullptr)
-			{
-				selectedSampleComponents[i]->setSelected(true);
+	for (int i = 0; i < sampleComponents.size(); i++)
+	{
+		const bool isSelected = selectedComponents[i];
 
-				if (selectedSampleComponents[i]->getSound() != nullptr)
-				{
-					handler->getSelection().addToSelection(selectedSampleComponents[i]->getSound());
-				}
-			}
-		}
+		sampleComponents[i]->setSelected(isSelected);
 
-        refreshGraphics();
-	}
-	else if (dynamic_cast<ModulatorSamplerSound*>(b) != nullptr)
-	{
-		jassertfalse;
+		if (isSelected && sendToHandler && sampleComponents[i]->getSound() != nullptr)
+			newSounds.add(sampleComponents[i]->getSound());
 	}
 
+	if (sendToHandler)
+		handler->getSelection().setSelection(newSounds);
+
+	refreshGraphics();
 }
 
 void SamplerSoundMap::selectNeighbourSample(Neighbour direction)
 {
-	if(selectedSounds->getNumSelected() != 0)
+	const int firstSelected = selectedComponents.findNextSetBit(0);
+
+	if(firstSelected != -1)
 	{
-		auto sound = selectedSounds->getSelectedItem(0).get();
+		auto sound = sampleComponents[firstSelected]->getSound();
 
 		if (sound == nullptr)
 			return;
 
-		const int lowKey = selectedSounds->getSelectedItem(0)->getSound()->getSampleProperty(SampleIds::LoKey);
-		const int lowVelo = selectedSounds->getSelectedItem(0)->getSound()->getSampleProperty(SampleIds::LoVel);
+		const int lowKey = sound->getSampleProperty(SampleIds::LoKey);
+		const int lowVelo = sound->getSampleProperty(SampleIds::LoVel);
 
-		const int hiKey = selectedSounds->getSelectedItem(0)->getSound()->getSampleProperty(SampleIds::HiKey);
-		const int hiVelo = selectedSounds->getSelectedItem(0)->getSound()->getSampleProperty(SampleIds::HiVel);
+		const int hiKey = sound->getSampleProperty(SampleIds::HiKey);
+		const int hiVelo = sound->getSampleProperty(SampleIds::HiVel);
 
-		const int group = selectedSounds->getSelectedItem(0)->getSound()->getSampleProperty(SampleIds::RRGroup);
+		const int group = sound->getSampleProperty(SampleIds::RRGroup);
 
 		for(int i = 0; i < sampleComponents.size(); i++)
 		{
@@ -395,14 +382,13 @@ void SamplerSoundMap::endSampleDragging(bool copyDraggedSounds)
 
 void SamplerSoundMap::samplePropertyWasChanged(ModulatorSamplerSound* s, const Identifier& id, const var& /*newValue*/)
 {
-	auto index = s->getId();
-
-	if (SampleIds::Helpers::isMapProperty(id) && index < sampleComponents.size())
+	if (SampleIds::Helpers::isMapProperty(id))
 	{
-		updateSampleComponent(index);
-	}
+		auto index = getSampleComponentIndex(s);
 
-	
+		if (index != -1)
+			updateSampleComponent(index);
+	}
 }
 
 void SamplerSoundMap::preloadStateChanged(bool isPreloading_)
@@ -417,7 +403,7 @@ void SamplerSoundMap::preloadStateChanged(bool isPreloading_)
 
 void SamplerSoundMap::modifierKeysChanged(const ModifierKeys &modifiers)
 {
-	if(modifiers.isAltDown() && selectedSounds->getNumSelected() != 0)
+	if(modifiers.isAltDown() && !selectedComponents.isZero())
 	{
 		if(modifiers.isCtrlDown())
 		{
@@ -448,19 +434,65 @@ void SamplerSoundMap::refreshSelectedSoundsFromLasso()
 {
 	lassoSelectedComponents.clear();
 
-	for (int i = 0; i < sampleComponents.size(); i++)
-	{
-		SampleComponent *c = sampleComponents[i];
+	if (getWidth() == 0)
+		return;
+
+	updateKeyIndex();
 
-		Rectangle<int> sampleBounds = c->getBoundsInParent();
+	const float noteWidth = (float)getWidth() / 128.0f;
+
+	const int lowKey = jlimit(0, 127, (int)((float)currentLassoRectangle.getX() / noteWidth));
+	const int highKey = jlimit(0, 127, (int)((float)currentLassoRectangle.getRight() / noteWidth));
 
-		if (c->isVisible() && currentLassoRectangle.intersectRectangle(sampleBounds))
+	for (int key = lowKey; key <= highKey; key++)
+	{
+		for (auto index : keyIndex[key])
 		{
-			lassoSelectedComponents.add(c);
+			if (lassoSelectedComponents[index])
+				continue;
+
+			SampleComponent *c = sampleComponents[index];
+
+			Rectangle<int> sampleBounds = c->getBoundsInParent();
+
+			if (c->isVisible() && currentLassoRectangle.intersectRectangle(sampleBounds))
+			{
+				lassoSelectedComponents.setBit(index, true);
+			}
 		}
 	}
 }
 
+void SamplerSoundMap::updateKeyIndex()
+{
+	if (!keyIndexDirty)
+		return;
+
+	for (int i = 0; i < 128; i++)
+		keyIndex[i].clearQuick();
+
+	for (int i = 0; i < sampleComponents.size(); i++)
+	{
+		auto keyRange = sampleComponents[i]->getKeyRange().getIntersectionWith({ 0, 128 });
+
+		for (int key = keyRange.getStart(); key < keyRange.getEnd(); key++)
+			keyIndex[key].add(i);
+	}
+
+	keyIndexDirty = false;
+}
+
+Rectangle<int> SamplerSoundMap::getVisibleArea() const
+{
+	if (auto viewport = findParentComponentOfClass<Viewport>())
+	{
+		if (auto viewedComponent = viewport->getViewedComponent())
+			return getLocalArea(viewedComponent, viewport->getViewArea()).getIntersection(getLocalBounds());
+	}
+
+	return getLocalBounds();
+}
+
 void SamplerSoundMap::drawSoundMap(Graphics &g)
 {
     g.fillAll(Colour(0xFF333333));
@@ -522,21 +554,76 @@ void SamplerSoundMap::drawSoundMap(Graphics &g)
         //g.drawLine(i * noteWidth, 0, i * noteWidth, (float)getHeight(), 1.0f);
     }
     
+	// Rectangles without crossfades are collected per colour and filled with a single call
+	struct ColourBatch
+	{
+		Colour c;
+		RectangleList<int> area;
+	};
+
+	Array<ColourBatch> batches;
+
+	auto addToBatch = [&batches](Colour c, Rectangle<int> area)
+	{
+		for (auto& b : batches)
+		{
+			if (b.c == c)
+			{
+				b.area.addWithoutMerging(area);
+				return;
+			}
+		}
+
+		ColourBatch nb;
+		nb.c = c;
+		nb.area.addWithoutMerging(area);
+		batches.add(nb);
+	};
+
+	const auto clipBounds = g.getClipBounds();
+
+	ScopedLock sl(ownerSampler->getExportLock());
+
     for(int i = 0; i < sampleComponents.size(); i++)
     {
         SampleComponent *c = sampleComponents[i];
 		
-		if (!c->isVisible()) continue;
+		if (!c->isVisible() || c->getSound() == nullptr) continue;
 
-		c->drawSampleRectangle(g, c->getBoundsInParent());
+		auto b = c->getBoundsInParent();
+
+		if (!clipBounds.intersects(b)) continue;
+
+		if (c->hasCrossfade())
+		{
+			c->drawSampleRectangle(g, b);
+			continue;
+		}
+
+		addToBatch(c->getColourForSound(false), b);
+
+		auto outlineColour = c->getColourForSound(true);
+
+		addToBatch(outlineColour, b.withHeight(1));
+		addToBatch(outlineColour, b.withTop(b.getBottom() - 1));
+		addToBatch(outlineColour, b.withWidth(1));
+		addToBatch(outlineColour, b.withLeft(b.getRight() - 1));
     }
+
+	for (const auto& b : batches)
+	{
+		g.setColour(b.c);
+		g.fillRectList(b.area);
+	}
 }
 
 void SamplerSoundMap::paint(Graphics &g)
 {
-	g.drawImageAt(currentSnapshot, 0, 0);
+	g.drawImageAt(currentSnapshot, snapshotArea.getX(), snapshotArea.getY());
 
-	
+	// The viewport was scrolled into an area that wasn't drawn yet
+	if (!snapshotArea.contains(getVisibleArea()))
+		refreshGraphics();
 };
 
 void SamplerSoundMap::paintOverChildren(Graphics &g)
@@ -640,9 +727,9 @@ void SamplerSoundMap::drawSampleMapForDragPosition()
 
 void SamplerSoundMap::updateSampleComponentWithSound(ModulatorSamplerSound *sound)
 {
-    const int index = (int)sound->getSampleProperty(SampleIds::ID);
+    const int index = getSampleComponentIndex(sound);
     
-    if(index < sampleComponents.size())
+    if(index != -1)
     {
         updateSampleComponent(index);
     }
@@ -671,6 +758,14 @@ void SamplerSoundMap::updateSampleComponent(int index)
 		const int y_max = getHeight() - (int)s->getSampleProperty(SampleIds::LoVel) * velocityHeight;
 
 		sampleComponents[index]->setSampleBounds((int)x, (int)y, (int)(x_max - x), (int)(y_max-y));
+
+		const auto oldKeyRange = sampleComponents[index]->getKeyRange();
+
+		sampleComponents[index]->setMappingData(s->getNoteRange(), s->getVelocityRange(), 
+												s->getSampleProperty(SampleIds::LowerVelocityXFade), 
+												s->getSampleProperty(SampleIds::UpperVelocityXFade));
+
+		keyIndexDirty |= oldKeyRange != sampleComponents[index]->getKeyRange();
 		
         refreshGraphics();
 	}
@@ -694,13 +789,18 @@ void SamplerSoundMap::updateSoundData()
 	if(newSamplesDetected())
 	{
 		sampleComponents.clear();
+		componentIndexes.clear();
+		keyIndexDirty = true;
 
 		ModulatorSampler::SoundIterator sIter(ownerSampler, false);
 
 		while (auto sound = sIter.getNextSound())
 		{
+			componentIndexes.set(sound.get(), sampleComponents.size());
 			sampleComponents.add(new SampleComponent(sound, this));
 		}
+
+		setSelectedIds(handler->getSelection().getItemArray());
 	}
 	else
 	{
@@ -754,37 +854,42 @@ void SamplerSoundMap::mouseUp(const MouseEvent &e)
 			e.getPosition() == e.getMouseDownPosition() &&
 			getSampleComponentAt(e.getPosition()) == nullptr)
 		{
-			selectedSounds->deselectAll();
+			setSelectedComponents(BigInteger(), true);
 		}
 
 		sampleLasso->endLasso();
 
 		if (!e.getOffsetFromDragStart().isOrigin())
 		{
-			auto modifiers = e.mods;
-
-			// Deselect the previous ones...
-			if (!modifiers.isShiftDown())
-				selectedSounds->deselectAll();
+			// Shift adds the lassoed samples to the previous selection
+			auto newSelection = e.mods.isShiftDown() ? selectedComponents : BigInteger();
 
-			// We need to add the shift modifier to that it selects all samples in the list
-			if (!modifiers.isShiftDown() && !modifiers.isCommandDown())
-				modifiers = modifiers.withFlags(ModifierKeys::shiftModifier);
+			newSelection |= lassoSelectedComponents;
 
-			for (int i = 0; i < lassoSelectedComponents.size(); i++)
-			{
-				selectedSounds->addToSelectionBasedOnModifiers(lassoSelectedComponents[i], modifiers);
-			}
+			setSelectedComponents(newSelection, true);
 		}
         else if (!e.mods.isRightButtonDown())
         {
-            SampleComponent *c = getSampleComponentAt(e.getMouseDownPosition());
+			const int index = getSampleComponentIndexAt(e.getMouseDownPosition());
             
-            if(c != nullptr )
+            if(index != -1 && sampleComponents[index]->getSound() != nullptr)
             {
-                ModulatorSamplerSound *s = c->getSound();
-                
-				if (s != nullptr) selectedSounds->addToSelectionBasedOnModifiers(c, e.mods);
+				BigInteger newSelection;
+
+				if (e.mods.isShiftDown())
+				{
+					newSelection = selectedComponents;
+					newSelection.setBit(index, true);
+				}
+				else if (e.mods.isCommandDown())
+				{
+					newSelection = selectedComponents;
+					newSelection.setBit(index, !selectedComponents[index]);
+				}
+				else
+					newSelection.setBit(index, true);
+
+				setSelectedComponents(newSelection, true);
             }
         }
 
@@ -813,27 +918,11 @@ bool SamplerSoundMap::isDragOperation(const MouseEvent& e)
 {
 	bool selectModifiersActive = e.mods.isShiftDown() || e.mods.isCommandDown();
 
-	bool hoverOverSelection = false;
+	const int hoveredIndex = getSampleComponentIndexAt(e.getPosition());
 
-	if (auto hoveredComponent = getSampleComponentAt(e.getPosition()))
-	{
-		if (auto s = hoveredComponent->getSound())
-		{
-			for (auto& s_ : *selectedSounds)
-			{
-				if (s_.get() == nullptr)
-					continue;
+	bool hoverOverSelection = hoveredIndex != -1 && selectedComponents[hoveredIndex];
 
-				if (s == s_.get()->getSound())
-				{
-					hoverOverSelection = true;
-					break;
-				}
-			}
-		}
-	}
-
-	bool dragOperation = hoverOverSelection && selectedSounds->getNumSelected() != 0 && !selectModifiersActive;
+	bool dragOperation = hoverOverSelection && !selectModifiersActive;
 
 	return dragOperation;
 }
@@ -974,6 +1063,8 @@ void SamplerSoundMap::mouseDrag(const MouseEvent &e)
 
 void SamplerSoundMap::setPressedKeys(const uint8 *pressedKeyData)
 {
+	updateKeyIndex();
+
 	for(int i = 0; i < 127; i++)
 	{
 		const int number = i;
@@ -983,7 +1074,7 @@ void SamplerSoundMap::setPressedKeys(const uint8 *pressedKeyData)
 
 		if(change)
 		{
-			for (int j = 0; j < sampleComponents.size(); j++)
+			for (auto j : keyIndex[i])
 			{
 				if (sampleComponents[j]->isVisible() && sampleComponents[j]->getSound() != nullptr &&
 					sampleComponents[j]->getSound()->appliesToMessage(1, number, velocity) &&
@@ -1003,13 +1094,36 @@ void SamplerSoundMap::setPressedKeys(const uint8 *pressedKeyData)
 
 SampleComponent* SamplerSoundMap::getSampleComponentAt(Point<int> point)
 {
-	for(int i = 0; i < sampleComponents.size(); i++)
+	const int index = getSampleComponentIndexAt(point);
+
+	return index != -1 ? sampleComponents[index] : nullptr;
+};
+
+int SamplerSoundMap::getSampleComponentIndexAt(Point<int> point)
+{
+	if (getWidth() == 0)
+		return -1;
+
+	updateKeyIndex();
+
+	const float noteWidth = (float)getWidth() / 128.0f;
+	const int key = jlimit(0, 127, (int)((float)point.getX() / noteWidth));
+
+	for (auto i : keyIndex[key])
 	{
-		if (sampleComponents[i]->isVisible() && sampleComponents[i]->samplePathContains(point)) return sampleComponents[i];
+		if (sampleComponents[i]->isVisible() && sampleComponents[i]->samplePathContains(point)) return i;
 	}
 
-	return nullptr;
-};
+	return -1;
+}
+
+int SamplerSoundMap::getSampleComponentIndex(const ModulatorSamplerSound* sound) const
+{
+	if (componentIndexes.contains(sound))
+		return componentIndexes[sound];
+
+	return -1;
+}
 
 
 
@@ -1024,9 +1138,9 @@ void SamplerSoundMap::checkEventForSampleDragging(const MouseEvent &e)
 		currentDragDeltaX = 0;
 		currentDragDeltaY = 0;
 
-		for(int i = 0; i < selectedSounds->getNumSelected(); i++)
+		for(int i = selectedComponents.findNextSetBit(0); i != -1; i = selectedComponents.findNextSetBit(i + 1))
 		{
-			if (auto sc = selectedSounds->getSelectedItem(i))
+			if (auto sc = sampleComponents[i])
 			{
 				DragData d;
 
@@ -1047,17 +1161,17 @@ void SamplerSoundMap::checkEventForSampleDragging(const MouseEvent &e)
 
 void SamplerSoundMap::setSelectedIds(const SampleSelection& newSelectionList)
 {
-	selectedSounds->deselectAll();
+	BigInteger newSelection;
 
-	for(int i = 0; i < sampleComponents.size(); i++)
+	for (auto s : newSelectionList)
 	{
-		if(newSelectionList.contains(sampleComponents[i]->getSound()))
-		{
-			selectedSounds->addToSelection(sampleComponents[i]);
-		}
+		const int index = getSampleComponentIndex(s.get());
+
+		if (index != -1)
+			newSelection.setBit(index, true);
 	}
 
-	updateSampleComponents();
+	setSelectedComponents(newSelection, false);
 }
 
 
@@ -1297,7 +1411,7 @@ int SamplerSoundTable::getNumRows() { return ownerSampler->getNumSounds(); }
 
 bool SamplerSoundTable::broadcasterIsSelection(ChangeBroadcaster *b) const
 {
-	return dynamic_cast<SelectedItemSet<ModulatorSamplerSound*>*>(b) != nullptr;
+	return dynamic_cast<SampleSelectionSet*>(b) != nullptr;
 }
 
 	
@@ -1376,15 +1490,26 @@ void SamplerSoundTable::soundsSelected(const SampleSelection &selectedSounds)
 {
 	table.deselectAllRows();
 
+	HashMap<const void*, bool> selectedLookup;
+
+	for (auto s : selectedSounds)
+		selectedLookup.set(s.get(), true);
+
     SparseSet<int> selection;
     
-	for (int i = 0; i < sortedSoundList.size(); i++)
+	// Adds consecutive rows as a single range so that selecting a big map doesn't fragment the set
+	int rangeStart = -1;
+
+	for (int i = 0; i <= sortedSoundList.size(); i++)
 	{
-		ModulatorSamplerSound *sound = sortedSoundList[i];
+		const bool selected = i < sortedSoundList.size() && selectedLookup.contains(sortedSoundList[i].get());
 
-		if (selectedSounds.contains(sound))
+		if (selected && rangeStart == -1)
+			rangeStart = i;
+		else if (!selected && rangeStart != -1)
 		{
-			selection.addRange(Range<int>(i, i + 1));
+			selection.addRange(Range<int>(rangeStart, i));
+			rangeStart = -1;
 		}
 	}
         
@@ -1411,12 +1536,17 @@ void SamplerSoundTable::selectedRowsChanged(int /*lastRowSelected*/)
 
 	SparseSet<int> selection = table.getSelectedRows();
 
-	handler->getSelection().deselectAll();
+	SampleSelection newSelection;
 
-	for(int i = 0; i < selection.size(); i++)
+	for (int i = 0; i < selection.getNumRanges(); i++)
 	{
-		handler->getSelection().addToSelection(sortedSoundList[selection[i]]);
+		auto r = selection.getRange(i);
+
+		for (int row = r.getStart(); row < r.getEnd(); row++)
+			newSelection.add(sortedSoundList[row]);
 	}
+
+	handler->getSelection().setSelection(newSelection);
 };
 
 } // namespace hise
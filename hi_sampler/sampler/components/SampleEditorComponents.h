@@ -231,8 +231,25 @@ public:
 
 	bool samplePathContains(Point<int> localPoint) const;
 
+	/** Draws the sample with velocity crossfades. Samples without crossfades are drawn in a batch by the map. */
     void drawSampleRectangle(Graphics &g, Rectangle<int> area);
 
+	/** Caches the mapping properties so that drawing and hit testing doesn't need to access the sample data. */
+	void setMappingData(Range<int> newKeyRange, Range<int> newVelocityRange, int newLowerXFade, int newUpperXFade)
+	{
+		keyRange = newKeyRange;
+		velocityRange = newVelocityRange;
+		lowerXFade = newLowerXFade;
+		upperXFade = newUpperXFade;
+	}
+
+	/** Returns the cached key range (the end is exclusive). */
+	Range<int> getKeyRange() const noexcept { return keyRange; }
+
+	Range<int> getVelocityRange() const noexcept { return velocityRange; }
+
+	bool hasCrossfade() const noexcept { return lowerXFade != 0 || upperXFade != 0; }
+
 	const ModulatorSamplerSound *getSound() const noexcept { return sound; };
 
 	ModulatorSamplerSound *getSound() noexcept { return sound.get(); };
@@ -285,6 +302,11 @@ private:
 
 	int numOverlayerSiblings;
 
+	Range<int> keyRange;
+	Range<int> velocityRange;
+	int lowerXFade = 0;
+	int upperXFade = 0;
+
 	Path outline;
 
 	SamplerSoundMap *map;
@@ -327,12 +349,16 @@ public:
 
 	void timerCallback() override
 	{
-		if (getWidth() > 0 && getHeight() > 0)
+		snapshotArea = getVisibleArea();
+
+		if (!snapshotArea.isEmpty())
 		{
-			currentSnapshot = Image(Image::RGB, getWidth(), getHeight(), true);
+			currentSnapshot = Image(Image::RGB, snapshotArea.getWidth(), snapshotArea.getHeight(), true);
 
 			Graphics g2(currentSnapshot);
 
+			g2.setOrigin(-snapshotArea.getX(), -snapshotArea.getY());
+
 			drawSoundMap(g2);
 
 			repaint();
@@ -367,7 +393,8 @@ public:
 
 	void refreshSelectedSoundsFromLasso();
 
-	SelectedItemSet<WeakReference<SampleComponent>> &getLassoSelection() override { return *selectedSounds; };
+	/** The lasso selection is handled by the map itself, so this will always be empty. */
+	SelectedItemSet<WeakReference<SampleComponent>> &getLassoSelection() override { return lassoSelection; };
 
 	void changeListenerCallback(ChangeBroadcaster *b) override;
 
@@ -409,8 +436,8 @@ public:
 	/** change the selection to the supplied list of sounds. */
 	void setSelectedIds(const SampleSelection& newSelectionList);
 
-	/** checks if the sound with the id is selected. */
-	bool isSelected(int id) { return selectedIds.contains(id); };
+	/** checks if the sample component with the index is selected. */
+	bool isSelected(int index) const { return selectedComponents[index]; };
 
 	/** This hides all sounds that to not belong to the specified group index. If you want to display all sounds, pass -1. */
 	void soloGroup(int groupIndex);
@@ -457,6 +484,20 @@ private:
 
 	SampleComponent* getSampleComponentAt(Point<int> point);
 
+	int getSampleComponentIndexAt(Point<int> point);
+
+	/** Returns the index of the component for the given sound or -1 if the sound is not displayed. */
+	int getSampleComponentIndex(const ModulatorSamplerSound* sound) const;
+
+	/** Sets the selected components and optionally sends the sounds to the SampleEditHandler. */
+	void setSelectedComponents(const BigInteger& newSelection, bool sendToHandler);
+
+	/** Returns the area that is visible in the parent Viewport. */
+	Rectangle<int> getVisibleArea() const;
+
+	/** Rebuilds the key index if a sample was moved or added. */
+	void updateKeyIndex();
+
 	void checkEventForSampleDragging(const MouseEvent &e);
 
 	void endSampleDragging(bool copyDraggedSounds);
@@ -478,12 +519,19 @@ private:
 	
 	DragLimiters currentDragLimiter;
 
-	Array<int> selectedIds;
 	OwnedArray<SampleComponent> sampleComponents;
 
-	Array<WeakReference<SampleComponent>> lassoSelectedComponents;
+	/** The index of each sound in the sampleComponents array. */
+	HashMap<const void*, int> componentIndexes;
+
+	/** The indexes of all sample components that span each key. */
+	Array<int> keyIndex[128];
+	bool keyIndexDirty = true;
+
+	BigInteger selectedComponents;
+	BigInteger lassoSelectedComponents;
 
-	ScopedPointer<SelectedItemSet<WeakReference<SampleComponent>>> selectedSounds;
+	SelectedItemSet<WeakReference<SampleComponent>> lassoSelection;
 	ScopedPointer<LassoComponent<WeakReference<SampleComponent>>> sampleLasso;
 
 	Rectangle<int> currentLassoRectangle;
@@ -491,6 +539,7 @@ private:
 	uint32 milliSecondsSinceLastLassoCheck;
     
     Image currentSnapshot;
+	Rectangle<int> snapshotArea;
 };
 
 /** A wrapper class around a SamplerSoundMap which adds a keyboard that can be clicked to trigger the note. 
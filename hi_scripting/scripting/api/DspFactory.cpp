@@ -53,6 +53,7 @@ public:
 		DspFactory *f = dynamic_cast<DspFactory*>(handler->getFactory(name, password));
 
 		f->currentProcessor = p;
+		f->numRandomStreams = 0;
 
 		return var(f);
 	}
@@ -188,6 +189,13 @@ void DynamicDspFactory::openDynamicLibrary()
 		library->open(fullLibraryPath);
 
 		errorCode = initialise(args);
+
+		typedef int(*getAbiVersion_)();
+
+		// Libraries that were built before the polyphonic API don't export this function
+		getAbiVersion_ v = (getAbiVersion_)library->getFunction("getAbiVersion");
+
+		abiVersion = v != nullptr ? v() : 1;
 	}
 }
 
@@ -226,6 +234,21 @@ void DynamicDspFactory::destroyDspBaseObject(DspBaseObject *object) const
 	}
 }
 
+typedef PolyDspBaseObject*(*getPolyphonicDspObject_)(DspBaseObject*);
+
+PolyDspBaseObject* DynamicDspFactory::getPolyphonicObject(DspBaseObject* object) const
+{
+	if (library != nullptr && abiVersion >= 2 && object != nullptr)
+	{
+		getPolyphonicDspObject_ p = (getPolyphonicDspObject_)library->getFunction("getPolyphonicDspObject");
+
+		if (p != nullptr)
+			return p(object);
+	}
+
+	return nullptr;
+}
+
 typedef LoadingErrorCode(*init_)(const char* name);
 
 int DynamicDspFactory::initialise(const String &arguments)
@@ -39,6 +39,13 @@ struct DspInstance::Wrapper
 	API_VOID_METHOD_WRAPPER_2(DspInstance, setParameter);
 	API_VOID_METHOD_WRAPPER_2(DspInstance, setStringParameter);
 	API_METHOD_WRAPPER_1(DspInstance, getParameter);
+	API_VOID_METHOD_WRAPPER_3(DspInstance, addParameterEvent);
+	API_VOID_METHOD_WRAPPER_3(DspInstance, startVoice);
+	API_VOID_METHOD_WRAPPER_1(DspInstance, stopVoice);
+	API_VOID_METHOD_WRAPPER_2(DspInstance, processVoice);
+	API_METHOD_WRAPPER_0(DspInstance, isPolyphonic);
+	API_METHOD_WRAPPER_0(DspInstance, getLatency);
+	API_METHOD_WRAPPER_0(DspInstance, getTailLength);
 	API_METHOD_WRAPPER_0(DspInstance, getInfo);
 	API_METHOD_WRAPPER_1(DspInstance, getStringParameter);
 	API_VOID_METHOD_WRAPPER_1(DspInstance, setBypassed);
@@ -57,7 +64,23 @@ factory(const_cast<DspFactory*>(f)),
 object(nullptr),
 bypassed(false)
 {
-	
+	pendingEvents.ensureStorageAllocated(HISE_NUM_DSP_PARAMETER_EVENTS);
+}
+
+namespace DspInstanceHelpers
+{
+	template <typename T> static T* alignPointer(T* p, int alignmentInBytes)
+	{
+		const pointer_sized_int address = reinterpret_cast<pointer_sized_int>(p);
+		const pointer_sized_int offset = (alignmentInBytes - (address % alignmentInBytes)) % alignmentInBytes;
+
+		return reinterpret_cast<T*>(address + offset);
+	}
+
+	static int roundUp(int value, int multiple)
+	{
+		return ((value + multiple - 1) / multiple) * multiple;
+	}
 }
 
 
@@ -84,6 +107,20 @@ void DspInstance::initialise()
 
 		if (object != nullptr)
 		{
+			polyObject = factory->getPolyphonicObject(object);
+
+			if (auto noise = dynamic_cast<ScriptingDsp::NoiseGenerator*>(object))
+			{
+				// Derive the stream from the processor ID and the creation order so it's stable between sessions
+				if (processor != nullptr)
+				{
+					const String streamName = processor->getId() + ".noise" + String(factory->numRandomStreams++);
+					const uint32 streamId = RandomNumberService::getStreamId(streamName);
+
+					noise->setGenerator(processor->getMainController()->getRandomNumberService().createGenerator(streamId));
+				}
+			}
+
 			ADD_API_METHOD_1(processBlock);
 			ADD_API_METHOD_2(prepareToPlay);
 			ADD_API_METHOD_2(setParameter);
@@ -97,6 +134,13 @@ void DspInstance::initialise()
             ADD_API_METHOD_0(getNumConstants);
             ADD_API_METHOD_1(getConstant);
             ADD_API_METHOD_1(getConstantId);
+			ADD_API_METHOD_3(addParameterEvent);
+			ADD_API_METHOD_3(startVoice);
+			ADD_API_METHOD_1(stopVoice);
+			ADD_API_METHOD_2(processVoice);
+			ADD_API_METHOD_0(isPolyphonic);
+			ADD_API_METHOD_0(getLatency);
+			ADD_API_METHOD_0(getTailLength);
             
 
 			for (int i = 0; i < object->getNumConstants(); i++)
@@ -220,7 +264,7 @@ void DspInstance::processBlock(const var &data)
 				FloatVectorOperations::copy(leftSamples, sampleData[0], numSamples);
 				FloatVectorOperations::copy(rightSamples, sampleData[1], numSamples);
 
-				object->processBlock(sampleData, a->size(), numSamples);
+				processWithParameterEvents(sampleData, a->size(), numSamples);
 
 				if (rampUp)
 				{
@@ -256,7 +300,7 @@ void DspInstance::processBlock(const var &data)
 				for (int i = 0; i < numChannels; i++)
 					FloatSanitizers::sanitizeArray(sampleData[i], numSamples);
 
-				object->processBlock(sampleData, numChannels, numSamples);
+				processWithParameterEvents(sampleData, numChannels, numSamples);
 
 				CHECK_AND_LOG_BUFFER_DATA_WITH_ID(processor, debugId, DebugLogger::Location::DspInstanceRenderingPost, sampleData[0], true, numSamples);
 				CHECK_AND_LOG_BUFFER_DATA_WITH_ID(processor, debugId, DebugLogger::Location::DspInstanceRenderingPost, sampleData[1], false, numSamples);
@@ -278,7 +322,7 @@ void DspInstance::processBlock(const var &data)
 				CHECK_AND_LOG_BUFFER_DATA_WITH_ID(processor, debugId, DebugLogger::Location::DspInstanceRendering, sampleData[0], true, numSamples);
 				FloatSanitizers::sanitizeArray(sampleData[0], numSamples);
 
-				object->processBlock(sampleData, 1, numSamples);
+				processWithParameterEvents(sampleData, 1, numSamples);
 
 				CHECK_AND_LOG_BUFFER_DATA_WITH_ID(processor, debugId, DebugLogger::Location::DspInstanceRenderingPost, sampleData[0], true, numSamples);
 				FloatSanitizers::sanitizeArray(sampleData[0], numSamples);
@@ -298,6 +342,226 @@ void DspInstance::setParameter(int index, float newValue)
 	}
 }
 
+void DspInstance::processWithParameterEvents(float** data, int numChannels, int numSamples)
+{
+	if (pendingEvents.isEmpty())
+	{
+		object->processBlock(data, numChannels, numSamples);
+		return;
+	}
+
+	clipParameterEvents(numSamples);
+
+	// processBlock() can't handle the events itself, so we split the block exactly at the events.
+	float* subBlockData[NUM_MAX_CHANNELS];
+
+	int eventIndex = 0;
+	int pos = 0;
+
+	while (pos < numSamples)
+	{
+		int end = numSamples;
+
+		while (eventIndex < pendingEvents.size())
+		{
+			const DspParameterEvent& e = pendingEvents.getReference(eventIndex);
+
+			if (e.timestamp > pos)
+			{
+				end = e.timestamp;
+				break;
+			}
+
+			object->setParameter(e.parameterIndex, e.value);
+			eventIndex++;
+		}
+
+		for (int i = 0; i < numChannels; i++)
+			subBlockData[i] = data[i] + pos;
+
+		object->processBlock(subBlockData, numChannels, end - pos);
+
+		pos = end;
+	}
+
+	pendingEvents.clearQuick();
+}
+
+void DspInstance::clipParameterEvents(int numSamples)
+{
+	// The list is sorted, so clipping the timestamps keeps the order
+	for (auto& e : pendingEvents)
+		e.timestamp = jlimit<int>(0, jmax<int>(0, numSamples - 1), e.timestamp);
+}
+
+void* DspInstance::getVoiceState(int voiceIndex)
+{
+	return voiceStates + voiceIndex * voiceStateSize;
+}
+
+void DspInstance::addParameterEvent(int index, float newValue, int timestamp)
+{
+	if (object != nullptr && index >= 0 && index < object->getNumParameters())
+	{
+		const SpinLock::ScopedLockType sl(getLock());
+
+		if (pendingEvents.size() >= HISE_NUM_DSP_PARAMETER_EVENTS)
+			throwError("Too many parameter events for one block");
+
+		DspParameterEvent e;
+		e.timestamp = jmax<int>(0, timestamp);
+		e.parameterIndex = index;
+		e.value = newValue;
+
+		// Insert it after all events with the same timestamp so that the order is preserved
+		int insertIndex = pendingEvents.size();
+
+		while (insertIndex > 0 && pendingEvents.getReference(insertIndex - 1).timestamp > e.timestamp)
+			insertIndex--;
+
+		pendingEvents.insert(insertIndex, e);
+	}
+}
+
+void DspInstance::startVoice(int voiceIndex, int noteNumber, float velocity)
+{
+	if (polyObject == nullptr)
+		throwError(moduleName + " is not a polyphonic module");
+
+	if (voiceStates == nullptr)
+		throwError(moduleName + ": prepareToPlay must be called before starting voices.");
+
+	if (voiceIndex < 0 || voiceIndex >= NUM_POLYPHONIC_VOICES)
+		throwError("Voice index out of range: " + String(voiceIndex));
+
+	const SpinLock::ScopedLockType sl(getLock());
+
+	polyObject->startVoice(getVoiceState(voiceIndex), noteNumber, velocity);
+}
+
+void DspInstance::stopVoice(int voiceIndex)
+{
+	if (polyObject == nullptr)
+		throwError(moduleName + " is not a polyphonic module");
+
+	if (voiceStates != nullptr && voiceIndex >= 0 && voiceIndex < NUM_POLYPHONIC_VOICES)
+	{
+		const SpinLock::ScopedLockType sl(getLock());
+
+		polyObject->stopVoice(getVoiceState(voiceIndex));
+	}
+}
+
+void DspInstance::processVoice(int voiceIndex, const var &data)
+{
+	if (!prepareToPlayWasCalled)
+		throw String(moduleName + ": prepareToPlay must be called before processing buffers.");
+
+	if (polyObject == nullptr)
+		throwError(moduleName + " is not a polyphonic module");
+
+	if (voiceIndex < 0 || voiceIndex >= NUM_POLYPHONIC_VOICES)
+		throwError("Voice index out of range: " + String(voiceIndex));
+
+	checkPriorityInversion();
+
+	const SpinLock::ScopedLockType sl(getLock());
+
+	if (isBypassed())
+	{
+		pendingEvents.clearQuick();
+		return;
+	}
+
+	float* sampleData[2] = { nullptr, nullptr };
+	int numChannels = 0;
+	int numSamples = 0;
+
+	if (data.isBuffer())
+	{
+		sampleData[0] = data.getBuffer()->buffer.getWritePointer(0);
+		numSamples = data.getBuffer()->size;
+		numChannels = 1;
+	}
+	else if (data.isArray() && (data.getArray()->size() == 1 || data.getArray()->size() == 2))
+	{
+		for (const auto& c : *data.getArray())
+		{
+			VariantBuffer* b = c.getBuffer();
+
+			if (b == nullptr)
+				throwError("processVoice must be called on array of buffers");
+
+			if (numChannels > 0 && b->size != numSamples)
+				throwError("Buffer size mismatch");
+
+			numSamples = b->size;
+			sampleData[numChannels++] = b->buffer.getWritePointer(0);
+		}
+	}
+	else throwError("processVoice must be called on a buffer or an array of two buffers");
+
+	if (numSamples > alignedBufferSize)
+		throwError("The buffer size exceeds the block size from prepareToPlay");
+
+	const int alignment = jmax<int>(1, polyObject->getSimdWidth()) * (int)sizeof(float);
+
+	bool isAligned = true;
+
+	for (int i = 0; i < numChannels; i++)
+		isAligned &= DspInstanceHelpers::alignPointer(sampleData[i], alignment) == sampleData[i];
+
+	float* voiceData[2] = { sampleData[0], sampleData[1] };
+
+	if (!isAligned)
+	{
+		for (int i = 0; i < numChannels; i++)
+		{
+			voiceData[i] = alignedBuffer + i * alignedBufferSize;
+			FloatVectorOperations::copy(voiceData[i], sampleData[i], numSamples);
+		}
+	}
+
+	for (int i = 0; i < numChannels; i++)
+		FloatSanitizers::sanitizeArray(voiceData[i], numSamples);
+
+	clipParameterEvents(numSamples);
+
+	DspVoiceBlock block;
+	block.data = voiceData;
+	block.numChannels = numChannels;
+	block.numSamples = numSamples;
+	block.events = pendingEvents.begin();
+	block.numEvents = pendingEvents.size();
+
+	polyObject->processVoice(getVoiceState(voiceIndex), block);
+
+	pendingEvents.clearQuick();
+
+	for (int i = 0; i < numChannels; i++)
+	{
+		FloatSanitizers::sanitizeArray(voiceData[i], numSamples);
+
+		if (!isAligned)
+			FloatVectorOperations::copy(sampleData[i], voiceData[i], numSamples);
+	}
+}
+
+bool DspInstance::isPolyphonic() const
+{
+	return polyObject != nullptr;
+}
+
+var DspInstance::getLatency() const
+{
+	return polyObject != nullptr ? polyObject->getLatencySamples() : 0;
+}
+
+var DspInstance::getTailLength() const
+{
+	return polyObject != nullptr ? polyObject->getTailSamples() : 0;
+}
+
 var DspInstance::getParameter(int index) const
 {
 	if (object != nullptr)
@@ -422,6 +686,9 @@ var DspInstance::getInfo() const
 
 		info << "Name: " + moduleName << "\n";
 
+		if (polyObject != nullptr)
+			info << "Polyphonic: " << String(polyObject->getVoiceStateSize()) << " bytes per voice\n";
+
 		info << "Parameters: " << String(object->getNumParameters()) << "\n";
 
 		for (int i = 0; i < object->getNumParameters(); i++)
@@ -488,6 +755,20 @@ void DspInstance::prepareToPlay(double sampleRate, int samplesPerBlock)
 
 		bypassSwitchBuffer.setSize(2, samplesPerBlock);
 
+		if (polyObject != nullptr)
+		{
+			const int simdWidth = jmax<int>(1, polyObject->getSimdWidth());
+			const int alignment = simdWidth * (int)sizeof(float);
+
+			voiceStateSize = DspInstanceHelpers::roundUp(jmax<int>(1, polyObject->getVoiceStateSize()), alignment);
+			voiceStateData.calloc(voiceStateSize * NUM_POLYPHONIC_VOICES + alignment);
+			voiceStates = DspInstanceHelpers::alignPointer(voiceStateData.get(), alignment);
+
+			alignedBufferSize = DspInstanceHelpers::roundUp(samplesPerBlock, simdWidth);
+			alignedBufferData.calloc(2 * alignedBufferSize + simdWidth);
+			alignedBuffer = DspInstanceHelpers::alignPointer(alignedBufferData.get(), alignment);
+		}
+
 		for (int i = 0; i < object->getNumConstants(); i++)
 		{
 			if (getConstantValue(i).isBuffer())
@@ -514,6 +795,7 @@ void DspInstance::unload()
         
 		factory->destroyDspBaseObject(object);
 		object = nullptr;
+		polyObject = nullptr;
 		factory = nullptr;
 	}
 }
@@ -40,6 +40,11 @@ namespace hise { using namespace juce;
 #define REGISTER_STATIC_DSP_LIBRARIES() void hise::DspFactory::Handler::registerStaticFactories(hise::DspFactory::Handler *instance)
 #define REGISTER_STATIC_DSP_FACTORY(factoryName) hise::DspFactory::Handler::registerStaticFactory<factoryName>(instance);
 
+/** The amount of parameter events that can be queued for a single block. */
+#ifndef HISE_NUM_DSP_PARAMETER_EVENTS
+#define HISE_NUM_DSP_PARAMETER_EVENTS 256
+#endif
+
 class DynamicDspFactory : public DspFactory
 {
 public:
@@ -51,6 +56,9 @@ public:
 	DspBaseObject *createDspBaseObject(const String &moduleName) const override;
 	void destroyDspBaseObject(DspBaseObject *object) const override;
 
+	int getAbiVersion() const override { return abiVersion; }
+	PolyDspBaseObject* getPolyphonicObject(DspBaseObject* object) const override;
+
 	int initialise(const String &args);
 	var createModule(const String &moduleName) const override;
 
@@ -73,6 +81,7 @@ private:
 	bool isUnloadedForCompilation = false;
 
 	int errorCode;
+	int abiVersion = 1;
 	const String name;
 	const String args;
 	ScopedPointer<DynamicLibrary> library;
@@ -177,6 +186,27 @@ public:
 	/** Returns the parameter with the given index. */
 	var getParameter(int index) const;
 
+	/** Changes the parameter at the given sample position of the next processed block. */
+	void addParameterEvent(int index, float newValue, int timestamp);
+
+	/** Initialises the state of the voice with the given index (polyphonic modules only). */
+	void startVoice(int voiceIndex, int noteNumber, float velocity);
+
+	/** Tells the module that the voice with the given index was killed (polyphonic modules only). */
+	void stopVoice(int voiceIndex);
+
+	/** Renders the voice with the given index into the data (polyphonic modules only). */
+	void processVoice(int voiceIndex, const var &data);
+
+	/** Checks if the module supports voice processing. */
+	bool isPolyphonic() const;
+
+	/** Returns the latency of the module in samples. */
+	var getLatency() const;
+
+	/** Returns the amount of samples that the module produces after the input became silent. */
+	var getTailLength() const;
+
     /** Returns the number of parameters. */
     var getNumParameters() const;
     
@@ -254,11 +284,32 @@ private:
 		throw String(errorMessage);
 	}
 
+	/** Calls the module's processBlock and splits the block at the pending parameter events. */
+	void processWithParameterEvents(float** data, int numChannels, int numSamples);
+
+	/** Limits the pending events to the given block size. */
+	void clipParameterEvents(int numSamples);
+
+	void* getVoiceState(int voiceIndex);
+
 	const String moduleName;
 
 	DspBaseObject *object;
+	PolyDspBaseObject* polyObject = nullptr;
 	DspFactory::Ptr factory;
 
+	Array<DspParameterEvent> pendingEvents;
+
+	// The states of all voices in one block that is aligned to the SIMD width of the module
+	HeapBlock<char> voiceStateData;
+	char* voiceStates = nullptr;
+	int voiceStateSize = 0;
+
+	// Used if the buffers that are passed to processVoice() are not aligned
+	HeapBlock<float> alignedBufferData;
+	float* alignedBuffer = nullptr;
+	int alignedBufferSize = 0;
+
 	AudioSampleBuffer bypassSwitchBuffer;
 
 	std::atomic<bool> bypassed;
@@ -39,7 +39,121 @@
 
 using namespace hise;
 
+/** Counts the calls to operator new of the current thread while it exists.
 
+	Use this to check that a realtime function doesn't allocate. The replaced operators below forward to malloc / free,
+	so this counts every object, string and standard container allocation, but not the storage of a HeapBlock. */
+struct ScopedAllocationCounter
+{
+	ScopedAllocationCounter()
+	{
+		numAllocations.store(0);
+		countedThread.store(Thread::getCurrentThreadId());
+	}
+
+	~ScopedAllocationCounter()
+	{
+		countedThread.store(nullptr);
+	}
+
+	int getNumAllocations() const noexcept { return numAllocations.load(); }
+
+	void reset() noexcept { numAllocations.store(0); }
+
+	static void onAllocation() noexcept
+	{
+		if (countedThread.load() == Thread::getCurrentThreadId())
+			numAllocations.fetch_add(1);
+	}
+
+	static std::atomic<Thread::ThreadID> countedThread;
+	static std::atomic<int> numAllocations;
+};
+
+std::atomic<Thread::ThreadID> ScopedAllocationCounter::countedThread = { nullptr };
+std::atomic<int> ScopedAllocationCounter::numAllocations = { 0 };
+
+void* operator new(size_t size)
+{
+	ScopedAllocationCounter::onAllocation();
+
+	if (auto p = std::malloc(size > 0 ? size : 1))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+/** A polyphonic test module that writes its state into the buffer.
+
+	Every voice writes 'value * 1000 + noteNumber' so the test can check where an event was applied and that it
+	only changed the state of the rendered voice. processBlock() writes the global value. */
+class PolyEventTestModule : public PolyDspBaseObject
+{
+public:
+
+	struct VoiceState
+	{
+		int noteNumber;
+		float value;
+	};
+
+	static Identifier getName() { RETURN_STATIC_IDENTIFIER("poly_event_test"); }
+
+	void prepareToPlay(double /*sampleRate*/, int /*blockSize*/) override {}
+
+	int getNumParameters() const override { return 1; }
+	float getParameter(int /*index*/) const override { return value; }
+	void setParameter(int /*index*/, float newValue) override { value = newValue; }
+
+	void processBlock(float** data, int numChannels, int numSamples) override
+	{
+		for (int c = 0; c < numChannels; c++)
+			FloatVectorOperations::fill(data[c], value, numSamples);
+	}
+
+	int getVoiceStateSize() const override { return sizeof(VoiceState); }
+
+	void startVoice(void* voiceState, int noteNumber, float /*velocity*/) override
+	{
+		auto s = static_cast<VoiceState*>(voiceState);
+		s->noteNumber = noteNumber;
+		s->value = value;
+	}
+
+	void processVoice(void* voiceState, DspVoiceBlock& block) override
+	{
+		auto s = static_cast<VoiceState*>(voiceState);
+		int eventIndex = 0;
+
+		for (int i = 0; i < block.numSamples; i++)
+		{
+			while (eventIndex < block.numEvents && block.events[eventIndex].timestamp <= i)
+				s->value = block.events[eventIndex++].value;
+
+			for (int c = 0; c < block.numChannels; c++)
+				block.data[c][i] = s->value * 1000.0f + (float)s->noteNumber;
+		}
+	}
+
+private:
+
+	float value = 0.0f;
+};
+
+class TestDspFactory : public StaticDspFactory
+{
+	Identifier getId() const override { RETURN_STATIC_IDENTIFIER("test") };
+
+	void registerModules() override
+	{
+		registerDspModule<PolyEventTestModule>();
+	}
+};
 
 class DspUnitTests : public UnitTest
 {
@@ -59,7 +173,720 @@ public:
 
 		testDspInstances();
 
+		testPolyphonicDspInstance();
+
 		testCircularBuffers();
+
+		testBlockDynamics();
+
+		testDynamicsSuspension();
+
+		testLatencyCompensation();
+
+		testMidiRecordingBuffer();
+
+		testSpectralProcessor(SpectralProcessor::WindowType::Hann, 4);
+		testSpectralProcessor(SpectralProcessor::WindowType::Sine, 2);
+		testSpectralProcessor(SpectralProcessor::WindowType::Rectangle, 1);
+		testSpectralProcessor(SpectralProcessor::WindowType::Hann, 2);
+		testSpectralProcessor(SpectralProcessor::WindowType::BlackmanHarris, 2);
+
+		testFFTService();
+	}
+
+	static String getFFTTypeName(audiofft::ImplementationType t)
+	{
+		switch (t)
+		{
+		case audiofft::ImplementationType::BestAvailable:	return "BestAvailable";
+		case audiofft::ImplementationType::IPP:				return "IPP";
+		case audiofft::ImplementationType::AppleAccelerate:	return "AppleAccelerate";
+		case audiofft::ImplementationType::Ooura:			return "Ooura";
+		case audiofft::ImplementationType::FFTW3:			return "FFTW3";
+		case audiofft::ImplementationType::SIMD:			return "SIMD";
+		default:											return "Unknown";
+		}
+	}
+
+	void testFFTService()
+	{
+		beginTest("Testing FFT service accuracy");
+
+		SharedResourcePointer<FFTService> service;
+		Random r;
+
+		for (int i = 1; i < (int)audiofft::ImplementationType::numImplementationTypes; i++)
+		{
+			auto type = (audiofft::ImplementationType)i;
+
+			if (!audiofft::AudioFFT::isAvailable(type))
+				continue;
+
+			for (int size : { 4, 16, 256, 2048 })
+			{
+				auto plan = service->getPlan(size, type);
+				const int numBins = plan->getNumBins();
+				const String name = getFFTTypeName(type) + " " + String(size) + ": ";
+
+				expectEquals<int>(numBins, size / 2 + 1, name + "Bin amount");
+
+				HeapBlock<float> x(size), y(size), re(numBins), im(numBins);
+				HeapBlock<float> cRe(size), cIm(size), cOutRe(size), cOutIm(size);
+
+				for (int n = 0; n < size; n++)
+				{
+					x[n] = r.nextFloat() * 2.0f - 1.0f;
+					cRe[n] = r.nextFloat() * 2.0f - 1.0f;
+					cIm[n] = r.nextFloat() * 2.0f - 1.0f;
+				}
+
+				plan->forward(x, re, im);
+				plan->complexForward(cRe, cIm, cOutRe, cOutIm);
+
+				double maxError = 0.0;
+				double maxComplexError = 0.0;
+
+				for (int k = 0; k < size; k++)
+				{
+					double sumRe = 0.0, sumIm = 0.0, cSumRe = 0.0, cSumIm = 0.0;
+
+					for (int n = 0; n < size; n++)
+					{
+						const double phase = -2.0 * double_Pi * (double)((k * n) % size) / (double)size;
+						const double c = std::cos(phase);
+						const double s = std::sin(phase);
+
+						sumRe += x[n] * c;
+						sumIm += x[n] * s;
+						cSumRe += cRe[n] * c - cIm[n] * s;
+						cSumIm += cRe[n] * s + cIm[n] * c;
+					}
+
+					if (k < numBins)
+						maxError = jmax(maxError, std::abs(sumRe - re[k]), std::abs(sumIm - im[k]));
+
+					maxComplexError = jmax(maxComplexError, std::abs(cSumRe - cOutRe[k]), std::abs(cSumIm - cOutIm[k]));
+				}
+
+				// The error grows with the size (the magnitude of random noise is about sqrt(size))
+				const double tolerance = 1e-5 * (double)size;
+
+				expect(maxError < tolerance, name + "Real FFT error: " + String(maxError));
+				expect(maxComplexError < tolerance, name + "Complex FFT error: " + String(maxComplexError));
+
+				plan->inverse(y, re, im);
+
+				maxError = 0.0;
+
+				for (int n = 0; n < size; n++)
+					maxError = jmax<double>(maxError, std::abs(y[n] - x[n]));
+
+				expect(maxError < 1e-4, name + "Real round trip error: " + String(maxError));
+
+				plan->complexInverse(cOutRe, cOutIm, cOutRe, cOutIm);
+
+				maxComplexError = 0.0;
+
+				for (int n = 0; n < size; n++)
+					maxComplexError = jmax<double>(maxComplexError, std::abs(cOutRe[n] - cRe[n]), std::abs(cOutIm[n] - cIm[n]));
+
+				expect(maxComplexError < 1e-4, name + "Complex round trip error: " + String(maxComplexError));
+			}
+		}
+
+		beginTest("Testing FFT service batch transforms and plan cache");
+
+		{
+			const int size = 512;
+			auto plan = service->getPlan(size);
+			const int numBins = plan->getNumBins();
+
+			AudioSampleBuffer input(3, size), re(3, numBins), im(3, numBins), single(2, numBins), output(3, size);
+
+			for (int c = 0; c < 3; c++)
+			{
+				for (int i = 0; i < size; i++)
+					input.setSample(c, i, r.nextFloat() * 2.0f - 1.0f);
+			}
+
+			plan->forwardBatch(input.getArrayOfReadPointers(), re.getArrayOfWritePointers(), im.getArrayOfWritePointers(), 3);
+
+			for (int c = 0; c < 3; c++)
+			{
+				plan->forward(input.getReadPointer(c), single.getWritePointer(0), single.getWritePointer(1));
+
+				for (int i = 0; i < numBins; i++)
+				{
+					expectEquals<float>(re.getSample(c, i), single.getSample(0, i), "Batch real part");
+					expectEquals<float>(im.getSample(c, i), single.getSample(1, i), "Batch imaginary part");
+				}
+			}
+
+			plan->inverseBatch(output.getArrayOfWritePointers(), re.getArrayOfReadPointers(), im.getArrayOfReadPointers(), 3);
+
+			for (int c = 0; c < 3; c++)
+			{
+				for (int i = 0; i < size; i++)
+					expectWithinAbsoluteError<float>(output.getSample(c, i), input.getSample(c, i), 1e-5f, "Batch round trip");
+			}
+
+			// the plan is still in use, so we need to get another one
+			auto otherPlan = service->getPlan(size);
+			expect(otherPlan.get() != plan.get(), "Plan in use is not shared");
+
+			auto otherPlanPtr = otherPlan.get();
+			otherPlan = nullptr;
+
+			expect(service->getPlan(size).get() == otherPlanPtr, "Unused plan is reused");
+			expect(service->getPlan(1024).get() != otherPlanPtr, "Plan size");
+		}
+
+		beginTest("Testing FFT service throughput");
+
+		for (int size : { 256, 1024, 4096 })
+		{
+			String s;
+			s << "FFT size " << String(size) << " (forward + inverse): ";
+
+			HeapBlock<float> x(size), re(size / 2 + 1), im(size / 2 + 1);
+
+			for (int i = 0; i < size; i++)
+				x[i] = r.nextFloat() * 2.0f - 1.0f;
+
+			for (int i = 1; i < (int)audiofft::ImplementationType::numImplementationTypes; i++)
+			{
+				auto type = (audiofft::ImplementationType)i;
+
+				if (!audiofft::AudioFFT::isAvailable(type))
+					continue;
+
+				auto plan = service->getPlan(size, type);
+				const int numRepetitions = (1 << 20) / size;
+
+				auto start = Time::getHighResolutionTicks();
+
+				for (int n = 0; n < numRepetitions; n++)
+				{
+					plan->forward(x, re, im);
+					plan->inverse(x, re, im);
+				}
+
+				auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start);
+
+				s << getFFTTypeName(type) << ": " << String(seconds * 1000000.0 / (double)numRepetitions, 2) << " us, ";
+			}
+
+			s << "fastest: " << getFFTTypeName(audiofft::AudioFFT::getFastestImplementation((size_t)size));
+
+			logMessage(s);
+		}
+	}
+
+	struct IdentitySpectrum : public SpectralProcessor::Callback
+	{
+		void processSpectrum(int, float*, float*, int) override { numFrames++; }
+
+		int numFrames = 0;
+	};
+
+	void testSpectralProcessor(SpectralProcessor::WindowType window, int overlap)
+	{
+		beginTest("Testing spectral processor with overlap " + String(overlap));
+
+		const int numSamples = 8192;
+
+		Random r;
+
+		AudioSampleBuffer input(2, numSamples);
+
+		for (int c = 0; c < 2; c++)
+		{
+			for (int i = 0; i < numSamples; i++)
+				input.setSample(c, i, r.nextFloat() * 2.0f - 1.0f);
+		}
+
+		AudioSampleBuffer output;
+		output.makeCopyOf(input);
+
+		IdentitySpectrum callback;
+		SpectralProcessor p(callback);
+
+		SpectralProcessor::Config c;
+		c.fftSize = 512;
+		c.overlap = overlap;
+		c.window = window;
+		p.setConfig(c);
+
+		expectEquals<int>(p.getLatency(), 512, "Latency");
+
+		// Use irregular block sizes to check that the FFT size doesn't depend on the block size
+		int pos = 0;
+
+		while (pos < numSamples)
+		{
+			const int numThisTime = jmin<int>(numSamples - pos, r.nextInt(300) + 1);
+
+			float* data[2] = { output.getWritePointer(0, pos), output.getWritePointer(1, pos) };
+			p.process(data, 2, numThisTime);
+			pos += numThisTime;
+		}
+
+		expectEquals<int>(callback.numFrames, 2 * (numSamples / (512 / overlap)), "Amount of frames");
+
+		float maxError = 0.0f;
+
+		// The first frames are not overlapped completely
+		for (int c = 0; c < 2; c++)
+		{
+			for (int i = 1024; i < numSamples; i++)
+				maxError = jmax<float>(maxError, std::abs(output.getSample(c, i) - input.getSample(c, i - 512)));
+		}
+
+		expect(maxError < 0.001f, "Overlap-add resynthesis error: " + String(maxError));
+	}
+
+	void testMidiRecordingBuffer()
+	{
+		beginTest("Testing MIDI recording buffer with 100k events");
+
+		const int numNotes = 50000;
+		const int lastTimestamp = numNotes * 10 + 100;
+
+		MidiRecordingBuffer recorder(8192);
+
+		Array<HiseEvent> existing;
+
+		HiseEvent existingOn(HiseEvent::Type::NoteOn, 60, 100, 1);
+		existingOn.setEventId(1);
+		existingOn.setTimeStamp(100);
+
+		HiseEvent existingOff(HiseEvent::Type::NoteOff, 60, 0, 1);
+		existingOff.setEventId(1);
+		existingOff.setTimeStamp(200);
+
+		existing.add(existingOn);
+		existing.add(existingOff);
+
+		recorder.reset(existing, lastTimestamp);
+
+		// This simulates the audio thread which pushes the events in blocks. After each block it waits until
+		// the consumer drained the buffer, so the ring buffer can't overflow regardless of the thread timing.
+		struct Producer : public Thread
+		{
+			Producer(MidiRecordingBuffer& r_, int numNotes_) :
+				Thread("Recording producer"),
+				r(r_),
+				numNotes(numNotes_)
+			{};
+
+			void run() override
+			{
+				ScopedAllocationCounter counter;
+
+				// A note off without note on (pressed before the recording started)
+				HiseEvent orphan(HiseEvent::Type::NoteOff, 10, 0, 1);
+				orphan.setEventId(60000);
+				r.push(orphan);
+
+				for (int i = 0; i < numNotes; i++)
+				{
+					HiseEvent on(HiseEvent::Type::NoteOn, (uint8)(i % 128), 100, 1);
+					on.setEventId((uint16)(i + 2));
+					on.setTimeStamp(i * 10);
+					r.push(on);
+
+					// Overlap the notes and leave the last one hanging
+					if (i > 0)
+					{
+						const int lastIndex = i - 1;
+
+						HiseEvent off(HiseEvent::Type::NoteOff, (uint8)(lastIndex % 128), 0, 1);
+						off.setEventId((uint16)(lastIndex + 2));
+
+						// Every 1000th note off wraps around the loop end
+						off.setTimeStamp(lastIndex % 1000 == 999 ? 3 : lastIndex * 10 + 15);
+						r.push(off);
+					}
+
+					if (i % 128 == 127 || i == numNotes - 1)
+					{
+						numAllocations += counter.getNumAllocations();
+
+						blockPushed.signal();
+						blockConsumed.wait();
+
+						counter.reset();
+					}
+				}
+
+				finished.store(true);
+				blockPushed.signal();
+			}
+
+			MidiRecordingBuffer& r;
+			const int numNotes;
+
+			WaitableEvent blockPushed;
+			WaitableEvent blockConsumed;
+			std::atomic<bool> finished = { false };
+			int numAllocations = 0;
+		};
+
+		Producer producer(recorder, numNotes);
+		producer.startThread(9);
+
+		int numConsolidated = 0;
+
+		while (!producer.finished.load())
+		{
+			producer.blockPushed.wait();
+			numConsolidated += recorder.consolidate();
+			producer.blockConsumed.signal();
+		}
+
+		producer.stopThread(1000);
+
+		numConsolidated += recorder.consolidate();
+
+		expectEquals<int>(producer.numAllocations, 0, "Allocations while pushing");
+		expectEquals<int>(recorder.getNumDroppedEvents(), 0, "Dropped events");
+		expectEquals<int>(numConsolidated, 2 * numNotes, "Consolidated events");
+
+		Array<HiseEvent> result;
+		recorder.finish(lastTimestamp, result);
+
+		expectEquals<int>(result.size(), 2 + 2 * numNotes, "Number of events after finishing");
+
+		bool isSorted = true;
+
+		for (int i = 1; i < result.size(); i++)
+			isSorted &= result[i - 1].getTimeStamp() <= result[i].getTimeStamp();
+
+		expect(isSorted, "Events are sorted");
+
+		HashMap<int, int> noteOnTimestamps;
+		int numUnmatched = 0;
+		int numWrapped = 0;
+
+		for (const auto& e : result)
+		{
+			if (e.isNoteOn())
+				noteOnTimestamps.set(e.getEventId(), e.getTimeStamp());
+			else if (e.isNoteOff())
+			{
+				if (!noteOnTimestamps.contains(e.getEventId()) || noteOnTimestamps[e.getEventId()] > e.getTimeStamp())
+					numUnmatched++;
+
+				noteOnTimestamps.remove(e.getEventId());
+
+				if (e.getTimeStamp() == lastTimestamp)
+					numWrapped++;
+			}
+		}
+
+		expectEquals<int>(numUnmatched, 0, "Unmatched note offs");
+		expectEquals<int>(noteOnTimestamps.size(), 0, "Hanging notes");
+		// 49 wrapped note offs and the hanging note
+		expectEquals<int>(numWrapped, numNotes / 1000, "Wrapped and closed notes");
+
+		Array<HiseEvent> nextTake;
+		recorder.getEvents(nextTake);
+
+		expectEquals<int>(nextTake.size(), result.size(), "The take is used for overdubbing");
+
+		beginTest("Testing MIDI recording buffer overflow");
+
+		MidiRecordingBuffer smallRecorder(16);
+
+		Array<HiseEvent> noEvents;
+		smallRecorder.reset(noEvents, lastTimestamp);
+
+		const int numToPush = smallRecorder.getQueueSize() + 5;
+		int numPushed = 0;
+
+		for (int i = 0; i < numToPush; i++)
+		{
+			HiseEvent on(HiseEvent::Type::NoteOn, 64, 100, 1);
+			on.setEventId((uint16)(i + 1));
+			on.setTimeStamp(i);
+
+			if (smallRecorder.push(on))
+				numPushed++;
+		}
+
+		expectEquals<int>(numPushed, smallRecorder.getQueueSize(), "Pushed events until full");
+		expectEquals<int>(smallRecorder.getNumDroppedEvents(), 5, "Dropped events are counted");
+		expectEquals<int>(smallRecorder.consolidate(), smallRecorder.getQueueSize(), "Consolidated events of full buffer");
+	}
+
+	void testLatencyCompensation()
+	{
+		beginTest("Testing latency compensation");
+
+		const int numSamples = 1024;
+		const int blockSize = 100;
+
+		AudioSampleBuffer input(2, numSamples);
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			input.setSample(0, i, r.nextFloat());
+			input.setSample(1, i, r.nextFloat());
+		}
+
+		LatencyCompensation lc(2);
+
+		lc.setDelay(0, 37);
+		expect(lc.isActive(), "Not active");
+		expectEquals<int>(lc.getDelay(0), 37, "Delay");
+		expectEquals<int>(lc.getDelay(1), 0, "Delay of undelayed channel");
+
+		AudioSampleBuffer output(input);
+		AudioSampleBuffer sum(2, numSamples);
+		sum.clear();
+
+		LatencyCompensation sendDelay(2);
+		sendDelay.setDelay(1, 37);
+
+		for (int i = 0; i < numSamples; i += blockSize)
+		{
+			const int numThisTime = jmin<int>(blockSize, numSamples - i);
+			AudioSampleBuffer block(output.getArrayOfWritePointers(), 2, i, numThisTime);
+
+			lc.process(block);
+			sendDelay.processChannelAndAdd(1, input.getReadPointer(1, i), sum.getWritePointer(0, i), numThisTime);
+		}
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			const float expectedDelayed = i < 37 ? 0.0f : input.getSample(0, i - 37);
+			const float expectedSend = i < 37 ? 0.0f : input.getSample(1, i - 37);
+
+			expectEquals<float>(output.getSample(0, i), expectedDelayed, "Delayed channel at " + String(i));
+			expectEquals<float>(output.getSample(1, i), input.getSample(1, i), "Undelayed channel at " + String(i));
+			expectEquals<float>(sum.getSample(0, i), expectedSend, "Delayed send at " + String(i));
+		}
+	}
+
+	void testBlockDynamics()
+	{
+		beginTest("Testing block dynamics against chunkware's dynamics classes");
+
+		const int numSamples = 44100 * 4;
+		const int blockSize = 512;
+
+		AudioSampleBuffer input(2, numSamples);
+
+		float env = 0.0f;
+
+		for (int i = 0; i < numSamples; i++)
+		{
+			if (i % 11025 == 0)
+				env = r.nextFloat() * 1.5f;
+
+			env *= 0.99995f;
+
+			input.setSample(0, i, (r.nextFloat() * 2.0f - 1.0f) * env);
+			input.setSample(1, i, (r.nextFloat() * 2.0f - 1.0f) * env * 0.7f);
+		}
+
+		AudioSampleBuffer reference(input);
+		AudioSampleBuffer output(input);
+
+		chunkware_simple::SimpleGate gate;
+		chunkware_simple::SimpleComp comp;
+		chunkware_simple::SimpleLimit limiter;
+
+		gate.setSampleRate(44100.0);
+		comp.setSampleRate(44100.0);
+		limiter.setSampleRate(44100.0);
+
+		gate.setThresh(-30.0); gate.setAttack(5.0); gate.setRelease(50.0);
+		comp.setThresh(-12.0); comp.setRatio(0.25); comp.setAttack(10.0); comp.setRelease(80.0);
+		limiter.setThresh(-3.0); limiter.setAttack(3.0); limiter.setRelease(40.0);
+
+		gate.initRuntime();
+		comp.initRuntime();
+		limiter.initRuntime();
+
+		BlockDynamics d;
+
+		d.setSampleRate(44100.0);
+		d.setThreshold(BlockDynamics::Gate, -30.0); d.setAttack(BlockDynamics::Gate, 5.0); d.setRelease(BlockDynamics::Gate, 50.0);
+		d.setThreshold(BlockDynamics::Compressor, -12.0); d.setRatio(0.25); d.setAttack(BlockDynamics::Compressor, 10.0); d.setRelease(BlockDynamics::Compressor, 80.0);
+		d.setThreshold(BlockDynamics::Limiter, -3.0); d.setAttack(BlockDynamics::Limiter, 3.0); d.setRelease(BlockDynamics::Limiter, 40.0);
+
+		d.setEnabled(BlockDynamics::Gate, true);
+		d.setEnabled(BlockDynamics::Compressor, true);
+		d.setEnabled(BlockDynamics::Limiter, true);
+		d.reset();
+
+		expectEquals<int>(d.getLatency(), (int)limiter.getLatency(), "Latency");
+
+		// Run a silent block to get past the crossfade of the limiter
+		{
+			AudioSampleBuffer silence(2, blockSize);
+			silence.clear();
+
+			d.process(silence.getWritePointer(0), silence.getWritePointer(1), blockSize);
+
+			for (int i = 0; i < blockSize; i++)
+			{
+				SimpleDataType l = 0.0, r_ = 0.0;
+				gate.process(l, r_);
+				comp.process(l, r_);
+				limiter.process(l, r_);
+			}
+		}
+
+		const double referenceStart = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numSamples; i += blockSize)
+		{
+			const int num = jmin(blockSize, numSamples - i);
+			float* l = reference.getWritePointer(0, i);
+			float* r_ = reference.getWritePointer(1, i);
+
+			processChunkwareStage(gate, l, r_, num);
+			processChunkwareStage(comp, l, r_, num);
+			processChunkwareStage(limiter, l, r_, num);
+		}
+
+		const double blockStart = Time::getMillisecondCounterHiRes();
+
+		for (int i = 0; i < numSamples; i += blockSize)
+		{
+			const int num = jmin(blockSize, numSamples - i);
+			d.process(output.getWritePointer(0, i), output.getWritePointer(1, i), num);
+		}
+
+		const double blockEnd = Time::getMillisecondCounterHiRes();
+
+		String s;
+		s << "chunkware: " << String(blockStart - referenceStart, 2) << "ms, block dynamics: " << String(blockEnd - blockStart, 2) << "ms";
+		logMessage(s);
+
+		float maxDifference = 0.0f;
+
+		for (int c = 0; c < 2; c++)
+		{
+			for (int i = 0; i < numSamples; i++)
+				maxDifference = jmax(maxDifference, std::abs(reference.getSample(c, i) - output.getSample(c, i)));
+		}
+
+		expect(maxDifference < 0.0001f, "Max difference: " + String(maxDifference));
+	}
+
+	void testDynamicsSuspension()
+	{
+		beginTest("Testing suspension of the dynamics effect");
+
+		ScopedValueSetter<bool> s(MainController::unitTestMode, true);
+
+		const int blockSize = 512;
+
+		ScopedPointer<BackendProcessor> bp = new BackendProcessor(nullptr, nullptr);
+
+		auto createEffect = [&]()
+		{
+			auto fx = new DynamicsEffect(bp, "Dynamics");
+
+			fx->prepareToPlay(44100.0, blockSize);
+			fx->setAttribute(DynamicsEffect::CompressorEnabled, 1.0f, dontSendNotification);
+			fx->setAttribute(DynamicsEffect::CompressorThreshold, -20.0f, dontSendNotification);
+			fx->setAttribute(DynamicsEffect::CompressorRatio, 4.0f, dontSendNotification);
+			fx->setAttribute(DynamicsEffect::CompressorRelease, 100.0f, dontSendNotification);
+
+			return fx;
+		};
+
+		ScopedPointer<DynamicsEffect> fx = createEffect();
+
+		expectEquals<int>(fx->getNumSilentSamplesBeforeSuspension(), 4410, "Tail of the compressor release");
+
+		AudioSampleBuffer loud(2, blockSize);
+
+		for (int i = 0; i < blockSize; i++)
+		{
+			loud.setSample(0, i, (r.nextFloat() * 2.0f - 1.0f) * 0.8f);
+			loud.setSample(1, i, (r.nextFloat() * 2.0f - 1.0f) * 0.8f);
+		}
+
+		AudioSampleBuffer b(2, blockSize);
+
+		// Mimics EffectProcessorChain::renderMasterEffects()
+		auto processBlock = [&](DynamicsEffect& e, const AudioSampleBuffer& input)
+		{
+			b.makeCopyOf(input);
+
+			if (e.updateSuspension(input.getMagnitude(0, blockSize) == 0.0f, blockSize))
+				return true;
+
+			e.applyEffect(b, 0, blockSize);
+			e.setOutputIsSilent(b.getMagnitude(0, blockSize) == 0.0f);
+			return false;
+		};
+
+		AudioSampleBuffer silence(2, blockSize);
+		silence.clear();
+
+		for (int i = 0; i < 8; i++)
+			expect(!processBlock(*fx, loud), "Not suspended with input");
+
+		int numSilentSamples = 0;
+
+		while (!processBlock(*fx, silence))
+		{
+			numSilentSamples += blockSize;
+
+			if (numSilentSamples > 44100)
+				break;
+		}
+
+		expect(numSilentSamples >= 4410, "Suspended before the release: " + String(numSilentSamples));
+		expect(numSilentSamples < 4410 + blockSize, "Suspended too late: " + String(numSilentSamples));
+
+		// The envelopes must start from scratch when the input comes back
+		expect(!processBlock(*fx, loud), "Resumed with input");
+
+		AudioSampleBuffer resumed(b);
+
+		ScopedPointer<DynamicsEffect> fresh = createEffect();
+		processBlock(*fresh, loud);
+
+		float maxError = 0.0f;
+
+		for (int c = 0; c < 2; c++)
+		{
+			for (int i = 0; i < blockSize; i++)
+				maxError = jmax(maxError, std::abs(resumed.getSample(c, i) - b.getSample(c, i)));
+		}
+
+		expectEquals<float>(maxError, 0.0f, "Resumed output matches a fresh instance");
+
+		fx->setAttribute(DynamicsEffect::LimiterEnabled, 1.0f, dontSendNotification);
+		fx->setAttribute(DynamicsEffect::LimiterAttack, 10.0f, dontSendNotification);
+
+		expectEquals<int>(fx->getNumSilentSamplesBeforeSuspension(), 441 + 4410, "Tail with lookahead");
+
+		fresh = nullptr;
+		fx = nullptr;
+		bp = nullptr;
+	}
+
+	/** Processes the signal like the DynamicsEffect did before it used the BlockDynamics class. */
+	template <class ChunkwareType> static void processChunkwareStage(ChunkwareType& stage, float* l, float* r, int numSamples)
+	{
+		for (int i = 0; i < numSamples; i++)
+		{
+			SimpleDataType l_ = (SimpleDataType)l[i];
+			SimpleDataType r_ = (SimpleDataType)r[i];
+
+			stage.process(l_, r_);
+
+			l[i] = (float)l_;
+			r[i] = (float)r_;
+		}
 	}
 
 	void testCircularBuffers()
@@ -218,10 +1045,89 @@ public:
 			expectEquals<String>(message, "stereo: prepareToPlay must be called before processing buffers.");
 		}
 		
+		expect(!stereoModule->isPolyphonic(), "Stereo module is not polyphonic");
 
+		var gm = coreFactory->createModule("smoothed_gainer");
+		DspInstance* gainModule = dynamic_cast<DspInstance*>(gm.getObject());
+		expect(gainModule != nullptr, "Gain Module creation");
+		expect(gainModule->isPolyphonic(), "Gain module is polyphonic");
+
+		gainModule->prepareToPlay(44100.0, 256);
+		gainModule->setParameter(0, 1.0f);
+		gainModule->startVoice(3, 64, 1.0f);
+
+		VariantBuffer::Ptr voiceData = new VariantBuffer(256);
+		FloatVectorOperations::fill(voiceData->buffer.getWritePointer(0), 1.0f, 256);
+
+		gainModule->addParameterEvent(0, 0.0f, 128);
+		gainModule->processVoice(3, var(voiceData));
+
+		expectEquals<float>(voiceData->buffer.getSample(0, 127), 1.0f, "Voice gain before the parameter event");
+		expect(voiceData->buffer.getSample(0, 255) < 0.5f, "Voice gain after the parameter event");
+		expectEquals<float>((float)gainModule->getParameter(0), 1.0f, "Parameter event doesn't change the global value");
 	}
 
 
+	void testPolyphonicDspInstance()
+	{
+		beginTest("Testing polyphonic DSP modules with parameter events");
+
+		DspFactory::Handler handler;
+
+		DspFactory::Handler::registerStaticFactory<TestDspFactory>(&handler);
+
+		DspFactory* testFactory = handler.getFactory("test", "");
+
+		expect(testFactory != nullptr, "Creating the test factory");
+
+		var tm = testFactory->createModule("poly_event_test");
+		DspInstance* testModule = dynamic_cast<DspInstance*>(tm.getObject());
+		expect(testModule != nullptr, "Test module creation");
+		expect(testModule->isPolyphonic(), "Test module is polyphonic");
+
+		testModule->prepareToPlay(44100.0, 64);
+		testModule->setParameter(0, 1.0f);
+
+		testModule->startVoice(0, 60, 1.0f);
+		testModule->startVoice(1, 72, 1.0f);
+
+		VariantBuffer::Ptr voice0 = new VariantBuffer(64);
+		VariantBuffer::Ptr voice1 = new VariantBuffer(64);
+
+		testModule->addParameterEvent(0, 2.0f, 13);
+		testModule->processVoice(0, var(voice0));
+		testModule->processVoice(1, var(voice1));
+
+		expectEquals<float>(voice0->buffer.getSample(0, 12), 1060.0f, "Voice 0 before the event");
+		expectEquals<float>(voice0->buffer.getSample(0, 13), 2060.0f, "Voice 0 at the event position");
+		expectEquals<float>(voice0->buffer.getSample(0, 63), 2060.0f, "Voice 0 after the event");
+		expectEquals<float>(voice1->buffer.getSample(0, 13), 1072.0f, "The event doesn't change other voices");
+		expectEquals<float>(voice1->buffer.getSample(0, 63), 1072.0f, "The event is consumed by the first voice");
+		expectEquals<float>((float)testModule->getParameter(0), 1.0f, "The event doesn't change the global value");
+
+		testModule->processVoice(0, var(voice0));
+		expectEquals<float>(voice0->buffer.getSample(0, 0), 2060.0f, "The voice state is kept between blocks");
+
+		testModule->startVoice(0, 61, 1.0f);
+		testModule->processVoice(0, var(voice0));
+		expectEquals<float>(voice0->buffer.getSample(0, 0), 1061.0f, "A new voice starts with the global value");
+
+		beginTest("Testing sample accurate parameter events in processBlock");
+
+		VariantBuffer::Ptr global = new VariantBuffer(64);
+
+		testModule->setParameter(0, 5.0f);
+		testModule->addParameterEvent(0, 7.0f, 5);
+		testModule->addParameterEvent(0, 9.0f, 37);
+		testModule->processBlock(var(global));
+
+		expectEquals<float>(global->buffer.getSample(0, 4), 5.0f, "Value before the first event");
+		expectEquals<float>(global->buffer.getSample(0, 5), 7.0f, "First event at its exact position");
+		expectEquals<float>(global->buffer.getSample(0, 36), 7.0f, "Value before the second event");
+		expectEquals<float>(global->buffer.getSample(0, 37), 9.0f, "Second event at its exact position");
+		expectEquals<float>(global->buffer.getSample(0, 63), 9.0f, "Value at the end of the block");
+	}
+
 	void testVariantBufferWithCorruptValues()
 	{
 		VariantBuffer b(6);
@@ -1553,7 +1553,9 @@ int ScriptingApi::Engine::isControllerUsedByAutomation(int controllerNumber)
 
 	for (int i = 0; i < handler->getNumActiveConnections(); i++)
 	{
-		if (handler->getDataFromIndex(i).ccNumber == controllerNumber)
+		auto data = handler->getDataFromIndex(i);
+
+		if (data.controllerType == MidiControllerAutomationHandler::ControllerType::CC && data.ccNumber == controllerNumber)
 			return i;
 	}
 
@@ -1902,7 +1904,7 @@ var ScriptingApi::Sampler::createSelection(String regex)
 		RETURN_IF_NO_THROW({});
 	}
 
-	SelectedItemSet<ModulatorSamplerSound::Ptr> newSet;
+	SampleSelectionSet newSet;
 
 	ModulatorSamplerSound::selectSoundsBasedOnRegex(regex, s, newSet);
 
@@ -2428,6 +2430,9 @@ struct ScriptingApi::Synth::Wrapper
 	API_VOID_METHOD_WRAPPER_3(Synth, addVolumeFade);
 	API_VOID_METHOD_WRAPPER_4(Synth, addPitchFade);
 	API_VOID_METHOD_WRAPPER_4(Synth, addController);
+	API_METHOD_WRAPPER_4(Synth, scheduleNoteOn);
+	API_VOID_METHOD_WRAPPER_3(Synth, scheduleNoteOff);
+	API_VOID_METHOD_WRAPPER_4(Synth, scheduleController);
 	API_METHOD_WRAPPER_1(Synth, addMessageFromHolder);
 	API_VOID_METHOD_WRAPPER_2(Synth, setVoiceGainValue);
 	API_VOID_METHOD_WRAPPER_2(Synth, setVoicePitchValue);
@@ -2496,6 +2501,9 @@ ScriptingApi::Synth::Synth(ProcessorWithScriptingContent *p, ModulatorSynth *own
 	ADD_API_METHOD_3(addVolumeFade);
 	ADD_API_METHOD_4(addPitchFade);
 	ADD_API_METHOD_4(addController);
+	ADD_API_METHOD_4(scheduleNoteOn);
+	ADD_API_METHOD_3(scheduleNoteOff);
+	ADD_API_METHOD_4(scheduleController);
 	ADD_API_METHOD_1(addMessageFromHolder);
 	ADD_API_METHOD_2(setVoiceGainValue);
 	ADD_API_METHOD_2(setVoicePitchValue);
@@ -2911,11 +2919,11 @@ void ScriptingApi::Synth::setMacroControl(int macroIndex, float newValue)
 {
 	if(ModulatorSynthChain *chain = dynamic_cast<ModulatorSynthChain*>(owner))
 	{
-		if(macroIndex > 0 && macroIndex < 8)
+		if(macroIndex > 0 && macroIndex <= chain->getNumMacroControls())
 		{
 			chain->setMacroControl(macroIndex - 1, newValue, sendNotification);
 		}
-		else reportScriptError("macroIndex must be between 1 and 8!");
+		else reportScriptError("macroIndex must be between 1 and " + String(chain->getNumMacroControls()) + "!");
 	}
 	else
 	{
@@ -3408,6 +3416,66 @@ void ScriptingApi::Synth::addController(int channel, int number, int value, int
 	else reportScriptError("Channel must be between 1 and 16.");
 }
 
+int ScriptingApi::Synth::scheduleNoteOn(int channel, int noteNumber, int velocity, int delaySamples)
+{
+	if (channel <= 0 || channel > 16)
+		reportScriptError("Channel must be between 1 and 16.");
+	else if (noteNumber < 0 || noteNumber >= 127)
+		reportScriptError("Note number must be between 0 and 127");
+	else if (velocity <= 0 || velocity > 127)
+		reportScriptError("Velocity must be between 1 and 127");
+	else
+	{
+		HiseEvent m(HiseEvent::Type::NoteOn, (uint8)noteNumber, (uint8)velocity, (uint8)channel);
+
+		// The event is not artificial (it gets into the master buffer), so the ID is reserved here
+		const uint16 eventId = getScriptProcessor()->getMainController_()->getEventHandler().reserveEventId();
+		m.setEventId(eventId);
+
+		pushToEventInbox(m, delaySamples);
+
+		return (int)eventId;
+	}
+
+	RETURN_IF_NO_THROW(-1)
+}
+
+void ScriptingApi::Synth::scheduleNoteOff(int channel, int noteNumber, int delaySamples)
+{
+	if (channel <= 0 || channel > 16)
+		reportScriptError("Channel must be between 1 and 16.");
+	else if (noteNumber < 0 || noteNumber >= 127)
+		reportScriptError("Note number must be between 0 and 127");
+	else
+		pushToEventInbox(HiseEvent(HiseEvent::Type::NoteOff, (uint8)noteNumber, 127, (uint8)channel), delaySamples);
+}
+
+void ScriptingApi::Synth::scheduleController(int channel, int number, int value, int delaySamples)
+{
+	if (channel <= 0 || channel > 16)
+		reportScriptError("Channel must be between 1 and 16.");
+	else if (number < 0 || number > 127)
+		reportScriptError("CC number must be between 0 and 127");
+	else if (value < 0 || value > 127)
+		reportScriptError("CC Value must be between 0 and 127");
+	else
+		pushToEventInbox(HiseEvent(HiseEvent::Type::Controller, (uint8)number, (uint8)value, (uint8)channel), delaySamples);
+}
+
+void ScriptingApi::Synth::pushToEventInbox(const HiseEvent& e, int delaySamples)
+{
+	if (delaySamples < 0)
+	{
+		reportScriptError("Delay must be >= 0");
+		return;
+	}
+
+	auto& inbox = getScriptProcessor()->getMainController_()->getEventInbox();
+
+	if (!inbox.push(e, inbox.getCurrentSamplePosition() + (int64)delaySamples))
+		reportScriptError("The event inbox is full");
+}
+
 void ScriptingApi::Synth::setClockSpeed(int clockSpeed)
 {
 	switch (clockSpeed)
@@ -532,7 +532,7 @@ public:
 	private:
 
 		WeakReference<Processor> sampler;
-		SelectedItemSet<ModulatorSamplerSound::Ptr> soundSelection;
+		SampleSelectionSet soundSelection;
 
 		Array<Identifier> sampleIds;
 	};
@@ -621,6 +621,15 @@ public:
 		/** Adds a controller to the buffer. */
 		void addController(int channel, int number, int value, int timeStampSamples);
 
+		/** Schedules a note on like incoming MIDI (it goes through all MIDI processors, including this one). Can be called from any callback and returns the event ID. */
+		int scheduleNoteOn(int channel, int noteNumber, int velocity, int delaySamples);
+
+		/** Schedules a note off like incoming MIDI. It stops the note that was scheduled with scheduleNoteOn(). */
+		void scheduleNoteOff(int channel, int noteNumber, int delaySamples);
+
+		/** Schedules a controller like incoming MIDI. Can be called from any callback. */
+		void scheduleController(int channel, int number, int value, int delaySamples);
+
 		/** Sets the internal clock speed. */
 		void setClockSpeed(int clockSpeed);
 
@@ -756,6 +765,9 @@ public:
 
 		int internalAddNoteOn(int channel, int noteNumber, int velocity, int timestamp, int startOffset);
 
+		/** Pushes the event into the event inbox of the MainController, relative to the start of the next block. */
+		void pushToEventInbox(const HiseEvent& e, int delaySamples);
+
 		friend class ModuleHandler;
 		
 		OwnedArray<Message> artificialNoteOns;
@@ -2103,6 +2103,7 @@ struct ScriptingApi::Content::ScriptSliderPack::Wrapper
 	API_METHOD_WRAPPER_0(ScriptSliderPack, getNumSliders);
 	API_VOID_METHOD_WRAPPER_1(ScriptSliderPack, referToData);
     API_VOID_METHOD_WRAPPER_1(ScriptSliderPack, setWidthArray);
+	API_METHOD_WRAPPER_0(ScriptSliderPack, getDataAsBuffer);
 };
 
 ScriptingApi::Content::ScriptSliderPack::ScriptSliderPack(ProcessorWithScriptingContent *base, Content* /*parentContent*/, Identifier name_, int x, int y, int , int ) :
@@ -2157,6 +2158,7 @@ existingData(nullptr)
 	ADD_API_METHOD_0(getNumSliders);
 	ADD_API_METHOD_1(referToData);
     ADD_API_METHOD_1(setWidthArray);
+	ADD_API_METHOD_0(getDataAsBuffer);
 }
 
 ScriptingApi::Content::ScriptSliderPack::~ScriptSliderPack()
@@ -2205,6 +2207,11 @@ int ScriptingApi::Content::ScriptSliderPack::getNumSliders() const
 	return getSliderPackData()->getNumSliders();
 }
 
+var ScriptingApi::Content::ScriptSliderPack::getDataAsBuffer()
+{
+	return var(getSliderPackData()->getDataBuffer().get());
+}
+
 void ScriptingApi::Content::ScriptSliderPack::connectToOtherSliderPack(const String &newPackId)
 {
 	if (newPackId.isEmpty() || newPackId == " ")
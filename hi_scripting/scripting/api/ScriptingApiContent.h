@@ -1115,6 +1115,9 @@ public:
 		/** Returns the number of sliders. */
 		int getNumSliders() const;
 
+		/** Returns a Buffer object that refers to the slider values (changing the amount of sliders will disconnect it). */
+		var getDataAsBuffer();
+
         /** Sets a non-uniform width per slider using an array in the form [0.0, ... a[i], ... 1.0]. */
         void setWidthArray(var normalizedWidths);
         
@@ -245,7 +245,7 @@ struct ScriptingObjects::ScriptSliderPackData::Wrapper
 	API_METHOD_WRAPPER_1(ScriptSliderPackData, getValue);
 	API_METHOD_WRAPPER_0(ScriptSliderPackData, getNumSliders);
 	API_VOID_METHOD_WRAPPER_3(ScriptSliderPackData, setRange);
-	
+	API_METHOD_WRAPPER_0(ScriptSliderPackData, getDataAsBuffer);
 };
 
 ScriptingObjects::ScriptSliderPackData::ScriptSliderPackData(ProcessorWithScriptingContent* pwsc) :
@@ -259,6 +259,7 @@ ScriptingObjects::ScriptSliderPackData::ScriptSliderPackData(ProcessorWithScript
 	ADD_API_METHOD_1(getValue);
 	ADD_API_METHOD_0(getNumSliders);
 	ADD_API_METHOD_3(setRange);
+	ADD_API_METHOD_0(getDataAsBuffer);
 }
 
 void ScriptingObjects::ScriptSliderPackData::rightClickCallback(const MouseEvent& e, Component *c)
@@ -317,6 +318,11 @@ void ScriptingObjects::ScriptSliderPackData::setRange(double minValue, double ma
 	data.setRange(minValue, maxValue, stepSize);
 }
 
+var ScriptingObjects::ScriptSliderPackData::getDataAsBuffer()
+{
+	return var(data.getDataBuffer().get());
+}
+
 
 struct ScriptingObjects::ScriptingSamplerSound::Wrapper
 {
@@ -1453,16 +1459,24 @@ struct ScriptingObjects::ScriptRoutingMatrix::Wrapper
 	API_METHOD_WRAPPER_2(ScriptRoutingMatrix, removeConnection);
 	API_VOID_METHOD_WRAPPER_0(ScriptRoutingMatrix, clear);
 	API_METHOD_WRAPPER_1(ScriptRoutingMatrix, getSourceGainValue);
+	API_VOID_METHOD_WRAPPER_3(ScriptRoutingMatrix, setSendGain);
+	API_METHOD_WRAPPER_2(ScriptRoutingMatrix, getSendGain);
+	API_VOID_METHOD_WRAPPER_1(ScriptRoutingMatrix, setAuxReturnSource);
 };
 
 ScriptingObjects::ScriptRoutingMatrix::ScriptRoutingMatrix(ProcessorWithScriptingContent *p, Processor *processor):
-	ConstScriptingObject(p, 2),
+	ConstScriptingObject(p, 3),
 	rp(processor)
 {
 	ADD_API_METHOD_2(addConnection);
 	ADD_API_METHOD_2(removeConnection);
 	ADD_API_METHOD_0(clear);
 	ADD_API_METHOD_1(getSourceGainValue);
+	ADD_API_METHOD_3(setSendGain);
+	ADD_API_METHOD_2(getSendGain);
+	ADD_API_METHOD_1(setAuxReturnSource);
+
+	addConstant("FirstAuxChannel", dynamic_cast<RouteEffect*>(rp.get()) != nullptr ? RouteEffect::getAuxChannelIndex(0) : -1);
 
 	if (auto r = dynamic_cast<RoutableProcessor*>(rp.get()))
 	{
@@ -1538,6 +1552,44 @@ float ScriptingObjects::ScriptRoutingMatrix::getSourceGainValue(int channelIndex
 	return 0.0f;
 }
 
+void ScriptingObjects::ScriptRoutingMatrix::setSendGain(int sourceIndex, int destinationIndex, float gain)
+{
+	if (checkValidObject())
+	{
+		if (auto r = dynamic_cast<RouteEffect*>(rp.get()))
+		{
+			if (isPositiveAndBelow(sourceIndex, RouteEffect::NumSendChannels) && isPositiveAndBelow(destinationIndex, RouteEffect::NumSendChannels))
+				r->setSendGain(sourceIndex, destinationIndex, gain);
+			else
+				reportScriptError("Invalid send channel index");
+		}
+		else
+			reportScriptError("Sends are only available for route effects");
+	}
+}
+
+float ScriptingObjects::ScriptRoutingMatrix::getSendGain(int sourceIndex, int destinationIndex)
+{
+	if (checkValidObject())
+	{
+		if (auto r = dynamic_cast<RouteEffect*>(rp.get()))
+			return r->getSendGain(sourceIndex, destinationIndex);
+	}
+
+	return 0.0f;
+}
+
+void ScriptingObjects::ScriptRoutingMatrix::setAuxReturnSource(String routeEffectId)
+{
+	if (checkValidObject())
+	{
+		if (auto r = dynamic_cast<RouteEffect*>(rp.get()))
+			r->setAuxReturnSource(routeEffectId);
+		else
+			reportScriptError("Aux returns are only available for route effects");
+	}
+}
+
 // ScriptingSynth ==============================================================================================================
 
 struct ScriptingObjects::ScriptingSynth::Wrapper
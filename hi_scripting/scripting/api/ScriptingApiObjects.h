@@ -260,6 +260,9 @@ public:
 		/** Sets the range. */
 		void setRange(double minValue, double maxValue, double stepSize);
 
+		/** Returns a Buffer object that refers to the slider values (changing the amount of sliders will disconnect it). */
+		var getDataAsBuffer();
+
 		// ============================================================================================================
 
 	private:
@@ -745,6 +748,15 @@ public:
 		/** Gets the current peak value of the given channelIndex. */
 		float getSourceGainValue(int channelIndex);
 
+		/** Sets the gain of a send from the source to the destination channel (zero mutes it). Only for route effects. */
+		void setSendGain(int sourceIndex, int destinationIndex, float gain);
+
+		/** Returns the gain of the send from the source to the destination channel. Only for route effects. */
+		float getSendGain(int sourceIndex, int destinationIndex);
+
+		/** Uses the aux channels of the route effect with the given ID as source for the aux channel indexes. */
+		void setAuxReturnSource(String routeEffectId);
+
 		// ============================================================================================================ 
 
 		struct Wrapper;
@@ -49,7 +49,7 @@ HiseJavascriptEngine::HiseJavascriptEngine(JavascriptProcessor *p) : maximumExec
 	registerNativeObject(RootObject::ObjectClass::getClassName(), new RootObject::ObjectClass());
 	registerNativeObject(RootObject::ArrayClass::getClassName(), new RootObject::ArrayClass());
 	registerNativeObject(RootObject::StringClass::getClassName(), new RootObject::StringClass());
-	registerApiClass(new RootObject::MathClass());
+	registerApiClass(new RootObject::MathClass(p));
 	registerNativeObject(RootObject::JSONClass::getClassName(), new RootObject::JSONClass());
 	registerNativeObject(RootObject::IntegerClass::getClassName(), new RootObject::IntegerClass());
 }
@@ -36,8 +36,9 @@ namespace hise { using namespace juce;
 /** The Math Object. */
 struct HiseJavascriptEngine::RootObject::MathClass : public ApiClass
 {
-	MathClass() :
-	ApiClass(2)
+	MathClass(JavascriptProcessor* p) :
+	ApiClass(2),
+	processor(p)
 	{
 		ADD_API_METHOD_1(abs);
 		ADD_API_METHOD_1(round);
@@ -119,13 +120,13 @@ struct HiseJavascriptEngine::RootObject::MathClass : public ApiClass
 	/** Returns a random number between 0.0 and 1.0. */
 	var random()
 	{
-		return Random::getSystemRandom().nextDouble();
+		return getGenerator().nextDouble();
 	}
 
 	/** Returns a random integer between the low and the high values. */
 	var randInt(var low, var high)
 	{
-		return Random::getSystemRandom().nextInt(Range<int>((int)low, (int)high));
+		return getGenerator().nextInt(Range<int>((int)low, (int)high));
 	}
 
 	/** Returns the absolute (unsigned) value. */
@@ -237,6 +238,27 @@ struct HiseJavascriptEngine::RootObject::MathClass : public ApiClass
 	var floor(var value) { return std::floor((double)value); }
 
 	template <typename Type> static Type sign_(Type n) noexcept{ return n > 0 ? (Type)1 : (n < 0 ? (Type)-1 : 0); }
+
+private:
+
+	/** The stream is created on the first call because the processor isn't fully constructed when the engine is created. */
+	PhiloxRandom& getGenerator()
+	{
+		if (!generatorInitialised)
+		{
+			if (auto p = dynamic_cast<Processor*>(processor))
+				generator = p->getMainController()->getRandomNumberService().createGenerator(RandomNumberService::getStreamId(p->getId()));
+
+			generatorInitialised = true;
+		}
+
+		return generator;
+	}
+
+	JavascriptProcessor* processor;
+
+	bool generatorInitialised = false;
+	PhiloxRandom generator;
 };
 
 } // namespace hise
\ No newline at end of file
@@ -78,6 +78,93 @@ const SliderPackData * Arpeggiator::getSliderPackData(int index) const
 	}
 }
 
+void Arpeggiator::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+	HardcodedScriptProcessor::prepareToPlay(sampleRate, samplesPerBlock);
+
+	stepClock.prepare(sampleRate);
+
+	updateStepTimerIndex();
+}
+
+void Arpeggiator::preprocessBuffer(HiseEventBuffer& buffer, int numSamples)
+{
+	skipStepsInThisBlock = false;
+
+	if (isBypassed() || bypassButton->getValue())
+		return;
+
+	const auto& pos = getMainController()->getHostPosition();
+
+	stepClock.setStepLength((double)TempoSyncer::getTempoFactor((TempoSyncer::Tempo)(int)speedKnob->getValue()));
+	stepClock.setShuffle((double)shuffleSlider->getValue());
+	stepClock.advance(pos.isPlaying, pos.ppqPosition, getMainController()->getBpm(), numSamples);
+
+	if (!is_playing && !stepClock.isRunning())
+	{
+		// Start at the note that will start the arpeggiator so that the following steps of this block are added too
+		for (const auto& e : buffer)
+		{
+			if (e.isNoteOn() && !e.isIgnored() && !shouldFilterMessage(e.getChannel()))
+			{
+				stepClock.start((int)e.getTimeStamp());
+				break;
+			}
+		}
+	}
+
+	if (!stepClock.isRunning())
+		return;
+
+	if (getIndexInChain() == -1)
+		updateStepTimerIndex();
+
+	const int timerIndex = getIndexInChain();
+
+	if (timerIndex == -1)
+		return;
+
+	int timestamps[MaxStepsPerBlock];
+
+	const int numSteps = stepClock.getNextSteps(timestamps, MaxStepsPerBlock);
+
+	for (int i = 0; i < numSteps; i++)
+		buffer.addEvent(HiseEvent::createTimerEvent((uint8)timerIndex, timestamps[i]));
+}
+
+void Arpeggiator::updateStepTimerIndex()
+{
+	if (getIndexInChain() >= NumSynthTimers)
+		return;
+
+	auto chain = getParentProcessor(false, false);
+
+	if (chain == nullptr)
+		return;
+
+	for (int timerIndex = NumSynthTimers; timerIndex <= UINT8_MAX; timerIndex++)
+	{
+		bool isUsed = false;
+
+		for (int i = 0; i < chain->getNumChildProcessors(); i++)
+		{
+			auto mp = dynamic_cast<MidiProcessor*>(chain->getChildProcessor(i));
+
+			if (mp != nullptr && mp != this && mp->getIndexInChain() == timerIndex)
+			{
+				isUsed = true;
+				break;
+			}
+		}
+
+		if (!isUsed)
+		{
+			setIndexInChain(timerIndex);
+			return;
+		}
+	}
+}
+
 void Arpeggiator::onInit()
 {
 	Content.setWidth(800);
@@ -495,7 +582,7 @@ void Arpeggiator::onAllNotesOff()
 
 void Arpeggiator::onTimer(int /*offsetInBuffer*/)
 {
-	if (bypassButton->getValue())
+	if (bypassButton->getValue() || skipStepsInThisBlock)
 		return;
 
 	if (keys_are_held())
@@ -503,6 +590,11 @@ void Arpeggiator::onTimer(int /*offsetInBuffer*/)
 		// do work if user is holding notes
 		playNote();
 	}
+	else
+	{
+		// the note that started the clock didn't reach this processor
+		stepClock.stop();
+	}
 }
 
 
@@ -515,24 +607,7 @@ void Arpeggiator::playNote()
 	start();
 
 	// transfer user held keys to midi sequence
-	MidiSequenceArray.clearQuick();
-	MidiSequenceArraySorted.clearQuick();
-
-	const int octaveRaw = (int)octaveSlider->getValue();
-
-	const int octaveSign = octaveRaw >= 0 ? 1 : -1;
-
-	auto octaveAmount = abs(octaveRaw) + 1;
-
-
-	for (int i = 0; i < octaveAmount; i++)
-	{
-		for (int j = 0; j < userHeldKeysArray.size(); j++)
-		{
-			MidiSequenceArray.addIfNotAlreadyThere(userHeldKeysArray[j] + (int8)(octaveSign * i * 12));
-			MidiSequenceArraySorted.addIfNotAlreadyThere(userHeldKeysArraySorted[j] + (int8)(octaveSign * i * 12));
-		}
-	}
+	rebuildSequence();
 
 	if (randomOrder)
 	{
@@ -772,9 +847,51 @@ void Arpeggiator::calcTimeInterval()
 	BPM = Engine.getHostBpm();
 	BPS = BPM / 60.0;
 
-	auto t = TempoSyncer::getTempoInMilliSeconds(BPM, (TempoSyncer::Tempo)(int)speedKnob->getValue()) * 0.001;
-	
-	timeInterval = jmax<double>(minTimerTime, t);
+	timeInterval = TempoSyncer::getTempoInMilliSeconds(BPM, (TempoSyncer::Tempo)(int)speedKnob->getValue()) * 0.001;
+}
+
+void Arpeggiator::rebuildSequence()
+{
+	MidiSequenceArray.clearQuick();
+	MidiSequenceArraySorted.clearQuick();
+
+	uint32 usedChannels[128];
+	uint32 usedChannelsSorted[128];
+
+	memset(usedChannels, 0, sizeof(usedChannels));
+	memset(usedChannelsSorted, 0, sizeof(usedChannelsSorted));
+
+	const int octaveRaw = (int)octaveSlider->getValue();
+
+	const int octaveSign = octaveRaw >= 0 ? 1 : -1;
+
+	auto octaveAmount = abs(octaveRaw) + 1;
+
+	for (int i = 0; i < octaveAmount; i++)
+	{
+		for (int j = 0; j < userHeldKeysArray.size(); j++)
+		{
+			addToSequence(MidiSequenceArray, usedChannels, userHeldKeysArray[j], octaveSign * i * 12);
+			addToSequence(MidiSequenceArraySorted, usedChannelsSorted, userHeldKeysArraySorted[j], octaveSign * i * 12);
+		}
+	}
+}
+
+void Arpeggiator::addToSequence(Array<NoteWithChannel, DummyCriticalSection, 256>& sequence, uint32* usedChannels, NoteWithChannel note, int delta)
+{
+	const int noteNumber = (int)note.noteNumber + delta;
+
+	if (noteNumber < 0 || noteNumber > 127)
+		return;
+
+	// Without MPE the same note on another channel is a duplicate
+	const uint32 channelBit = mpeMode ? (1u << jlimit<int>(0, 31, (int)note.channel)) : 1u;
+
+	if ((usedChannels[noteNumber] & channelBit) != 0)
+		return;
+
+	usedChannels[noteNumber] |= channelBit;
+	sequence.add({ (int8)noteNumber, note.channel });
 }
 
 void Arpeggiator::addUserHeldKey(const NoteWithChannel& note)
@@ -783,8 +900,9 @@ void Arpeggiator::addUserHeldKey(const NoteWithChannel& note)
 		return;
 
 	userHeldKeysArray.add(note);
-	userHeldKeysArraySorted.add(note);
-	userHeldKeysArraySorted.sort();
+
+	DefaultElementComparator<NoteWithChannel> comparator;
+	userHeldKeysArraySorted.addSorted(comparator, note);
 }
 
 void Arpeggiator::remUserHeldKey(const NoteWithChannel& note)
@@ -830,13 +948,15 @@ void Arpeggiator::reset(bool do_all_notes_off, bool do_stop)
 
 void Arpeggiator::start()
 {
-	auto shuffleAmount = 0.5 * (double)shuffleSlider->getValue();
-
-	auto shuffleFactor = shuffleNextNote ? (1.0 - shuffleAmount) : (1.0 + shuffleAmount);
+	if (!stepClock.isRunning())
+	{
+		// The steps of this block were calculated before the restart
+		auto ce = getCurrentHiseEvent();
 
-	shuffleNextNote = !shuffleNextNote;
+		stepClock.start(ce != nullptr ? (int)ce->getTimeStamp() : 0);
+		skipStepsInThisBlock = true;
+	}
 
-	Synth.startTimer(timeInterval * shuffleFactor);
 	is_playing = true;
 }
 
@@ -844,9 +964,8 @@ void Arpeggiator::stop()
 {
 	stopCurrentNote();
 
-	Synth.stopTimer();
+	stepClock.stop();
 	is_playing = false;
-	shuffleNextNote = false;
 }
 
 } // namespace hise
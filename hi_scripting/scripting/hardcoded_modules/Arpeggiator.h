@@ -40,6 +40,10 @@ namespace hise { using namespace juce;
 *
 *	A general purpose arpeggiator that can be used to build sequenced patches.
 *	This code is based on a script by Elan Hickler.
+*
+*	The steps are calculated from the host transport for every block and added as timer events
+*	to the buffer, so they are sample accurate and don't use one of the four synth timers. This
+*	allows multiple arpeggiators on the same channel (eg. one for each octave range).
 */
 class Arpeggiator : public HardcodedScriptProcessor,
 	public SliderPackProcessor,
@@ -76,7 +80,7 @@ public:
 	~Arpeggiator();
 
 	void mpeDataReloaded() override {};
-	void mpeModeChanged(bool isEnabled) override { mpeMode = isEnabled; reset(true, true); }
+	void mpeModeChanged(bool isEnabled) override { mpeMode = isEnabled; clearUserHeldKeys(); reset(true, true); }
 	void mpeModulatorAssigned(MPEModulator* /*m*/, bool /*wasAssigned*/) override {};
 
 	SET_PROCESSOR_NAME("Arpeggiator", "Arpeggiator", "A arpeggiator module");
@@ -87,6 +91,14 @@ public:
 
 	const SliderPackData *getSliderPackData(int index) const override;
 
+	void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+
+	bool isProcessingWholeBuffer() const override { return true; }
+
+	bool needsToBeFirstInChain() const override { return false; }
+
+	/** Adds a timer event for every step of this block. */
+	void preprocessBuffer(HiseEventBuffer& buffer, int numSamples) override;
 
 	void onInit() override;
 
@@ -115,6 +127,22 @@ private:
 
 	int sendNoteOn();
 
+	/** Picks the timer index of the steps and stores it as index in the chain.
+	
+		The synth timers use 0-3, so it's the first index after that which isn't used by another processor
+		of the chain. This walks the chain, so it's only called when the processor is prepared (or in the 
+		first block if it was added to a running chain, because it gets prepared before it's inserted).
+	*/
+	void updateStepTimerIndex();
+
+	static constexpr int NumSynthTimers = 4;
+	static constexpr int MaxStepsPerBlock = 64;
+
+	TransportStepClock stepClock;
+
+	// set when the arpeggiator is restarted after the steps of this block were added
+	bool skipStepsInThisBlock = false;
+
 	bool mpeMode = false;
 
 	int channelFilter = 0;
@@ -126,12 +154,15 @@ private:
 		int8 noteNumber;
 		int8 channel;
 
-		bool operator<(const NoteWithChannel& other) const noexcept { return noteNumber < other.noteNumber; }
-		bool operator<=(const NoteWithChannel& other) const noexcept { return noteNumber <= other.noteNumber; }
-		bool operator>=(const NoteWithChannel& other) const noexcept { return noteNumber >= other.noteNumber; }
-		bool operator>(const NoteWithChannel& other) const noexcept { return noteNumber > other.noteNumber; }
-		bool operator==(const NoteWithChannel& other) const noexcept { return noteNumber == other.noteNumber; }
-		bool operator!=(const NoteWithChannel& other) const noexcept { return noteNumber != other.noteNumber; }
+		// The same note can be held on multiple channels (MPE), so the channel is part of the identity
+		int getSortValue() const noexcept { return (int)noteNumber * 32 + (int)channel; }
+
+		bool operator<(const NoteWithChannel& other) const noexcept { return getSortValue() < other.getSortValue(); }
+		bool operator<=(const NoteWithChannel& other) const noexcept { return getSortValue() <= other.getSortValue(); }
+		bool operator>=(const NoteWithChannel& other) const noexcept { return getSortValue() >= other.getSortValue(); }
+		bool operator>(const NoteWithChannel& other) const noexcept { return getSortValue() > other.getSortValue(); }
+		bool operator==(const NoteWithChannel& other) const noexcept { return getSortValue() == other.getSortValue(); }
+		bool operator!=(const NoteWithChannel& other) const noexcept { return getSortValue() != other.getSortValue(); }
 
 		NoteWithChannel operator+(int8 delta) const noexcept { return { static_cast<int8>(noteNumber + delta), channel }; };
 		NoteWithChannel operator+=(int8 delta) noexcept { noteNumber += delta; return *this; };
@@ -172,7 +203,6 @@ private:
 	double BPM = 60.0;
 	double BPS = 1.0;
 	int minNoteLenSamples; // LATER: = Engine.getSampleRate() / 80;
-	const double minTimerTime = 0.04;
 	
 	int arpDirMod = 1; // increment value for midi sequence.
 
@@ -216,8 +246,6 @@ private:
 	bool dir_needs_change = false;
 	int curTiedNote = -1;
 
-	bool shuffleNextNote = false;
-
 	Random r;
 
 	bool shouldFilterMessage(int channel)
@@ -239,6 +267,12 @@ private:
 
 	void calcTimeInterval();;
 
+	/** Transfers the held keys to the sequence arrays (with the octave range). */
+	void rebuildSequence();
+
+	/** Adds the note if it's not already in the sequence. The mask contains a bit for every channel of a note number. */
+	void addToSequence(Array<NoteWithChannel, DummyCriticalSection, 256>& sequence, uint32* usedChannels, NoteWithChannel note, int delta);
+
 	void addUserHeldKey(const NoteWithChannel& note);
 
 	void remUserHeldKey(const NoteWithChannel& note);
@@ -302,16 +336,7 @@ private:
 
 	static float getSliderValueWithoutDisplay(ScriptingApi::Content::ScriptSliderPack* sp, int index)
 	{
-		auto array = sp->getSliderPackData()->getDataArray();
-
-		if (index < array.size())
-			return (float)array[index];
-		else
-		{
-			//jassertfalse;
-			return 0.0f;
-		}
-			
+		return sp->getSliderPackData()->getValue(index);
 	}
 
 	ScriptSliderPack semiToneSliderPack;
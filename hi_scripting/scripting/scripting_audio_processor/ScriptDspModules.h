@@ -142,7 +142,7 @@ public:
 
 
 
-	class SmoothedGainer : public DspBaseObject
+	class SmoothedGainer : public PolyDspBaseObject
 	{
 	public:
 
@@ -156,7 +156,7 @@ public:
 		};
 
 		SmoothedGainer() :
-			DspBaseObject(),
+			PolyDspBaseObject(),
 			gain(1.0f),
 			smoothingTime(200.0f),
 			fastMode(true),
@@ -184,6 +184,7 @@ public:
             {
                 smoothingTime = newValue;
                 smoother.setSmoothingTime(smoothingTime);
+				updateVoiceCoefficient();
             }
             else if (index == (int)Parameters::FastMode)
             {
@@ -196,10 +197,54 @@ public:
             
 		}
 
-		void prepareToPlay(double sampleRate, int /*samplesPerBlock*/)
+		void prepareToPlay(double sampleRate_, int /*samplesPerBlock*/)
 		{
+			sampleRate = sampleRate_;
 			smoother.prepareToPlay(sampleRate);
 			smoother.setSmoothingTime(smoothingTime);
+			updateVoiceCoefficient();
+		}
+
+		int getVoiceStateSize() const override { return sizeof(VoiceState); }
+
+		void startVoice(void* voiceState, int /*noteNumber*/, float /*velocity*/) override
+		{
+			auto s = static_cast<VoiceState*>(voiceState);
+
+			s->gain = gain;
+			s->lastValue = gain;
+		}
+
+		void processVoice(void* voiceState, DspVoiceBlock& block) override
+		{
+			auto s = static_cast<VoiceState*>(voiceState);
+
+			const float a = fastMode ? 0.99f : voiceCoefficient;
+			int pos = 0;
+
+			for (int i = 0; i <= block.numEvents; i++)
+			{
+				const int end = i < block.numEvents ? block.events[i].timestamp : block.numSamples;
+
+				for (int c = 0; c < block.numChannels; c++)
+				{
+					float value = s->lastValue;
+
+					for (int j = pos; j < end; j++)
+					{
+						value = value * a + s->gain * (1.0f - a);
+						block.data[c][j] *= value;
+					}
+
+					if (c == block.numChannels - 1)
+						s->lastValue = value;
+				}
+
+				pos = end;
+
+				if (i < block.numEvents && block.events[i].parameterIndex == (int)Parameters::Gain)
+					s->gain = block.events[i].value;
+			}
 		}
 
 		void processBlock(float** data, int numChannels, int numSamples)
@@ -299,12 +344,28 @@ public:
 
 	private:
 
+		struct VoiceState
+		{
+			float gain;
+			float lastValue;
+		};
+
+		void updateVoiceCoefficient()
+		{
+			const double numSmoothingSamples = (double)smoothingTime * 0.001 * sampleRate;
+
+			voiceCoefficient = numSmoothingSamples > 1.0 ? (float)std::exp(-1.0 / numSmoothingSamples) : 0.0f;
+		}
+
 		float gain;
 		float smoothingTime;
 		bool fastMode;
 
 		float lastValue;
 
+		double sampleRate = 44100.0;
+		float voiceCoefficient = 0.0f;
+
 		Smoother smoother;
 	};
 
@@ -474,13 +535,12 @@ public:
 				auto img = imgTempBuffer.getArrayOfWritePointers();
 
 				for (int c = 0; c < channels; c++)
-				{
-					auto fft = ffts[c];
-
 					FloatVectorOperations::multiply(data[c], getWindow(), numSamples);
 
-					fft->fft(data[c], re[c], img[c]);
+				plan->forwardBatch(data, re, img, channels);
 
+				for (int c = 0; c < channels; c++)
+				{
 					switch (currentMode)
 					{
 					case DomainModes::Raw:
@@ -495,12 +555,7 @@ public:
 					}
 					case DomainModes::Magnitude:
 					{
-						for (int i = 0; i < numSamples / 2; i++)
-						{
-							float v = re[c][i] * re[c][i] + img[c][i] * img[c][i];
-
-							data[c][i] = std::sqrtf(v);
-						}
+						FFTService::calculateMagnitudes(re[c], img[c], data[c], numSamples / 2);
 
 						FloatVectorOperations::multiply(data[c], 1.0f / (float)(lastSize / 2), numSamples/2);
 
@@ -525,17 +580,12 @@ public:
 
 		void resetFFT()
 		{
-			ScopedLock sl(lock);
+			// Getting the plan might allocate, so we do it before locking the audio thread
+			FFTService::Plan::Ptr newPlan = lastSize != -1 ? fftService->getPlan(lastSize, type) : nullptr;
 
-			ffts.clear();
-
-			for (int i = 0; i < numChannels; i++)
-			{
-				ffts.add(new audiofft::AudioFFT(type));
+			ScopedLock sl(lock);
 
-				if (lastSize != -1)
-					ffts.getLast()->init(lastSize);
-			}
+			plan = newPlan;
 
 			if (lastSize != -1)
 			{
@@ -580,7 +630,241 @@ public:
 		AudioSampleBuffer windowBuffer;
 		float* windowToUse = nullptr;
 
-		OwnedArray<audiofft::AudioFFTBase> ffts;
+		SharedResourcePointer<FFTService> fftService;
+		FFTService::Plan::Ptr plan;
+	};
+
+	/** A spectral effect that uses overlap-add resynthesis, so the FFT size doesn't depend on the block size.
+	*
+	*	It can freeze the spectrum or remove all bins below a threshold (spectral gating). The threshold is a linear gain
+	*	relative to the magnitude of a full scale sine wave.
+	*	The output is delayed by the FFT size. Changing the FFT size, overlap or window allocates a new engine, so if
+	*	they are changed outside of the message thread (eg. in the audio callbacks), the engine is created asynchronously.
+	*/
+	class Spectral : public DspBaseObject,
+					 public SpectralProcessor::Callback,
+					 private AsyncUpdater
+	{
+	public:
+
+		enum class Parameters
+		{
+			FFTSize = 0,
+			Overlap,
+			Window,
+			Threshold,
+			Freeze,
+			numParameters
+		};
+
+		enum class WindowTypes
+		{
+			Rectangle = (int)Parameters::numParameters,
+			Hann,
+			BlackmanHarris,
+			Sine,
+			numWindowTypes
+		};
+
+		SET_MODULE_NAME("spectral");
+
+		Spectral() :
+			DspBaseObject(),
+			processor(*this)
+		{
+			frozenMagnitudes.setSize(2, (int)audiofft::AudioFFT::ComplexSize(32768));
+			frozenMagnitudes.clear();
+			handleAsyncUpdate();
+		}
+
+		~Spectral()
+		{
+			cancelPendingUpdate();
+		}
+
+		void prepareToPlay(double /*sampleRate*/, int /*blockSize*/) override
+		{
+			processor.reset();
+		}
+
+		void processBlock(float **data, int numChannels, int numSamples) override
+		{
+			processor.process(data, numChannels, numSamples);
+		}
+
+		void processSpectrum(int channelIndex, float* re, float* im, int numBins) override
+		{
+			if (channelIndex >= frozenMagnitudes.getNumChannels())
+				return;
+
+			float* frozen = frozenMagnitudes.getWritePointer(channelIndex);
+
+			if (freeze)
+			{
+				// Capture the spectrum of the first frame after freezing, then keep the magnitude and use the current phase
+				const bool capture = !frozenChannels[channelIndex];
+				frozenChannels[channelIndex] = true;
+
+				for (int i = 0; i < numBins; i++)
+				{
+					const float magnitude = std::sqrt(re[i] * re[i] + im[i] * im[i]);
+
+					if (capture)
+						frozen[i] = magnitude;
+
+					const float factor = magnitude > 0.0f ? frozen[i] / magnitude : 0.0f;
+
+					re[i] *= factor;
+					im[i] *= factor;
+				}
+
+				return;
+			}
+
+			frozenChannels[channelIndex] = false;
+
+			if (threshold > 0.0f)
+			{
+				const float numFFTSamples = (float)((numBins - 1) * 2);
+				const float limit = threshold * numFFTSamples * getCoherentGain() * 0.5f;
+				const float squaredLimit = limit * limit;
+
+				for (int i = 0; i < numBins; i++)
+				{
+					if (re[i] * re[i] + im[i] * im[i] < squaredLimit)
+					{
+						re[i] = 0.0f;
+						im[i] = 0.0f;
+					}
+				}
+			}
+		}
+
+		int getNumParameters() const override { return (int)Parameters::numParameters; }
+
+		float getParameter(int index) const override
+		{
+			auto c = processor.getConfig();
+
+			// Return the new values until the engine is created
+			if (isUpdatePending())
+			{
+				c.fftSize = fftSize;
+				c.overlap = overlap;
+				c.window = windowType;
+			}
+
+			switch ((Parameters)index)
+			{
+			case Parameters::FFTSize:	return (float)c.fftSize;
+			case Parameters::Overlap:	return (float)c.overlap;
+			case Parameters::Window:	return (float)((int)c.window + (int)Parameters::numParameters);
+			case Parameters::Threshold: return threshold;
+			case Parameters::Freeze:	return freeze ? 1.0f : 0.0f;
+			default:					return 0.0f;
+			}
+		}
+
+		void setParameter(int index, float newValue) override
+		{
+			switch ((Parameters)index)
+			{
+			case Parameters::FFTSize:	fftSize = (int)newValue; updateConfig(); break;
+			case Parameters::Overlap:	overlap = (int)newValue; updateConfig(); break;
+			case Parameters::Window:
+				windowType = (SpectralProcessor::WindowType)jlimit<int>(0, (int)SpectralProcessor::WindowType::numWindowTypes - 1,
+																		(int)newValue - (int)Parameters::numParameters);
+				updateConfig();
+				break;
+			case Parameters::Threshold: threshold = jmax<float>(0.0f, newValue); break;
+			case Parameters::Freeze:	freeze = newValue > 0.5f; break;
+			default:					break;
+			}
+		}
+
+		int getNumConstants() const override
+		{
+			return (int)WindowTypes::numWindowTypes;
+		}
+
+		void getIdForConstant(int index, char*name, int &size) const noexcept override
+		{
+			switch (index)
+			{
+				FILL_PARAMETER_ID(Parameters, FFTSize, size, name);
+				FILL_PARAMETER_ID(Parameters, Overlap, size, name);
+				FILL_PARAMETER_ID(Parameters, Window, size, name);
+				FILL_PARAMETER_ID(Parameters, Threshold, size, name);
+				FILL_PARAMETER_ID(Parameters, Freeze, size, name);
+				FILL_PARAMETER_ID(WindowTypes, Rectangle, size, name);
+				FILL_PARAMETER_ID(WindowTypes, Hann, size, name);
+				FILL_PARAMETER_ID(WindowTypes, BlackmanHarris, size, name);
+				FILL_PARAMETER_ID(WindowTypes, Sine, size, name);
+			}
+		};
+
+		bool getConstant(int index, int& value) const noexcept override
+		{
+			if (index < (int)WindowTypes::numWindowTypes)
+			{
+				value = index;
+				return true;
+			}
+
+			return false;
+		};
+
+	private:
+
+		/** SpectralProcessor::setConfig() allocates and locks, so it's deferred if this isn't the message thread. */
+		void updateConfig()
+		{
+			auto mm = MessageManager::getInstanceWithoutCreating();
+
+			if (mm != nullptr && mm->isThisTheMessageThread())
+			{
+				cancelPendingUpdate();
+				handleAsyncUpdate();
+			}
+			else
+				triggerAsyncUpdate();
+		}
+
+		void handleAsyncUpdate() override
+		{
+			SpectralProcessor::Config c;
+
+			c.fftSize = fftSize;
+			c.overlap = overlap;
+			c.window = windowType;
+			c.numChannels = 2;
+
+			processor.setConfig(c);
+		}
+
+		/** Returns the average amplitude of the window, so that the threshold is relative to a full scale sine. */
+		float getCoherentGain() const
+		{
+			switch (windowType)
+			{
+			case SpectralProcessor::WindowType::Hann:			return 0.5f;
+			case SpectralProcessor::WindowType::BlackmanHarris:	return 0.35875f;
+			case SpectralProcessor::WindowType::Sine:			return 0.6366f;
+			default:											return 1.0f;
+			}
+		}
+
+		std::atomic<int> fftSize { 2048 };
+		std::atomic<int> overlap { 4 };
+		std::atomic<SpectralProcessor::WindowType> windowType { SpectralProcessor::WindowType::Hann };
+
+		float threshold = 0.0f;
+		bool freeze = false;
+
+		bool frozenChannels[2] = { false, false };
+		AudioSampleBuffer frozenMagnitudes;
+
+		SpectralProcessor processor;
 	};
 
 	// Don't use this for anything else than to check the Debug Logger!
@@ -1683,6 +1967,12 @@ public:
 
 		SET_MODULE_NAME("noise");
 
+		/** Sets the generator that creates the noise. The DspInstance derives it from the project seed. */
+		void setGenerator(const PhiloxRandom& newGenerator) noexcept
+		{
+			r = newGenerator;
+		}
+
 		void setParameter(int /*index*/, float newValue) override
 		{
 			gain.setValue(newValue);
@@ -1700,24 +1990,35 @@ public:
 		void processBlock(float **data, int numChannels, int numSamples) override
 		{
 			float* inL = data[0];
+			float* inR = numChannels == 2 ? data[1] : nullptr;
 
-			if (numChannels == 2)
+			float noise[NoiseBlockSize];
+
+			while (numSamples > 0)
 			{
-				float* inR = data[1];
+				const int numThisTime = jmin<int>(numSamples, NoiseBlockSize);
 
-				while (--numSamples >= 0)
+				r.fillBipolar(noise, numThisTime);
+
+				if (gain.isSmoothing())
 				{
-					const float v = (r.nextFloat() * 2.0f - 1.0f) * gain.getNextValue();
-					*inL++ += v;
-					*inR++ += v;
+					for (int i = 0; i < numThisTime; i++)
+						noise[i] *= gain.getNextValue();
 				}
-			}
-			else
-			{
-				while (--numSamples >= 0)
+				else
+					FloatVectorOperations::multiply(noise, gain.getTargetValue(), numThisTime);
+
+				if (inR != nullptr)
 				{
-					*inL++ = (r.nextFloat() * 2.0f - 1.0f) * gain.getNextValue();
+					FloatVectorOperations::add(inL, noise, numThisTime);
+					FloatVectorOperations::add(inR, noise, numThisTime);
+					inR += numThisTime;
 				}
+				else
+					FloatVectorOperations::copy(inL, noise, numThisTime);
+
+				inL += numThisTime;
+				numSamples -= numThisTime;
 			}
 		}
 
@@ -1749,7 +2050,9 @@ public:
 
 	private:
 
-		Random r;
+		enum { NoiseBlockSize = 256 };
+
+		PhiloxRandom r;
 
 		LinearSmoothedValue<float> gain;
 	};
@@ -2292,6 +2595,7 @@ class HiseCoreDspFactory : public StaticDspFactory
 		registerDspModule<ScriptingDsp::Delay>();
 		registerDspModule<ScriptingDsp::SignalSmoother>();
 		registerDspModule<ScriptingDsp::FFT>();
+		registerDspModule<ScriptingDsp::Spectral>();
 		registerDspModule<ScriptingDsp::SmoothedGainer>();
 		registerDspModule<ScriptingDsp::StereoWidener>();
         registerDspModule<ScriptingDsp::MoogFilter>();
@@ -6,6 +6,7 @@
 #include "hi_streaming/MonolithAudioFormat.cpp"
 #include "hi_streaming/StreamingSampler.cpp"
 #include "hi_streaming/StreamingSamplerSound.cpp"
+#include "hi_streaming/SamplePrefetchCache.cpp"
 #include "hi_streaming/StreamingSamplerVoice.cpp"
 
 
@@ -0,0 +1,243 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+namespace hise { using namespace juce;
+
+SamplePrefetchCache::SamplePrefetchCache(SampleThreadPool* pool_, int numSlots) :
+	SampleThreadPoolJob("Sample Prefetch"),
+	pool(pool_),
+	pendingRequests(64)
+{
+	for (int i = 0; i < numSlots; i++)
+		slots.add(new Slot());
+}
+
+SamplePrefetchCache::~SamplePrefetchCache()
+{
+	clear();
+}
+
+void SamplePrefetchCache::clear()
+{
+	++generation;
+
+	// Requests that were added before the generation change will be skipped,
+	// so we only need to wait for the one that is currently loaded.
+	while (isRunning())
+		Thread::sleep(1);
+
+	for (auto slot : slots)
+	{
+		// Remove the sound first: if the audio thread is copying this chunk right now, it will
+		// release the slot afterwards and the slot can't match any sound until it's refilled.
+		slot->sound.store(nullptr);
+
+		int expected = Ready;
+		slot->state.compare_exchange_strong(expected, Empty);
+	}
+}
+
+bool SamplePrefetchCache::requestChunk(const StreamingSamplerSound* s)
+{
+	if (s == nullptr || s->isEntireSampleLoaded() || s->getSampleLength() == 0 || chunkSize.load() == 0)
+		return false;
+
+	if (isCached(s))
+		return false;
+
+	if (!pendingRequests.try_enqueue({ s, generation.load() }))
+		return false;
+
+	if (!isQueued())
+		pool->addJob(this, false);
+
+	return true;
+}
+
+bool SamplePrefetchCache::copyChunk(const StreamingSamplerSound* s, hlac::HiseSampleBuffer& destination)
+{
+	const int numSamples = destination.getNumSamples();
+	const bool isFloat = destination.isFloatingPoint();
+
+	if (chunkSize.load() != numSamples || chunkIsFloat.load() != isFloat)
+	{
+		// The streaming buffers have been resized, so the next chunks will use the new format
+		chunkSize.store(numSamples);
+		chunkIsFloat.store(isFloat);
+		return false;
+	}
+
+	for (auto slot : slots)
+	{
+		if (slot->sound.load() != s)
+			continue;
+
+		int expected = Ready;
+
+		if (!slot->state.compare_exchange_strong(expected, InUse))
+			continue;
+
+		const bool fits = slot->sound.load() == s &&
+						  slot->buffer.getNumSamples() == numSamples &&
+						  slot->buffer.isFloatingPoint() == isFloat &&
+						  slot->key == ChunkKey::create(s);
+
+		if (fits)
+		{
+			destination.clearNormalisation({});
+			hlac::HiseSampleBuffer::copy(destination, slot->buffer, 0, 0, numSamples);
+			slot->lastUsed.store(++useCounter);
+		}
+
+		slot->state.store(fits ? Ready : Empty);
+		return fits;
+	}
+
+	return false;
+}
+
+SampleThreadPoolJob::JobStatus SamplePrefetchCache::runJob()
+{
+	Request r;
+
+	// Only load one chunk per call so that the voices that are already
+	// streaming don't have to wait for the prefetching.
+	if (!pendingRequests.try_dequeue(r))
+		return SampleThreadPoolJob::jobHasFinished;
+
+	// The cache was cleared after this request, so the sound might be deleted already
+	if (r.generation == generation.load() && !isCached(r.sound))
+	{
+		if (auto slot = getSlotToReplace())
+			fillSlot(*slot, r.sound);
+	}
+
+	if (shouldExit() || pendingRequests.peek() == nullptr)
+		return SampleThreadPoolJob::jobHasFinished;
+
+	return SampleThreadPoolJob::jobNeedsRunningAgain;
+}
+
+SamplePrefetchCache::ChunkKey SamplePrefetchCache::ChunkKey::create(const StreamingSamplerSound* s)
+{
+	ChunkKey k;
+
+	k.startPosition = s->getPreloadBuffer().getNumSamples();
+	k.sampleStart = s->getSampleStart();
+	k.sampleEnd = s->getSampleEnd();
+	k.loopStart = s->getLoopStart();
+	k.loopEnd = s->getLoopEnd();
+	k.loopEnabled = s->isLoopEnabled();
+
+	return k;
+}
+
+bool SamplePrefetchCache::ChunkKey::operator==(const ChunkKey& other) const noexcept
+{
+	return startPosition == other.startPosition &&
+		   sampleStart == other.sampleStart &&
+		   sampleEnd == other.sampleEnd &&
+		   loopStart == other.loopStart &&
+		   loopEnd == other.loopEnd &&
+		   loopEnabled == other.loopEnabled;
+}
+
+bool SamplePrefetchCache::isCached(const StreamingSamplerSound* s) const
+{
+	for (auto slot : slots)
+	{
+		if (slot->sound.load() == s && slot->state.load() != Empty)
+			return true;
+	}
+
+	return false;
+}
+
+SamplePrefetchCache::Slot* SamplePrefetchCache::getSlotToReplace()
+{
+	while (!shouldExit())
+	{
+		Slot* oldest = nullptr;
+
+		for (auto slot : slots)
+		{
+			const int state = slot->state.load();
+
+			if (state == Empty)
+			{
+				oldest = slot;
+				break;
+			}
+
+			if (state == Ready && (oldest == nullptr || slot->lastUsed.load() < oldest->lastUsed.load()))
+				oldest = slot;
+		}
+
+		if (oldest == nullptr)
+			return nullptr;
+
+		int expected = oldest->state.load();
+
+		if (expected != InUse && oldest->state.compare_exchange_strong(expected, Loading))
+			return oldest;
+	}
+
+	return nullptr;
+}
+
+void SamplePrefetchCache::fillSlot(Slot& slot, const StreamingSamplerSound* s)
+{
+	const int numSamples = chunkSize.load();
+	const bool isFloat = chunkIsFloat.load();
+
+	if (slot.buffer.getNumSamples() != numSamples || slot.buffer.isFloatingPoint() != isFloat)
+		slot.buffer = hlac::HiseSampleBuffer(isFloat, 2, numSamples);
+
+	slot.sound.store(s);
+	slot.key = ChunkKey::create(s);
+
+	// The file reader only reads from disk while the sound is used by a voice
+	s->increaseVoiceCount();
+
+	StreamingHelpers::fillStreamingBuffer(s, slot.buffer, numSamples, slot.key.startPosition);
+
+	s->decreaseVoiceCount();
+
+	// Don't keep the file handles open for sounds that are not played (this does nothing if a voice uses the sound).
+	if (!s->isMonolithic())
+		const_cast<StreamingSamplerSound*>(s)->closeFileHandle();
+
+	slot.lastUsed.store(++useCounter);
+	slot.state.store(Ready);
+}
+
+} // namespace hise
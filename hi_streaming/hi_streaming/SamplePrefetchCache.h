@@ -0,0 +1,140 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef SAMPLEPREFETCHCACHE_H_INCLUDED
+#define SAMPLEPREFETCHCACHE_H_INCLUDED
+
+namespace hise { using namespace juce;
+
+/** A small LRU cache for the first streaming chunk of sounds that are likely to be played next.
+*
+*	Normally a SampleLoader has to play from the preload buffer of the sound until its first disk read has landed.
+*	If the chunk that follows the preload buffer was read into this cache before the note starts, the loader copies it
+*	into its write buffer and skips the initial disk request, so the preload buffer only has to cover the time until
+*	the first buffer swap.
+*
+*	Chunks are requested from the audio thread with requestChunk() and read on the sample loading thread. Every slot
+*	has an atomic state, so the audio thread can check and copy a chunk without locking.
+*/
+class SamplePrefetchCache : public SampleThreadPoolJob
+{
+public:
+
+	SamplePrefetchCache(SampleThreadPool* pool_, int numSlots=HISE_NUM_PREFETCH_SLOTS);
+	~SamplePrefetchCache();
+
+	/** Removes all pending requests and invalidates every slot.
+	*
+	*	Call this before the sounds that might have been requested are deleted. It waits until the loading thread
+	*	has finished the current request, so don't call this from the audio thread.
+	*/
+	void clear();
+
+	/** Queues the first streaming chunk of the given sound for loading.
+	*
+	*	This is lock free and can be called from the audio thread. It returns false if the sound doesn't need
+	*	to be streamed, if it is already cached or if the request queue is full.
+	*/
+	bool requestChunk(const StreamingSamplerSound* s);
+
+	/** Copies the cached chunk of the sound into the given buffer and returns true on a cache hit.
+	*
+	*	The buffer must have the same size and data type as the cached chunk. If it doesn't, the format
+	*	of the buffer will be used for subsequent requests.
+	*/
+	bool copyChunk(const StreamingSamplerSound* s, hlac::HiseSampleBuffer& destination);
+
+	JobStatus runJob() override;
+
+private:
+
+	/** The properties of a sound that define the content of its first streaming chunk. */
+	struct ChunkKey
+	{
+		static ChunkKey create(const StreamingSamplerSound* s);
+
+		bool operator==(const ChunkKey& other) const noexcept;
+
+		int startPosition = 0;
+		int sampleStart = 0;
+		int sampleEnd = 0;
+		int loopStart = 0;
+		int loopEnd = 0;
+		bool loopEnabled = false;
+	};
+
+	enum SlotState
+	{
+		Empty = 0,
+		Loading,
+		Ready,
+		InUse
+	};
+
+	struct Slot
+	{
+		std::atomic<int> state { Empty };
+		std::atomic<uint32> lastUsed { 0 };
+		std::atomic<const StreamingSamplerSound*> sound { nullptr };
+
+		ChunkKey key;
+		hlac::HiseSampleBuffer buffer;
+	};
+
+	struct Request
+	{
+		const StreamingSamplerSound* sound;
+		uint32 generation;
+	};
+
+	bool isCached(const StreamingSamplerSound* s) const;
+	Slot* getSlotToReplace();
+	void fillSlot(Slot& slot, const StreamingSamplerSound* s);
+
+	SampleThreadPool* pool;
+
+	OwnedArray<Slot> slots;
+
+	moodycamel::ReaderWriterQueue<Request> pendingRequests;
+
+	std::atomic<uint32> generation { 0 };
+	std::atomic<uint32> useCounter { 0 };
+
+	std::atomic<int> chunkSize { 0 };
+	std::atomic<bool> chunkIsFloat { DEFAULT_BUFFER_TYPE_IS_FLOAT };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePrefetchCache);
+};
+
+} // namespace hise
+
+#endif  // SAMPLEPREFETCHCACHE_H_INCLUDED
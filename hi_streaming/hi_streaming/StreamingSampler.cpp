@@ -62,6 +62,27 @@ bool StreamingHelpers::preloadSample(StreamingSamplerSound * s, const int preloa
 	}
 }
 
+void StreamingHelpers::fillStreamingBuffer(const StreamingSamplerSound* s, hlac::HiseSampleBuffer& b, int numSamples, int positionInSampleFile)
+{
+	if (s->hasEnoughSamplesForBlock(positionInSampleFile + numSamples))
+	{
+		s->fillSampleBuffer(b, numSamples, positionInSampleFile);
+	}
+	else if (s->hasEnoughSamplesForBlock(positionInSampleFile))
+	{
+		const int numSamplesToFill = (int)s->getSampleLength() - positionInSampleFile;
+		const int numSamplesToClear = numSamples - numSamplesToFill;
+
+		s->fillSampleBuffer(b, numSamplesToFill, positionInSampleFile);
+
+		b.clear(numSamplesToFill, numSamplesToClear);
+	}
+	else
+	{
+		b.clear();
+	}
+}
+
 hise::StreamingHelpers::BasicMappingData StreamingHelpers::getBasicMappingDataFromSample(const ValueTree& sampleData)
 {
 	BasicMappingData data;
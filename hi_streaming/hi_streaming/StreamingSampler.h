@@ -55,6 +55,9 @@ struct StreamingHelpers
 
 	static bool preloadSample(StreamingSamplerSound * s, const int preloadSize, String& errorMessage);
 
+	/** Fills the buffer with the samples of the sound starting at the given position and clears the part after the sample end. */
+	static void fillStreamingBuffer(const StreamingSamplerSound* s, hlac::HiseSampleBuffer& b, int numSamples, int positionInSampleFile);
+
 	/** Creates a BasicMappingData object from the given samplemap entry. */
 	static BasicMappingData getBasicMappingDataFromSample(const ValueTree& sampleData);
 };
@@ -163,6 +166,16 @@ struct StereoChannelData
 #endif
 
 
+// The number of streaming chunks that a sampler keeps in its prefetch cache. Set this to 0 to disable the prefetching.
+#ifndef HISE_NUM_PREFETCH_SLOTS
+#define HISE_NUM_PREFETCH_SLOTS 16
+#endif
+
+// The maximum number of chunks that are requested for the predicted notes after each note on.
+#ifndef HISE_MAX_PREFETCH_REQUESTS_PER_NOTE
+#define HISE_MAX_PREFETCH_REQUESTS_PER_NOTE 8
+#endif
+
 #if JUCE_32BIT
 #define NUM_UNMAPPERS 8
 #else
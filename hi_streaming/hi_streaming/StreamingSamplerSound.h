@@ -459,6 +459,7 @@ private:
 	bool purged;
 
 	friend class SampleLoader;
+	friend struct StreamingHelpers;
 
 	hlac::HiseSampleBuffer preloadBuffer;
 	double sampleRate;
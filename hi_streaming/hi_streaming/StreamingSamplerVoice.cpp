@@ -124,6 +124,13 @@ void SampleLoader::startNote(StreamingSamplerSound const *s, int startTime)
 
 	if (!entireSampleIsLoaded)
 	{
+		// If the first streaming chunk was prefetched, the write buffer is already
+		// filled and the next disk read will be requested at the first buffer swap.
+		const bool loaderIsIdle = !isQueued() && !writeBufferIsBeingFilled;
+
+		if (loaderIsIdle && prefetchCache != nullptr && prefetchCache->copyChunk(s, *localWriteBuffer))
+			return;
+
 		// The other buffer will be filled on the next free thread pool slot
 		requestNewData();
 	}
@@ -402,23 +409,7 @@ void SampleLoader::fillInactiveBuffer()
 
 	if (localSound != nullptr)
 	{
-		if (localSound->hasEnoughSamplesForBlock(positionInSampleFile + getNumSamplesForStreamingBuffers()))
-		{
-			localSound->fillSampleBuffer(*writeBuffer.get(), getNumSamplesForStreamingBuffers(), (int)positionInSampleFile);
-		}
-		else if (localSound->hasEnoughSamplesForBlock(positionInSampleFile))
-		{
-			const int numSamplesToFill = (int)localSound->getSampleLength() - positionInSampleFile;
-			const int numSamplesToClear = getNumSamplesForStreamingBuffers() - numSamplesToFill;
-
-			localSound->fillSampleBuffer(*writeBuffer.get(), numSamplesToFill, (int)positionInSampleFile);
-
-			writeBuffer.get()->clear(numSamplesToFill, numSamplesToClear);
-		}
-		else
-		{
-			writeBuffer.get()->clear();
-		}
+		StreamingHelpers::fillStreamingBuffer(localSound, *writeBuffer.get(), getNumSamplesForStreamingBuffers(), (int)positionInSampleFile);
 
 #if LOG_SAMPLE_RENDERING
 		logger->checkAssertion(nullptr, DebugLogger::Location::SampleLoaderReadOperation, localSound != nullptr, 1174);
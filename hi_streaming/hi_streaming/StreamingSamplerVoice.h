@@ -123,6 +123,9 @@ public:
 
 
 	void setLogger(DebugLogger* l) { logger = l; }
+
+	/** Sets a cache that is checked for the first streaming chunk when a note is started. */
+	void setPrefetchCache(SamplePrefetchCache* newCache) { prefetchCache = newCache; }
 	const CriticalSection &getLock() const { return lock; }
 
 
@@ -177,6 +180,8 @@ private:
 
 	DebugLogger* logger;
 
+	SamplePrefetchCache* prefetchCache = nullptr;
+
 	Atomic<hlac::HiseSampleBuffer const *> readBuffer;
 	Atomic<hlac::HiseSampleBuffer *> writeBuffer;
 
@@ -223,6 +228,8 @@ public:
 
 	void setDebugLogger(DebugLogger* newLogger);
 
+	void setPrefetchCache(SamplePrefetchCache* newCache) { loader.setPrefetchCache(newCache); }
+
 	/** Adds it's output to the outputBuffer. */
 	void renderNextBlock(AudioSampleBuffer &outputBuffer, int startSample, int numSamples) override;
 
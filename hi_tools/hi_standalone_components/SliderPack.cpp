@@ -38,11 +38,13 @@ nextIndexToDisplay(-1),
 showValueOverlay(true),
 flashActive(true),
 undoManager(undoManager_),
-cachedData(0),
+dataBuffer(new VariantBuffer(0)),
+numReaders(0),
 defaultValue(var(1.0))
 {
     //enableAllocationFreeMessages(50);
     
+	currentBuffer.store(dataBuffer.get());
 	sliderRange = Range<double>(0.0, 1.0);
 	enablePooledUpdate(updater);
 }
@@ -60,36 +62,47 @@ void SliderPackData::setRange(double minValue, double maxValue, double stepSize_
 
 Range<double> SliderPackData::getRange() const { return sliderRange; }
 double SliderPackData::getStepSize() const { return stepSize; }
-int SliderPackData::getNumSliders() const { return values.size(); };
+
+int SliderPackData::getNumSliders() const 
+{ 
+	ScopedReader r(*this);
+	return r.buffer->size;
+};
 
 void SliderPackData::setValue(int sliderIndex, float value, NotificationType notifySliderPack/*=dontSendNotification*/, bool useUndoManager)
 {
-	ScopedReadLock sl(arrayLock);
+	if (useUndoManager && undoManager != nullptr)
+	{
+		if (sliderIndex >= 0 && sliderIndex < getNumSliders())
+			undoManager->perform(new SliderPackAction(this, sliderIndex, getValue(sliderIndex), value, notifySliderPack));
+
+		return;
+	}
+
+	bool changed = false;
 
-	if (sliderIndex >= 0 && sliderIndex < getNumSliders())
 	{
-		if (useUndoManager && undoManager != nullptr)
-		{
-			undoManager->perform(new SliderPackAction(this, sliderIndex, values[sliderIndex], value, notifySliderPack));
-		}
-		else
-		{
-			values[sliderIndex] = value;
+		// Resizing copies the values into the new buffer, so it must not happen in between
+		SpinLock::ScopedLockType sl(writerLock);
 
-			if (notifySliderPack == sendNotification)
-				sendPooledChangeMessage();
+		if (sliderIndex >= 0 && sliderIndex < dataBuffer->size)
+		{
+			dataBuffer->buffer.setSample(0, sliderIndex, value);
+			changed = true;
 		}
-
 	}
+
+	if (changed && notifySliderPack == sendNotification)
+		sendPooledChangeMessage();
 }
 
 float SliderPackData::getValue(int index) const
 {
-	ScopedReadLock sl(arrayLock);
+	ScopedReader r(*this);
 
-	if (index >= 0 && index < getNumSliders())
+	if (index >= 0 && index < r.buffer->size)
 	{
-		return values[index];
+		return r.buffer->buffer.getSample(0, index);
 	}
 
 	//jassertfalse;
@@ -98,16 +111,13 @@ float SliderPackData::getValue(int index) const
 
 void SliderPackData::setFromFloatArray(const Array<float> &valueArray)
 {
-	ScopedReadLock sl(arrayLock);
-
-	for (int i = 0; i < valueArray.size(); i++)
 	{
-		if (i < getNumSliders())
-		{
-			const float v = valueArray[i];
+		SpinLock::ScopedLockType sl(writerLock);
 
-			setValue(i, v, dontSendNotification);
-		}
+		const int numToCopy = jmin<int>(valueArray.size(), dataBuffer->size);
+
+		if (numToCopy > 0)
+			FloatVectorOperations::copy(dataBuffer->buffer.getWritePointer(0), valueArray.begin(), numToCopy);
 	}
 
 	sendChangeMessage();
@@ -115,25 +125,21 @@ void SliderPackData::setFromFloatArray(const Array<float> &valueArray)
 
 void SliderPackData::writeToFloatArray(Array<float> &valueArray) const
 {
-	valueArray.ensureStorageAllocated(getNumSliders());
+	ScopedReader r(*this);
 
-	for (int i = 0; i < getNumSliders(); i++)
-	{
-		const float v = getValue(i);
-		valueArray.set(i, v);
-	}
+	valueArray.ensureStorageAllocated(r.buffer->size);
+
+	for (int i = 0; i < r.buffer->size; i++)
+		valueArray.set(i, r.buffer->buffer.getSample(0, i));
 }
 
 String SliderPackData::toBase64() const
 {
 	Array<float> copyData;
 
-	for (int i = 0; i < getNumSliders(); i++)
-	{
-		copyData.add(values[i]);
-	}
+	writeToFloatArray(copyData);
 
-	MemoryBlock mb = MemoryBlock(copyData.getRawDataPointer(), values.size() * sizeof(float));
+	MemoryBlock mb = MemoryBlock(copyData.getRawDataPointer(), copyData.size() * sizeof(float));
 
 	return mb.toBase64Encoding();
 }
@@ -146,20 +152,42 @@ void SliderPackData::fromBase64(const String &encodedValues)
 
 	mb.fromBase64Encoding(encodedValues);
 
-	Array<float> newData((float*)mb.getData(), (int)(mb.getSize() / sizeof(float)));
+	const int numValues = (int)(mb.getSize() / sizeof(float));
 
-	var newArray = Array<var>();
+	VariantBuffer::Ptr newBuffer = new VariantBuffer(numValues);
 
-	
+	if (numValues > 0)
+		FloatVectorOperations::copy(newBuffer->buffer.getWritePointer(0), (const float*)mb.getData(), numValues);
+
+	publishBuffer(newBuffer);
+}
+
+void SliderPackData::swapData(Array<var> &otherData)
+{
+	VariantBuffer::Ptr newBuffer = new VariantBuffer(otherData.size());
+
+	for (int i = 0; i < otherData.size(); i++)
+		newBuffer->buffer.setSample(0, i, (float)otherData[i]);
+
+	publishBuffer(newBuffer);
+
+	sendChangeMessage();
+}
+
+var SliderPackData::getDataArray() const
+{
+	Array<var> copy;
 
-	for (int i = 0; i < newData.size(); i++)
 	{
-		newArray.append(newData[i]);
-	}
+		ScopedReader r(*this);
+
+		copy.ensureStorageAllocated(r.buffer->size);
 
-	ScopedWriteLock sl(arrayLock);
-	values.swapWith(newArray);
+		for (int i = 0; i < r.buffer->size; i++)
+			copy.add(r.buffer->buffer.getSample(0, i));
+	}
 
+	return var(copy);
 }
 
 void SliderPackData::setNewUndoAction() const
@@ -170,32 +198,63 @@ void SliderPackData::setNewUndoAction() const
 
 void SliderPackData::setNumSliders(int numSliders)
 {
-	int numToCopy = jmin<int>(numSliders, values.size());
+	numSliders = jmax<int>(0, numSliders);
 
-	Array<var> newValues;
+	VariantBuffer::Ptr newBuffer = new VariantBuffer(numSliders);
 
-	for (int i = 0; i < numSliders; i++)
-	{
-		if (i < numToCopy)
-			newValues.add(values[i]);
-		else
-			newValues.add(defaultValue);
-	}
+	if (numSliders > 0)
+		FloatVectorOperations::fill(newBuffer->buffer.getWritePointer(0), (float)defaultValue, numSliders);
+
+	VariantBuffer::Ptr oldBuffer;
 
-	if(auto ar = values.getArray())
 	{
-		ScopedWriteLock sl(arrayLock);
-		ar->swapWith(newValues);
+		// Copy and swap in one go so that a concurrent setValue() can't write into the old buffer
+		SpinLock::ScopedLockType sl(writerLock);
+
+		const int numToCopy = jmin<int>(numSliders, dataBuffer->size);
+
+		if (numToCopy > 0)
+			FloatVectorOperations::copy(newBuffer->buffer.getWritePointer(0), dataBuffer->buffer.getReadPointer(0), numToCopy);
+
+		oldBuffer = swapBuffer(newBuffer);
 	}
-	else
+
+	releaseBuffer(oldBuffer);
+
+	sendChangeMessage();
+}
+
+void SliderPackData::publishBuffer(VariantBuffer::Ptr newBuffer)
+{
+	VariantBuffer::Ptr oldBuffer;
+
 	{
-		ScopedWriteLock sl(arrayLock);
-		values = var(newValues);
+		SpinLock::ScopedLockType sl(writerLock);
+		oldBuffer = swapBuffer(newBuffer);
 	}
 
-	sendChangeMessage();
+	releaseBuffer(oldBuffer);
+}
+
+VariantBuffer::Ptr SliderPackData::swapBuffer(VariantBuffer::Ptr newBuffer)
+{
+	VariantBuffer::Ptr oldBuffer = dataBuffer;
+	dataBuffer = newBuffer;
+	currentBuffer.store(newBuffer.get());
+	return oldBuffer;
 }
 
+void SliderPackData::releaseBuffer(VariantBuffer::Ptr& oldBuffer)
+{
+	// Every reader that starts now will get the new buffer, so we only have
+	// to wait for the ones that might have picked up the old one. This happens
+	// without the writer lock, so setValue() calls are not blocked meanwhile.
+	while (numReaders.load() != 0)
+		Thread::yield();
+
+	// If nobody else holds a reference, the old buffer is deleted here
+	oldBuffer = nullptr;
+}
 
 SliderPack::SliderPack(SliderPackData *data_):
 data(data_),
@@ -35,7 +35,16 @@
 
 namespace hise { using namespace juce;
 
-/** The data model for a SliderPack component. */
+/** The data model for a SliderPack component. 
+
+	The values are stored as float buffer that can be read from the audio thread without locking:
+	changing the amount of sliders creates a new buffer and publishes it, and the old buffer is only
+	released after every reader that might still access it has finished. Changing a single value
+	writes into the published buffer directly (guarded by a short spin lock against resizing).
+
+	Notifications from the audio thread (the displayed index and value changes) only set atomic
+	values and are coalesced by the PooledUIUpdater, so they don't allocate or lock.
+*/
 class SliderPackData: public SafeChangeBroadcaster
 {
 public:
@@ -76,42 +85,38 @@ public:
 
 	int getNextIndexToDisplay() const
 	{
-		return nextIndexToDisplay;
+		return nextIndexToDisplay.load();
 	}
 
-	void swapData(Array<var> &otherData)
-	{
-		{
-			ScopedWriteLock sl(arrayLock);
-			values = var(otherData);
-		}
-		
-		sendChangeMessage();
-	}
+	void swapData(Array<var> &otherData);
 
+	/** Sets the index that is flashed in the SliderPack. This can be called from the audio thread. */
 	void setDisplayedIndex(int index)
 	{
-		if (index != nextIndexToDisplay)
-		{
-			nextIndexToDisplay = index;
+		if (nextIndexToDisplay.exchange(index) != index)
 			sendPooledChangeMessage();
-		}
 	}
 
-	const float* getCachedData()
+	/** Returns the data of the published buffer. 
+	
+		This doesn't copy anything, but the pointer is only valid until the amount of sliders changes.
+	*/
+	const float* getCachedData() const
 	{
-		int size = getNumSliders();
-		cachedData.buffer.setSize(1, size);
-
-		for (int i = 0; i < size; i++)
-		{
-			cachedData.setSample(i, getValue(i));
-		}
-
-		return cachedData.buffer.getReadPointer(0);
+		auto b = currentBuffer.load();
+		return b->size > 0 ? b->buffer.getReadPointer(0) : nullptr;
 	}
 
-	var getDataArray() const { return values; }
+	/** Returns a copy of the values as var array. */
+	var getDataArray() const;
+
+	/** Returns the buffer that holds the values. 
+	
+		Changing the buffer will change the slider values (without notification). If the amount of sliders
+		changes, the buffer will be replaced, so the old one will not be connected to this data anymore.
+		Don't call this from the audio thread (the reference counter might delete the buffer).
+	*/
+	VariantBuffer::Ptr getDataBuffer() const { return dataBuffer; }
 
 	void setFlashActive(bool shouldBeShown) { flashActive = shouldBeShown; };
 	void setShowValueOverlay(bool shouldBeShown) { showValueOverlay = shouldBeShown; };
@@ -171,32 +176,56 @@ private:
 		NotificationType n;
 	};
 
-	
+	/** Counts the readers of the published buffer for as long as it exists. */
+	struct ScopedReader
+	{
+		ScopedReader(const SliderPackData& d) :
+			parent(d)
+		{
+			++parent.numReaders;
+			buffer = parent.currentBuffer.load();
+		}
+
+		~ScopedReader()
+		{
+			--parent.numReaders;
+		}
+
+		const SliderPackData& parent;
+		VariantBuffer* buffer;
+	};
+
+	/** Replaces the published buffer and waits until the old one isn't read anymore. */
+	void publishBuffer(VariantBuffer::Ptr newBuffer);
 
-	ReadWriteLock arrayLock;
+	/** Publishes the new buffer and returns the old one. The writer lock must be held. */
+	VariantBuffer::Ptr swapBuffer(VariantBuffer::Ptr newBuffer);
+
+	/** Waits until the old buffer isn't read anymore and releases it. Call this without holding the writer lock. */
+	void releaseBuffer(VariantBuffer::Ptr& oldBuffer);
 
 	UndoManager* undoManager;
 
 	bool flashActive;
 	bool showValueOverlay;
 
-	VariantBuffer cachedData;
-	
 	WeakReference<SliderPackData>::Master masterReference;
 
 	friend class WeakReference < SliderPackData > ;
 
-	int nextIndexToDisplay;
+	std::atomic<int> nextIndexToDisplay;
 	
 	Range<double> sliderRange;
 
 	double stepSize;
 
-	var values;
+	SpinLock writerLock;
 
-	var defaultValue;
+	VariantBuffer::Ptr dataBuffer;
+	std::atomic<VariantBuffer*> currentBuffer;
+	mutable std::atomic<int> numReaders;
 
-	//Array<float> values;
+	var defaultValue;
 };
 
 
@@ -0,0 +1,178 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "AppConfig.h"
+
+#if HI_RUN_UNIT_TESTS
+
+#include  "JuceHeader.h"
+
+using namespace hise;
+
+class SliderPackDataUnitTest : public UnitTest
+{
+public:
+
+	SliderPackDataUnitTest() :
+		UnitTest("Testing SliderPackData")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testValuesAndBuffers();
+		testConcurrentValueChanges();
+	}
+
+private:
+
+	void testValuesAndBuffers()
+	{
+		beginTest("Testing values and buffers");
+
+		SliderPackData data(nullptr, nullptr);
+
+		data.setDefaultValue(0.5);
+		data.setNumSliders(4);
+
+		expectEquals<int>(data.getNumSliders(), 4);
+		expectEquals<float>(data.getValue(3), 0.5f, "Default value");
+		expectEquals<float>(data.getValue(4), 0.0f, "Out of range");
+
+		data.setValue(1, 0.25f);
+		data.setValue(5, 0.25f);
+
+		auto b = data.getDataBuffer();
+
+		expect(data.getCachedData() == b->buffer.getReadPointer(0), "The cached data is the buffer");
+		expectEquals<float>((*b)[1], 0.25f);
+
+		(*b)[2] = 0.75f;
+
+		expectEquals<float>(data.getValue(2), 0.75f, "The buffer refers to the values");
+
+		data.setNumSliders(8);
+
+		expectEquals<int>(data.getNumSliders(), 8);
+		expectEquals<float>(data.getValue(2), 0.75f, "Values are kept when resizing");
+		expectEquals<float>(data.getValue(7), 0.5f, "New sliders use the default value");
+		expect(data.getDataBuffer() != b, "Resizing replaces the buffer");
+		expectEquals<int>(b->size, 4, "The old buffer stays valid");
+
+		auto restored = data.toBase64();
+
+		Array<var> values;
+		values.add(1.0f);
+		values.add(2.0f);
+
+		data.swapData(values);
+
+		expectEquals<int>(data.getNumSliders(), 2);
+		expectEquals<float>(data.getValue(1), 2.0f);
+
+		data.fromBase64(restored);
+
+		expectEquals<int>(data.getNumSliders(), 8);
+		expectEquals<float>(data.getValue(1), 0.25f, "Base64 roundtrip");
+
+		// Read the values from another thread while the buffer is replaced
+		std::atomic<bool> done(false);
+		std::atomic<int> numInvalidReads(0);
+
+		std::thread reader([&]()
+		{
+			while (!done.load())
+			{
+				const int numSliders = data.getNumSliders();
+
+				for (int i = 0; i < numSliders; i++)
+				{
+					const float v = data.getValue(i);
+
+					if (v != 0.0f && v != 0.5f && v != 0.25f && v != 0.75f)
+						numInvalidReads++;
+				}
+			}
+		});
+
+		for (int i = 0; i < 2000; i++)
+			data.setNumSliders(1 + (i * 7) % 64);
+
+		done.store(true);
+		reader.join();
+
+		expectEquals<int>(numInvalidReads.load(), 0, "No invalid reads while resizing");
+	}
+
+	void testConcurrentValueChanges()
+	{
+		beginTest("Testing value changes while resizing");
+
+		SliderPackData data(nullptr, nullptr);
+
+		data.setDefaultValue(0.0);
+		data.setNumSliders(1);
+
+		std::atomic<bool> done(false);
+
+		std::thread resizer([&]()
+		{
+			int i = 0;
+
+			while (!done.load())
+				data.setNumSliders(1 + (i++ * 7) % 64);
+		});
+
+		int numLostValues = 0;
+
+		for (int i = 1; i <= 20000; i++)
+		{
+			const float v = (float)i;
+
+			data.setValue(0, v);
+
+			if (data.getValue(0) != v)
+				numLostValues++;
+		}
+
+		done.store(true);
+		resizer.join();
+
+		expectEquals<int>(numLostValues, 0, "Resizing doesn't lose value changes");
+	}
+};
+
+static SliderPackDataUnitTest sliderPackDataTestInstance;
+
+#endif
@@ -56,6 +56,7 @@
 
 #include "hi_tools/CustomDataContainers.cpp"
 #include "hi_tools/HiseEventBuffer.cpp"
+#include "hi_tools/CounterBasedRandom.cpp"
 
 #include "hi_tools/MiscToolClasses.cpp"
 
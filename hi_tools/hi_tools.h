@@ -108,6 +108,7 @@ END_JUCE_MODULE_DECLARATION
 
 #include "hi_tools/CustomDataContainers.h"
 #include "hi_tools/HiseEventBuffer.h"
+#include "hi_tools/CounterBasedRandom.h"
 
 #include "hi_tools/UpdateMerger.h"
 #include "hi_tools/MiscToolClasses.h"
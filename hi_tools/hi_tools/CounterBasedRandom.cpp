@@ -0,0 +1,266 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#if JUCE_INTEL
+#include <emmintrin.h>
+#endif
+
+namespace hise { using namespace juce;
+
+namespace PhiloxConstants
+{
+	static constexpr uint32 M0 = 0xD2511F53;
+	static constexpr uint32 M1 = 0xCD9E8D57;
+	static constexpr uint32 W0 = 0x9E3779B9;
+	static constexpr uint32 W1 = 0xBB67AE85;
+	static constexpr int NumRounds = 10;
+}
+
+PhiloxRandom::PhiloxRandom(uint64 seed, uint64 streamIndex_) noexcept
+{
+	key[0] = (uint32)seed;
+	key[1] = (uint32)(seed >> 32);
+	setStream(streamIndex_);
+}
+
+void PhiloxRandom::setSeed(uint64 newSeed) noexcept
+{
+	key[0] = (uint32)newSeed;
+	key[1] = (uint32)(newSeed >> 32);
+	setPosition(0);
+}
+
+void PhiloxRandom::setStream(uint64 newStreamIndex) noexcept
+{
+	streamIndex = newStreamIndex;
+	setPosition(0);
+}
+
+void PhiloxRandom::setPosition(uint64 numberIndex) noexcept
+{
+	nextBlockIndex = numberIndex / NumValuesPerBlock;
+	blockPosition = NumValuesPerBlock;
+
+	const int offset = (int)(numberIndex % NumValuesPerBlock);
+
+	if (offset != 0)
+	{
+		refillBlock();
+		blockPosition = offset;
+	}
+}
+
+uint64 PhiloxRandom::getPosition() const noexcept
+{
+	return nextBlockIndex * NumValuesPerBlock - (uint64)(NumValuesPerBlock - blockPosition);
+}
+
+double PhiloxRandom::nextDouble() noexcept
+{
+	const uint64 a = nextUint32() >> 5;
+	const uint64 b = nextUint32() >> 6;
+
+	return (double)(a * 67108864 + b) * (1.0 / 9007199254740992.0);
+}
+
+void PhiloxRandom::fillUniform(float* data, int numValues) noexcept
+{
+	fillInternal<false>(data, numValues);
+}
+
+void PhiloxRandom::fillBipolar(float* data, int numValues) noexcept
+{
+	fillInternal<true>(data, numValues);
+}
+
+void PhiloxRandom::generateBlock(const uint32* counter, const uint32* key_, uint32* result) noexcept
+{
+	using namespace PhiloxConstants;
+
+	uint32 c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	uint32 k0 = key_[0], k1 = key_[1];
+
+	for (int r = 0; r < NumRounds; r++)
+	{
+		const uint64 p0 = (uint64)M0 * c0;
+		const uint64 p1 = (uint64)M1 * c2;
+
+		c0 = (uint32)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32)p1;
+		c2 = (uint32)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32)p0;
+
+		k0 += W0;
+		k1 += W1;
+	}
+
+	result[0] = c0;
+	result[1] = c1;
+	result[2] = c2;
+	result[3] = c3;
+}
+
+void PhiloxRandom::generateBlocks(uint64 firstBlock, uint32* destination, int numBlocks) const noexcept
+{
+	jassert(numBlocks <= NumLanes);
+
+#if JUCE_INTEL
+	using namespace PhiloxConstants;
+
+	// Every register holds the same counter word of four blocks, so one round calculates all blocks at once
+	uint32 lanes[2][NumLanes];
+
+	for (int l = 0; l < NumLanes; l++)
+	{
+		const uint64 blockIndex = firstBlock + (uint64)l;
+		lanes[0][l] = (uint32)blockIndex;
+		lanes[1][l] = (uint32)(blockIndex >> 32);
+	}
+
+	__m128i c0 = _mm_loadu_si128((const __m128i*)lanes[0]);
+	__m128i c1 = _mm_loadu_si128((const __m128i*)lanes[1]);
+	__m128i c2 = _mm_set1_epi32((int)(uint32)streamIndex);
+	__m128i c3 = _mm_set1_epi32((int)(uint32)(streamIndex >> 32));
+
+	__m128i k0 = _mm_set1_epi32((int)key[0]);
+	__m128i k1 = _mm_set1_epi32((int)key[1]);
+
+	const __m128i m0 = _mm_set1_epi32((int)M0);
+	const __m128i m1 = _mm_set1_epi32((int)M1);
+	const __m128i w0 = _mm_set1_epi32((int)W0);
+	const __m128i w1 = _mm_set1_epi32((int)W1);
+	const __m128i loMask = _mm_set_epi32(0, -1, 0, -1);
+
+	for (int r = 0; r < NumRounds; r++)
+	{
+		// SSE2 only multiplies the even lanes to 64 bit, so the odd lanes are shifted down
+		const __m128i even0 = _mm_mul_epu32(c0, m0);
+		const __m128i odd0 = _mm_mul_epu32(_mm_srli_epi64(c0, 32), m0);
+		const __m128i even1 = _mm_mul_epu32(c2, m1);
+		const __m128i odd1 = _mm_mul_epu32(_mm_srli_epi64(c2, 32), m1);
+
+		const __m128i lo0 = _mm_or_si128(_mm_and_si128(even0, loMask), _mm_slli_epi64(odd0, 32));
+		const __m128i hi0 = _mm_or_si128(_mm_srli_epi64(even0, 32), _mm_andnot_si128(loMask, odd0));
+		const __m128i lo1 = _mm_or_si128(_mm_and_si128(even1, loMask), _mm_slli_epi64(odd1, 32));
+		const __m128i hi1 = _mm_or_si128(_mm_srli_epi64(even1, 32), _mm_andnot_si128(loMask, odd1));
+
+		c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), k0);
+		c1 = lo1;
+		c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), k1);
+		c3 = lo0;
+
+		k0 = _mm_add_epi32(k0, w0);
+		k1 = _mm_add_epi32(k1, w1);
+	}
+
+	// Transpose the registers so that the words of each block are next to each other
+	__m128 r0 = _mm_castsi128_ps(c0);
+	__m128 r1 = _mm_castsi128_ps(c1);
+	__m128 r2 = _mm_castsi128_ps(c2);
+	__m128 r3 = _mm_castsi128_ps(c3);
+
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	if (numBlocks == NumLanes)
+	{
+		_mm_storeu_ps((float*)destination, r0);
+		_mm_storeu_ps((float*)destination + 4, r1);
+		_mm_storeu_ps((float*)destination + 8, r2);
+		_mm_storeu_ps((float*)destination + 12, r3);
+	}
+	else
+	{
+		uint32 blocks[NumLanes * NumValuesPerBlock];
+
+		_mm_storeu_ps((float*)blocks, r0);
+		_mm_storeu_ps((float*)blocks + 4, r1);
+		_mm_storeu_ps((float*)blocks + 8, r2);
+		_mm_storeu_ps((float*)blocks + 12, r3);
+
+		memcpy(destination, blocks, sizeof(uint32) * NumValuesPerBlock * numBlocks);
+	}
+#else
+	for (int l = 0; l < numBlocks; l++)
+	{
+		const uint64 blockIndex = firstBlock + (uint64)l;
+		const uint32 counter[4] = { (uint32)blockIndex, (uint32)(blockIndex >> 32), (uint32)streamIndex, (uint32)(streamIndex >> 32) };
+
+		generateBlock(counter, key, destination + l * NumValuesPerBlock);
+	}
+#endif
+}
+
+template <bool Bipolar> void PhiloxRandom::fillInternal(float* data, int numValues) noexcept
+{
+	// Use the rest of the current block first, so the result doesn't depend on the call pattern
+	while (numValues > 0 && blockPosition != NumValuesPerBlock)
+	{
+		const uint32 v = currentBlock[blockPosition++];
+		*data++ = Bipolar ? toBipolar(v) : toUnipolar(v);
+		--numValues;
+	}
+
+	uint32 raw[NumLanes * NumValuesPerBlock];
+
+	while (numValues >= NumValuesPerBlock)
+	{
+		const int numBlocks = jmin<int>(NumLanes, numValues / NumValuesPerBlock);
+		const int numThisTime = numBlocks * NumValuesPerBlock;
+
+		generateBlocks(nextBlockIndex, raw, numBlocks);
+		nextBlockIndex += (uint64)numBlocks;
+
+		for (int i = 0; i < numThisTime; i++)
+			data[i] = Bipolar ? toBipolar(raw[i]) : toUnipolar(raw[i]);
+
+		data += numThisTime;
+		numValues -= numThisTime;
+	}
+
+	while (--numValues >= 0)
+	{
+		const uint32 v = nextUint32();
+		*data++ = Bipolar ? toBipolar(v) : toUnipolar(v);
+	}
+}
+
+void PhiloxRandom::refillBlock() noexcept
+{
+	const uint32 counter[4] = { (uint32)nextBlockIndex, (uint32)(nextBlockIndex >> 32), (uint32)streamIndex, (uint32)(streamIndex >> 32) };
+
+	generateBlock(counter, key, currentBlock);
+
+	++nextBlockIndex;
+	blockPosition = 0;
+}
+
+} // namespace hise
@@ -0,0 +1,181 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+#ifndef COUNTERBASEDRANDOM_H_INCLUDED
+#define COUNTERBASEDRANDOM_H_INCLUDED
+
+namespace hise { using namespace juce;
+
+/** A counter based random number generator (Philox4x32-10).
+	@ingroup utility
+
+	Unlike juce::Random, this class doesn't advance an internal state, but creates the numbers by scrambling
+	a counter with the key (the seed). Every number only depends on the seed, the stream and its position, so
+
+	- you can create many independent streams from the same seed (eg. one for each voice or event),
+	- the same seed and stream will always produce the same numbers on every platform,
+	- blocks of numbers can be calculated in parallel (fillUniform() processes multiple counters at once
+	  so the compiler can vectorise the rounds).
+*/
+class PhiloxRandom
+{
+public:
+
+	enum
+	{
+		NumValuesPerBlock = 4,
+		NumLanes = 4
+	};
+
+	/** Creates a generator with the given seed and stream index. */
+	PhiloxRandom(uint64 seed = 0, uint64 streamIndex = 0) noexcept;
+
+	/** Changes the seed and starts the stream from the beginning. */
+	void setSeed(uint64 newSeed) noexcept;
+
+	/** Changes the stream and starts it from the beginning. */
+	void setStream(uint64 newStreamIndex) noexcept;
+
+	/** Jumps to the given number of the current stream without calculating the numbers in between. */
+	void setPosition(uint64 numberIndex) noexcept;
+
+	/** Returns the index of the next number in the current stream. */
+	uint64 getPosition() const noexcept;
+
+	/** Returns the next number with 32 random bits. */
+	uint32 nextUint32() noexcept
+	{
+		if (blockPosition == NumValuesPerBlock)
+			refillBlock();
+
+		return currentBlock[blockPosition++];
+	}
+
+	/** Returns a number between 0 and maxValue (exclusive). */
+	int nextInt(int maxValue) noexcept
+	{
+		jassert(maxValue > 0);
+		return (int)(((uint64)nextUint32() * (uint64)maxValue) >> 32);
+	}
+
+	/** Returns a number within the given range (the end is exclusive). */
+	int nextInt(Range<int> range) noexcept
+	{
+		return range.getStart() + nextInt(jmax<int>(1, range.getLength()));
+	}
+
+	/** Returns a number between 0.0f and 1.0f (exclusive). */
+	float nextFloat() noexcept { return toUnipolar(nextUint32()); }
+
+	/** Returns a number between 0.0 and 1.0 (exclusive) with 53 random bits. */
+	double nextDouble() noexcept;
+
+	bool nextBool() noexcept { return (nextUint32() & 0x80000000) != 0; }
+
+	/** Fills the data with numbers between 0.0f and 1.0f. This yields the same numbers as calling nextFloat() repeatedly. */
+	void fillUniform(float* data, int numValues) noexcept;
+
+	/** Fills the data with numbers between -1.0f and 1.0f. */
+	void fillBipolar(float* data, int numValues) noexcept;
+
+	/** Calculates a single block with the given counter and key. */
+	static void generateBlock(const uint32* counter, const uint32* key, uint32* result) noexcept;
+
+	static float toUnipolar(uint32 v) noexcept { return (float)(int)(v >> 8) * (1.0f / 16777216.0f); }
+	static float toBipolar(uint32 v) noexcept { return (float)(int)(v >> 8) * (2.0f / 16777216.0f) - 1.0f; }
+
+private:
+
+	/** Calculates up to NumLanes blocks starting with the given block index. */
+	void generateBlocks(uint64 firstBlock, uint32* destination, int numBlocks) const noexcept;
+
+	template <bool Bipolar> void fillInternal(float* data, int numValues) noexcept;
+
+	void refillBlock() noexcept;
+
+	uint32 key[2];
+	uint64 streamIndex = 0;
+	uint64 nextBlockIndex = 0;
+
+	uint32 currentBlock[NumValuesPerBlock];
+	int blockPosition = NumValuesPerBlock;
+};
+
+
+/** Creates the random number generators of a project.
+	@ingroup utility
+
+	Every generator is derived from the project seed, a stream ID (eg. the hashed ID of the processor that uses it)
+	and optionally the voice index and the event ID. This way the same events create the same random numbers, which
+	makes renders reproducible, no matter in which order the voices are calculated.
+*/
+class RandomNumberService
+{
+public:
+
+	RandomNumberService(uint64 initialSeed = 0) :
+		projectSeed(initialSeed)
+	{};
+
+	void setProjectSeed(uint64 newSeed) noexcept { projectSeed.store(newSeed); }
+	uint64 getProjectSeed() const noexcept { return projectSeed.load(); }
+
+	/** Returns a stream ID for the given name that doesn't change between sessions. */
+	static uint32 getStreamId(const String& name) { return (uint32)name.hashCode(); }
+
+	/** Creates a generator for the given stream. */
+	PhiloxRandom createGenerator(uint32 streamId) const noexcept
+	{
+		return PhiloxRandom(getProjectSeed(), getStreamIndex(streamId, -1, 0));
+	}
+
+	/** Creates a generator for the given stream that depends on the voice and the event ID. */
+	PhiloxRandom createGenerator(uint32 streamId, int voiceIndex, uint16 eventId) const noexcept
+	{
+		return PhiloxRandom(getProjectSeed(), getStreamIndex(streamId, voiceIndex, eventId));
+	}
+
+	static uint64 getStreamIndex(uint32 streamId, int voiceIndex, uint16 eventId) noexcept
+	{
+		return ((uint64)streamId << 32) | ((uint64)(voiceIndex & 0xFFFF) << 16) | (uint64)eventId;
+	}
+
+private:
+
+	std::atomic<uint64> projectSeed;
+
+	JUCE_DECLARE_NON_COPYABLE(RandomNumberService);
+};
+
+} // namespace hise
+
+#endif  // COUNTERBASEDRANDOM_H_INCLUDED
@@ -0,0 +1,158 @@
+/*  ===========================================================================
+*
+*   This file is part of HISE.
+*   Copyright 2016 Christoph Hart
+*
+*   HISE is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   HISE is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with HISE.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Commercial licenses for using HISE in an closed source project are
+*   available on request. Please visit the project's website to get more
+*   information about commercial licensing:
+*
+*   http://www.hise.audio/
+*
+*   HISE is based on the JUCE library,
+*   which must be separately licensed for closed source applications:
+*
+*   http://www.juce.com
+*
+*   ===========================================================================
+*/
+
+
+#include "AppConfig.h"
+
+#if HI_RUN_UNIT_TESTS
+
+#include  "JuceHeader.h"
+
+using namespace hise;
+
+class CounterBasedRandomUnitTest : public UnitTest
+{
+public:
+
+	CounterBasedRandomUnitTest() :
+		UnitTest("Testing counter based random")
+	{
+
+	}
+
+	void runTest() override
+	{
+		testCounterBasedRandom();
+	}
+
+private:
+
+	void testCounterBasedRandom()
+	{
+		beginTest("Testing counter based random numbers");
+
+		// The known answer vectors of the Random123 reference implementation
+		{
+			uint32 counter[4] = { 0, 0, 0, 0 };
+			uint32 key[2] = { 0, 0 };
+			uint32 result[4];
+
+			PhiloxRandom::generateBlock(counter, key, result);
+
+			expectEquals<int>((int)result[0], (int)0x6627e8d5);
+			expectEquals<int>((int)result[3], (int)0x9b00dbd8);
+
+			uint32 piCounter[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 };
+			uint32 piKey[2] = { 0xa4093822, 0x299f31d0 };
+
+			PhiloxRandom::generateBlock(piCounter, piKey, result);
+
+			expectEquals<int>((int)result[0], (int)0xd16cfe09);
+			expectEquals<int>((int)result[3], (int)0x24126ea1);
+		}
+
+		// The block fill must produce the same values as single calls
+		PhiloxRandom single(0x1234, 9);
+		PhiloxRandom block(0x1234, 9);
+
+		float expected[1000];
+		float actual[1000];
+
+		for (int i = 0; i < 1000; i++)
+			expected[i] = single.nextFloat() * 2.0f - 1.0f;
+
+		block.fillBipolar(actual, 3);
+		block.fillBipolar(actual + 3, 514);
+		block.fillBipolar(actual + 517, 483);
+
+		int numMismatches = 0;
+
+		for (int i = 0; i < 1000; i++)
+		{
+			if (std::abs(expected[i] - actual[i]) > 1e-6f || std::abs(actual[i]) > 1.0f)
+				numMismatches++;
+		}
+
+		expectEquals<int>(numMismatches, 0, "Block fill matches single values");
+
+		// Random access
+		PhiloxRandom seeker(0x1234, 9);
+		seeker.setPosition(517);
+
+		expectEquals<float>(seeker.nextFloat() * 2.0f - 1.0f, expected[517], "setPosition()");
+		expect(seeker.getPosition() == 518, "getPosition()");
+
+		// The streams of the service are reproducible and independent
+		RandomNumberService service(42);
+		const uint32 streamId = RandomNumberService::getStreamId("Noise Generator");
+
+		auto a = service.createGenerator(streamId, 3, 100);
+		auto b = service.createGenerator(streamId, 3, 100);
+		auto otherVoice = service.createGenerator(streamId, 4, 100);
+		auto otherEvent = service.createGenerator(streamId, 3, 101);
+
+		int numEqual = 0;
+		int numCollisions = 0;
+
+		for (int i = 0; i < 256; i++)
+		{
+			const uint32 v = a.nextUint32();
+
+			numEqual += (v == b.nextUint32()) ? 1 : 0;
+			numCollisions += (v == otherVoice.nextUint32() || v == otherEvent.nextUint32()) ? 1 : 0;
+		}
+
+		expectEquals<int>(numEqual, 256, "Same stream is reproducible");
+		expectEquals<int>(numCollisions, 0, "Different streams are independent");
+
+		service.setProjectSeed(43);
+		auto c = service.createGenerator(streamId, 3, 100);
+		auto d = service.createGenerator(streamId, 3, 100);
+		d.setSeed(42);
+
+		expect(c.nextUint32() != d.nextUint32(), "The project seed changes the stream");
+
+		for (int i = 0; i < 1000; i++)
+		{
+			const int v = a.nextInt(Range<int>(-5, 5));
+
+			if (v < -5 || v >= 5)
+				numMismatches++;
+		}
+
+		expectEquals<int>(numMismatches, 0, "nextInt() stays in range");
+	}
+};
+
+static CounterBasedRandomUnitTest counterBasedRandomTestInstance;
+
+#endif
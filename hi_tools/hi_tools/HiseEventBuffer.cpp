@@ -585,6 +585,27 @@ void HiseEventBuffer::moveEventsAbove(HiseEventBuffer& targetBuffer, int lowestT
 	numUsed = indexOfFirstElementToMove;
 }
 
+void HiseEventBuffer::moveEventsAbove(HiseEventScheduler& targetScheduler, int lowestTimestamp)
+{
+	if (numUsed == 0 || (buffer[numUsed - 1].getTimeStamp() < lowestTimestamp))
+		return; // Skip the work if no events with bigger timestamps
+
+	jassert(timeStampsAreSorted());
+
+	int indexOfFirstElementToMove = numUsed;
+
+	while (indexOfFirstElementToMove > 0 && buffer[indexOfFirstElementToMove - 1].getTimeStamp() >= lowestTimestamp)
+		indexOfFirstElementToMove--;
+
+	// Add them in the buffer order so that events with the same timestamp keep their order
+	for (int i = indexOfFirstElementToMove; i < numUsed; i++)
+		targetScheduler.addEvent(buffer[i]);
+
+	HiseEvent::clear(buffer + indexOfFirstElementToMove, numUsed - indexOfFirstElementToMove);
+
+	numUsed = indexOfFirstElementToMove;
+}
+
 void HiseEventBuffer::copyFrom(const HiseEventBuffer& otherBuffer)
 {
     const int eventsToCopy = jmin<int>(otherBuffer.numUsed, HISE_EVENT_BUFFER_SIZE);
@@ -686,6 +707,172 @@ void HiseEventBuffer::insertEventAtPosition(const HiseEvent& e, int positionInBu
     }
 }
 
+HiseEventScheduler::HiseEventScheduler(int poolSize_):
+	poolSize(jmax<int>(1, poolSize_))
+{
+	nodes.calloc(poolSize);
+
+	clear();
+}
+
+void HiseEventScheduler::addEvent(const HiseEvent& e)
+{
+	addEventAtPosition(e, position + e.getTimeStamp());
+}
+
+void HiseEventScheduler::addEventAtPosition(const HiseEvent& e, int64 samplePosition)
+{
+	if (firstFreeNode == -1)
+	{
+		// You've scheduled too many events. Increase HISE_EVENT_SCHEDULER_SIZE if you need more.
+		jassertfalse;
+		return;
+	}
+
+	const int nodeIndex = firstFreeNode;
+	auto& n = nodes[nodeIndex];
+
+	firstFreeNode = n.next;
+
+	n.e = e;
+	n.position = jmax<int64>(position, samplePosition);
+
+	insertNode(nodeIndex);
+
+	numScheduled++;
+}
+
+void HiseEventScheduler::moveDueEvents(HiseEventBuffer& targetBuffer, int numSamples)
+{
+	const int64 blockStart = position;
+	const int64 blockEnd = position + numSamples;
+
+	while (numScheduled > 0 && position < blockEnd)
+	{
+		// Process the block until the end of the range of the first level
+		const int64 rangeEnd = (position | SlotMask) + 1;
+		const int64 end = jmin<int64>(blockEnd, rangeEnd);
+
+		const int firstSlot = (int)(position & SlotMask);
+		const int lastSlot = (int)((end - 1) & SlotMask);
+
+		uint64 dueSlots = usedSlots[0] & (~(uint64)0 << firstSlot) & (~(uint64)0 >> (SlotMask - lastSlot));
+
+		while (dueSlots != 0)
+		{
+			const uint64 lowestBit = dueSlots & (~dueSlots + 1);
+
+			moveSlot(countNumberOfBits(lowestBit - 1), targetBuffer, blockStart);
+
+			dueSlots &= ~lowestBit;
+		}
+
+		position = end;
+
+		if (position == rangeEnd)
+			cascade();
+	}
+
+	// If there are no events left, we don't need to redistribute anything
+	position = blockEnd;
+}
+
+void HiseEventScheduler::clear()
+{
+	for (int i = 0; i < poolSize; i++)
+		nodes[i].next = (i + 1 < poolSize) ? i + 1 : -1;
+
+	firstFreeNode = 0;
+	numScheduled = 0;
+
+	for (int level = 0; level < NumLevels; level++)
+	{
+		for (auto& s : slots[level])
+			s = Slot();
+
+		usedSlots[level] = 0;
+	}
+}
+
+void HiseEventScheduler::insertNode(int nodeIndex)
+{
+	auto& n = nodes[nodeIndex];
+
+	// The highest level also takes the events that are more than one rotation away
+	int level = 0;
+
+	while (level < NumLevels - 1 && (n.position >> (NumSlotBits * (level + 1))) != (position >> (NumSlotBits * (level + 1))))
+		level++;
+
+	const int slotIndex = (int)(n.position >> (NumSlotBits * level)) & SlotMask;
+	auto& s = slots[level][slotIndex];
+
+	n.next = -1;
+
+	if (s.tail == -1)
+		s.head = nodeIndex;
+	else
+		nodes[s.tail].next = nodeIndex;
+
+	s.tail = nodeIndex;
+
+	usedSlots[level] |= (uint64)1 << slotIndex;
+}
+
+void HiseEventScheduler::cascade()
+{
+	// Find the highest level with a slot that starts at the current position
+	int highestLevel = 1;
+
+	while (highestLevel < NumLevels - 1 && (position & (((int64)1 << (NumSlotBits * (highestLevel + 1))) - 1)) == 0)
+		highestLevel++;
+
+	// Start at the top so that the order of events with the same position is kept
+	for (int level = highestLevel; level > 0; level--)
+	{
+		const int slotIndex = (int)(position >> (NumSlotBits * level)) & SlotMask;
+		const uint64 slotBit = (uint64)1 << slotIndex;
+
+		if ((usedSlots[level] & slotBit) == 0)
+			continue;
+
+		const Slot s = slots[level][slotIndex];
+
+		slots[level][slotIndex] = Slot();
+		usedSlots[level] &= ~slotBit;
+
+		for (int i = s.head; i != -1;)
+		{
+			const int next = nodes[i].next;
+			insertNode(i);
+			i = next;
+		}
+	}
+}
+
+void HiseEventScheduler::moveSlot(int slotIndex, HiseEventBuffer& targetBuffer, int64 blockStart)
+{
+	auto& s = slots[0][slotIndex];
+
+	for (int i = s.head; i != -1;)
+	{
+		auto& n = nodes[i];
+		const int next = n.next;
+
+		n.e.setTimeStamp((int)(n.position - blockStart));
+		targetBuffer.addEvent(n.e);
+
+		n.next = firstFreeNode;
+		firstFreeNode = i;
+		numScheduled--;
+
+		i = next;
+	}
+
+	s = Slot();
+	usedSlots[0] &= ~((uint64)1 << slotIndex);
+}
+
 EventIdHandler::EventIdHandler(HiseEventBuffer& masterBuffer_) :
 	masterBuffer(masterBuffer_),
 	currentEventId(1)
@@ -720,7 +907,9 @@ void EventIdHandler::handleEventIds()
 		{
 			auto channel = jlimit<int>(0, 15, m->getChannel() - 1);
 
-			m->setEventId(currentEventId++);
+			// Note ons from the event inbox might already have a reserved ID
+			if (m->getEventId() == 0)
+				m->setEventId(currentEventId++);
 
 			if (realNoteOnEvents[channel][m->getNoteNumber()].isEmpty())
 				realNoteOnEvents[channel][m->getNoteNumber()] = HiseEvent(*m);
@@ -815,11 +1004,22 @@ void EventIdHandler::pushArtificialNoteOn(HiseEvent& noteOnEvent) noexcept
 	jassert(noteOnEvent.isNoteOn());
 	jassert(noteOnEvent.isArtificial());
 
-	noteOnEvent.setEventId(currentEventId);
-	artificialEvents[currentEventId % HISE_EVENT_ID_ARRAY_SIZE] = noteOnEvent;
-	lastArtificialEventIds[noteOnEvent.getChannel() % 16][noteOnEvent.getNoteNumber()] = currentEventId;
+	const uint16 eventId = currentEventId++;
+
+	noteOnEvent.setEventId(eventId);
+	artificialEvents[eventId % HISE_EVENT_ID_ARRAY_SIZE] = noteOnEvent;
+	lastArtificialEventIds[noteOnEvent.getChannel() % 16][noteOnEvent.getNoteNumber()] = eventId;
+}
+
+uint16 EventIdHandler::reserveEventId() noexcept
+{
+	uint16 eventId = currentEventId++;
+
+	// Zero means "no ID yet"
+	if (eventId == 0)
+		eventId = currentEventId++;
 
-	currentEventId++;
+	return eventId;
 }
 
 
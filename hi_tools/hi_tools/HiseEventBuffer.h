@@ -470,6 +470,12 @@ private:
 
 #define HISE_EVENT_BUFFER_SIZE 256
 
+#ifndef HISE_EVENT_SCHEDULER_SIZE
+#define HISE_EVENT_SCHEDULER_SIZE 1024
+#endif
+
+class HiseEventScheduler;
+
 /** The buffer type for the HiseEvent.
 
 */
@@ -623,6 +629,9 @@ public:
 	void moveEventsBelow(HiseEventBuffer& targetBuffer, int highestTimestamp);
 	void moveEventsAbove(HiseEventBuffer& targetBuffer, int lowestTimestamp);
 
+	/** Moves all events with a timestamp of lowestTimestamp or higher into the scheduler. */
+	void moveEventsAbove(HiseEventScheduler& targetScheduler, int lowestTimestamp);
+
 	void copyFrom(const HiseEventBuffer& otherBuffer);
 
 	void addEvent(const HiseEvent& hiseEvent);
@@ -714,6 +723,93 @@ private:
 };
 
 
+/** A scheduler for events that are due in a later block.
+*
+*	The events are stored with their absolute sample position in a hierarchical timing wheel, so adding an event and
+*	fetching the events for the current block doesn't depend on the number of scheduled events (the old approach of
+*	shifting a sorted HiseEventBuffer by the block size was O(n) on every block).
+*
+*	Each level of the wheel has 64 slots and covers 64 times the range of the level below, with the first level
+*	having a resolution of one sample. When the position crosses the boundary of a slot in a higher level, its
+*	events are redistributed to the lower levels. Events with the same position are returned in the order they
+*	were added.
+*
+*	The nodes are allocated in the constructor, so you can add and fetch events in the audio thread. The only limit
+*	is the size of the node pool.
+*/
+class HiseEventScheduler
+{
+public:
+
+	HiseEventScheduler(int poolSize=HISE_EVENT_SCHEDULER_SIZE);
+
+	/** Adds an event. The timestamp is relative to the start of the current block. */
+	void addEvent(const HiseEvent& e);
+
+	/** Adds an event at the absolute sample position. If the position is in the past, it will be due in the current block. */
+	void addEventAtPosition(const HiseEvent& e, int64 samplePosition);
+
+	/** Adds all events that are due in the current block to the buffer and advances the position to the next block.
+	*
+	*	The timestamps of the events will be relative to the start of the current block.
+	*/
+	void moveDueEvents(HiseEventBuffer& targetBuffer, int numSamples);
+
+	/** Removes all scheduled events. */
+	void clear();
+
+	bool isEmpty() const noexcept { return numScheduled == 0; }
+
+	int getNumScheduledEvents() const noexcept { return numScheduled; }
+
+	/** Returns the absolute sample position of the current block. */
+	int64 getCurrentPosition() const noexcept { return position; }
+
+	int getPoolSize() const noexcept { return poolSize; }
+
+private:
+
+	static constexpr int NumLevels = 6;
+	static constexpr int NumSlotBits = 6;
+	static constexpr int NumSlots = 1 << NumSlotBits;
+	static constexpr int SlotMask = NumSlots - 1;
+
+	struct Node
+	{
+		HiseEvent e;
+		int64 position;
+		int next;
+	};
+
+	struct Slot
+	{
+		int head = -1;
+		int tail = -1;
+	};
+
+	/** Adds the node to the lowest level that contains its position. */
+	void insertNode(int nodeIndex);
+
+	/** Redistributes the events of the slots that start at the current position. */
+	void cascade();
+
+	/** Adds the events of the slot to the buffer and returns the nodes to the pool. */
+	void moveSlot(int slotIndex, HiseEventBuffer& targetBuffer, int64 blockStart);
+
+	HeapBlock<Node> nodes;
+	int poolSize;
+	int firstFreeNode = -1;
+	int numScheduled = 0;
+
+	int64 position = 0;
+
+	Slot slots[NumLevels][NumSlots];
+	uint64 usedSlots[NumLevels];
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HiseEventScheduler)
+};
+
+
 
 
 /** This class will iterate over incoming MIDI messages, and transform them
@@ -749,6 +845,13 @@ public:
 	/** Searches all active note on events and returns the one with the given event id. */
 	HiseEvent popNoteOnFromEventId(uint16 eventId);
 
+	/** Reserves an event ID for a note on that will be added to the master buffer later.
+	*
+	*	Set the ID to the note on before you schedule it (eg. with the EventInbox) and handleEventIds() will keep it
+	*	instead of assigning a new one. This can be called from any thread.
+	*/
+	uint16 reserveEventId() noexcept;
+
 	// ===========================================================================================================
 
 private:
@@ -757,7 +860,7 @@ private:
 	HeapBlock<HiseEvent> artificialEvents;
 	uint16 lastArtificialEventIds[16][128];
 	HiseEvent realNoteOnEvents[16][128];
-	uint16 currentEventId;
+	std::atomic<uint16> currentEventId;
 
 	UnorderedStack<HiseEvent, 256> overlappingNoteOns;
 
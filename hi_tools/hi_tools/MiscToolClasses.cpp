@@ -619,17 +619,17 @@ Rectangle<int> HiseDeviceSimulator::getDisplayResolution()
 
 void PooledUIUpdater::Broadcaster::sendPooledChangeMessage()
 {
-	if (pending)
-		return;
-
-	if (handler != nullptr)
+	if (handler == nullptr)
 	{
-		handler.get()->pendingHandlers.push(this);
-		pending = true;
-	}
-		
-	else
 		jassertfalse; // you need to register it...
+		return;
+	}
+
+	// Only the first message until the next timer callback is queued
+	if (pending.exchange(true))
+		return;
+
+	handler.get()->pendingHandlers.push(this);
 }
 
 void SafeChangeListener::handlePooledMessage(PooledUIUpdater::Broadcaster* b)
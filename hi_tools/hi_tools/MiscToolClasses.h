@@ -178,6 +178,11 @@ public:
 		void setHandler(PooledUIUpdater* handler_)
 		{
 			handler = handler_;
+
+			// Creates the shared pointer of the weak reference, so that
+			// sendPooledChangeMessage() doesn't allocate.
+			WeakReference<Broadcaster> r(this);
+			ignoreUnused(r);
 		}
 
 		void sendPooledChangeMessage();
@@ -187,7 +192,7 @@ public:
 
 		bool isHandlerInitialised() const { return handler != nullptr; };
 
-		bool pending = false;
+		std::atomic<bool> pending = { false };
 
 	private:
 
@@ -208,7 +213,7 @@ public:
 		{
 			if (b.get() != nullptr)
 			{
-				b->pending = false;
+				b->pending.store(false);
 
 				for (auto l : b->pooledListeners)
 				{